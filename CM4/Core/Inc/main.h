@@ -63,6 +63,24 @@ void Error_Handler(void);
 #define OSC32_IN_GPIO_Port GPIOC
 #define OSC_IN_Pin GPIO_PIN_0
 #define OSC_IN_GPIO_Port GPIOH
+#define TO_MCU_BP_SPEED_Pin GPIO_PIN_8
+#define TO_MCU_BP_SPEED_GPIO_Port GPIOA
+#define NTC_1_Pin GPIO_PIN_0
+#define NTC_1_GPIO_Port GPIOC
+#define NTC_2_Pin GPIO_PIN_1
+#define NTC_2_GPIO_Port GPIOC
+#define TO_MCU_RAD_SPEED_Pin GPIO_PIN_0
+#define TO_MCU_RAD_SPEED_GPIO_Port GPIOA
+#define VOLTAGE_SENSE_3V3_Pin GPIO_PIN_6
+#define VOLTAGE_SENSE_3V3_GPIO_Port GPIOA
+#define MANETTINO_1_Pin GPIO_PIN_0
+#define MANETTINO_1_GPIO_Port GPIOA
+#define MANETTINO_2_Pin GPIO_PIN_1
+#define MANETTINO_2_GPIO_Port GPIOA
+#define VOLTAGE_SENS_5V_Pin GPIO_PIN_4
+#define VOLTAGE_SENS_5V_GPIO_Port GPIOC
+#define VOLTAGE_SENSE_24V_Pin GPIO_PIN_1
+#define VOLTAGE_SENSE_24V_GPIO_Port GPIOB
 
 /* USER CODE BEGIN Private defines */
 
@@ -0,0 +1,20 @@
+#ifndef MEM_SECTIONS_H
+#define MEM_SECTIONS_H
+
+/*
+ * Placement on the CM4, see STM32H745XIHX_FLASH.ld. The core has no tightly
+ * coupled memory: the same macros as on the CM7 put the hot paths of the
+ * I/O code in the D2 SRAM1, which the CM4 reaches without wait states,
+ * instead of the flash behind the ART accelerator.
+ */
+
+/* Code copied to the SRAM1 with the initialized data (.RamFunc). Calls
+ * between the flash and the SRAM go through long-branch veneers added by
+ * the linker. */
+#define ITCM_FUNC __attribute__((section(".RamFunc"), noinline))
+
+/* Data in the SRAM1 like any other, the whole RAM of the CM4 is fast */
+#define DTCM_DATA
+#define DTCM_BSS
+
+#endif /* MEM_SECTIONS_H */
@@ -0,0 +1,36 @@
+#ifndef CAN_DB_H
+#define CAN_DB_H
+
+#include <stdint.h>
+
+#include "can_msgs.h"
+#include "driver/can.h"
+#include "sw/can_log.h"
+#include "sw/can_tx.h"
+
+/* Frames the dash consumes, IDs from the DBC (can_msgs.h, generated by
+ * tools/dbcgen). Bus 1 carries the powertrain (BMS, inverters, vehicle
+ * control unit), bus 2 the chassis sensors and the telemetry unit. */
+
+extern const BSP_CAN_RxId_t CAN_DB_Bus1[];
+extern const uint32_t CAN_DB_Bus1Count;
+extern const BSP_CAN_RxId_t CAN_DB_Bus2[];
+extern const uint32_t CAN_DB_Bus2Count;
+
+/* Powertrain frames forwarded from bus 1 to the telemetry unit on bus 2 */
+extern const BSP_CAN_Route_t CAN_DB_Routes1[];
+extern const uint32_t CAN_DB_Routes1Count;
+
+/* Messages flagged stale on the dash when they stop (CAN_SUP) */
+extern const uint16_t CAN_DB_Supervised[];
+extern const uint32_t CAN_DB_SupervisedCount;
+
+/* Messages recorded by the telemetry log on the CM7 (CAN_LOG) */
+extern const CAN_LOG_Channel_t CAN_DB_Logged[];
+extern const uint32_t CAN_DB_LoggedCount;
+
+/* Frames the dash sends */
+extern const CAN_TX_Entry_t CAN_DB_Tx[];
+extern const uint32_t CAN_DB_TxCount;
+
+#endif /* CAN_DB_H */
@@ -0,0 +1,18 @@
+#ifndef CAN_LOAD_H
+#define CAN_LOAD_H
+
+#include <stdint.h>
+
+/* Bits of a frame on the wire, split by the rate they are sent at */
+typedef struct
+{
+  uint32_t Nominal; /* Arbitration phase, trailer and intermission */
+  uint32_t Data;    /* Data phase, 0 for classic frames */
+} CAN_LOAD_Bits_t;
+
+uint32_t CAN_LOAD_FdLen(uint32_t Len);
+void CAN_LOAD_FrameBits(uint32_t Len, uint32_t Extended, uint32_t Fd, CAN_LOAD_Bits_t *Bits);
+uint32_t CAN_LOAD_FrameNs(uint32_t Len, uint32_t Extended, uint32_t Fd, uint32_t NominalBitrate,
+                          uint32_t DataBitrate);
+
+#endif /* CAN_LOAD_H */
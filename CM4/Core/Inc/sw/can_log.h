@@ -0,0 +1,31 @@
+#ifndef CAN_LOG_H
+#define CAN_LOG_H
+
+#include <stdint.h>
+
+#include "can_msgs.h"
+#include "driver/errno.h"
+
+/* Messages the recorder can hold */
+#ifndef CAN_LOG_MSGS_MAX
+#define CAN_LOG_MSGS_MAX 16U
+#endif
+
+/* A message recorded by the CM7 telemetry log */
+typedef struct
+{
+  uint16_t Msg;   /* CAN_MSG_<NAME>_INDEX */
+  uint32_t MinUs; /* Shortest interval between two records, 0 for every frame */
+} CAN_LOG_Channel_t;
+
+typedef struct
+{
+  uint32_t Forwarded; /* Frames queued for the CM7 */
+  uint32_t Skipped;   /* Frames inside the MinUs of their channel */
+  uint32_t Dropped;   /* Frames lost on a full or closed ring */
+} CAN_LOG_Stats_t;
+
+int32_t CAN_LOG_Init(const CAN_LOG_Channel_t *Channels, uint32_t Count);
+const CAN_LOG_Stats_t *CAN_LOG_GetStats(void);
+
+#endif /* CAN_LOG_H */
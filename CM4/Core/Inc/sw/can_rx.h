@@ -0,0 +1,35 @@
+#ifndef CAN_RX_H
+#define CAN_RX_H
+
+#include <stdint.h>
+
+#include "can_msgs.h"
+#include "driver/can.h"
+#include "driver/errno.h"
+
+/* Handlers per message */
+#ifndef CAN_RX_HANDLERS_MAX
+#define CAN_RX_HANDLERS_MAX 4U
+#endif
+
+/* Frames taken from the driver per BSP_CAN_Read() */
+#define CAN_RX_BATCH 16U
+
+/* Called with the decoded signals (CAN_MSG_<NAME>_t of message Msg) */
+typedef void (*CAN_RX_Handler_t)(uint32_t Msg, const void *pSignals, const BSP_CAN_Frame_t *pFrame, void *Context);
+
+typedef struct
+{
+  uint32_t Frames[CAN_MSGS_COUNT]; /* Dispatched, per message */
+  uint32_t Unknown;                /* ID not in the DBC */
+  uint32_t Short;                  /* Fewer bytes than the DBC DLC */
+  uint32_t LatencyMaxUs;           /* From the start of frame to the handlers */
+  uint64_t LatencySumUs;           /* Mean: LatencySumUs / dispatched frames */
+} CAN_RX_Stats_t;
+
+int32_t CAN_RX_Subscribe(uint32_t Msg, CAN_RX_Handler_t Handler, void *Context);
+void CAN_RX_Dispatch(const BSP_CAN_Frame_t *pFrame);
+uint32_t CAN_RX_Process(void);
+const CAN_RX_Stats_t *CAN_RX_GetStats(void);
+
+#endif /* CAN_RX_H */
@@ -0,0 +1,60 @@
+#ifndef CAN_STATS_H
+#define CAN_STATS_H
+
+#include <stdint.h>
+
+#include "can_msgs.h"
+#include "driver/can.h"
+
+/* Period of the rates, loads and window maxima */
+#define CAN_STATS_WINDOW_MS 1000U
+
+/* A periodic message misses its deadline when nothing arrives within this
+ * share of its cycle time, in percent */
+#define CAN_STATS_DEADLINE_PCT 150U
+
+/* Cost allowed to CAN_STATS_Rx() and CAN_STATS_Tx() per frame, in DWT
+ * cycles of the CM4 (0.8 us at 240 MHz) */
+#ifndef CAN_STATS_BUDGET_CYCLES
+#define CAN_STATS_BUDGET_CYCLES 200U
+#endif
+
+/* One DBC message, received or sent */
+typedef struct
+{
+  uint32_t Frames;
+  uint32_t Rate;          /* Frames per second over the last window */
+  uint32_t Missed;        /* Deadlines missed: late frame or silence */
+  uint32_t JitterMaxUs;   /* Largest |inter-arrival - cycle| of the last window */
+  uint32_t IntervalMaxUs; /* Largest inter-arrival of the last window */
+  uint64_t LastUs;        /* Start of the last frame, 0 before the first */
+} CAN_STATS_Id_t;
+
+typedef struct
+{
+  uint32_t LoadPermille; /* Bus time taken by the frames of the last window, worst-case stuffing */
+  uint32_t Rate;         /* Frames per second, both directions */
+  uint32_t Frames;
+  uint32_t Unknown;      /* Frames with an ID outside the DBC */
+  uint32_t BusOff;       /* Bus-off events */
+  BSP_CAN_Errors_t Errors;
+} CAN_STATS_Bus_t;
+
+/* Measured cost of the per-frame update */
+typedef struct
+{
+  uint32_t Samples;
+  uint32_t MaxCycles;
+  uint64_t SumCycles;
+  uint32_t OverBudget; /* Updates above CAN_STATS_BUDGET_CYCLES */
+} CAN_STATS_Cost_t;
+
+void CAN_STATS_Init(void);
+void CAN_STATS_Rx(BSP_CAN_Bus_t Bus, const BSP_CAN_Frame_t *pFrame);
+void CAN_STATS_Tx(BSP_CAN_Bus_t Bus, const BSP_CAN_TxEvent_t *pEvent);
+void CAN_STATS_Process(void);
+const CAN_STATS_Bus_t *CAN_STATS_GetBus(BSP_CAN_Bus_t Bus);
+const CAN_STATS_Id_t *CAN_STATS_GetId(uint32_t Msg);
+const CAN_STATS_Cost_t *CAN_STATS_GetCost(void);
+
+#endif /* CAN_STATS_H */
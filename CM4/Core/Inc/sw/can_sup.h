@@ -0,0 +1,32 @@
+#ifndef CAN_SUP_H
+#define CAN_SUP_H
+
+#include <stdint.h>
+
+#include "can_msgs.h"
+#include "driver/errno.h"
+
+/* Messages the supervisor can hold */
+#ifndef CAN_SUP_MSGS_MAX
+#define CAN_SUP_MSGS_MAX 16U
+#endif
+
+/* Staleness listeners */
+#define CAN_SUP_LISTENERS_MAX 4U
+
+/* A message is stale after this many DBC cycle times without a frame, and
+ * never sooner than CAN_SUP_TIMEOUT_MIN_MS */
+#define CAN_SUP_TIMEOUT_CYCLES 3U
+#define CAN_SUP_TIMEOUT_MIN_MS 20U
+
+/* Called on every change, Stale is 1 when the message times out and 0 on
+ * its next frame. Main loop context. */
+typedef void (*CAN_SUP_Listener_t)(uint32_t Msg, uint32_t Stale, void *Context);
+
+int32_t CAN_SUP_Init(const uint16_t *Msgs, uint32_t Count);
+int32_t CAN_SUP_Listen(CAN_SUP_Listener_t Listener, void *Context);
+void CAN_SUP_Process(void);
+uint32_t CAN_SUP_IsStale(uint32_t Msg);
+uint32_t CAN_SUP_GetTimeouts(uint32_t Msg);
+
+#endif /* CAN_SUP_H */
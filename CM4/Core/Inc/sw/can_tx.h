@@ -0,0 +1,55 @@
+#ifndef CAN_TX_H
+#define CAN_TX_H
+
+#include <stdint.h>
+
+#include "can_msgs.h"
+#include "driver/can.h"
+#include "driver/errno.h"
+
+/* Messages the scheduler can hold */
+#ifndef CAN_TX_MSGS_MAX
+#define CAN_TX_MSGS_MAX 16U
+#endif
+
+/* Timer wheel: 1 ms per slot, a power of two. Longer periods wrap around
+ * the wheel. */
+#define CAN_TX_WHEEL_SLOTS 64U
+
+/* Span over which the phase offsets balance the frames, a multiple of the
+ * usual periods */
+#define CAN_TX_PHASE_SPAN_MS 1000U
+
+/* CAN_TX_Entry_t.Buffer of messages going through the Tx queue */
+#define CAN_TX_QUEUE 0xFFU
+
+/* A transmitted message: bus and period come from the DBC */
+typedef struct
+{
+  uint16_t Msg;   /* CAN_MSG_<NAME>_INDEX */
+  uint8_t Buffer; /* Dedicated Tx buffer of the bus, or CAN_TX_QUEUE */
+} CAN_TX_Entry_t;
+
+typedef struct
+{
+  uint32_t Sent;           /* Periodic frames accepted by the driver */
+  uint32_t Events;         /* Event frames accepted by the driver */
+  uint32_t Busy;           /* Refused by the driver: periodic frames are dropped, events retried */
+  uint32_t Missed;         /* Periods skipped, the main loop ran late */
+  uint32_t PhaseMs;        /* Offset in the period, chosen by CAN_TX_Init() */
+  int32_t JitterMinUs;     /* Interval between two periodic sends minus the period */
+  int32_t JitterMaxUs;
+  uint32_t JitterAbsSumUs; /* Mean absolute jitter: JitterAbsSumUs / Intervals */
+  uint32_t Intervals;
+  uint32_t OnBus;          /* Tx events: frames that reached the bus */
+  uint32_t LatencyMaxUs;   /* From the send to the start of frame */
+  uint64_t LatencySumUs;   /* Mean latency: LatencySumUs / OnBus */
+} CAN_TX_Stats_t;
+
+int32_t CAN_TX_Init(const CAN_TX_Entry_t *Entries, uint32_t Count);
+int32_t CAN_TX_Set(uint32_t Msg, const void *pSignals);
+int32_t CAN_TX_Trigger(uint32_t Msg);
+void CAN_TX_Process(void);
+const CAN_TX_Stats_t *CAN_TX_GetStats(uint32_t Msg);
+
+#endif /* CAN_TX_H */
@@ -0,0 +1,13 @@
+#ifndef IPC_SRV_H
+#define IPC_SRV_H
+
+#include <stdint.h>
+
+#include "driver/errno.h"
+#include "ipc.h"
+
+int32_t IPC_SRV_Init(void);
+void IPC_SRV_Process(void);
+uint32_t IPC_SRV_GetSunk(void);
+
+#endif /* IPC_SRV_H */
@@ -0,0 +1,51 @@
+#ifndef SENSE_H
+#define SENSE_H
+
+#include <stdint.h>
+
+#include "driver/errno.h"
+#include "vstate.h"
+
+/* Sampling period of the analog inputs and the tachometers */
+#define SENSE_PERIOD_MS 10U
+
+/* First order filter of the analog inputs, weight of a new sample 1/2^n */
+#define SENSE_FILTER_SHIFT 2U
+
+/* ADC reference, the analog supply of the board */
+#ifndef SENSE_VREF_MV
+#define SENSE_VREF_MV 3300U
+#endif
+
+/* NTC thermistors to ground, pulled up to the ADC reference */
+#ifndef SENSE_NTC_PULLUP_OHM
+#define SENSE_NTC_PULLUP_OHM 10000.0f
+#endif
+#ifndef SENSE_NTC_R25_OHM
+#define SENSE_NTC_R25_OHM 10000.0f
+#endif
+#ifndef SENSE_NTC_BETA
+#define SENSE_NTC_BETA 3435.0f
+#endif
+
+/* Counter clock of the TIM1 and TIM2 input captures, prescaler 2399 of the
+ * 240 MHz timer clock (tim.c) */
+#define SENSE_TACH_HZ 100000U
+
+/* Tachometer pulses per fan revolution */
+#ifndef SENSE_TACH_PULSES
+#define SENSE_TACH_PULSES 2U
+#endif
+
+/* A tachometer silent this long reads 0 rpm, below the 655 ms wrap of the
+ * 16-bit TIM1 counter */
+#define SENSE_TACH_TIMEOUT_MS 500U
+
+/* NtcDeciC of an open or shorted thermistor */
+#define SENSE_NTC_INVALID INT16_MIN
+
+int32_t SENSE_Init(void);
+void SENSE_Process(void);
+void SENSE_Fill(VSTATE_t *pState);
+
+#endif /* SENSE_H */
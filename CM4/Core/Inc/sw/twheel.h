@@ -0,0 +1,50 @@
+#ifndef TWHEEL_H
+#define TWHEEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Hierarchical timer wheel: TWHEEL_LEVELS levels of 2^TWHEEL_BITS slots,
+ * one tick per slot on level 0, each level 2^TWHEEL_BITS times coarser.
+ * With 1 ms ticks the levels span 64 ms, 4.1 s and 262 s. */
+#define TWHEEL_BITS 6U
+#define TWHEEL_SLOTS (1UL << TWHEEL_BITS)
+#define TWHEEL_LEVELS 3U
+
+/* Longest timeout, longer ones are cut to it */
+#define TWHEEL_SPAN ((1UL << (TWHEEL_BITS * TWHEEL_LEVELS)) - 1U)
+
+typedef struct TWHEEL_Timer TWHEEL_Timer_t;
+
+/* Called from TWHEEL_Advance() with the timer unlinked, it may restart it */
+typedef void (*TWHEEL_Handler_t)(TWHEEL_Timer_t *pTimer);
+
+/* Embedded in the owner, first member to cast back from the handler */
+struct TWHEEL_Timer
+{
+  TWHEEL_Timer_t *pNext;
+  TWHEEL_Timer_t **ppPrev; /* Link pointing at this timer, NULL when stopped */
+  uint32_t Expires;        /* Tick */
+  TWHEEL_Handler_t Handler;
+};
+
+typedef struct
+{
+  TWHEEL_Timer_t *Slots[TWHEEL_LEVELS][TWHEEL_SLOTS];
+  uint32_t Now; /* Last tick served */
+} TWHEEL_t;
+
+void TWHEEL_Init(TWHEEL_t *pWheel, uint32_t Now);
+void TWHEEL_Start(TWHEEL_t *pWheel, TWHEEL_Timer_t *pTimer, uint32_t Expires);
+void TWHEEL_Stop(TWHEEL_Timer_t *pTimer);
+uint32_t TWHEEL_Advance(TWHEEL_t *pWheel, uint32_t Now);
+
+/**
+ * @brief  Whether a timer is running.
+ */
+static inline uint32_t TWHEEL_IsActive(const TWHEEL_Timer_t *pTimer)
+{
+  return (pTimer->ppPrev != NULL) ? 1U : 0U;
+}
+
+#endif /* TWHEEL_H */
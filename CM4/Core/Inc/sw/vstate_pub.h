@@ -0,0 +1,12 @@
+#ifndef VSTATE_PUB_H
+#define VSTATE_PUB_H
+
+#include <stdint.h>
+
+#include "driver/errno.h"
+#include "vstate.h"
+
+int32_t VSTATE_PUB_Init(void);
+void VSTATE_PUB_Process(void);
+
+#endif /* VSTATE_PUB_H */
@@ -18,10 +18,24 @@
 /* USER CODE END Header */
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
+#include "adc.h"
+#include "fdcan.h"
+#include "tim.h"
 #include "gpio.h"
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "driver/can.h"
+#include "sw/can_db.h"
+#include "sw/can_log.h"
+#include "sw/can_rx.h"
+#include "sw/can_stats.h"
+#include "sw/can_sup.h"
+#include "sw/can_tx.h"
+#include "sw/ipc_srv.h"
+#include "sw/sense.h"
+#include "sw/vstate_pub.h"
+#include "vstate.h"
 
 /* USER CODE END Includes */
 
@@ -36,6 +50,9 @@
 #ifndef HSEM_ID_0
 #define HSEM_ID_0 (0U) /* HW semaphore 0*/
 #endif
+
+/* Heartbeat of LED_8 */
+#define HEARTBEAT_MS 1000U
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -65,6 +82,7 @@
 int main(void)
 {
   /* USER CODE BEGIN 1 */
+  uint32_t heartbeat;
 
   /* USER CODE END 1 */
 
@@ -89,6 +107,10 @@ int main(void)
   HAL_Init();
 
   /* USER CODE BEGIN Init */
+  /* Cycle counter of the CAN statistics cost measurement */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0U;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
   /* USER CODE END Init */
 
@@ -98,7 +120,34 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_ADC1_Init();
+  MX_ADC2_Init();
+  MX_ADC3_Init();
+  MX_FDCAN1_Init();
+  MX_FDCAN2_Init();
+  MX_TIM1_Init();
+  MX_TIM2_Init();
   /* USER CODE BEGIN 2 */
+  /* SRAM3 clock, cleared snapshot before the first publication */
+  VSTATE_Init();
+  /* Only the consumed and routed IDs pass the acceptance filters */
+  if ((BSP_CAN_SetRoutes(CAN_BUS_1, CAN_DB_Routes1, CAN_DB_Routes1Count) != BSP_ERROR_NONE) ||
+      (BSP_CAN_Init(CAN_BUS_1, CAN_DB_Bus1, CAN_DB_Bus1Count) != BSP_ERROR_NONE) ||
+      (BSP_CAN_Init(CAN_BUS_2, CAN_DB_Bus2, CAN_DB_Bus2Count) != BSP_ERROR_NONE) ||
+      (BSP_CAN_Start(CAN_BUS_1) != BSP_ERROR_NONE) || (BSP_CAN_Start(CAN_BUS_2) != BSP_ERROR_NONE) ||
+      (CAN_TX_Init(CAN_DB_Tx, CAN_DB_TxCount) != BSP_ERROR_NONE))
+  {
+    Error_Handler();
+  }
+  CAN_STATS_Init();
+  /* Frames dispatched from the main loop only, the subscriptions are in place */
+  if ((CAN_SUP_Init(CAN_DB_Supervised, CAN_DB_SupervisedCount) != BSP_ERROR_NONE) ||
+      (CAN_LOG_Init(CAN_DB_Logged, CAN_DB_LoggedCount) != BSP_ERROR_NONE) || (SENSE_Init() != BSP_ERROR_NONE) ||
+      (VSTATE_PUB_Init() != BSP_ERROR_NONE) || (IPC_SRV_Init() != BSP_ERROR_NONE))
+  {
+    Error_Handler();
+  }
+  heartbeat = HAL_GetTick();
 
   /* USER CODE END 2 */
 
@@ -106,8 +155,18 @@ int main(void)
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-    HAL_GPIO_TogglePin(LED_8_GPIO_Port, LED_8_Pin);
-    HAL_Delay(1000);
+    (void)CAN_RX_Process();
+    CAN_TX_Process();
+    CAN_SUP_Process();
+    CAN_STATS_Process();
+    SENSE_Process();
+    VSTATE_PUB_Process();
+    IPC_SRV_Process();
+    if ((HAL_GetTick() - heartbeat) >= HEARTBEAT_MS)
+    {
+      heartbeat += HEARTBEAT_MS;
+      HAL_GPIO_TogglePin(LED_8_GPIO_Port, LED_8_Pin);
+    }
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
@@ -22,6 +22,8 @@
 #include "stm32h7xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "driver/can.h"
+#include "ipc.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -199,5 +201,44 @@ void SysTick_Handler(void)
 /******************************************************************************/
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles FDCAN1 interrupt 0 (Rx FIFO 0, high priority IDs).
+  */
+void FDCAN1_IT0_IRQHandler(void)
+{
+  BSP_CAN_IRQHandler(CAN_BUS_1, 0U);
+}
+
+/**
+  * @brief This function handles FDCAN1 interrupt 1 (Rx FIFO 1).
+  */
+void FDCAN1_IT1_IRQHandler(void)
+{
+  BSP_CAN_IRQHandler(CAN_BUS_1, 1U);
+}
+
+/**
+  * @brief This function handles FDCAN2 interrupt 0 (Rx FIFO 0, high priority IDs).
+  */
+void FDCAN2_IT0_IRQHandler(void)
+{
+  BSP_CAN_IRQHandler(CAN_BUS_2, 0U);
+}
+
+/**
+  * @brief This function handles FDCAN2 interrupt 1 (Rx FIFO 1).
+  */
+void FDCAN2_IT1_IRQHandler(void)
+{
+  BSP_CAN_IRQHandler(CAN_BUS_2, 1U);
+}
+
+/**
+  * @brief This function handles HSEM2 global interrupt, the inter-core doorbell.
+  */
+void HSEM2_IRQHandler(void)
+{
+  IPC_IRQHandler();
+}
 
 /* USER CODE END 1 */
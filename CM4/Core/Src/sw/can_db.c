@@ -0,0 +1,77 @@
+#include "sw/can_db.h"
+
+/*
+ * Safety related frames (shutdown chain, ready-to-drive, brakes) go to the
+ * high priority FIFO, the rest is display data. FD messages need the
+ * bus in one of the FD modes, their filters are simply never hit otherwise.
+ */
+
+#define CAN_DB_RX(NAME, FIFO) {CAN_MSG_##NAME##_ID, CAN_MSG_##NAME##_EXTENDED, FIFO}
+
+const BSP_CAN_RxId_t CAN_DB_Bus1[] = {
+    CAN_DB_RX(VCU_STATUS, CAN_FIFO_HIGH), CAN_DB_RX(BMS_STATUS, CAN_FIFO_HIGH),
+    CAN_DB_RX(INV_L_STATUS, CAN_FIFO_HIGH), CAN_DB_RX(INV_R_STATUS, CAN_FIFO_HIGH),
+    CAN_DB_RX(BMS_PACK, CAN_FIFO_LOW), CAN_DB_RX(BMS_CELLS, CAN_FIFO_LOW),
+    CAN_DB_RX(BMS_TEMPS, CAN_FIFO_LOW), CAN_DB_RX(INV_L_TEMPS, CAN_FIFO_LOW),
+    CAN_DB_RX(INV_R_TEMPS, CAN_FIFO_LOW), CAN_DB_RX(VCU_SPEED, CAN_FIFO_LOW),
+    CAN_DB_RX(VCU_POWER, CAN_FIFO_LOW), CAN_DB_RX(LAP_TIMER, CAN_FIFO_LOW),
+    CAN_DB_RX(INV_FAST_FD, CAN_FIFO_LOW),
+};
+const uint32_t CAN_DB_Bus1Count = sizeof(CAN_DB_Bus1) / sizeof(CAN_DB_Bus1[0]);
+
+const BSP_CAN_RxId_t CAN_DB_Bus2[] = {
+    CAN_DB_RX(BRAKE_PRESS, CAN_FIFO_HIGH), CAN_DB_RX(PEDALS, CAN_FIFO_HIGH),
+    CAN_DB_RX(STEER_ANGLE, CAN_FIFO_LOW), CAN_DB_RX(COOLING, CAN_FIFO_LOW),
+    CAN_DB_RX(TYRE_TEMPS, CAN_FIFO_LOW), CAN_DB_RX(GPS_SPEED, CAN_FIFO_LOW),
+    CAN_DB_RX(WHEEL_SPEEDS_FD, CAN_FIFO_LOW), CAN_DB_RX(PEDAL_TRACE_FD, CAN_FIFO_LOW),
+};
+const uint32_t CAN_DB_Bus2Count = sizeof(CAN_DB_Bus2) / sizeof(CAN_DB_Bus2[0]);
+
+/* Route keeping the ID, consumed here as well. A limit just under a
+ * multiple of the cycle time keeps one frame in that many. */
+#define CAN_DB_ROUTE(NAME, FIFO, MIN_US)                                                                             \
+  {CAN_MSG_##NAME##_ID, CAN_MSG_##NAME##_ID, MIN_US, CAN_MSG_##NAME##_EXTENDED, CAN_MSG_##NAME##_EXTENDED, FIFO, 1U}
+
+/* The state the telemetry needs at full rate, pack and speed decimated to 20 Hz */
+const BSP_CAN_Route_t CAN_DB_Routes1[] = {
+    CAN_DB_ROUTE(VCU_STATUS, CAN_FIFO_HIGH, 0U),
+    CAN_DB_ROUTE(BMS_STATUS, CAN_FIFO_HIGH, 0U),
+    CAN_DB_ROUTE(BMS_PACK, CAN_FIFO_LOW, 45000U),
+    CAN_DB_ROUTE(VCU_SPEED, CAN_FIFO_LOW, 45000U),
+};
+const uint32_t CAN_DB_Routes1Count = sizeof(CAN_DB_Routes1) / sizeof(CAN_DB_Routes1[0]);
+
+/* Safety related state: shutdown chain and ready-to-drive, battery,
+ * inverters and brakes */
+const uint16_t CAN_DB_Supervised[] = {
+    CAN_MSG_VCU_STATUS_INDEX,   CAN_MSG_BMS_STATUS_INDEX,   CAN_MSG_BMS_CELLS_INDEX,  CAN_MSG_BMS_TEMPS_INDEX,
+    CAN_MSG_INV_L_STATUS_INDEX, CAN_MSG_INV_R_STATUS_INDEX, CAN_MSG_INV_L_TEMPS_INDEX, CAN_MSG_INV_R_TEMPS_INDEX,
+    CAN_MSG_BRAKE_PRESS_INDEX,  CAN_MSG_PEDALS_INDEX,
+};
+const uint32_t CAN_DB_SupervisedCount = sizeof(CAN_DB_Supervised) / sizeof(CAN_DB_Supervised[0]);
+
+/* Recorded message and the shortest interval between two of its records,
+ * 0 keeps every frame. A limit just under a multiple of the cycle time
+ * keeps one frame in that many. */
+#define CAN_DB_LOG(NAME, MIN_US) {CAN_MSG_##NAME##_INDEX, MIN_US}
+
+/* Driver inputs and wheel dynamics at full rate, the powertrain state at
+ * its cycle time, the pack and the temperatures decimated */
+const CAN_LOG_Channel_t CAN_DB_Logged[] = {
+    CAN_DB_LOG(STEER_ANGLE, 0U),       CAN_DB_LOG(PEDALS, 0U),          CAN_DB_LOG(BRAKE_PRESS, 0U),
+    CAN_DB_LOG(PEDAL_TRACE_FD, 0U),    CAN_DB_LOG(WHEEL_SPEEDS_FD, 0U), CAN_DB_LOG(INV_FAST_FD, 0U),
+    CAN_DB_LOG(VCU_STATUS, 0U),        CAN_DB_LOG(VCU_SPEED, 0U),       CAN_DB_LOG(BMS_STATUS, 0U),
+    CAN_DB_LOG(INV_L_STATUS, 0U),      CAN_DB_LOG(INV_R_STATUS, 0U),    CAN_DB_LOG(BMS_PACK, 95000U),
+    CAN_DB_LOG(INV_L_TEMPS, 950000U),  CAN_DB_LOG(INV_R_TEMPS, 950000U),
+};
+const uint32_t CAN_DB_LoggedCount = sizeof(CAN_DB_Logged) / sizeof(CAN_DB_Logged[0]);
+
+/* Ready-to-drive requests and buttons own a dedicated buffer of bus 1: a
+ * queue full of lower priority frames cannot hold them back */
+const CAN_TX_Entry_t CAN_DB_Tx[] = {
+    {CAN_MSG_DASH_RTD_REQ_INDEX, 0U},
+    {CAN_MSG_DASH_BUTTONS_INDEX, 1U},
+    {CAN_MSG_DASH_MANETTINO_INDEX, CAN_TX_QUEUE},
+    {CAN_MSG_DASH_STATUS_INDEX, CAN_TX_QUEUE},
+};
+const uint32_t CAN_DB_TxCount = sizeof(CAN_DB_Tx) / sizeof(CAN_DB_Tx[0]);
@@ -0,0 +1,106 @@
+#include "sw/can_load.h"
+
+/*
+ * Frame duration model for bus load figures.
+ *
+ * Counts follow ISO 11898-1:2015 with worst-case bit stuffing: one stuff bit
+ * per 4 bits of the stuffed region, which is what a frame may need in the
+ * worst case. In FD frames the stuffed region ends before the stuff count,
+ * the stuff count and CRC carry fixed stuff bits instead. The data phase of
+ * an FD frame runs from the BRS bit to the CRC delimiter; the bit rate
+ * switch points are approximated to whole bits.
+ */
+
+/* SOF, ID, RTR, IDE, r0, DLC / SOF, ID, SRR, IDE, ID ext, RTR, r1, r0, DLC */
+#define CAN_LOAD_CLASSIC_HDR_STD 19U
+#define CAN_LOAD_CLASSIC_HDR_EXT 39U
+#define CAN_LOAD_CRC15 15U
+/* CRC delimiter, ACK slot and delimiter, EOF, intermission */
+#define CAN_LOAD_TRAILER 13U
+
+/* SOF, ID, RRS, IDE, FDF, res, BRS / SOF, ID, SRR, IDE, ID ext, RRS, FDF, res, BRS */
+#define CAN_LOAD_FD_ARB_STD 17U
+#define CAN_LOAD_FD_ARB_EXT 36U
+/* ESI and DLC */
+#define CAN_LOAD_FD_CTRL 5U
+/* Stuff count with its parity, then CRC17 or CRC21 (more than 16 bytes),
+ * each with its fixed stuff bits */
+#define CAN_LOAD_FD_CRC17 (4U + 17U + 6U)
+#define CAN_LOAD_FD_CRC21 (4U + 21U + 7U)
+
+static const uint8_t CAN_LOAD_Lens[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+
+/**
+ * @brief  Rounds a payload length up to the next one an FD DLC can encode.
+ * @param  Len Bytes, at most 64
+ * @retval Bytes sent, 64 beyond
+ */
+uint32_t CAN_LOAD_FdLen(uint32_t Len)
+{
+  uint32_t i;
+
+  for (i = 0; i < sizeof(CAN_LOAD_Lens); i++)
+  {
+    if (CAN_LOAD_Lens[i] >= Len)
+    {
+      return CAN_LOAD_Lens[i];
+    }
+  }
+  return 64U;
+}
+
+/**
+ * @brief  Worst-case length of a data frame.
+ * @param  Len      Payload bytes, at most 8 for classic frames, rounded up
+ *                  to an FD length for FD frames
+ * @param  Extended 29-bit identifier
+ * @param  Fd       FD format, the data phase bits are counted apart
+ * @param  Bits     Result
+ */
+void CAN_LOAD_FrameBits(uint32_t Len, uint32_t Extended, uint32_t Fd, CAN_LOAD_Bits_t *Bits)
+{
+  uint32_t hdr, stuffed;
+
+  if (Fd == 0U)
+  {
+    Len = (Len > 8U) ? 8U : Len;
+    hdr = (Extended != 0U) ? CAN_LOAD_CLASSIC_HDR_EXT : CAN_LOAD_CLASSIC_HDR_STD;
+    stuffed = hdr + 8U * Len + CAN_LOAD_CRC15;
+    Bits->Nominal = stuffed + (stuffed - 1U) / 4U + CAN_LOAD_TRAILER;
+    Bits->Data = 0U;
+  }
+  else
+  {
+    Len = CAN_LOAD_FdLen(Len);
+    hdr = (Extended != 0U) ? CAN_LOAD_FD_ARB_EXT : CAN_LOAD_FD_ARB_STD;
+    /* The stuff bits of the arbitration field stay at the nominal rate */
+    Bits->Nominal = hdr + (hdr - 1U) / 4U + CAN_LOAD_TRAILER;
+    stuffed = CAN_LOAD_FD_CTRL + 8U * Len;
+    Bits->Data = stuffed + stuffed / 4U + ((Len > 16U) ? CAN_LOAD_FD_CRC21 : CAN_LOAD_FD_CRC17);
+  }
+}
+
+/**
+ * @brief  Worst-case duration of a data frame.
+ * @param  Len            Payload bytes
+ * @param  Extended       29-bit identifier
+ * @param  Fd             FD format
+ * @param  NominalBitrate Arbitration rate, bit/s
+ * @param  DataBitrate    Data phase rate of FD frames, bit/s; the nominal
+ *                        rate without BRS
+ * @retval Nanoseconds, rounded up
+ */
+uint32_t CAN_LOAD_FrameNs(uint32_t Len, uint32_t Extended, uint32_t Fd, uint32_t NominalBitrate,
+                          uint32_t DataBitrate)
+{
+  CAN_LOAD_Bits_t bits;
+  uint64_t ns;
+
+  CAN_LOAD_FrameBits(Len, Extended, Fd, &bits);
+  ns = ((uint64_t)bits.Nominal * 1000000000U + NominalBitrate - 1U) / NominalBitrate;
+  if (bits.Data != 0U)
+  {
+    ns += ((uint64_t)bits.Data * 1000000000U + DataBitrate - 1U) / DataBitrate;
+  }
+  return (uint32_t)ns;
+}
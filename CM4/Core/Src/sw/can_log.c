@@ -0,0 +1,110 @@
+#include "sw/can_log.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "ipc.h"
+#include "sw/can_rx.h"
+
+/*
+ * Telemetry log feed.
+ *
+ * The frames of the logged messages are forwarded to the CM7 one by one,
+ * as they are dispatched, with their hardware timestamp: the log sees every
+ * frame of a channel up to its MinUs, whatever the snapshot period. The
+ * raw data goes over the ring (IPC_TYPE_CAN_LOG), the CM7 decodes it: a
+ * decoded FD message does not fit a slot. The CAN path never waits for the
+ * CM7, a frame finding the ring full is dropped and counted.
+ */
+
+typedef struct
+{
+  uint64_t LastUs; /* Timestamp of the last frame forwarded */
+  uint32_t MinUs;
+  uint8_t Forwarded; /* LastUs valid */
+} CAN_LOG_Entry_t;
+
+static CAN_LOG_Entry_t CAN_LOG_Entries[CAN_LOG_MSGS_MAX];
+static CAN_LOG_Stats_t CAN_LOG_Stats;
+
+_Static_assert(CAN_MSGS_DLC_MAX <= IPC_CAN_LOG_DATA_MAX, "a logged frame does not fit IPC_CanLog_t");
+
+static void CAN_LOG_Received(uint32_t Msg, const void *pSignals, const BSP_CAN_Frame_t *pFrame, void *Context);
+
+/**
+ * @brief  Forwards the frames of the given messages to the CM7 telemetry
+ *         log. Subscribes to CAN_RX, before CAN_RX_Process() runs.
+ * @param  Channels Messages and their shortest record interval
+ * @param  Count    At most CAN_LOG_MSGS_MAX
+ * @retval BSP status, BSP_ERROR_WRONG_PARAM on an unknown or duplicate
+ *         message
+ */
+int32_t CAN_LOG_Init(const CAN_LOG_Channel_t *Channels, uint32_t Count)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t seen[(CAN_MSGS_COUNT + 31U) / 32U] = {0};
+  uint32_t i, msg;
+
+  if (((Channels == NULL) && (Count != 0U)) || (Count > CAN_LOG_MSGS_MAX))
+  {
+    return BSP_ERROR_WRONG_PARAM;
+  }
+
+  memset(CAN_LOG_Entries, 0, sizeof(CAN_LOG_Entries));
+  memset(&CAN_LOG_Stats, 0, sizeof(CAN_LOG_Stats));
+
+  for (i = 0; (i < Count) && (ret == BSP_ERROR_NONE); i++)
+  {
+    msg = Channels[i].Msg;
+    if ((msg >= CAN_MSGS_COUNT) || ((seen[msg / 32U] & (1UL << (msg % 32U))) != 0U))
+    {
+      ret = BSP_ERROR_WRONG_PARAM;
+    }
+    else
+    {
+      seen[msg / 32U] |= 1UL << (msg % 32U);
+      CAN_LOG_Entries[i].MinUs = Channels[i].MinUs;
+      ret = CAN_RX_Subscribe(msg, CAN_LOG_Received, &CAN_LOG_Entries[i]);
+    }
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+const CAN_LOG_Stats_t *CAN_LOG_GetStats(void)
+{
+  return &CAN_LOG_Stats;
+}
+
+/* Frame of a logged message: queued for the CM7 past the interval */
+static void CAN_LOG_Received(uint32_t Msg, const void *pSignals, const BSP_CAN_Frame_t *pFrame, void *Context)
+{
+  CAN_LOG_Entry_t *entry = (CAN_LOG_Entry_t *)Context;
+  IPC_CanLog_t record;
+
+  (void)pSignals;
+  if ((entry->Forwarded != 0U) && ((pFrame->Timestamp - entry->LastUs) < entry->MinUs))
+  {
+    CAN_LOG_Stats.Skipped++;
+    return;
+  }
+
+  record.TimeMs = (uint32_t)(pFrame->Timestamp / 1000U);
+  record.Msg = (uint16_t)Msg;
+  record.Len = CAN_MSGS_Table[Msg].Dlc;
+  record.Reserved = 0U;
+  memcpy(record.Data, pFrame->Data, record.Len);
+
+  if (IPC_Send(IPC_CH_M4_TO_M7, IPC_TYPE_CAN_LOG, &record, offsetof(IPC_CanLog_t, Data) + record.Len) ==
+      BSP_ERROR_NONE)
+  {
+    entry->LastUs = pFrame->Timestamp;
+    entry->Forwarded = 1U;
+    CAN_LOG_Stats.Forwarded++;
+  }
+  else
+  {
+    CAN_LOG_Stats.Dropped++;
+  }
+}
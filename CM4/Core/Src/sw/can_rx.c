@@ -0,0 +1,131 @@
+#include "sw/can_rx.h"
+
+#include "sw/can_stats.h"
+
+/*
+ * Received frame dispatch.
+ *
+ * The ID is mapped to its DBC message by CAN_MSGS_Lookup() (generated: a
+ * direct table for standard IDs, a perfect hash for extended ones), so the
+ * cost per frame does not grow with the database. The payload is decoded
+ * once by the generated Unpack and handed to every handler subscribed to
+ * the message. The age of the frame (hardware timestamp to dispatch) is
+ * accounted as the receive latency.
+ */
+
+typedef struct
+{
+  CAN_RX_Handler_t Handler;
+  void *Context;
+} CAN_RX_Sub_t;
+
+static CAN_RX_Sub_t CAN_RX_Subs[CAN_MSGS_COUNT][CAN_RX_HANDLERS_MAX];
+static CAN_RX_Stats_t CAN_RX_Stats;
+
+_Static_assert(CAN_DATA_BYTES >= CAN_MSGS_DATA_MIN, "Unpack reads past BSP_CAN_Frame_t.Data");
+_Static_assert(CAN_DATA_BYTES >= CAN_MSGS_DLC_MAX, "FD messages do not fit BSP_CAN_Frame_t.Data");
+
+/**
+ * @brief  Adds a handler to a message. Not to be called while frames are
+ *         dispatched.
+ * @param  Msg     CAN_MSG_<NAME>_INDEX
+ * @param  Handler Called from CAN_RX_Dispatch()
+ * @param  Context Passed to the handler
+ * @retval BSP status, BSP_ERROR_BUSY when the message has no free slot
+ */
+int32_t CAN_RX_Subscribe(uint32_t Msg, CAN_RX_Handler_t Handler, void *Context)
+{
+  int32_t ret = BSP_ERROR_BUSY;
+  uint32_t i;
+
+  if ((Msg >= CAN_MSGS_COUNT) || (Handler == NULL))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    for (i = 0; i < CAN_RX_HANDLERS_MAX; i++)
+    {
+      if (CAN_RX_Subs[Msg][i].Handler == NULL)
+      {
+        CAN_RX_Subs[Msg][i].Handler = Handler;
+        CAN_RX_Subs[Msg][i].Context = Context;
+        ret = BSP_ERROR_NONE;
+        break;
+      }
+    }
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Decodes a frame and calls the handlers of its message.
+ * @param  pFrame Received frame
+ */
+void CAN_RX_Dispatch(const BSP_CAN_Frame_t *pFrame)
+{
+  CAN_MSGS_Any_t signals;
+  const CAN_RX_Sub_t *sub;
+  int32_t msg = CAN_MSGS_Lookup(pFrame->Id, pFrame->Extended);
+  uint32_t i, latency;
+
+  if (msg < 0)
+  {
+    CAN_RX_Stats.Unknown++;
+    return;
+  }
+  if (pFrame->Len < CAN_MSGS_Table[msg].Dlc)
+  {
+    CAN_RX_Stats.Short++;
+    return;
+  }
+
+  /* BSP_CAN_Frame_t holds CAN_MSGS_DATA_MIN bytes whatever the length */
+  CAN_MSGS_Table[msg].Unpack(&signals, pFrame->Data);
+  CAN_RX_Stats.Frames[msg]++;
+  latency = (uint32_t)(BSP_CAN_GetTimeUs() - pFrame->Timestamp);
+  if (latency > CAN_RX_Stats.LatencyMaxUs)
+  {
+    CAN_RX_Stats.LatencyMaxUs = latency;
+  }
+  CAN_RX_Stats.LatencySumUs += latency;
+
+  sub = CAN_RX_Subs[msg];
+  for (i = 0; (i < CAN_RX_HANDLERS_MAX) && (sub[i].Handler != NULL); i++)
+  {
+    sub[i].Handler((uint32_t)msg, &signals, pFrame, sub[i].Context);
+  }
+}
+
+/**
+ * @brief  Dispatches every frame received on both buses, high priority
+ *         frames of a bus first. Main loop context.
+ * @retval Number of frames taken from the driver
+ */
+uint32_t CAN_RX_Process(void)
+{
+  BSP_CAN_Frame_t frames[CAN_RX_BATCH];
+  uint32_t total = 0U, n, i, bus;
+
+  for (bus = 0; bus < CAN_BUS_NBR; bus++)
+  {
+    do
+    {
+      n = BSP_CAN_Read((BSP_CAN_Bus_t)bus, frames, CAN_RX_BATCH);
+      for (i = 0; i < n; i++)
+      {
+        CAN_STATS_Rx((BSP_CAN_Bus_t)bus, &frames[i]);
+        CAN_RX_Dispatch(&frames[i]);
+      }
+      total += n;
+    } while (n == CAN_RX_BATCH);
+  }
+  return total;
+}
+
+const CAN_RX_Stats_t *CAN_RX_GetStats(void)
+{
+  return &CAN_RX_Stats;
+}
@@ -0,0 +1,245 @@
+#include "sw/can_stats.h"
+
+#include <string.h>
+
+#include "mem_sections.h"
+#include "sw/can_load.h"
+
+/*
+ * Bus health statistics.
+ *
+ * CAN_RX_Process() and the Tx events of CAN_TX_Process() feed every frame
+ * through one update: a lookup of the frame duration in a table built by
+ * CAN_STATS_Init() for the bus setup, the ID lookup and a few compares on
+ * the fixed slot of the message. Nothing is allocated or searched, the
+ * update is timed with the DWT counter against CAN_STATS_BUDGET_CYCLES.
+ *
+ * CAN_STATS_Process() closes a window every CAN_STATS_WINDOW_MS: rates and
+ * loads are computed over the window, silent periodic messages are counted
+ * as one missed deadline, the error counters are sampled. Everything runs
+ * in the main loop, no locking.
+ */
+
+/* Frame formats of the duration table */
+#define CAN_STATS_CLASSIC 0U
+#define CAN_STATS_FD 1U
+#define CAN_STATS_FD_BRS 2U
+
+typedef struct
+{
+  uint32_t CycleUs;    /* 0 for event messages */
+  uint32_t DeadlineUs;
+  uint32_t WindowFrames;
+  uint32_t JitterUs;
+  uint32_t IntervalUs;
+  uint8_t Stale; /* Silence already counted */
+} CAN_STATS_Work_t;
+
+static CAN_STATS_Id_t CAN_STATS_Ids[CAN_MSGS_COUNT];
+static CAN_STATS_Work_t CAN_STATS_Work[CAN_MSGS_COUNT];
+static CAN_STATS_Bus_t CAN_STATS_Buses[CAN_BUS_NBR];
+static CAN_STATS_Cost_t CAN_STATS_Cost;
+static uint64_t CAN_STATS_BusyNs[CAN_BUS_NBR];
+static uint32_t CAN_STATS_WindowFrames[CAN_BUS_NBR];
+static uint64_t CAN_STATS_WindowStart;
+
+/* Worst-case duration of a frame, ns, by bus, ID type, format and DLC */
+static DTCM_BSS uint32_t CAN_STATS_FrameNs[CAN_BUS_NBR][2][3][16];
+
+static const uint8_t CAN_STATS_LenToDlc[CAN_DATA_BYTES + 1U] = {
+    0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  9,  9,  9,  10, 10, 10, 10, 11, 11, 11, 11, 12,
+    12, 12, 12, 13, 13, 13, 13, 13, 13, 13, 13, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+};
+
+static void CAN_STATS_Update(uint32_t Bus, uint32_t Id, uint32_t Extended, uint32_t Len, uint32_t Flags,
+                             uint64_t Timestamp);
+
+/**
+ * @brief  Clears the statistics and builds the frame duration table from
+ *         the bus setup. After BSP_CAN_Init() of both buses.
+ */
+void CAN_STATS_Init(void)
+{
+  static const uint8_t lens[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+  uint32_t bus, ext, dlc, i;
+
+  memset(CAN_STATS_Ids, 0, sizeof(CAN_STATS_Ids));
+  memset(CAN_STATS_Work, 0, sizeof(CAN_STATS_Work));
+  memset(CAN_STATS_Buses, 0, sizeof(CAN_STATS_Buses));
+  memset(CAN_STATS_BusyNs, 0, sizeof(CAN_STATS_BusyNs));
+  memset(CAN_STATS_WindowFrames, 0, sizeof(CAN_STATS_WindowFrames));
+  CAN_STATS_Cost = (CAN_STATS_Cost_t){0};
+
+  for (bus = 0; bus < CAN_BUS_NBR; bus++)
+  {
+    for (ext = 0; ext < 2U; ext++)
+    {
+      for (dlc = 0; dlc < 16U; dlc++)
+      {
+        CAN_STATS_FrameNs[bus][ext][CAN_STATS_CLASSIC][dlc] =
+            CAN_LOAD_FrameNs(lens[dlc], ext, 0U, CAN_NOMINAL_BITRATE, CAN_NOMINAL_BITRATE);
+        CAN_STATS_FrameNs[bus][ext][CAN_STATS_FD][dlc] =
+            CAN_LOAD_FrameNs(lens[dlc], ext, 1U, CAN_NOMINAL_BITRATE, CAN_NOMINAL_BITRATE);
+        CAN_STATS_FrameNs[bus][ext][CAN_STATS_FD_BRS][dlc] =
+            CAN_LOAD_FrameNs(lens[dlc], ext, 1U, CAN_NOMINAL_BITRATE, BSP_CAN_GetDataBitrate((BSP_CAN_Bus_t)bus));
+      }
+    }
+  }
+
+  for (i = 0; i < CAN_MSGS_COUNT; i++)
+  {
+    CAN_STATS_Work[i].CycleUs = CAN_MSGS_Table[i].CycleMs * 1000U;
+    CAN_STATS_Work[i].DeadlineUs = CAN_STATS_Work[i].CycleUs / 100U * CAN_STATS_DEADLINE_PCT;
+  }
+  CAN_STATS_WindowStart = BSP_CAN_GetTimeUs();
+}
+
+/**
+ * @brief  Accounts a received frame. Main loop context.
+ */
+void CAN_STATS_Rx(BSP_CAN_Bus_t Bus, const BSP_CAN_Frame_t *pFrame)
+{
+  CAN_STATS_Update(Bus, pFrame->Id, pFrame->Extended, pFrame->Len, pFrame->Flags, pFrame->Timestamp);
+}
+
+/**
+ * @brief  Accounts a frame sent on the bus, from its Tx event. Main loop
+ *         context.
+ */
+void CAN_STATS_Tx(BSP_CAN_Bus_t Bus, const BSP_CAN_TxEvent_t *pEvent)
+{
+  CAN_STATS_Update(Bus, pEvent->Id, pEvent->Extended, pEvent->Len, pEvent->Flags, pEvent->Timestamp);
+}
+
+/**
+ * @brief  Closes the statistics window once CAN_STATS_WINDOW_MS elapsed.
+ *         Main loop context.
+ */
+void CAN_STATS_Process(void)
+{
+  uint64_t now = BSP_CAN_GetTimeUs();
+  uint64_t elapsed = now - CAN_STATS_WindowStart;
+  BSP_CAN_Stats_t driver;
+  CAN_STATS_Work_t *work;
+  CAN_STATS_Id_t *id;
+  uint32_t bus, i;
+
+  if (elapsed < (uint64_t)CAN_STATS_WINDOW_MS * 1000U)
+  {
+    return;
+  }
+  CAN_STATS_WindowStart = now;
+
+  for (bus = 0; bus < CAN_BUS_NBR; bus++)
+  {
+    /* ns of bus time per us of window, i.e. per mille */
+    CAN_STATS_Buses[bus].LoadPermille = (uint32_t)(CAN_STATS_BusyNs[bus] / elapsed);
+    CAN_STATS_Buses[bus].Rate = (uint32_t)(((uint64_t)CAN_STATS_WindowFrames[bus] * 1000000U) / elapsed);
+    CAN_STATS_BusyNs[bus] = 0U;
+    CAN_STATS_WindowFrames[bus] = 0U;
+
+    BSP_CAN_GetErrors((BSP_CAN_Bus_t)bus, &CAN_STATS_Buses[bus].Errors);
+    BSP_CAN_GetStats((BSP_CAN_Bus_t)bus, &driver);
+    CAN_STATS_Buses[bus].BusOff = driver.BusOff;
+  }
+
+  for (i = 0; i < CAN_MSGS_COUNT; i++)
+  {
+    id = &CAN_STATS_Ids[i];
+    work = &CAN_STATS_Work[i];
+    id->Rate = (uint32_t)(((uint64_t)work->WindowFrames * 1000000U) / elapsed);
+    id->JitterMaxUs = work->JitterUs;
+    id->IntervalMaxUs = work->IntervalUs;
+    work->WindowFrames = work->JitterUs = work->IntervalUs = 0U;
+
+    /* A message seen once and silent since misses one deadline, not one per window */
+    if ((work->DeadlineUs != 0U) && (id->LastUs != 0U) && (work->Stale == 0U) &&
+        ((now - id->LastUs) > work->DeadlineUs))
+    {
+      id->Missed++;
+      work->Stale = 1U;
+    }
+  }
+}
+
+const CAN_STATS_Bus_t *CAN_STATS_GetBus(BSP_CAN_Bus_t Bus)
+{
+  return (Bus < CAN_BUS_NBR) ? &CAN_STATS_Buses[Bus] : NULL;
+}
+
+const CAN_STATS_Id_t *CAN_STATS_GetId(uint32_t Msg)
+{
+  return (Msg < CAN_MSGS_COUNT) ? &CAN_STATS_Ids[Msg] : NULL;
+}
+
+const CAN_STATS_Cost_t *CAN_STATS_GetCost(void)
+{
+  return &CAN_STATS_Cost;
+}
+
+/* Per-frame update, timed */
+static ITCM_FUNC void CAN_STATS_Update(uint32_t Bus, uint32_t Id, uint32_t Extended, uint32_t Len, uint32_t Flags,
+                                       uint64_t Timestamp)
+{
+  uint32_t start = DWT->CYCCNT;
+  uint32_t format, interval, jitter, cycles;
+  CAN_STATS_Work_t *work;
+  CAN_STATS_Id_t *id;
+  int32_t msg;
+
+  format = ((Flags & CAN_FRAME_FD) == 0U)    ? CAN_STATS_CLASSIC
+           : ((Flags & CAN_FRAME_BRS) != 0U) ? CAN_STATS_FD_BRS
+                                             : CAN_STATS_FD;
+  CAN_STATS_BusyNs[Bus] += CAN_STATS_FrameNs[Bus][(Extended != 0U) ? 1U : 0U][format][CAN_STATS_LenToDlc[Len]];
+  CAN_STATS_WindowFrames[Bus]++;
+  CAN_STATS_Buses[Bus].Frames++;
+
+  msg = CAN_MSGS_Lookup(Id, Extended);
+  if (msg < 0)
+  {
+    CAN_STATS_Buses[Bus].Unknown++;
+  }
+  else
+  {
+    id = &CAN_STATS_Ids[msg];
+    work = &CAN_STATS_Work[msg];
+    if ((id->LastUs != 0U) && (Timestamp > id->LastUs))
+    {
+      interval = (uint32_t)(Timestamp - id->LastUs);
+      if (interval > work->IntervalUs)
+      {
+        work->IntervalUs = interval;
+      }
+      if (work->CycleUs != 0U)
+      {
+        jitter = (interval > work->CycleUs) ? (interval - work->CycleUs) : (work->CycleUs - interval);
+        if (jitter > work->JitterUs)
+        {
+          work->JitterUs = jitter;
+        }
+        /* A silence already counted by CAN_STATS_Process() */
+        if ((interval > work->DeadlineUs) && (work->Stale == 0U))
+        {
+          id->Missed++;
+        }
+      }
+    }
+    work->Stale = 0U;
+    work->WindowFrames++;
+    id->LastUs = Timestamp;
+    id->Frames++;
+  }
+
+  cycles = DWT->CYCCNT - start;
+  CAN_STATS_Cost.Samples++;
+  CAN_STATS_Cost.SumCycles += cycles;
+  if (cycles > CAN_STATS_Cost.MaxCycles)
+  {
+    CAN_STATS_Cost.MaxCycles = cycles;
+  }
+  if (cycles > CAN_STATS_BUDGET_CYCLES)
+  {
+    CAN_STATS_Cost.OverBudget++;
+  }
+}
@@ -0,0 +1,194 @@
+#include "sw/can_sup.h"
+
+#include <string.h>
+
+#include "main.h"
+#include "sw/can_rx.h"
+#include "sw/twheel.h"
+
+/*
+ * Signal timeout supervision.
+ *
+ * Each supervised message owns a timer of a hierarchical wheel (twheel.h)
+ * ticking in milliseconds. Every frame of the message restarts its timer
+ * from the CAN_RX handler, an O(1) relink; CAN_SUP_Process() advances the
+ * wheel and only the timers that expire are visited. The signals of a
+ * message arrive together, the message is the unit of staleness.
+ *
+ * A supervised message is stale from CAN_SUP_Init() until its first
+ * frame: no data is no better than old data. Listeners (UI bindings,
+ * indicator LEDs) are called on each change only.
+ */
+
+#define CAN_SUP_NONE 0xFFU
+
+typedef struct
+{
+  TWHEEL_Timer_t Timer; /* First, the handler casts back */
+  uint32_t TimeoutMs;
+  uint32_t Timeouts;
+  uint16_t Msg;
+  uint8_t Stale;
+} CAN_SUP_Entry_t;
+
+typedef struct
+{
+  CAN_SUP_Listener_t Listener;
+  void *Context;
+} CAN_SUP_Sub_t;
+
+static TWHEEL_t CAN_SUP_Wheel;
+static CAN_SUP_Entry_t CAN_SUP_Entries[CAN_SUP_MSGS_MAX];
+static uint8_t CAN_SUP_ByMsg[CAN_MSGS_COUNT]; /* Entry of each message, CAN_SUP_NONE if not supervised */
+static CAN_SUP_Sub_t CAN_SUP_Subs[CAN_SUP_LISTENERS_MAX];
+
+_Static_assert(CAN_SUP_MSGS_MAX < CAN_SUP_NONE, "entry indices are 8-bit");
+
+static void CAN_SUP_Received(uint32_t Msg, const void *pSignals, const BSP_CAN_Frame_t *pFrame, void *Context);
+static void CAN_SUP_Expired(TWHEEL_Timer_t *pTimer);
+static void CAN_SUP_Publish(const CAN_SUP_Entry_t *pEntry);
+
+/**
+ * @brief  Supervises the given messages, their timeout is derived from the
+ *         DBC cycle time. Subscribes to CAN_RX, before CAN_RX_Process()
+ *         runs.
+ * @param  Msgs  CAN_MSG_<NAME>_INDEX of the periodic messages to supervise
+ * @param  Count At most CAN_SUP_MSGS_MAX
+ * @retval BSP status, BSP_ERROR_WRONG_PARAM on an unknown, event or
+ *         duplicate message
+ */
+int32_t CAN_SUP_Init(const uint16_t *Msgs, uint32_t Count)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  CAN_SUP_Entry_t *entry;
+  uint32_t i, timeout;
+
+  if (((Msgs == NULL) && (Count != 0U)) || (Count > CAN_SUP_MSGS_MAX))
+  {
+    return BSP_ERROR_WRONG_PARAM;
+  }
+
+  memset(CAN_SUP_Entries, 0, sizeof(CAN_SUP_Entries));
+  memset(CAN_SUP_ByMsg, CAN_SUP_NONE, sizeof(CAN_SUP_ByMsg));
+  memset(CAN_SUP_Subs, 0, sizeof(CAN_SUP_Subs));
+  TWHEEL_Init(&CAN_SUP_Wheel, HAL_GetTick());
+
+  for (i = 0; (i < Count) && (ret == BSP_ERROR_NONE); i++)
+  {
+    if ((Msgs[i] >= CAN_MSGS_COUNT) || (CAN_MSGS_Table[Msgs[i]].CycleMs == 0U) ||
+        (CAN_SUP_ByMsg[Msgs[i]] != CAN_SUP_NONE))
+    {
+      ret = BSP_ERROR_WRONG_PARAM;
+    }
+    else
+    {
+      timeout = CAN_MSGS_Table[Msgs[i]].CycleMs * CAN_SUP_TIMEOUT_CYCLES;
+      entry = &CAN_SUP_Entries[i];
+      entry->Timer.Handler = CAN_SUP_Expired;
+      entry->TimeoutMs = (timeout < CAN_SUP_TIMEOUT_MIN_MS) ? CAN_SUP_TIMEOUT_MIN_MS : timeout;
+      entry->Msg = Msgs[i];
+      entry->Stale = 1U;
+      CAN_SUP_ByMsg[Msgs[i]] = (uint8_t)i;
+      ret = CAN_RX_Subscribe(Msgs[i], CAN_SUP_Received, entry);
+    }
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Adds a listener of the staleness changes. The current state is
+ *         read with CAN_SUP_IsStale().
+ * @retval BSP status, BSP_ERROR_BUSY when CAN_SUP_LISTENERS_MAX are set
+ */
+int32_t CAN_SUP_Listen(CAN_SUP_Listener_t Listener, void *Context)
+{
+  int32_t ret = BSP_ERROR_BUSY;
+  uint32_t i;
+
+  if (Listener == NULL)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  for (i = 0; (i < CAN_SUP_LISTENERS_MAX) && (ret == BSP_ERROR_BUSY); i++)
+  {
+    if (CAN_SUP_Subs[i].Listener == NULL)
+    {
+      CAN_SUP_Subs[i].Listener = Listener;
+      CAN_SUP_Subs[i].Context = Context;
+      ret = BSP_ERROR_NONE;
+    }
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Advances the wheel to the current tick and flags the messages
+ *         whose timer expired. Main loop context, after CAN_RX_Process().
+ */
+void CAN_SUP_Process(void)
+{
+  (void)TWHEEL_Advance(&CAN_SUP_Wheel, HAL_GetTick());
+}
+
+/**
+ * @brief  Whether a message is stale, 0 for a message not supervised.
+ */
+uint32_t CAN_SUP_IsStale(uint32_t Msg)
+{
+  if ((Msg >= CAN_MSGS_COUNT) || (CAN_SUP_ByMsg[Msg] == CAN_SUP_NONE))
+  {
+    return 0U;
+  }
+  return CAN_SUP_Entries[CAN_SUP_ByMsg[Msg]].Stale;
+}
+
+/**
+ * @brief  Number of times a message went stale after its first frame.
+ */
+uint32_t CAN_SUP_GetTimeouts(uint32_t Msg)
+{
+  if ((Msg >= CAN_MSGS_COUNT) || (CAN_SUP_ByMsg[Msg] == CAN_SUP_NONE))
+  {
+    return 0U;
+  }
+  return CAN_SUP_Entries[CAN_SUP_ByMsg[Msg]].Timeouts;
+}
+
+/* Frame of a supervised message: restart its timer */
+static void CAN_SUP_Received(uint32_t Msg, const void *pSignals, const BSP_CAN_Frame_t *pFrame, void *Context)
+{
+  CAN_SUP_Entry_t *entry = (CAN_SUP_Entry_t *)Context;
+
+  (void)Msg;
+  (void)pSignals;
+  (void)pFrame;
+  TWHEEL_Start(&CAN_SUP_Wheel, &entry->Timer, HAL_GetTick() + entry->TimeoutMs);
+  if (entry->Stale != 0U)
+  {
+    entry->Stale = 0U;
+    CAN_SUP_Publish(entry);
+  }
+}
+
+static void CAN_SUP_Expired(TWHEEL_Timer_t *pTimer)
+{
+  CAN_SUP_Entry_t *entry = (CAN_SUP_Entry_t *)pTimer;
+
+  entry->Stale = 1U;
+  entry->Timeouts++;
+  CAN_SUP_Publish(entry);
+}
+
+static void CAN_SUP_Publish(const CAN_SUP_Entry_t *pEntry)
+{
+  uint32_t i;
+
+  for (i = 0; (i < CAN_SUP_LISTENERS_MAX) && (CAN_SUP_Subs[i].Listener != NULL); i++)
+  {
+    CAN_SUP_Subs[i].Listener(pEntry->Msg, pEntry->Stale, CAN_SUP_Subs[i].Context);
+  }
+}
@@ -0,0 +1,417 @@
+#include "sw/can_tx.h"
+
+#include <string.h>
+
+#include "sw/can_stats.h"
+
+/*
+ * Transmit scheduler.
+ *
+ * Each transmitted message keeps the latest signals given by CAN_TX_Set(),
+ * packed when the frame leaves. Periodic messages sit in a hashed timer
+ * wheel of 1 ms slots: CAN_TX_Process() walks the slots elapsed since its
+ * previous call and sends what is due, so the cost follows the number of
+ * due messages, not the number of messages. A loop late by more than a
+ * turn walks the wheel once and counts the skipped periods as missed.
+ *
+ * Messages of the same period would all fire on the same tick and queue
+ * up in the controller; CAN_TX_Init() gives each one the phase offset that
+ * collides the least with the messages already placed, shortest periods
+ * first, over CAN_TX_PHASE_SPAN_MS.
+ *
+ * Event frames (CAN_TX_Trigger()) go out at once, outside the period. One
+ * refused by the driver is retried on the next CAN_TX_Process().
+ *
+ * Jitter is the interval between two consecutive periodic sends, on the
+ * BSP_CAN_GetTimeUs() timebase, minus the period. An interval spanning a
+ * drop or a missed period is not sampled. The Tx events of both buses add
+ * the latency from the send to the start of frame on the bus.
+ */
+
+#define CAN_TX_NONE 0xFFU
+#define CAN_TX_UNPLACED UINT32_MAX
+#define CAN_TX_EVENT_BATCH 8U
+
+typedef struct
+{
+  CAN_MSGS_Any_t Signals;
+  uint32_t Due;    /* Tick of the next periodic send */
+  uint32_t Period; /* ms, 0 for event-only messages */
+  uint64_t LastUs;
+  uint16_t Msg;
+  uint8_t Buffer;
+  uint8_t Next; /* Wheel slot list */
+  uint8_t LastValid;
+  uint8_t EventPending;
+  CAN_TX_Stats_t Stats;
+} CAN_TX_Slot_t;
+
+static CAN_TX_Slot_t CAN_TX_Slots[CAN_TX_MSGS_MAX];
+static uint32_t CAN_TX_Count;
+static uint8_t CAN_TX_ByMsg[CAN_MSGS_COUNT]; /* Slot of each message, CAN_TX_NONE if not sent */
+static uint8_t CAN_TX_Wheel[CAN_TX_WHEEL_SLOTS];
+static uint32_t CAN_TX_Cursor; /* Next tick to serve */
+
+_Static_assert((CAN_TX_WHEEL_SLOTS & (CAN_TX_WHEEL_SLOTS - 1U)) == 0U, "CAN_TX_WHEEL_SLOTS must be a power of two");
+_Static_assert(CAN_TX_MSGS_MAX < CAN_TX_NONE, "slot indices are 8-bit");
+
+static uint32_t CAN_TX_Phase(uint32_t Slot);
+static int32_t CAN_TX_Send(CAN_TX_Slot_t *pSlot);
+static void CAN_TX_Periodic(CAN_TX_Slot_t *pSlot, uint32_t Now);
+static void CAN_TX_Insert(uint32_t Slot);
+static void CAN_TX_Events(void);
+
+/**
+ * @brief  Takes the list of transmitted messages, chooses their phase
+ *         offsets and starts the wheel. BSP_CAN_Init() must have been
+ *         called on the buses used.
+ * @param  Entries Messages, with the dedicated buffer of each
+ * @param  Count   At most CAN_TX_MSGS_MAX
+ * @retval BSP status, BSP_ERROR_WRONG_PARAM on an unknown message, a
+ *         message listed twice or a buffer given to two messages of a bus
+ */
+int32_t CAN_TX_Init(const CAN_TX_Entry_t *Entries, uint32_t Count)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t i, j, best, now;
+
+  if (((Entries == NULL) && (Count != 0U)) || (Count > CAN_TX_MSGS_MAX))
+  {
+    return BSP_ERROR_WRONG_PARAM;
+  }
+
+  memset(CAN_TX_Slots, 0, sizeof(CAN_TX_Slots));
+  memset(CAN_TX_ByMsg, CAN_TX_NONE, sizeof(CAN_TX_ByMsg));
+  memset(CAN_TX_Wheel, CAN_TX_NONE, sizeof(CAN_TX_Wheel));
+  CAN_TX_Count = 0U;
+
+  for (i = 0; (i < Count) && (ret == BSP_ERROR_NONE); i++)
+  {
+    if ((Entries[i].Msg >= CAN_MSGS_COUNT) || (CAN_TX_ByMsg[Entries[i].Msg] != CAN_TX_NONE) ||
+        ((Entries[i].Buffer != CAN_TX_QUEUE) && (Entries[i].Buffer >= CAN_TX_BUFFERS_NBR)))
+    {
+      ret = BSP_ERROR_WRONG_PARAM;
+      break;
+    }
+    for (j = 0; j < i; j++)
+    {
+      if ((Entries[i].Buffer != CAN_TX_QUEUE) && (Entries[j].Buffer == Entries[i].Buffer) &&
+          (CAN_MSGS_Table[Entries[j].Msg].Bus == CAN_MSGS_Table[Entries[i].Msg].Bus))
+      {
+        ret = BSP_ERROR_WRONG_PARAM;
+      }
+    }
+    CAN_TX_Slots[i].Msg = Entries[i].Msg;
+    CAN_TX_Slots[i].Buffer = Entries[i].Buffer;
+    CAN_TX_Slots[i].Period = CAN_MSGS_Table[Entries[i].Msg].CycleMs;
+    CAN_TX_Slots[i].Next = CAN_TX_NONE;
+    CAN_TX_ByMsg[Entries[i].Msg] = (uint8_t)i;
+  }
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    CAN_TX_Count = Count;
+
+    /* Shortest periods first, they have the fewest free ticks */
+    for (i = 0; i < Count; i++)
+    {
+      CAN_TX_Slots[i].Stats.PhaseMs = CAN_TX_UNPLACED;
+    }
+    for (i = 0; i < Count; i++)
+    {
+      best = CAN_TX_NONE;
+      for (j = 0; j < Count; j++)
+      {
+        if ((CAN_TX_Slots[j].Period != 0U) && (CAN_TX_Slots[j].Stats.PhaseMs == CAN_TX_UNPLACED) &&
+            ((best == CAN_TX_NONE) || (CAN_TX_Slots[j].Period < CAN_TX_Slots[best].Period)))
+        {
+          best = j;
+        }
+      }
+      if (best == CAN_TX_NONE)
+      {
+        break;
+      }
+      CAN_TX_Slots[best].Stats.PhaseMs = CAN_TX_Phase(best);
+    }
+
+    now = HAL_GetTick();
+    CAN_TX_Cursor = now + 1U;
+    for (i = 0; i < Count; i++)
+    {
+      if (CAN_TX_Slots[i].Period != 0U)
+      {
+        CAN_TX_Slots[i].Due = now + 1U + CAN_TX_Slots[i].Stats.PhaseMs;
+        CAN_TX_Insert(i);
+      }
+      else
+      {
+        CAN_TX_Slots[i].Stats.PhaseMs = 0U;
+      }
+    }
+  }
+  else
+  {
+    memset(CAN_TX_ByMsg, CAN_TX_NONE, sizeof(CAN_TX_ByMsg));
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Updates the signals of a transmitted message, sent by the next
+ *         periodic or event frame. Main loop context.
+ * @param  Msg      CAN_MSG_<NAME>_INDEX
+ * @param  pSignals CAN_MSG_<NAME>_t
+ * @retval BSP status, BSP_ERROR_WRONG_PARAM if the message is not sent
+ */
+int32_t CAN_TX_Set(uint32_t Msg, const void *pSignals)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if ((Msg >= CAN_MSGS_COUNT) || (CAN_TX_ByMsg[Msg] == CAN_TX_NONE) || (pSignals == NULL))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    memcpy(&CAN_TX_Slots[CAN_TX_ByMsg[Msg]].Signals, pSignals, CAN_MSGS_Table[Msg].Size);
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Sends a message now, outside its period. Main loop context.
+ * @param  Msg CAN_MSG_<NAME>_INDEX
+ * @retval BSP status, BSP_ERROR_BUSY if the driver refused the frame: it is
+ *         retried by CAN_TX_Process()
+ */
+int32_t CAN_TX_Trigger(uint32_t Msg)
+{
+  int32_t ret;
+  CAN_TX_Slot_t *slot;
+
+  if ((Msg >= CAN_MSGS_COUNT) || (CAN_TX_ByMsg[Msg] == CAN_TX_NONE))
+  {
+    return BSP_ERROR_WRONG_PARAM;
+  }
+  slot = &CAN_TX_Slots[CAN_TX_ByMsg[Msg]];
+
+  if ((ret = CAN_TX_Send(slot)) == BSP_ERROR_NONE)
+  {
+    slot->Stats.Events++;
+    slot->EventPending = 0U;
+  }
+  else
+  {
+    slot->Stats.Busy++;
+    slot->EventPending = 1U;
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Retries the refused event frames and sends the periodic frames
+ *         due since the previous call. Main loop context, every ms or so.
+ */
+void CAN_TX_Process(void)
+{
+  uint32_t now = HAL_GetTick();
+  uint32_t i, steps, tick, list;
+  CAN_TX_Slot_t *slot;
+
+  CAN_TX_Events();
+
+  for (i = 0; i < CAN_TX_Count; i++)
+  {
+    if ((CAN_TX_Slots[i].EventPending != 0U) && (CAN_TX_Send(&CAN_TX_Slots[i]) == BSP_ERROR_NONE))
+    {
+      CAN_TX_Slots[i].EventPending = 0U;
+      CAN_TX_Slots[i].Stats.Events++;
+    }
+  }
+
+  if ((int32_t)(now - CAN_TX_Cursor) < 0)
+  {
+    return;
+  }
+  steps = now - CAN_TX_Cursor + 1U;
+  if (steps > CAN_TX_WHEEL_SLOTS)
+  {
+    /* One turn reaches every late message */
+    steps = CAN_TX_WHEEL_SLOTS;
+  }
+
+  for (tick = CAN_TX_Cursor; steps > 0U; steps--, tick++)
+  {
+    /* The list is taken out of the slot, not yet due entries go back in */
+    list = CAN_TX_Wheel[tick % CAN_TX_WHEEL_SLOTS];
+    CAN_TX_Wheel[tick % CAN_TX_WHEEL_SLOTS] = CAN_TX_NONE;
+    while (list != CAN_TX_NONE)
+    {
+      slot = &CAN_TX_Slots[list];
+      i = list;
+      list = slot->Next;
+      if ((int32_t)(slot->Due - now) <= 0)
+      {
+        CAN_TX_Periodic(slot, now);
+      }
+      CAN_TX_Insert(i);
+    }
+  }
+  CAN_TX_Cursor = now + 1U;
+}
+
+/**
+ * @brief  Transmission counters and jitter of a message.
+ * @param  Msg CAN_MSG_<NAME>_INDEX
+ * @retval NULL if the message is not sent
+ */
+const CAN_TX_Stats_t *CAN_TX_GetStats(uint32_t Msg)
+{
+  if ((Msg >= CAN_MSGS_COUNT) || (CAN_TX_ByMsg[Msg] == CAN_TX_NONE))
+  {
+    return NULL;
+  }
+  return &CAN_TX_Slots[CAN_TX_ByMsg[Msg]].Stats;
+}
+
+/* Offset in the period colliding with the fewest frames of the bus already placed */
+static uint32_t CAN_TX_Phase(uint32_t Slot)
+{
+  const CAN_TX_Slot_t *self = &CAN_TX_Slots[Slot];
+  const CAN_TX_Slot_t *other;
+  uint32_t bus = CAN_MSGS_Table[self->Msg].Bus;
+  uint32_t phase, best = 0U, cost, best_cost = UINT32_MAX, t, i;
+
+  for (phase = 0; phase < self->Period; phase++)
+  {
+    cost = 0U;
+    for (t = phase; (t < CAN_TX_PHASE_SPAN_MS) && (cost < best_cost); t += self->Period)
+    {
+      for (i = 0; i < CAN_TX_Count; i++)
+      {
+        other = &CAN_TX_Slots[i];
+        if ((i != Slot) && (other->Period != 0U) && (other->Stats.PhaseMs != CAN_TX_UNPLACED) &&
+            (CAN_MSGS_Table[other->Msg].Bus == bus) && (t >= other->Stats.PhaseMs) &&
+            (((t - other->Stats.PhaseMs) % other->Period) == 0U))
+        {
+          cost++;
+        }
+      }
+    }
+    if (cost < best_cost)
+    {
+      best_cost = cost;
+      best = phase;
+    }
+  }
+  return best;
+}
+
+/* Packs the signals and hands the frame to the driver */
+static int32_t CAN_TX_Send(CAN_TX_Slot_t *pSlot)
+{
+  const CAN_MSGS_Desc_t *desc = &CAN_MSGS_Table[pSlot->Msg];
+  BSP_CAN_Bus_t bus = (BSP_CAN_Bus_t)(desc->Bus - 1U);
+  BSP_CAN_Frame_t frame;
+
+  frame.Id = desc->Id;
+  frame.Extended = desc->Extended;
+  frame.Len = desc->Dlc;
+  frame.Flags = (desc->Dlc > 8U) ? CAN_FRAME_FD : 0U;
+  desc->Pack(frame.Data, &pSlot->Signals);
+
+  return (pSlot->Buffer == CAN_TX_QUEUE) ? BSP_CAN_Send(bus, &frame) : BSP_CAN_SendBuffer(bus, pSlot->Buffer, &frame);
+}
+
+/* Sends a due periodic frame, samples the jitter and moves the due tick past Now */
+static void CAN_TX_Periodic(CAN_TX_Slot_t *pSlot, uint32_t Now)
+{
+  uint64_t now_us = BSP_CAN_GetTimeUs();
+  uint32_t late = (Now - pSlot->Due) / pSlot->Period;
+  int32_t jitter;
+
+  if (late != 0U)
+  {
+    /* Whole periods behind: only the latest one is sent */
+    pSlot->Due += late * pSlot->Period;
+    pSlot->Stats.Missed += late;
+    pSlot->LastValid = 0U;
+  }
+  pSlot->Due += pSlot->Period;
+
+  if (CAN_TX_Send(pSlot) != BSP_ERROR_NONE)
+  {
+    pSlot->Stats.Busy++;
+    pSlot->LastValid = 0U;
+    return;
+  }
+
+  pSlot->Stats.Sent++;
+  if (pSlot->LastValid != 0U)
+  {
+    jitter = (int32_t)(now_us - pSlot->LastUs) - (int32_t)(pSlot->Period * 1000U);
+    if ((pSlot->Stats.Intervals == 0U) || (jitter < pSlot->Stats.JitterMinUs))
+    {
+      pSlot->Stats.JitterMinUs = jitter;
+    }
+    if ((pSlot->Stats.Intervals == 0U) || (jitter > pSlot->Stats.JitterMaxUs))
+    {
+      pSlot->Stats.JitterMaxUs = jitter;
+    }
+    pSlot->Stats.JitterAbsSumUs += (uint32_t)((jitter < 0) ? -jitter : jitter);
+    pSlot->Stats.Intervals++;
+  }
+  /* A catch-up send is off the grid, the next interval is not sampled */
+  pSlot->LastUs = now_us;
+  pSlot->LastValid = (late == 0U) ? 1U : 0U;
+}
+
+/* Bus latency of the frames that left since the previous call */
+static void CAN_TX_Events(void)
+{
+  BSP_CAN_TxEvent_t events[CAN_TX_EVENT_BATCH];
+  CAN_TX_Stats_t *stats;
+  uint32_t bus, n, i;
+  int32_t msg;
+
+  for (bus = 0; bus < CAN_BUS_NBR; bus++)
+  {
+    do
+    {
+      n = BSP_CAN_ReadTxEvents((BSP_CAN_Bus_t)bus, events, CAN_TX_EVENT_BATCH);
+      for (i = 0; i < n; i++)
+      {
+        /* Every frame sent, scheduled here or not */
+        CAN_STATS_Tx((BSP_CAN_Bus_t)bus, &events[i]);
+        msg = CAN_MSGS_Lookup(events[i].Id, events[i].Extended);
+        if ((msg < 0) || (CAN_TX_ByMsg[msg] == CAN_TX_NONE))
+        {
+          continue;
+        }
+        stats = &CAN_TX_Slots[CAN_TX_ByMsg[msg]].Stats;
+        if (events[i].LatencyUs > stats->LatencyMaxUs)
+        {
+          stats->LatencyMaxUs = events[i].LatencyUs;
+        }
+        stats->LatencySumUs += events[i].LatencyUs;
+        stats->OnBus++;
+      }
+    } while (n == CAN_TX_EVENT_BATCH);
+  }
+}
+
+/* Links a periodic message in the slot of its due tick */
+static void CAN_TX_Insert(uint32_t Slot)
+{
+  uint32_t w = CAN_TX_Slots[Slot].Due % CAN_TX_WHEEL_SLOTS;
+
+  CAN_TX_Slots[Slot].Next = CAN_TX_Wheel[w];
+  CAN_TX_Wheel[w] = (uint8_t)Slot;
+}
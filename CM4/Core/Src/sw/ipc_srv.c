@@ -0,0 +1,115 @@
+#include "sw/ipc_srv.h"
+
+#include <string.h>
+
+/*
+ * CM4 end of the inter-core messages.
+ *
+ * The doorbell interrupt only flags the main loop, which then empties the
+ * ring; the empty IPC_Receive() that ends the pass re-arms the doorbell.
+ * The loop does not touch the SRAM3 between doorbells. IPC_TYPE_SOURCE
+ * holds the loop until its answer is queued, the CM7 drains meanwhile.
+ */
+
+typedef struct
+{
+  volatile uint32_t Rung;
+  uint32_t Sunk; /* IPC_TYPE_SINK messages received */
+} IPC_SRV_Ctx_t;
+
+static IPC_SRV_Ctx_t IPC_SRV_Ctx;
+
+static void IPC_SRV_Doorbell(IPC_Channel_t Channel, void *Context);
+static void IPC_SRV_Handle(const IPC_Msg_t *pMsg);
+static void IPC_SRV_Send(uint16_t Type, const void *pData, uint32_t Len);
+
+/**
+ * @brief  Opens the CM7 to CM4 ring and hooks its doorbell.
+ * @retval BSP status
+ */
+int32_t IPC_SRV_Init(void)
+{
+  int32_t ret;
+
+  memset(&IPC_SRV_Ctx, 0, sizeof(IPC_SRV_Ctx));
+  /* Messages queued before the ring was opened are not lost */
+  IPC_SRV_Ctx.Rung = 1U;
+  ret = IPC_Init();
+  if (ret == BSP_ERROR_NONE)
+  {
+    ret = IPC_SetDoorbell(IPC_CH_M7_TO_M4, IPC_SRV_Doorbell, NULL);
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Handles the queued messages once the doorbell rang. Main loop
+ *         context.
+ */
+void IPC_SRV_Process(void)
+{
+  IPC_Msg_t msg;
+
+  if (IPC_SRV_Ctx.Rung != 0U)
+  {
+    /* Cleared first: a doorbell during the pass brings one more */
+    IPC_SRV_Ctx.Rung = 0U;
+    while (IPC_Receive(IPC_CH_M7_TO_M4, &msg) != 0U)
+    {
+      IPC_SRV_Handle(&msg);
+    }
+  }
+}
+
+uint32_t IPC_SRV_GetSunk(void)
+{
+  return IPC_SRV_Ctx.Sunk;
+}
+
+static void IPC_SRV_Doorbell(IPC_Channel_t Channel, void *Context)
+{
+  (void)Channel;
+  (void)Context;
+  IPC_SRV_Ctx.Rung = 1U;
+}
+
+static void IPC_SRV_Handle(const IPC_Msg_t *pMsg)
+{
+  uint8_t data[IPC_PAYLOAD_MAX] = {0};
+  uint32_t count = 0U, i;
+
+  switch (pMsg->Type)
+  {
+  case IPC_TYPE_PING:
+    IPC_SRV_Send(IPC_TYPE_PONG, pMsg->Data, pMsg->Len);
+    break;
+
+  case IPC_TYPE_SINK:
+    IPC_SRV_Ctx.Sunk++;
+    break;
+
+  case IPC_TYPE_SOURCE:
+    memcpy(&count, pMsg->Data, (pMsg->Len < sizeof(count)) ? pMsg->Len : sizeof(count));
+    for (i = 0; i < count; i++)
+    {
+      memcpy(data, &i, sizeof(i));
+      IPC_SRV_Send(IPC_TYPE_SINK, data, sizeof(data));
+    }
+    IPC_SRV_Send(IPC_TYPE_PONG, &count, sizeof(count));
+    break;
+
+  default:
+    break;
+  }
+}
+
+/* Waits for room while the ring is full, drops the message if the CM7 has
+ * not opened its ring */
+static void IPC_SRV_Send(uint16_t Type, const void *pData, uint32_t Len)
+{
+  while (IPC_Send(IPC_CH_M4_TO_M7, Type, pData, Len) == BSP_ERROR_BUSY)
+  {
+  }
+}
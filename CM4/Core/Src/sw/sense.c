@@ -0,0 +1,222 @@
+#include "sw/sense.h"
+
+#include <math.h>
+
+#include "adc.h"
+#include "main.h"
+#include "tim.h"
+
+/*
+ * Analog inputs and fan tachometers.
+ *
+ * Every SENSE_PERIOD_MS the analog inputs are converted one after the
+ * other by polling: CubeMX sets each ADC up for one software-triggered
+ * conversion, the channel is switched before each start. A pass takes a
+ * few tens of microseconds, nothing waits on it: CAN reception runs from
+ * interrupts. The readings go through a first order filter.
+ *
+ * TIM1 and TIM2 are in PWM input mode: a rising edge of the tachometer
+ * captures the period in CCR1 and restarts the counter. The period is
+ * taken whenever the capture flag is set; silence for SENSE_TACH_TIMEOUT_MS
+ * means a stopped fan, and the first capture after it is dropped as it
+ * counted from an arbitrary point.
+ */
+
+/* 16-bit conversions through the board dividers, a longer sampling time
+ * than the CubeMX setting */
+#define SENSE_SAMPLETIME ADC_SAMPLETIME_64CYCLES_5
+#define SENSE_FULL_SCALE 65535U
+#define SENSE_ADC_TIMEOUT_MS 1U
+
+#define SENSE_KELVIN 273.15f
+
+typedef struct
+{
+  ADC_HandleTypeDef *Adc;
+  uint32_t Channel;
+} SENSE_Input_t;
+
+typedef struct
+{
+  uint32_t Filtered[VSTATE_SENSE_NBR]; /* Counts << SENSE_FILTER_SHIFT */
+  uint32_t TachPeriod[VSTATE_FAN_NBR]; /* SENSE_TACH_HZ ticks, 0 when silent */
+  uint32_t TachLastMs[VSTATE_FAN_NBR];
+  uint8_t TachArmed[VSTATE_FAN_NBR];
+  uint32_t LastMs;
+} SENSE_Ctx_t;
+
+static const SENSE_Input_t SENSE_Inputs[VSTATE_SENSE_NBR] = {
+    [VSTATE_SENSE_3V3] = {&hadc2, ADC_CHANNEL_3},
+    [VSTATE_SENSE_5V] = {&hadc2, ADC_CHANNEL_4},
+    [VSTATE_SENSE_24V] = {&hadc2, ADC_CHANNEL_5},
+    [VSTATE_SENSE_NTC_1] = {&hadc3, ADC_CHANNEL_10},
+    [VSTATE_SENSE_NTC_2] = {&hadc3, ADC_CHANNEL_11},
+    [VSTATE_SENSE_MANETTINO_1] = {&hadc1, ADC_CHANNEL_0},
+    [VSTATE_SENSE_MANETTINO_2] = {&hadc1, ADC_CHANNEL_1},
+};
+
+static TIM_HandleTypeDef *const SENSE_Tach[VSTATE_FAN_NBR] = {&htim1, &htim2};
+
+static SENSE_Ctx_t SENSE_Ctx;
+
+static void SENSE_Sample(uint32_t Prime);
+static int32_t SENSE_Convert(const SENSE_Input_t *pInput, uint32_t *pValue);
+static void SENSE_Capture(uint32_t Now);
+static uint32_t SENSE_Millivolts(uint32_t Input);
+static int16_t SENSE_Ntc(uint32_t Millivolts);
+
+/**
+ * @brief  Calibrates the three ADCs, starts the tachometer captures and
+ *         takes a first reading. After MX_ADCx_Init() and MX_TIMx_Init().
+ * @retval BSP status
+ */
+int32_t SENSE_Init(void)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  SENSE_Ctx = (SENSE_Ctx_t){0};
+  if ((HAL_ADCEx_Calibration_Start(&hadc1, ADC_CALIB_OFFSET_LINEARITY, ADC_SINGLE_ENDED) != HAL_OK) ||
+      (HAL_ADCEx_Calibration_Start(&hadc2, ADC_CALIB_OFFSET_LINEARITY, ADC_SINGLE_ENDED) != HAL_OK) ||
+      (HAL_ADCEx_Calibration_Start(&hadc3, ADC_CALIB_OFFSET_LINEARITY, ADC_SINGLE_ENDED) != HAL_OK))
+  {
+    ret = BSP_ERROR_PERIPH_FAILURE;
+  }
+  else if ((HAL_TIM_IC_Start(&htim1, TIM_CHANNEL_1) != HAL_OK) || (HAL_TIM_IC_Start(&htim2, TIM_CHANNEL_1) != HAL_OK))
+  {
+    ret = BSP_ERROR_PERIPH_FAILURE;
+  }
+  else
+  {
+    SENSE_Sample(1U);
+    SENSE_Ctx.LastMs = HAL_GetTick();
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Samples the inputs every SENSE_PERIOD_MS. Main loop context.
+ */
+void SENSE_Process(void)
+{
+  uint32_t now = HAL_GetTick();
+
+  if ((now - SENSE_Ctx.LastMs) >= SENSE_PERIOD_MS)
+  {
+    SENSE_Ctx.LastMs = now;
+    SENSE_Sample(0U);
+    SENSE_Capture(now);
+  }
+}
+
+/**
+ * @brief  Writes the analog inputs, NTC temperatures and fan speeds into a
+ *         snapshot.
+ * @param  pState Snapshot being built
+ */
+void SENSE_Fill(VSTATE_t *pState)
+{
+  uint32_t i;
+
+  for (i = 0; i < VSTATE_SENSE_NBR; i++)
+  {
+    pState->SenseMv[i] = (uint16_t)SENSE_Millivolts(i);
+  }
+  pState->NtcDeciC[0] = SENSE_Ntc(pState->SenseMv[VSTATE_SENSE_NTC_1]);
+  pState->NtcDeciC[1] = SENSE_Ntc(pState->SenseMv[VSTATE_SENSE_NTC_2]);
+  for (i = 0; i < VSTATE_FAN_NBR; i++)
+  {
+    pState->FanRpm[i] = (SENSE_Ctx.TachPeriod[i] == 0U)
+                            ? 0U
+                            : ((60U * SENSE_TACH_HZ) / (SENSE_Ctx.TachPeriod[i] * SENSE_TACH_PULSES));
+  }
+}
+
+/* One conversion of every input, Prime loads the filters with it */
+static void SENSE_Sample(uint32_t Prime)
+{
+  uint32_t i, value;
+
+  for (i = 0; i < VSTATE_SENSE_NBR; i++)
+  {
+    if (SENSE_Convert(&SENSE_Inputs[i], &value) != BSP_ERROR_NONE)
+    {
+      continue;
+    }
+    if (Prime != 0U)
+    {
+      SENSE_Ctx.Filtered[i] = value << SENSE_FILTER_SHIFT;
+    }
+    else
+    {
+      SENSE_Ctx.Filtered[i] += value - (SENSE_Ctx.Filtered[i] >> SENSE_FILTER_SHIFT);
+    }
+  }
+}
+
+static int32_t SENSE_Convert(const SENSE_Input_t *pInput, uint32_t *pValue)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  ADC_ChannelConfTypeDef config = {0};
+
+  config.Channel = pInput->Channel;
+  config.Rank = ADC_REGULAR_RANK_1;
+  config.SamplingTime = SENSE_SAMPLETIME;
+  config.SingleDiff = ADC_SINGLE_ENDED;
+  config.OffsetNumber = ADC_OFFSET_NONE;
+  if ((HAL_ADC_ConfigChannel(pInput->Adc, &config) != HAL_OK) || (HAL_ADC_Start(pInput->Adc) != HAL_OK) ||
+      (HAL_ADC_PollForConversion(pInput->Adc, SENSE_ADC_TIMEOUT_MS) != HAL_OK))
+  {
+    ret = BSP_ERROR_PERIPH_FAILURE;
+  }
+  else
+  {
+    *pValue = HAL_ADC_GetValue(pInput->Adc);
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+static void SENSE_Capture(uint32_t Now)
+{
+  uint32_t i, period;
+
+  for (i = 0; i < VSTATE_FAN_NBR; i++)
+  {
+    if (__HAL_TIM_GET_FLAG(SENSE_Tach[i], TIM_FLAG_CC1) != RESET)
+    {
+      /* Reading CCR1 clears the flag */
+      period = HAL_TIM_ReadCapturedValue(SENSE_Tach[i], TIM_CHANNEL_1);
+      SENSE_Ctx.TachPeriod[i] = (SENSE_Ctx.TachArmed[i] != 0U) ? period : 0U;
+      SENSE_Ctx.TachArmed[i] = 1U;
+      SENSE_Ctx.TachLastMs[i] = Now;
+    }
+    else if ((Now - SENSE_Ctx.TachLastMs[i]) >= SENSE_TACH_TIMEOUT_MS)
+    {
+      SENSE_Ctx.TachPeriod[i] = 0U;
+      SENSE_Ctx.TachArmed[i] = 0U;
+    }
+  }
+}
+
+static uint32_t SENSE_Millivolts(uint32_t Input)
+{
+  return ((SENSE_Ctx.Filtered[Input] >> SENSE_FILTER_SHIFT) * SENSE_VREF_MV) / SENSE_FULL_SCALE;
+}
+
+/* Beta model of the thermistor, tenths of a degree */
+static int16_t SENSE_Ntc(uint32_t Millivolts)
+{
+  float ohm, kelvin;
+
+  /* Within 1 % of a rail: shorted or disconnected */
+  if ((Millivolts < (SENSE_VREF_MV / 100U)) || (Millivolts > (SENSE_VREF_MV - (SENSE_VREF_MV / 100U))))
+  {
+    return SENSE_NTC_INVALID;
+  }
+  ohm = (SENSE_NTC_PULLUP_OHM * (float)Millivolts) / (float)(SENSE_VREF_MV - Millivolts);
+  kelvin = 1.0f / ((1.0f / (SENSE_KELVIN + 25.0f)) + (logf(ohm / SENSE_NTC_R25_OHM) / SENSE_NTC_BETA));
+  return (int16_t)lrintf((kelvin - SENSE_KELVIN) * 10.0f);
+}
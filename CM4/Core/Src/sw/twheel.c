@@ -0,0 +1,144 @@
+#include "sw/twheel.h"
+
+#include <string.h>
+
+/*
+ * Hierarchical timer wheel.
+ *
+ * A timer sits in the level that covers its distance to the current tick:
+ * level 0 holds the next TWHEEL_SLOTS ticks one per slot, level 1 the next
+ * TWHEEL_SLOTS^2 ticks TWHEEL_SLOTS per slot, and so on. Starting,
+ * restarting and stopping a timer is a list link or unlink in one slot,
+ * whatever the number of timers. Each tick serves one level 0 slot; when
+ * level 0 wraps, the next slot of level 1 is cascaded, its timers moved
+ * down by distance, and likewise upwards. A timer is visited once per
+ * level it goes through, the ticks without a due timer cost an index
+ * increment.
+ *
+ * Ticks are uint32_t and compared by difference, they may wrap.
+ */
+
+static void TWHEEL_Link(TWHEEL_t *pWheel, TWHEEL_Timer_t *pTimer);
+static void TWHEEL_Cascade(TWHEEL_t *pWheel, uint32_t Level);
+
+/**
+ * @brief  Empties a wheel.
+ * @param  pWheel Wheel
+ * @param  Now    Current tick
+ */
+void TWHEEL_Init(TWHEEL_t *pWheel, uint32_t Now)
+{
+  memset(pWheel->Slots, 0, sizeof(pWheel->Slots));
+  pWheel->Now = Now;
+}
+
+/**
+ * @brief  Starts or restarts a timer, O(1). A tick already past or
+ *         current expires on the next TWHEEL_Advance().
+ * @param  pWheel  Wheel
+ * @param  pTimer  Timer, Handler set
+ * @param  Expires Tick of expiry, at most TWHEEL_SPAN ahead
+ */
+void TWHEEL_Start(TWHEEL_t *pWheel, TWHEEL_Timer_t *pTimer, uint32_t Expires)
+{
+  TWHEEL_Stop(pTimer);
+  if ((int32_t)(Expires - pWheel->Now) <= 0)
+  {
+    Expires = pWheel->Now + 1U;
+  }
+  else if ((Expires - pWheel->Now) > TWHEEL_SPAN)
+  {
+    Expires = pWheel->Now + TWHEEL_SPAN;
+  }
+  pTimer->Expires = Expires;
+  TWHEEL_Link(pWheel, pTimer);
+}
+
+/**
+ * @brief  Stops a timer, O(1). No effect on a stopped timer.
+ */
+void TWHEEL_Stop(TWHEEL_Timer_t *pTimer)
+{
+  if (pTimer->ppPrev != NULL)
+  {
+    *pTimer->ppPrev = pTimer->pNext;
+    if (pTimer->pNext != NULL)
+    {
+      pTimer->pNext->ppPrev = pTimer->ppPrev;
+    }
+    pTimer->pNext = NULL;
+    pTimer->ppPrev = NULL;
+  }
+}
+
+/**
+ * @brief  Serves every tick up to Now, calling the handler of each timer
+ *         that expires.
+ * @param  pWheel Wheel
+ * @param  Now    Current tick
+ * @retval Number of timers expired
+ */
+uint32_t TWHEEL_Advance(TWHEEL_t *pWheel, uint32_t Now)
+{
+  TWHEEL_Timer_t *timer;
+  uint32_t expired = 0U, index, level;
+
+  while ((int32_t)(Now - pWheel->Now) > 0)
+  {
+    pWheel->Now++;
+    index = pWheel->Now & (TWHEEL_SLOTS - 1U);
+
+    /* Level 0 wrapped: the next slot of level 1 moves down, and of level 2
+     * if level 1 wrapped too */
+    for (level = 1U; (index == 0U) && (level < TWHEEL_LEVELS); level++)
+    {
+      TWHEEL_Cascade(pWheel, level);
+      index = (pWheel->Now >> (TWHEEL_BITS * level)) & (TWHEEL_SLOTS - 1U);
+    }
+
+    /* A handler restarting its timer puts it in a later slot */
+    index = pWheel->Now & (TWHEEL_SLOTS - 1U);
+    while ((timer = pWheel->Slots[0][index]) != NULL)
+    {
+      TWHEEL_Stop(timer);
+      timer->Handler(timer);
+      expired++;
+    }
+  }
+  return expired;
+}
+
+/* Puts a timer in the slot of its distance */
+static void TWHEEL_Link(TWHEEL_t *pWheel, TWHEEL_Timer_t *pTimer)
+{
+  uint32_t delta = pTimer->Expires - pWheel->Now;
+  uint32_t level = 0U;
+  TWHEEL_Timer_t **head;
+
+  while (((level + 1U) < TWHEEL_LEVELS) && (delta >= (1UL << (TWHEEL_BITS * (level + 1U)))))
+  {
+    level++;
+  }
+  head = &pWheel->Slots[level][(pTimer->Expires >> (TWHEEL_BITS * level)) & (TWHEEL_SLOTS - 1U)];
+
+  pTimer->pNext = *head;
+  pTimer->ppPrev = head;
+  if (*head != NULL)
+  {
+    (*head)->ppPrev = &pTimer->pNext;
+  }
+  *head = pTimer;
+}
+
+/* Moves the timers of the current slot of a level down the wheel */
+static void TWHEEL_Cascade(TWHEEL_t *pWheel, uint32_t Level)
+{
+  uint32_t index = (pWheel->Now >> (TWHEEL_BITS * Level)) & (TWHEEL_SLOTS - 1U);
+  TWHEEL_Timer_t *timer;
+
+  while ((timer = pWheel->Slots[Level][index]) != NULL)
+  {
+    TWHEEL_Stop(timer);
+    TWHEEL_Link(pWheel, timer);
+  }
+}
@@ -0,0 +1,167 @@
+#include "sw/vstate_pub.h"
+
+#include <string.h>
+
+#include "driver/can.h"
+#include "main.h"
+#include "sw/can_db.h"
+#include "sw/can_rx.h"
+#include "sw/can_stats.h"
+#include "sw/can_sup.h"
+#include "sw/sense.h"
+
+/*
+ * Vehicle state publisher.
+ *
+ * Every decoded frame is copied into the staging snapshot by its CAN_RX
+ * handler and staleness changes come from CAN_SUP, one store per event.
+ * Every VSTATE_PERIOD_MS the bus statistics, the analog inputs and the fan
+ * speeds are added and the whole staging copy goes to the CM7 (vstate.h).
+ */
+
+typedef struct
+{
+  VSTATE_t State;
+  uint32_t LastMs;
+} VSTATE_PUB_Ctx_t;
+
+static VSTATE_PUB_Ctx_t VSTATE_PUB_Ctx;
+
+static void VSTATE_PUB_Received(uint32_t Msg, const void *pSignals, const BSP_CAN_Frame_t *pFrame, void *Context);
+static void VSTATE_PUB_Stale(uint32_t Msg, uint32_t Stale, void *Context);
+static void VSTATE_PUB_Set(uint32_t *pMask, uint32_t Msg, uint32_t Value);
+static void VSTATE_PUB_Publish(void);
+
+/**
+ * @brief  Subscribes to every message and to the staleness changes, then
+ *         publishes a first snapshot. After VSTATE_Init(), CAN_SUP_Init()
+ *         and SENSE_Init().
+ * @retval BSP status
+ */
+int32_t VSTATE_PUB_Init(void)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t i;
+
+  memset(&VSTATE_PUB_Ctx, 0, sizeof(VSTATE_PUB_Ctx));
+  for (i = 0; (i < CAN_MSGS_COUNT) && (ret == BSP_ERROR_NONE); i++)
+  {
+    VSTATE_PUB_Set(VSTATE_PUB_Ctx.State.Stale, i, CAN_SUP_IsStale(i));
+    ret = CAN_RX_Subscribe(i, VSTATE_PUB_Received, NULL);
+  }
+  if ((ret == BSP_ERROR_NONE) && (CAN_SUP_Listen(VSTATE_PUB_Stale, NULL) != BSP_ERROR_NONE))
+  {
+    ret = BSP_ERROR_BUSY;
+  }
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    VSTATE_PUB_Ctx.LastMs = HAL_GetTick();
+    VSTATE_PUB_Publish();
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Publishes the snapshot every VSTATE_PERIOD_MS. Main loop context,
+ *         after CAN_RX_Process(), CAN_SUP_Process() and SENSE_Process().
+ */
+void VSTATE_PUB_Process(void)
+{
+  uint32_t now = HAL_GetTick();
+
+  if ((now - VSTATE_PUB_Ctx.LastMs) >= VSTATE_PERIOD_MS)
+  {
+    VSTATE_PUB_Ctx.LastMs = now;
+    VSTATE_PUB_Publish();
+  }
+}
+
+static void VSTATE_PUB_Received(uint32_t Msg, const void *pSignals, const BSP_CAN_Frame_t *pFrame, void *Context)
+{
+  (void)pFrame;
+  (void)Context;
+  memcpy(&VSTATE_PUB_Ctx.State.Signals[Msg], pSignals, CAN_MSGS_Table[Msg].Size);
+  VSTATE_PUB_Set(VSTATE_PUB_Ctx.State.Received, Msg, 1U);
+}
+
+static void VSTATE_PUB_Stale(uint32_t Msg, uint32_t Stale, void *Context)
+{
+  (void)Context;
+  VSTATE_PUB_Set(VSTATE_PUB_Ctx.State.Stale, Msg, Stale);
+}
+
+static void VSTATE_PUB_Set(uint32_t *pMask, uint32_t Msg, uint32_t Value)
+{
+  if (Value != 0U)
+  {
+    pMask[Msg / 32U] |= (1UL << (Msg % 32U));
+  }
+  else
+  {
+    pMask[Msg / 32U] &= ~(1UL << (Msg % 32U));
+  }
+}
+
+/* Statistics and inputs into the staging copy, then out to the CM7 */
+static void VSTATE_PUB_Publish(void)
+{
+  VSTATE_t *state = &VSTATE_PUB_Ctx.State;
+  const CAN_STATS_Bus_t *bus;
+  const CAN_STATS_Id_t *id;
+  const CAN_STATS_Cost_t *cost = CAN_STATS_GetCost();
+  BSP_CAN_RouteStats_t route;
+  uint64_t latency = 0U;
+  uint32_t i;
+
+  state->TimeUs = BSP_CAN_GetTimeUs();
+  for (i = 0; i < CAN_MSGS_COUNT; i++)
+  {
+    id = CAN_STATS_GetId(i);
+    state->Msgs[i].Rate = id->Rate;
+    state->Msgs[i].Missed = id->Missed;
+    state->Msgs[i].JitterMaxUs = id->JitterMaxUs;
+    state->Msgs[i].Timeouts = CAN_SUP_GetTimeouts(i);
+  }
+
+  for (i = 0; i < CAN_BUS_NBR; i++)
+  {
+    bus = CAN_STATS_GetBus((BSP_CAN_Bus_t)i);
+    state->Buses[i].LoadPermille = bus->LoadPermille;
+    state->Buses[i].Rate = bus->Rate;
+    state->Buses[i].Frames = bus->Frames;
+    state->Buses[i].Unknown = bus->Unknown;
+    state->Buses[i].BusOff = bus->BusOff;
+    state->Buses[i].Errors = bus->Errors.Errors;
+    state->Buses[i].Tec = bus->Errors.Tec;
+    state->Buses[i].Rec = bus->Errors.Rec;
+    state->Buses[i].Passive = bus->Errors.Passive;
+    state->Buses[i].Off = bus->Errors.BusOff;
+  }
+
+  memset(&state->Gateway, 0, sizeof(state->Gateway));
+  for (i = 0; i < CAN_DB_Routes1Count; i++)
+  {
+    BSP_CAN_GetRouteStats(CAN_BUS_1, i, &route);
+    state->Gateway.Forwarded += route.Forwarded;
+    state->Gateway.Sent += route.Sent;
+    state->Gateway.RateLimited += route.RateLimited;
+    state->Gateway.Dropped += route.Dropped;
+    latency += route.LatencySumUs;
+    if (route.LatencyMaxUs > state->Gateway.LatencyMaxUs)
+    {
+      state->Gateway.LatencyMaxUs = route.LatencyMaxUs;
+    }
+  }
+  state->Gateway.LatencyAvgUs = (state->Gateway.Sent == 0U) ? 0U : (uint32_t)(latency / state->Gateway.Sent);
+
+  state->Cost.AvgCycles = (cost->Samples == 0U) ? 0U : (uint32_t)(cost->SumCycles / cost->Samples);
+  state->Cost.MaxCycles = cost->MaxCycles;
+  state->Cost.BudgetCycles = CAN_STATS_BUDGET_CYCLES;
+  state->Cost.OverBudget = cost->OverBudget;
+
+  SENSE_Fill(state);
+  VSTATE_Publish(state);
+}
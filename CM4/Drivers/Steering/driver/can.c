@@ -0,0 +1,1183 @@
+#include "can.h"
+
+#include <string.h>
+
+#include "mem_sections.h"
+
+/*
+ * Interrupt-driven FDCAN reception.
+ *
+ * BSP_CAN_Init() gives each instance its half of the message RAM, turns
+ * the list of consumed IDs into acceptance filters and rejects everything
+ * else in hardware, so unrelated traffic never raises an interrupt. IDs
+ * marked CAN_FIFO_HIGH land in Rx FIFO 0, served on interrupt line 0 at
+ * CAN_IRQ_PRIO_HIGH; the rest in Rx FIFO 1 on line 1 at CAN_IRQ_PRIO_LOW.
+ *
+ * Each line drains its FIFO straight from the message RAM into a
+ * single-producer/single-consumer ring, one per bus and FIFO since the two
+ * lines preempt each other. BSP_CAN_Read() is the only consumer, it empties
+ * the high priority ring first.
+ *
+ * Filters: consecutive IDs (3 or more) become one range element, the
+ * others are paired in dual-ID elements.
+ *
+ * Bit timing is computed from the FDCAN kernel clock rather than taken from
+ * CubeMX: the nominal phase runs at CAN_NOMINAL_BITRATE in every mode, the
+ * data phase of BRS frames at one of the BSP_CAN_DataRate_t presets. The
+ * smallest prescaler giving an integer number of time quanta is used, which
+ * maximises the quanta per bit and so the sample point resolution. With BRS
+ * the transmitter delay compensation places the secondary sample point on
+ * the data sample point. Rx and Tx elements always hold 64 bytes, classic
+ * frames simply use the first 8.
+ *
+ * Transmission: CAN_TX_BUFFERS_NBR dedicated Tx buffers, each owned by one
+ * high priority ID so it never waits behind a full queue, and a Tx queue
+ * in priority mode for the rest. The controller arbitrates every pending
+ * buffer and queue element by ID, lowest first, so the bus sees the same
+ * order as the arbitration would give between nodes.
+ *
+ * Timebase: the timestamp counter of FDCAN1 ticks every microsecond
+ * (CAN_TS_PRESC nominal bit times); its wraparound interrupt extends it to
+ * the 64-bit BSP_CAN_GetTimeUs(), the time reference of the whole system.
+ * Each instance stamps the start of received frames and of transmitted
+ * ones (Tx event FIFO) with its own 16-bit counter, ticking at the same
+ * rate: a stamp is turned into system time from its age against the
+ * current counter, valid as long as it is read within 65 ms. The Tx
+ * message marker indexes the time each frame was queued, Tx events carry
+ * the queue to bus latency. While FDCAN1 is re-initialised the time goes on
+ * from the tick, held at the value it had reached: it never goes back.
+ *
+ * Bus-off: the controller leaves the bus and stops in INIT mode; the
+ * interrupt counts the event and clears INIT at once, the controller
+ * rejoins after the 128 x 11 recessive bits the protocol requires.
+ *
+ * Gateway: each route given to BSP_CAN_SetRoutes() gets its own filter
+ * element ahead of the consumed IDs, the filter index of a received
+ * element tells the interrupt that it is routed without any ID search.
+ * The element is copied word by word from the Rx FIFO of the source into
+ * the Tx queue of the other instance, both in the message RAM, with the
+ * ID rewritten; no frame buffer in between. The Tx event of the copy
+ * carries its source timestamp as the queue time, so its latency is the
+ * start of frame to start of frame forwarding delay. The Tx queue then
+ * has two producers, the interrupt and BSP_CAN_Send(): both fill and
+ * request an element with interrupts masked.
+ */
+
+#define CAN_ELMT_BYTES ((2U + CAN_DATA_BYTES / 4U) * 4U) /* Header and payload of an Rx/Tx element */
+#define CAN_ELMT_SIZE FDCAN_DATA_BYTES_64
+
+#define CAN_ELMT_XTD 0x40000000U
+#define CAN_ELMT_DLC_Pos 16U
+#define CAN_ELMT_FIDX_Pos 24U
+#define CAN_ELMT_BRS 0x00100000U
+#define CAN_ELMT_FDF 0x00200000U
+#define CAN_ELMT_TS_Msk 0x0000FFFFU
+#define CAN_ELMT_MM_Pos 24U
+#define CAN_ELMT_EFC 0x00800000U
+#define CAN_TX_EVENT_BYTES 8U
+
+/* Queue times kept per bus, indexed by the message marker; more than the
+ * Tx elements so a marker is never reused while its frame is pending */
+#define CAN_TX_MARKERS 32U
+
+/* HAL_FDCAN_Init() limits of the nominal and data bit timing */
+#define CAN_NOM_PRESC_MAX 512U
+#define CAN_NOM_SEG1_MAX 256U
+#define CAN_NOM_SEG2_MAX 128U
+#define CAN_DATA_PRESC_MAX 32U
+#define CAN_DATA_SEG1_MAX 32U
+#define CAN_DATA_SEG2_MAX 16U
+#define CAN_TDC_OFFSET_MAX 127U
+
+typedef struct
+{
+  uint32_t Prescaler;
+  uint32_t Seg1; /* Propagation and phase 1 segments */
+  uint32_t Seg2;
+} CAN_Timing_t;
+
+typedef struct
+{
+  uint32_t Rate;        /* bit/s */
+  uint32_t SamplePoint; /* Per mille */
+} CAN_Rate_t;
+
+typedef struct
+{
+  BSP_CAN_Frame_t Frames[CAN_RX_RING_SIZE];
+  volatile uint32_t Head; /* Written by the interrupt */
+  volatile uint32_t Tail; /* Written by BSP_CAN_Read() */
+} CAN_Ring_t;
+
+typedef struct
+{
+  BSP_CAN_TxEvent_t Events[CAN_TX_EVENT_RING_SIZE];
+  volatile uint32_t Head; /* Written by the interrupt */
+  volatile uint32_t Tail; /* Written by BSP_CAN_ReadTxEvents() */
+} CAN_EventRing_t;
+
+typedef struct
+{
+  FDCAN_HandleTypeDef *Handle;
+  IRQn_Type Irq[CAN_FIFO_NBR];
+  BSP_CAN_Config_t Config;
+  BSP_CAN_Stats_t Stats;
+  uint32_t TxMarker;
+  uint32_t Errors; /* FDCAN_ECR.CEL accumulated, the field clears on read */
+  uint64_t TxQueued[CAN_TX_MARKERS];
+  uint8_t TxRoute[CAN_TX_MARKERS]; /* Route of the other bus + 1 that queued the marker, 0 for BSP_CAN_Send() */
+  BSP_CAN_Route_t Routes[CAN_ROUTES_MAX];
+  uint32_t RouteCount;
+  BSP_CAN_RouteStats_t RouteStats[CAN_ROUTES_MAX];
+  uint64_t RouteLast[CAN_ROUTES_MAX];           /* Source timestamp of the last forwarded frame */
+  uint8_t RouteByFilter[2][CAN_STD_FILTERS_NBR]; /* Route + 1 by ID type and filter index, 0 if not routed */
+} CAN_Ctx_t;
+
+static CAN_Ctx_t CAN_Ctx[CAN_BUS_NBR] = {
+    {&hfdcan1, {FDCAN1_IT0_IRQn, FDCAN1_IT1_IRQn}, {CAN_BUS1_MODE, CAN_BUS1_DATA_RATE}},
+    {&hfdcan2, {FDCAN2_IT0_IRQn, FDCAN2_IT1_IRQn}, {CAN_BUS2_MODE, CAN_BUS2_DATA_RATE}},
+};
+
+static const CAN_Rate_t CAN_DataRates[CAN_DATA_NBR] = {
+    {2000000U, 750U},
+    {4000000U, 750U},
+    {5000000U, 750U},
+    {8000000U, 700U},
+};
+
+static DTCM_BSS CAN_Ring_t CAN_Rx[CAN_BUS_NBR][CAN_FIFO_NBR];
+static DTCM_BSS CAN_EventRing_t CAN_TxEvt[CAN_BUS_NBR];
+
+/* System time at the last reset of the FDCAN1 counter, and wraps since */
+static uint64_t CAN_TimeBase;
+/* System time reached when FDCAN1 last stopped, the tick fallback never
+ * reads below it */
+static uint64_t CAN_TimeFloor;
+static volatile uint32_t CAN_TimeWraps;
+static volatile uint32_t CAN_TimeRunning;
+
+static const uint8_t CAN_DlcToLen[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+
+static const uint32_t CAN_TxDlc[16] = {
+    FDCAN_DLC_BYTES_0,  FDCAN_DLC_BYTES_1,  FDCAN_DLC_BYTES_2,  FDCAN_DLC_BYTES_3,
+    FDCAN_DLC_BYTES_4,  FDCAN_DLC_BYTES_5,  FDCAN_DLC_BYTES_6,  FDCAN_DLC_BYTES_7,
+    FDCAN_DLC_BYTES_8,  FDCAN_DLC_BYTES_12, FDCAN_DLC_BYTES_16, FDCAN_DLC_BYTES_20,
+    FDCAN_DLC_BYTES_24, FDCAN_DLC_BYTES_32, FDCAN_DLC_BYTES_48, FDCAN_DLC_BYTES_64,
+};
+
+_Static_assert((CAN_RX_RING_SIZE & (CAN_RX_RING_SIZE - 1U)) == 0U, "CAN_RX_RING_SIZE must be a power of two");
+_Static_assert((CAN_TX_EVENT_RING_SIZE & (CAN_TX_EVENT_RING_SIZE - 1U)) == 0U,
+               "CAN_TX_EVENT_RING_SIZE must be a power of two");
+_Static_assert((CAN_TS_PRESC >= 1U) && (CAN_TS_PRESC <= 16U) && ((CAN_NOMINAL_BITRATE % 1000000U) == 0U),
+               "the timestamp counter cannot tick in microseconds");
+_Static_assert((CAN_TX_MARKERS > CAN_TX_BUFFERS_NBR + CAN_TX_QUEUE_ELMTS_NBR) && ((256U % CAN_TX_MARKERS) == 0U),
+               "message markers reused while pending");
+_Static_assert(CAN_STD_FILTERS_NBR + 2U * CAN_EXT_FILTERS_NBR +
+                       (CAN_RX_FIFO0_ELMTS_NBR + CAN_RX_FIFO1_ELMTS_NBR + CAN_TX_BUFFERS_NBR + CAN_TX_QUEUE_ELMTS_NBR) *
+                           (CAN_ELMT_BYTES / 4U) +
+                       CAN_TX_EVENTS_NBR * (CAN_TX_EVENT_BYTES / 4U) <=
+                   CAN_MSGRAM_WORDS,
+               "message RAM partition overflow");
+_Static_assert((CAN_STD_FILTERS_NBR >= CAN_EXT_FILTERS_NBR) && (CAN_STD_FILTERS_NBR <= 128U) &&
+                   (CAN_ROUTES_MAX <= CAN_EXT_FILTERS_NBR),
+               "filter index out of the route map");
+
+static int32_t CAN_ConfigFilters(BSP_CAN_Bus_t Bus, const BSP_CAN_RxId_t *Ids, uint32_t Count);
+static int32_t CAN_AddFilter(BSP_CAN_Bus_t Bus, uint32_t Extended, uint32_t Fifo, uint32_t Type, uint32_t Id1,
+                             uint32_t Id2);
+static void CAN_Drain(BSP_CAN_Bus_t Bus, BSP_CAN_Fifo_t Fifo);
+static void CAN_DrainTxEvents(BSP_CAN_Bus_t Bus);
+static void CAN_Forward(BSP_CAN_Bus_t Bus, uint32_t Route, const volatile uint32_t *Elmt, uint32_t W1,
+                        uint64_t Timestamp);
+static int32_t CAN_ConfigRoutes(BSP_CAN_Bus_t Bus);
+static int32_t CAN_ConfigTiming(BSP_CAN_Bus_t Bus);
+static int32_t CAN_Timing(uint32_t Clock, const CAN_Rate_t *Rate, uint32_t PrescMax, uint32_t Seg1Max,
+                          uint32_t Seg2Max, CAN_Timing_t *Timing);
+static int32_t CAN_TxPrepare(BSP_CAN_Bus_t Bus, const BSP_CAN_Frame_t *Frame, FDCAN_TxHeaderTypeDef *Header,
+                             uint32_t *Data, uint8_t **Payload);
+
+/**
+ * @brief  Selects the frame format and data rate of a bus, applied by the
+ *         next BSP_CAN_Init().
+ * @param  Bus    Instance
+ * @param  Config Mode and data phase preset
+ * @retval BSP status
+ */
+int32_t BSP_CAN_SetConfig(BSP_CAN_Bus_t Bus, const BSP_CAN_Config_t *Config)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if ((Bus >= CAN_BUS_NBR) || (Config == NULL) || (Config->Mode > CAN_MODE_FD_BRS) ||
+      (Config->DataRate >= CAN_DATA_NBR))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    CAN_Ctx[Bus].Config = *Config;
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Sets the frames of a bus forwarded to the other bus, applied by
+ *         the next BSP_CAN_Init() of the source bus. An ID routed and
+ *         consumed goes through the route, Local selects whether it is
+ *         also read.
+ * @param  Bus    Source instance
+ * @param  Routes Routes, copied
+ * @param  Count  Number of routes, at most CAN_ROUTES_MAX, 0 to stop forwarding
+ * @retval BSP status
+ */
+int32_t BSP_CAN_SetRoutes(BSP_CAN_Bus_t Bus, const BSP_CAN_Route_t *Routes, uint32_t Count)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t i;
+
+  if ((Bus >= CAN_BUS_NBR) || ((Routes == NULL) && (Count != 0U)) || (Count > CAN_ROUTES_MAX))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    for (i = 0; (i < Count) && (ret == BSP_ERROR_NONE); i++)
+    {
+      if ((Routes[i].Fifo >= CAN_FIFO_NBR) || (Routes[i].Id > ((Routes[i].Extended != 0U) ? 0x1FFFFFFFU : 0x7FFU)) ||
+          (Routes[i].TxId > ((Routes[i].TxExtended != 0U) ? 0x1FFFFFFFU : 0x7FFU)))
+      {
+        ret = BSP_ERROR_WRONG_PARAM;
+      }
+    }
+  }
+  if (ret == BSP_ERROR_NONE)
+  {
+    for (i = 0; i < Count; i++)
+    {
+      CAN_Ctx[Bus].Routes[i] = Routes[i];
+    }
+    CAN_Ctx[Bus].RouteCount = Count;
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Partitions the message RAM, programs the acceptance filters and
+ *         the interrupts of one instance. MX_FDCANx_Init() must have been
+ *         called, the instance must be stopped.
+ * @param  Bus   Instance
+ * @param  Ids   IDs consumed on this bus
+ * @param  Count Number of IDs, at most CAN_RX_IDS_MAX
+ * @retval BSP status, BSP_ERROR_WRONG_PARAM if the filters do not fit
+ */
+int32_t BSP_CAN_Init(BSP_CAN_Bus_t Bus, const BSP_CAN_RxId_t *Ids, uint32_t Count)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  FDCAN_HandleTypeDef *h;
+  uint32_t primask;
+
+  if ((Bus >= CAN_BUS_NBR) || ((Ids == NULL) && (Count != 0U)) || (Count > CAN_RX_IDS_MAX))
+  {
+    return BSP_ERROR_WRONG_PARAM;
+  }
+  h = CAN_Ctx[Bus].Handle;
+
+  h->Init.MessageRAMOffset = (uint32_t)Bus * CAN_MSGRAM_WORDS;
+  h->Init.StdFiltersNbr = CAN_STD_FILTERS_NBR;
+  h->Init.ExtFiltersNbr = CAN_EXT_FILTERS_NBR;
+  h->Init.RxFifo0ElmtsNbr = CAN_RX_FIFO0_ELMTS_NBR;
+  h->Init.RxFifo0ElmtSize = CAN_ELMT_SIZE;
+  h->Init.RxFifo1ElmtsNbr = CAN_RX_FIFO1_ELMTS_NBR;
+  h->Init.RxFifo1ElmtSize = CAN_ELMT_SIZE;
+  h->Init.RxBuffersNbr = 0U;
+  h->Init.TxEventsNbr = CAN_TX_EVENTS_NBR;
+  h->Init.TxBuffersNbr = CAN_TX_BUFFERS_NBR;
+  h->Init.TxFifoQueueElmtsNbr = CAN_TX_QUEUE_ELMTS_NBR;
+  h->Init.TxFifoQueueMode = FDCAN_TX_QUEUE_OPERATION;
+  h->Init.TxElmtSize = CAN_ELMT_SIZE;
+
+  HAL_NVIC_DisableIRQ(CAN_Ctx[Bus].Irq[CAN_FIFO_HIGH]);
+  HAL_NVIC_DisableIRQ(CAN_Ctx[Bus].Irq[CAN_FIFO_LOW]);
+  CAN_Ctx[Bus].Stats = (BSP_CAN_Stats_t){0};
+  CAN_Ctx[Bus].Errors = 0U;
+  memset(CAN_Ctx[Bus].TxRoute, 0, sizeof(CAN_Ctx[Bus].TxRoute));
+  memset(CAN_Ctx[Bus].RouteStats, 0, sizeof(CAN_Ctx[Bus].RouteStats));
+  memset(CAN_Ctx[Bus].RouteLast, 0, sizeof(CAN_Ctx[Bus].RouteLast));
+  CAN_Rx[Bus][CAN_FIFO_HIGH].Head = CAN_Rx[Bus][CAN_FIFO_HIGH].Tail = 0U;
+  CAN_Rx[Bus][CAN_FIFO_LOW].Head = CAN_Rx[Bus][CAN_FIFO_LOW].Tail = 0U;
+  CAN_TxEvt[Bus].Head = CAN_TxEvt[Bus].Tail = 0U;
+  if (Bus == CAN_BUS_1)
+  {
+    /* The timebase falls back on the tick until FDCAN1 runs again, from
+     * the time it reached: the tick may lag the counter */
+    primask = __get_PRIMASK();
+    __disable_irq();
+    CAN_TimeFloor = BSP_CAN_GetTimeUs();
+    CAN_TimeRunning = 0U;
+    __set_PRIMASK(primask);
+  }
+
+  if ((ret = CAN_ConfigTiming(Bus)) != BSP_ERROR_NONE)
+  {
+    /* No bit timing for the kernel clock */
+  }
+  /* Re-initialisation clears the message RAM of the instance */
+  else if (HAL_FDCAN_Init(h) != HAL_OK)
+  {
+    ret = BSP_ERROR_PERIPH_FAILURE;
+  }
+  else if ((h->Init.FrameFormat == FDCAN_FRAME_FD_BRS) &&
+           ((HAL_FDCAN_ConfigTxDelayCompensation(h, h->Init.DataPrescaler * (h->Init.DataTimeSeg1 + 1U), 0U) !=
+             HAL_OK) ||
+            (HAL_FDCAN_EnableTxDelayCompensation(h) != HAL_OK)))
+  {
+    ret = BSP_ERROR_PERIPH_FAILURE;
+  }
+  else if ((HAL_FDCAN_ConfigTimestampCounter(h, (CAN_TS_PRESC - 1U) << FDCAN_TSCC_TCP_Pos) != HAL_OK) ||
+           (HAL_FDCAN_EnableTimestampCounter(h, FDCAN_TIMESTAMP_INTERNAL) != HAL_OK))
+  {
+    ret = BSP_ERROR_PERIPH_FAILURE;
+  }
+  /* Route elements first, the first matching element wins */
+  else if (((ret = CAN_ConfigRoutes(Bus)) != BSP_ERROR_NONE) ||
+           ((ret = CAN_ConfigFilters(Bus, Ids, Count)) != BSP_ERROR_NONE))
+  {
+    /* Too many filter elements */
+  }
+  /* Line 0: FIFO 0 and the timebase wraparound, line 1: FIFO 1, Tx events and bus-off */
+  else if ((HAL_FDCAN_ConfigGlobalFilter(h, FDCAN_REJECT, FDCAN_REJECT, FDCAN_REJECT_REMOTE, FDCAN_REJECT_REMOTE) !=
+            HAL_OK) ||
+           (HAL_FDCAN_ConfigInterruptLines(h,
+                                           FDCAN_IT_RX_FIFO0_NEW_MESSAGE | FDCAN_IT_RX_FIFO0_MESSAGE_LOST |
+                                               FDCAN_IT_TIMESTAMP_WRAPAROUND,
+                                           FDCAN_INTERRUPT_LINE0) != HAL_OK) ||
+           (HAL_FDCAN_ConfigInterruptLines(h,
+                                           FDCAN_IT_RX_FIFO1_NEW_MESSAGE | FDCAN_IT_RX_FIFO1_MESSAGE_LOST |
+                                               FDCAN_IT_TX_EVT_FIFO_NEW_DATA | FDCAN_IT_TX_EVT_FIFO_ELT_LOST |
+                                               FDCAN_IT_BUS_OFF,
+                                           FDCAN_INTERRUPT_LINE1) != HAL_OK) ||
+           (HAL_FDCAN_ActivateNotification(h,
+                                           FDCAN_IT_RX_FIFO0_NEW_MESSAGE | FDCAN_IT_RX_FIFO0_MESSAGE_LOST |
+                                               FDCAN_IT_RX_FIFO1_NEW_MESSAGE | FDCAN_IT_RX_FIFO1_MESSAGE_LOST |
+                                               FDCAN_IT_TX_EVT_FIFO_NEW_DATA | FDCAN_IT_TX_EVT_FIFO_ELT_LOST |
+                                               FDCAN_IT_BUS_OFF | ((Bus == CAN_BUS_1) ? FDCAN_IT_TIMESTAMP_WRAPAROUND : 0U),
+                                           0U) != HAL_OK))
+  {
+    ret = BSP_ERROR_PERIPH_FAILURE;
+  }
+  else
+  {
+    HAL_NVIC_SetPriority(CAN_Ctx[Bus].Irq[CAN_FIFO_HIGH], CAN_IRQ_PRIO_HIGH, 0);
+    HAL_NVIC_SetPriority(CAN_Ctx[Bus].Irq[CAN_FIFO_LOW], CAN_IRQ_PRIO_LOW, 0);
+    HAL_NVIC_EnableIRQ(CAN_Ctx[Bus].Irq[CAN_FIFO_HIGH]);
+    HAL_NVIC_EnableIRQ(CAN_Ctx[Bus].Irq[CAN_FIFO_LOW]);
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Joins the bus. Starting FDCAN1 hands the system timebase over to
+ *         its timestamp counter.
+ * @param  Bus Instance
+ * @retval BSP status
+ */
+int32_t BSP_CAN_Start(BSP_CAN_Bus_t Bus)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t primask;
+
+  if (Bus >= CAN_BUS_NBR)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    if (Bus == CAN_BUS_1)
+    {
+      /* Counter zeroed, the time goes on from the last value any context
+       * could have read: taken with interrupts masked */
+      primask = __get_PRIMASK();
+      __disable_irq();
+      CAN_TimeBase = BSP_CAN_GetTimeUs();
+      (void)HAL_FDCAN_ResetTimestampCounter(CAN_Ctx[Bus].Handle);
+      CAN_Ctx[Bus].Handle->Instance->IR = FDCAN_IR_TSW;
+      CAN_TimeWraps = 0U;
+      CAN_TimeRunning = 1U;
+      __set_PRIMASK(primask);
+    }
+    if (HAL_FDCAN_Start(CAN_Ctx[Bus].Handle) != HAL_OK)
+    {
+      ret = BSP_ERROR_PERIPH_FAILURE;
+    }
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Queues a frame in the Tx queue. The payload is zero-padded up to
+ *         the next FD length. Frames longer than 8 bytes or flagged
+ *         CAN_FRAME_FD go out in FD format, with BRS when the bus is in
+ *         CAN_MODE_FD_BRS. Single producer: one context only.
+ * @param  Bus   Instance
+ * @param  Frame Id, Extended, Len, Flags and Data are used
+ * @retval BSP status, BSP_ERROR_BUSY if the Tx queue is full,
+ *         BSP_ERROR_WRONG_PARAM if the frame does not fit the bus mode
+ */
+int32_t BSP_CAN_Send(BSP_CAN_Bus_t Bus, const BSP_CAN_Frame_t *Frame)
+{
+  int32_t ret;
+  FDCAN_TxHeaderTypeDef header;
+  uint32_t data[CAN_DATA_BYTES / 4U];
+  uint32_t primask = __get_PRIMASK();
+  uint8_t *payload;
+
+  /* The gateway interrupt of the other bus queues here too */
+  __disable_irq();
+  if ((ret = CAN_TxPrepare(Bus, Frame, &header, data, &payload)) != BSP_ERROR_NONE)
+  {
+    /* Frame not valid on this bus */
+  }
+  else if ((CAN_Ctx[Bus].Handle->Instance->TXFQS & FDCAN_TXFQS_TFQF) != 0U)
+  {
+    CAN_Ctx[Bus].Stats.TxFull++;
+    ret = BSP_ERROR_BUSY;
+  }
+  else if (HAL_FDCAN_AddMessageToTxFifoQ(CAN_Ctx[Bus].Handle, &header, payload) != HAL_OK)
+  {
+    ret = BSP_ERROR_PERIPH_FAILURE;
+  }
+  else
+  {
+    CAN_Ctx[Bus].TxMarker++;
+    CAN_Ctx[Bus].Stats.Tx++;
+  }
+  __set_PRIMASK(primask);
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Sends a frame from a dedicated Tx buffer, see BSP_CAN_Send() for
+ *         the format. A buffer holds one frame: the previous one must have
+ *         left. Single producer per buffer.
+ * @param  Bus    Instance
+ * @param  Buffer Dedicated buffer, below CAN_TX_BUFFERS_NBR
+ * @param  Frame  Id, Extended, Len, Flags and Data are used
+ * @retval BSP status, BSP_ERROR_BUSY if the buffer is still pending
+ */
+int32_t BSP_CAN_SendBuffer(BSP_CAN_Bus_t Bus, uint32_t Buffer, const BSP_CAN_Frame_t *Frame)
+{
+  int32_t ret;
+  FDCAN_TxHeaderTypeDef header;
+  uint32_t data[CAN_DATA_BYTES / 4U];
+  uint32_t primask = __get_PRIMASK();
+  uint8_t *payload;
+
+  /* The message marker is shared with the gateway */
+  __disable_irq();
+  if (Buffer >= CAN_TX_BUFFERS_NBR)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if ((ret = CAN_TxPrepare(Bus, Frame, &header, data, &payload)) != BSP_ERROR_NONE)
+  {
+    /* Frame not valid on this bus */
+  }
+  else if ((CAN_Ctx[Bus].Handle->Instance->TXBRP & (FDCAN_TX_BUFFER0 << Buffer)) != 0U)
+  {
+    CAN_Ctx[Bus].Stats.TxPending++;
+    ret = BSP_ERROR_BUSY;
+  }
+  else if ((HAL_FDCAN_AddMessageToTxBuffer(CAN_Ctx[Bus].Handle, &header, payload, FDCAN_TX_BUFFER0 << Buffer) !=
+            HAL_OK) ||
+           (HAL_FDCAN_EnableTxBufferRequest(CAN_Ctx[Bus].Handle, FDCAN_TX_BUFFER0 << Buffer) != HAL_OK))
+  {
+    ret = BSP_ERROR_PERIPH_FAILURE;
+  }
+  else
+  {
+    CAN_Ctx[Bus].TxMarker++;
+    CAN_Ctx[Bus].Stats.Tx++;
+  }
+  __set_PRIMASK(primask);
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Takes received frames out of the rings of a bus, high priority
+ *         first. Single consumer: one context only.
+ * @param  Bus    Instance
+ * @param  Frames Destination
+ * @param  Max    Room in Frames
+ * @retval Number of frames copied
+ */
+uint32_t BSP_CAN_Read(BSP_CAN_Bus_t Bus, BSP_CAN_Frame_t *Frames, uint32_t Max)
+{
+  uint32_t n = 0U, fifo, tail;
+  CAN_Ring_t *ring;
+
+  if (Bus >= CAN_BUS_NBR)
+  {
+    return 0U;
+  }
+
+  for (fifo = 0; fifo < CAN_FIFO_NBR; fifo++)
+  {
+    ring = &CAN_Rx[Bus][fifo];
+    tail = ring->Tail;
+    while ((n < Max) && (tail != ring->Head))
+    {
+      /* Head is read before the slot */
+      __DMB();
+      Frames[n++] = ring->Frames[tail % CAN_RX_RING_SIZE];
+      tail++;
+    }
+    /* Slots are copied before they are handed back */
+    __DMB();
+    ring->Tail = tail;
+  }
+  return n;
+}
+
+/**
+ * @brief  Takes the Tx events of a bus out of its ring, oldest first.
+ *         Single consumer: one context only.
+ * @param  Bus    Instance
+ * @param  Events Destination
+ * @param  Max    Room in Events
+ * @retval Number of events copied
+ */
+uint32_t BSP_CAN_ReadTxEvents(BSP_CAN_Bus_t Bus, BSP_CAN_TxEvent_t *Events, uint32_t Max)
+{
+  uint32_t n = 0U, tail;
+  CAN_EventRing_t *ring;
+
+  if (Bus >= CAN_BUS_NBR)
+  {
+    return 0U;
+  }
+
+  ring = &CAN_TxEvt[Bus];
+  tail = ring->Tail;
+  while ((n < Max) && (tail != ring->Head))
+  {
+    __DMB();
+    Events[n++] = ring->Events[tail % CAN_TX_EVENT_RING_SIZE];
+    tail++;
+  }
+  __DMB();
+  ring->Tail = tail;
+  return n;
+}
+
+/**
+ * @brief  System time: the FDCAN1 timestamp counter extended to 64 bits,
+ *         the tick while FDCAN1 is stopped. Never goes back. Any context.
+ * @retval Microseconds since reset
+ */
+ITCM_FUNC uint64_t BSP_CAN_GetTimeUs(void)
+{
+  FDCAN_GlobalTypeDef *inst = hfdcan1.Instance;
+  uint32_t wraps, count, pending;
+  uint64_t tick;
+
+  if (CAN_TimeRunning == 0U)
+  {
+    tick = (uint64_t)HAL_GetTick() * 1000U;
+    return (tick > CAN_TimeFloor) ? tick : CAN_TimeFloor;
+  }
+
+  do
+  {
+    wraps = CAN_TimeWraps;
+    count = inst->TSCV & FDCAN_TSCV_TSC;
+    pending = inst->IR & FDCAN_IR_TSW;
+  } while (wraps != CAN_TimeWraps);
+
+  /* Wrapped, the interrupt is yet to run (masked or preempted by the
+   * caller): the counter restarted from 0 if it reads low */
+  if ((pending != 0U) && (count < 0x8000U))
+  {
+    wraps++;
+  }
+  return CAN_TimeBase + ((uint64_t)wraps << 16) + count;
+}
+
+/**
+ * @brief  Data phase bit rate of BRS frames on a bus, the nominal rate if
+ *         the bus does not switch.
+ * @param  Bus Instance
+ * @retval bit/s
+ */
+uint32_t BSP_CAN_GetDataBitrate(BSP_CAN_Bus_t Bus)
+{
+  if ((Bus >= CAN_BUS_NBR) || (CAN_Ctx[Bus].Config.Mode != CAN_MODE_FD_BRS))
+  {
+    return CAN_NOMINAL_BITRATE;
+  }
+  return CAN_DataRates[CAN_Ctx[Bus].Config.DataRate].Rate;
+}
+
+/**
+ * @brief  Reads the fault confinement state of a bus. Clears the last
+ *         error codes and the hardware error count, accumulated here:
+ *         single reader.
+ * @param  Bus    Instance
+ * @param  Errors Result
+ */
+void BSP_CAN_GetErrors(BSP_CAN_Bus_t Bus, BSP_CAN_Errors_t *Errors)
+{
+  FDCAN_GlobalTypeDef *inst;
+  uint32_t ecr, psr;
+
+  if (Bus >= CAN_BUS_NBR)
+  {
+    return;
+  }
+  inst = CAN_Ctx[Bus].Handle->Instance;
+  ecr = inst->ECR;
+  psr = inst->PSR;
+
+  CAN_Ctx[Bus].Errors += (ecr & FDCAN_ECR_CEL_Msk) >> FDCAN_ECR_CEL_Pos;
+  Errors->Tec = (uint8_t)((ecr & FDCAN_ECR_TEC_Msk) >> FDCAN_ECR_TEC_Pos);
+  Errors->Rec = (uint8_t)((ecr & FDCAN_ECR_REC_Msk) >> FDCAN_ECR_REC_Pos);
+  Errors->Passive = ((psr & FDCAN_PSR_EP_Msk) != 0U) ? 1U : 0U;
+  Errors->BusOff = ((psr & FDCAN_PSR_BO_Msk) != 0U) ? 1U : 0U;
+  Errors->LastError = (uint8_t)((psr & FDCAN_PSR_LEC_Msk) >> FDCAN_PSR_LEC_Pos);
+  Errors->DataLastError = (uint8_t)((psr & FDCAN_PSR_DLEC_Msk) >> FDCAN_PSR_DLEC_Pos);
+  Errors->Errors = CAN_Ctx[Bus].Errors;
+}
+
+/**
+ * @brief  Copies the reception counters of a bus.
+ */
+void BSP_CAN_GetStats(BSP_CAN_Bus_t Bus, BSP_CAN_Stats_t *Stats)
+{
+  if (Bus < CAN_BUS_NBR)
+  {
+    *Stats = CAN_Ctx[Bus].Stats;
+  }
+}
+
+/**
+ * @brief  Copies the counters of a gateway route.
+ * @param  Bus   Source instance
+ * @param  Route Index in the table given to BSP_CAN_SetRoutes()
+ * @param  Stats Result
+ */
+void BSP_CAN_GetRouteStats(BSP_CAN_Bus_t Bus, uint32_t Route, BSP_CAN_RouteStats_t *Stats)
+{
+  if ((Bus < CAN_BUS_NBR) && (Route < CAN_ROUTES_MAX))
+  {
+    *Stats = CAN_Ctx[Bus].RouteStats[Route];
+  }
+}
+
+/**
+ * @brief  Serves one interrupt line of an instance: line 0 drains Rx FIFO 0
+ *         and extends the timebase, line 1 drains Rx FIFO 1 and the Tx
+ *         events and recovers from bus-off. Called from
+ *         FDCANx_ITy_IRQHandler().
+ * @param  Bus  Instance
+ * @param  Line Interrupt line, 0 or 1
+ */
+ITCM_FUNC void BSP_CAN_IRQHandler(BSP_CAN_Bus_t Bus, uint32_t Line)
+{
+  FDCAN_GlobalTypeDef *inst = CAN_Ctx[Bus].Handle->Instance;
+  uint32_t ir = inst->IR & inst->IE;
+
+  /* ILS has one bit per IR flag, set for line 1 */
+  ir &= (Line == 0U) ? ~inst->ILS : inst->ILS;
+
+  if ((ir & FDCAN_IR_TSW) != 0U)
+  {
+    inst->IR = FDCAN_IR_TSW;
+    CAN_TimeWraps++;
+  }
+  if ((ir & (FDCAN_IR_RF0N | FDCAN_IR_RF0L)) != 0U)
+  {
+    /* Cleared before draining, a frame arriving meanwhile raises it again */
+    inst->IR = ir & (FDCAN_IR_RF0N | FDCAN_IR_RF0L);
+    if ((ir & FDCAN_IR_RF0L) != 0U)
+    {
+      CAN_Ctx[Bus].Stats.FifoLost[CAN_FIFO_HIGH]++;
+    }
+    CAN_Drain(Bus, CAN_FIFO_HIGH);
+  }
+  if ((ir & (FDCAN_IR_RF1N | FDCAN_IR_RF1L)) != 0U)
+  {
+    inst->IR = ir & (FDCAN_IR_RF1N | FDCAN_IR_RF1L);
+    if ((ir & FDCAN_IR_RF1L) != 0U)
+    {
+      CAN_Ctx[Bus].Stats.FifoLost[CAN_FIFO_LOW]++;
+    }
+    CAN_Drain(Bus, CAN_FIFO_LOW);
+  }
+  if ((ir & (FDCAN_IR_TEFN | FDCAN_IR_TEFL)) != 0U)
+  {
+    inst->IR = ir & (FDCAN_IR_TEFN | FDCAN_IR_TEFL);
+    if ((ir & FDCAN_IR_TEFL) != 0U)
+    {
+      CAN_Ctx[Bus].Stats.TxEventLost++;
+    }
+    CAN_DrainTxEvents(Bus);
+  }
+  if ((ir & FDCAN_IR_BO) != 0U)
+  {
+    /* Raised on entering and on leaving bus-off */
+    inst->IR = FDCAN_IR_BO;
+    if ((inst->PSR & FDCAN_PSR_BO_Msk) != 0U)
+    {
+      CAN_Ctx[Bus].Stats.BusOff++;
+      inst->CCCR &= ~FDCAN_CCCR_INIT;
+    }
+  }
+}
+
+/* Moves every element of an Rx FIFO into its ring, frames that do not fit are dropped */
+static ITCM_FUNC void CAN_Drain(BSP_CAN_Bus_t Bus, BSP_CAN_Fifo_t Fifo)
+{
+  FDCAN_HandleTypeDef *h = CAN_Ctx[Bus].Handle;
+  CAN_Ring_t *ring = &CAN_Rx[Bus][Fifo];
+  volatile uint32_t *status = (Fifo == CAN_FIFO_HIGH) ? &h->Instance->RXF0S : &h->Instance->RXF1S;
+  volatile uint32_t *ack = (Fifo == CAN_FIFO_HIGH) ? &h->Instance->RXF0A : &h->Instance->RXF1A;
+  uint32_t base = (Fifo == CAN_FIFO_HIGH) ? h->msgRam.RxFIFO0SA : h->msgRam.RxFIFO1SA;
+  const volatile uint32_t *elmt;
+  BSP_CAN_Frame_t *frame;
+  uint32_t s, index, head, w0, w1, words, i, count, route;
+  uint64_t now, timestamp;
+
+  /* Stamps are aged against one reading of the counter */
+  now = BSP_CAN_GetTimeUs();
+  count = h->Instance->TSCV & FDCAN_TSCV_TSC;
+
+  /* RXF0S and RXF1S share the field layout */
+  while (((s = *status) & FDCAN_RXF0S_F0FL_Msk) != 0U)
+  {
+    index = (s & FDCAN_RXF0S_F0GI_Msk) >> FDCAN_RXF0S_F0GI_Pos;
+    elmt = (const volatile uint32_t *)(base + index * CAN_ELMT_BYTES);
+    head = ring->Head;
+    w0 = elmt[0];
+    w1 = elmt[1];
+    timestamp = now - ((count - (w1 & CAN_ELMT_TS_Msk)) & CAN_ELMT_TS_Msk);
+
+    route = CAN_Ctx[Bus].RouteByFilter[((w0 & CAN_ELMT_XTD) != 0U) ? 1U : 0U][(w1 >> CAN_ELMT_FIDX_Pos) & 0x7FU];
+    if (route != 0U)
+    {
+      CAN_Forward(Bus, route - 1U, elmt, w1, timestamp);
+    }
+
+    if ((route != 0U) && (CAN_Ctx[Bus].Routes[route - 1U].Local == 0U))
+    {
+      /* Forwarded only */
+    }
+    else if ((head - ring->Tail) >= CAN_RX_RING_SIZE)
+    {
+      CAN_Ctx[Bus].Stats.RingFull[Fifo]++;
+    }
+    else
+    {
+      frame = &ring->Frames[head % CAN_RX_RING_SIZE];
+      frame->Extended = ((w0 & CAN_ELMT_XTD) != 0U) ? 1U : 0U;
+      frame->Id = (frame->Extended != 0U) ? (w0 & 0x1FFFFFFFU) : ((w0 >> 18) & 0x7FFU);
+      frame->Fifo = (uint8_t)Fifo;
+      frame->Len = CAN_DlcToLen[(w1 >> CAN_ELMT_DLC_Pos) & 0xFU];
+      if (frame->Len > CAN_DATA_BYTES)
+      {
+        frame->Len = CAN_DATA_BYTES;
+      }
+      frame->Filter = (uint8_t)((w1 >> CAN_ELMT_FIDX_Pos) & 0x7FU);
+      frame->Timestamp = timestamp;
+      frame->Flags = (uint8_t)((((w1 & CAN_ELMT_FDF) != 0U) ? CAN_FRAME_FD : 0U) |
+                               (((w1 & CAN_ELMT_BRS) != 0U) ? CAN_FRAME_BRS : 0U));
+
+      /* The message RAM is read by words */
+      words = (frame->Len + 3U) / 4U;
+      for (i = 0; i < words; i++)
+      {
+        ((uint32_t *)frame->Data)[i] = elmt[2U + i];
+      }
+
+      /* The slot is written before it is published */
+      __DMB();
+      ring->Head = head + 1U;
+      CAN_Ctx[Bus].Stats.Rx[Fifo]++;
+    }
+    *ack = index;
+  }
+}
+
+/* Moves every element of the Tx event FIFO into the event ring */
+static ITCM_FUNC void CAN_DrainTxEvents(BSP_CAN_Bus_t Bus)
+{
+  FDCAN_HandleTypeDef *h = CAN_Ctx[Bus].Handle;
+  CAN_EventRing_t *ring = &CAN_TxEvt[Bus];
+  const volatile uint32_t *elmt;
+  BSP_CAN_TxEvent_t *event;
+  BSP_CAN_RouteStats_t *route;
+  uint32_t s, index, head, w0, w1, count, marker;
+  uint64_t now;
+
+  now = BSP_CAN_GetTimeUs();
+  count = h->Instance->TSCV & FDCAN_TSCV_TSC;
+
+  while (((s = h->Instance->TXEFS) & FDCAN_TXEFS_EFFL) != 0U)
+  {
+    index = (s & FDCAN_TXEFS_EFGI) >> FDCAN_TXEFS_EFGI_Pos;
+    elmt = (const volatile uint32_t *)(h->msgRam.TxEventFIFOSA + index * CAN_TX_EVENT_BYTES);
+    head = ring->Head;
+
+    if ((head - ring->Tail) >= CAN_TX_EVENT_RING_SIZE)
+    {
+      CAN_Ctx[Bus].Stats.TxEventLost++;
+    }
+    else
+    {
+      event = &ring->Events[head % CAN_TX_EVENT_RING_SIZE];
+      w0 = elmt[0];
+      w1 = elmt[1];
+      marker = (w1 >> CAN_ELMT_MM_Pos) % CAN_TX_MARKERS;
+      event->Extended = ((w0 & CAN_ELMT_XTD) != 0U) ? 1U : 0U;
+      event->Id = (event->Extended != 0U) ? (w0 & 0x1FFFFFFFU) : ((w0 >> 18) & 0x7FFU);
+      event->Len = CAN_DlcToLen[(w1 >> CAN_ELMT_DLC_Pos) & 0xFU];
+      event->Flags = (uint8_t)((((w1 & CAN_ELMT_FDF) != 0U) ? CAN_FRAME_FD : 0U) |
+                               (((w1 & CAN_ELMT_BRS) != 0U) ? CAN_FRAME_BRS : 0U));
+      event->Timestamp = now - ((count - (w1 & CAN_ELMT_TS_Msk)) & CAN_ELMT_TS_Msk);
+      event->LatencyUs = (uint32_t)(event->Timestamp - CAN_Ctx[Bus].TxQueued[marker]);
+      if (CAN_Ctx[Bus].TxRoute[marker] != 0U)
+      {
+        /* Forwarded by the other bus */
+        route = &CAN_Ctx[(Bus == CAN_BUS_1) ? CAN_BUS_2 : CAN_BUS_1].RouteStats[CAN_Ctx[Bus].TxRoute[marker] - 1U];
+        if (event->LatencyUs > route->LatencyMaxUs)
+        {
+          route->LatencyMaxUs = event->LatencyUs;
+        }
+        route->LatencySumUs += event->LatencyUs;
+        route->Sent++;
+      }
+
+      __DMB();
+      ring->Head = head + 1U;
+      CAN_Ctx[Bus].Stats.TxEvents++;
+    }
+    h->Instance->TXEFA = index;
+  }
+}
+
+/* Copies a routed Rx element into the Tx queue of the other bus, ID rewritten */
+static ITCM_FUNC void CAN_Forward(BSP_CAN_Bus_t Bus, uint32_t Route, const volatile uint32_t *Elmt, uint32_t W1,
+                                  uint64_t Timestamp)
+{
+  const BSP_CAN_Route_t *route = &CAN_Ctx[Bus].Routes[Route];
+  BSP_CAN_RouteStats_t *stats = &CAN_Ctx[Bus].RouteStats[Route];
+  CAN_Ctx_t *dst = &CAN_Ctx[(Bus == CAN_BUS_1) ? CAN_BUS_2 : CAN_BUS_1];
+  FDCAN_GlobalTypeDef *inst = dst->Handle->Instance;
+  volatile uint32_t *tx;
+  uint32_t primask, s, put, marker, t1, words, i;
+
+  if ((route->MinIntervalUs != 0U) && (CAN_Ctx[Bus].RouteLast[Route] != 0U) &&
+      ((Timestamp - CAN_Ctx[Bus].RouteLast[Route]) < route->MinIntervalUs))
+  {
+    stats->RateLimited++;
+    return;
+  }
+  if (((W1 & CAN_ELMT_FDF) != 0U) && (dst->Config.Mode == CAN_MODE_CLASSIC))
+  {
+    stats->Dropped++;
+    return;
+  }
+
+  /* Both lines of the source bus and BSP_CAN_Send() produce into the queue */
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if (((s = inst->TXFQS) & FDCAN_TXFQS_TFQF) != 0U)
+  {
+    stats->Dropped++;
+    dst->Stats.TxFull++;
+  }
+  else
+  {
+    /* The put index counts the dedicated buffers */
+    put = (s & FDCAN_TXFQS_TFQPI) >> FDCAN_TXFQS_TFQPI_Pos;
+    tx = (volatile uint32_t *)(dst->Handle->msgRam.TxBufferSA + put * CAN_ELMT_BYTES);
+    marker = dst->TxMarker & 0xFFU;
+    /* DLC and FD format kept, BRS only if the destination switches */
+    t1 = W1 & ((0xFU << CAN_ELMT_DLC_Pos) | CAN_ELMT_FDF |
+               ((dst->Config.Mode == CAN_MODE_FD_BRS) ? CAN_ELMT_BRS : 0U));
+    tx[0] = (route->TxExtended != 0U) ? (CAN_ELMT_XTD | route->TxId) : (route->TxId << 18);
+    tx[1] = t1 | CAN_ELMT_EFC | (marker << CAN_ELMT_MM_Pos);
+    words = (CAN_DlcToLen[(W1 >> CAN_ELMT_DLC_Pos) & 0xFU] + 3U) / 4U;
+    for (i = 0; i < words; i++)
+    {
+      tx[2U + i] = Elmt[2U + i];
+    }
+    dst->TxQueued[marker % CAN_TX_MARKERS] = Timestamp;
+    dst->TxRoute[marker % CAN_TX_MARKERS] = (uint8_t)(Route + 1U);
+    dst->TxMarker++;
+    dst->Stats.Tx++;
+    inst->TXBAR = 1UL << put;
+    CAN_Ctx[Bus].RouteLast[Route] = Timestamp;
+    stats->Forwarded++;
+  }
+  __set_PRIMASK(primask);
+}
+
+/* One filter element per route, mapped back to the route by its index */
+static int32_t CAN_ConfigRoutes(BSP_CAN_Bus_t Bus)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  const BSP_CAN_Route_t *route;
+  uint32_t i, ext, index;
+
+  memset(CAN_Ctx[Bus].RouteByFilter, 0, sizeof(CAN_Ctx[Bus].RouteByFilter));
+  for (i = 0; (i < CAN_Ctx[Bus].RouteCount) && (ret == BSP_ERROR_NONE); i++)
+  {
+    route = &CAN_Ctx[Bus].Routes[i];
+    ext = (route->Extended != 0U) ? 1U : 0U;
+    index = (ext != 0U) ? CAN_Ctx[Bus].Stats.ExtFilters : CAN_Ctx[Bus].Stats.StdFilters;
+    if ((ret = CAN_AddFilter(Bus, ext, route->Fifo, FDCAN_FILTER_DUAL, route->Id, route->Id)) == BSP_ERROR_NONE)
+    {
+      CAN_Ctx[Bus].RouteByFilter[ext][index] = (uint8_t)(i + 1U);
+    }
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/* Sorted, duplicate-free IDs of one ID type and FIFO, compiled into filter elements */
+static int32_t CAN_ConfigFilters(BSP_CAN_Bus_t Bus, const BSP_CAN_RxId_t *Ids, uint32_t Count)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t ids[CAN_RX_IDS_MAX];
+  uint32_t ext, fifo, n, i, j, k, id, pending, has_pending;
+
+  for (ext = 0; (ext < 2U) && (ret == BSP_ERROR_NONE); ext++)
+  {
+    /* FIFO0 elements first, an ID listed twice goes to the high priority FIFO */
+    for (fifo = 0; (fifo < CAN_FIFO_NBR) && (ret == BSP_ERROR_NONE); fifo++)
+    {
+      n = 0U;
+      for (i = 0; i < Count; i++)
+      {
+        if (((Ids[i].Extended != 0U) ? 1U : 0U) != ext || (Ids[i].Fifo != fifo))
+        {
+          continue;
+        }
+        /* Insertion sort, dropping duplicates */
+        id = Ids[i].Id;
+        for (j = n; (j > 0U) && (ids[j - 1U] > id); j--)
+        {
+        }
+        if ((j > 0U) && (ids[j - 1U] == id))
+        {
+          continue;
+        }
+        for (k = n; k > j; k--)
+        {
+          ids[k] = ids[k - 1U];
+        }
+        ids[j] = id;
+        n++;
+      }
+
+      has_pending = 0U;
+      pending = 0U;
+      for (i = 0; (i < n) && (ret == BSP_ERROR_NONE); i = j + 1U)
+      {
+        for (j = i; ((j + 1U) < n) && (ids[j + 1U] == ids[j] + 1U); j++)
+        {
+        }
+        if ((j - i) >= 2U)
+        {
+          ret = CAN_AddFilter(Bus, ext, fifo, FDCAN_FILTER_RANGE, ids[i], ids[j]);
+          continue;
+        }
+        for (k = i; (k <= j) && (ret == BSP_ERROR_NONE); k++)
+        {
+          if (has_pending != 0U)
+          {
+            ret = CAN_AddFilter(Bus, ext, fifo, FDCAN_FILTER_DUAL, pending, ids[k]);
+            has_pending = 0U;
+          }
+          else
+          {
+            pending = ids[k];
+            has_pending = 1U;
+          }
+        }
+      }
+      if ((has_pending != 0U) && (ret == BSP_ERROR_NONE))
+      {
+        ret = CAN_AddFilter(Bus, ext, fifo, FDCAN_FILTER_DUAL, pending, pending);
+      }
+    }
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+static int32_t CAN_AddFilter(BSP_CAN_Bus_t Bus, uint32_t Extended, uint32_t Fifo, uint32_t Type, uint32_t Id1,
+                             uint32_t Id2)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  BSP_CAN_Stats_t *stats = &CAN_Ctx[Bus].Stats;
+  uint32_t *used = (Extended != 0U) ? &stats->ExtFilters : &stats->StdFilters;
+  FDCAN_FilterTypeDef filter = {0};
+
+  if (*used >= ((Extended != 0U) ? CAN_EXT_FILTERS_NBR : CAN_STD_FILTERS_NBR))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    filter.IdType = (Extended != 0U) ? FDCAN_EXTENDED_ID : FDCAN_STANDARD_ID;
+    filter.FilterIndex = *used;
+    filter.FilterType = Type;
+    filter.FilterConfig = (Fifo == CAN_FIFO_HIGH) ? FDCAN_FILTER_TO_RXFIFO0 : FDCAN_FILTER_TO_RXFIFO1;
+    filter.FilterID1 = Id1;
+    filter.FilterID2 = Id2;
+    if (HAL_FDCAN_ConfigFilter(CAN_Ctx[Bus].Handle, &filter) != HAL_OK)
+    {
+      ret = BSP_ERROR_PERIPH_FAILURE;
+    }
+    else
+    {
+      (*used)++;
+    }
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/* Fills the bit timing and frame format of the handle from the bus configuration */
+static int32_t CAN_ConfigTiming(BSP_CAN_Bus_t Bus)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  FDCAN_HandleTypeDef *h = CAN_Ctx[Bus].Handle;
+  const BSP_CAN_Config_t *config = &CAN_Ctx[Bus].Config;
+  const CAN_Rate_t nominal = {CAN_NOMINAL_BITRATE, CAN_NOMINAL_SAMPLE_POINT};
+  uint32_t clock = HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_FDCAN);
+  CAN_Timing_t nom, data;
+
+  if (CAN_Timing(clock, &nominal, CAN_NOM_PRESC_MAX, CAN_NOM_SEG1_MAX, CAN_NOM_SEG2_MAX, &nom) != BSP_ERROR_NONE)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if (config->Mode != CAN_MODE_FD_BRS)
+  {
+    /* Data phase unused, smallest valid values */
+    data = (CAN_Timing_t){1U, 1U, 1U};
+  }
+  else if ((CAN_Timing(clock, &CAN_DataRates[config->DataRate], CAN_DATA_PRESC_MAX, CAN_DATA_SEG1_MAX,
+                       CAN_DATA_SEG2_MAX, &data) != BSP_ERROR_NONE) ||
+           ((data.Prescaler * (data.Seg1 + 1U)) > CAN_TDC_OFFSET_MAX))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    h->Init.FrameFormat = (config->Mode == CAN_MODE_CLASSIC) ? FDCAN_FRAME_CLASSIC
+                          : (config->Mode == CAN_MODE_FD)    ? FDCAN_FRAME_FD_NO_BRS
+                                                             : FDCAN_FRAME_FD_BRS;
+    h->Init.NominalPrescaler = nom.Prescaler;
+    h->Init.NominalTimeSeg1 = nom.Seg1;
+    h->Init.NominalTimeSeg2 = nom.Seg2;
+    h->Init.NominalSyncJumpWidth = nom.Seg2;
+    h->Init.DataPrescaler = data.Prescaler;
+    h->Init.DataTimeSeg1 = data.Seg1;
+    h->Init.DataTimeSeg2 = data.Seg2;
+    h->Init.DataSyncJumpWidth = data.Seg2;
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/* Smallest prescaler dividing the clock into a whole number of quanta per bit that fits the segment limits */
+static int32_t CAN_Timing(uint32_t Clock, const CAN_Rate_t *Rate, uint32_t PrescMax, uint32_t Seg1Max,
+                          uint32_t Seg2Max, CAN_Timing_t *Timing)
+{
+  uint32_t presc, tq, seg1, seg2;
+
+  for (presc = 1U; presc <= PrescMax; presc++)
+  {
+    if ((Clock % (presc * Rate->Rate)) != 0U)
+    {
+      continue;
+    }
+    tq = Clock / (presc * Rate->Rate);
+    if (tq < 4U)
+    {
+      break;
+    }
+    /* The sync segment is one quantum, the sample point ends phase 1 */
+    seg1 = (tq * Rate->SamplePoint + 500U) / 1000U - 1U;
+    seg2 = tq - 1U - seg1;
+    if ((seg1 >= 1U) && (seg1 <= Seg1Max) && (seg2 >= 1U) && (seg2 <= Seg2Max))
+    {
+      Timing->Prescaler = presc;
+      Timing->Seg1 = seg1;
+      Timing->Seg2 = seg2;
+      return BSP_ERROR_NONE;
+    }
+  }
+  return BSP_ERROR_WRONG_PARAM;
+}
+
+/* Builds the Tx header of a frame, Data receives the padded payload when the length is not a DLC length */
+static int32_t CAN_TxPrepare(BSP_CAN_Bus_t Bus, const BSP_CAN_Frame_t *Frame, FDCAN_TxHeaderTypeDef *Header,
+                             uint32_t *Data, uint8_t **Payload)
+{
+  uint32_t dlc, fd;
+
+  if ((Bus >= CAN_BUS_NBR) || (Frame == NULL) || (Frame->Len > CAN_DATA_BYTES))
+  {
+    return BSP_ERROR_WRONG_PARAM;
+  }
+  fd = ((Frame->Len > 8U) || ((Frame->Flags & CAN_FRAME_FD) != 0U)) ? 1U : 0U;
+  if ((fd != 0U) && (CAN_Ctx[Bus].Config.Mode == CAN_MODE_CLASSIC))
+  {
+    return BSP_ERROR_WRONG_PARAM;
+  }
+
+  for (dlc = 0U; CAN_DlcToLen[dlc] < Frame->Len; dlc++)
+  {
+  }
+  *Payload = (uint8_t *)Frame->Data;
+  if (CAN_DlcToLen[dlc] != Frame->Len)
+  {
+    memcpy(Data, Frame->Data, Frame->Len);
+    memset((uint8_t *)Data + Frame->Len, 0, CAN_DlcToLen[dlc] - Frame->Len);
+    *Payload = (uint8_t *)Data;
+  }
+
+  *Header = (FDCAN_TxHeaderTypeDef){0};
+  Header->Identifier = Frame->Id;
+  Header->IdType = (Frame->Extended != 0U) ? FDCAN_EXTENDED_ID : FDCAN_STANDARD_ID;
+  Header->TxFrameType = FDCAN_DATA_FRAME;
+  Header->DataLength = CAN_TxDlc[dlc];
+  Header->ErrorStateIndicator = FDCAN_ESI_ACTIVE;
+  Header->BitRateSwitch =
+      ((fd != 0U) && (CAN_Ctx[Bus].Config.Mode == CAN_MODE_FD_BRS)) ? FDCAN_BRS_ON : FDCAN_BRS_OFF;
+  Header->FDFormat = (fd != 0U) ? FDCAN_FD_CAN : FDCAN_CLASSIC_CAN;
+  Header->TxEventFifoControl = FDCAN_STORE_TX_EVENTS;
+  Header->MessageMarker = CAN_Ctx[Bus].TxMarker & 0xFFU;
+  /* Written before the frame is queued, its Tx event may come right after */
+  CAN_Ctx[Bus].TxQueued[Header->MessageMarker % CAN_TX_MARKERS] = BSP_CAN_GetTimeUs();
+  CAN_Ctx[Bus].TxRoute[Header->MessageMarker % CAN_TX_MARKERS] = 0U;
+  return BSP_ERROR_NONE;
+}
@@ -0,0 +1,204 @@
+#ifndef CAN_H
+#define CAN_H
+
+#include "errno.h"
+#include "fdcan.h"
+
+/* Message RAM (2560 words) split in two equal halves, FDCAN1 first. Sizes
+ * are per instance. */
+#define CAN_MSGRAM_WORDS 1280U
+#define CAN_STD_FILTERS_NBR 32U
+#define CAN_EXT_FILTERS_NBR 8U
+#define CAN_RX_FIFO0_ELMTS_NBR 24U /* High priority IDs */
+#define CAN_RX_FIFO1_ELMTS_NBR 12U /* Everything else */
+#define CAN_TX_BUFFERS_NBR 4U      /* Dedicated, one per top priority ID */
+#define CAN_TX_QUEUE_ELMTS_NBR 12U /* Shared, sent lowest ID first */
+#define CAN_TX_EVENTS_NBR 16U      /* Tx event FIFO */
+
+/* Payload of the RX/TX elements, sized for CAN FD */
+#define CAN_DATA_BYTES 64U
+
+/* Arbitration phase, shared by every mode */
+#define CAN_NOMINAL_BITRATE 1000000U
+#define CAN_NOMINAL_SAMPLE_POINT 800U /* Per mille */
+
+/* The timestamp counter runs in nominal bit times, CAN_TS_PRESC of them
+ * make a microsecond */
+#define CAN_TS_PRESC (CAN_NOMINAL_BITRATE / 1000000U)
+
+/* Bus configuration applied by BSP_CAN_Init(), BSP_CAN_SetConfig()
+ * overrides it at run time */
+#ifndef CAN_BUS1_MODE
+#define CAN_BUS1_MODE CAN_MODE_FD_BRS
+#endif
+#ifndef CAN_BUS1_DATA_RATE
+#define CAN_BUS1_DATA_RATE CAN_DATA_2M
+#endif
+#ifndef CAN_BUS2_MODE
+#define CAN_BUS2_MODE CAN_MODE_FD_BRS
+#endif
+#ifndef CAN_BUS2_DATA_RATE
+#define CAN_BUS2_DATA_RATE CAN_DATA_5M
+#endif
+
+/* Frames buffered per bus and FIFO between the interrupt and the reader,
+ * a power of two */
+#ifndef CAN_RX_RING_SIZE
+#define CAN_RX_RING_SIZE 64U
+#endif
+
+/* Tx events buffered per bus between the interrupt and the reader, a
+ * power of two */
+#ifndef CAN_TX_EVENT_RING_SIZE
+#define CAN_TX_EVENT_RING_SIZE 32U
+#endif
+
+/* Largest ID list given to BSP_CAN_Init() */
+#define CAN_RX_IDS_MAX 128U
+
+/* Gateway routes per source bus, each takes one filter element */
+#define CAN_ROUTES_MAX 8U
+
+/* NVIC priorities of the FIFO0 (line 0) and FIFO1 (line 1) interrupts */
+#define CAN_IRQ_PRIO_HIGH 2U
+#define CAN_IRQ_PRIO_LOW 6U
+
+typedef enum
+{
+  CAN_BUS_1 = 0, /* hfdcan1 */
+  CAN_BUS_2,     /* hfdcan2 */
+  CAN_BUS_NBR
+} BSP_CAN_Bus_t;
+
+typedef enum
+{
+  CAN_FIFO_HIGH = 0, /* Rx FIFO 0, interrupt line 0 */
+  CAN_FIFO_LOW,      /* Rx FIFO 1, interrupt line 1 */
+  CAN_FIFO_NBR
+} BSP_CAN_Fifo_t;
+
+typedef enum
+{
+  CAN_MODE_CLASSIC = 0, /* ISO 11898-1 classic frames only, 8 bytes */
+  CAN_MODE_FD,          /* FD frames up to 64 bytes at the nominal rate */
+  CAN_MODE_FD_BRS       /* FD frames, data phase at the data rate */
+} BSP_CAN_Mode_t;
+
+/* Data phase presets, the sample point gets earlier as the bit gets
+ * shorter to leave room for the transceiver loop delay */
+typedef enum
+{
+  CAN_DATA_2M = 0, /* 75 % */
+  CAN_DATA_4M,     /* 75 % */
+  CAN_DATA_5M,     /* 75 % */
+  CAN_DATA_8M,     /* 70 %, short stubs only */
+  CAN_DATA_NBR
+} BSP_CAN_DataRate_t;
+
+typedef struct
+{
+  BSP_CAN_Mode_t Mode;
+  BSP_CAN_DataRate_t DataRate; /* Ignored unless Mode is CAN_MODE_FD_BRS */
+} BSP_CAN_Config_t;
+
+/* BSP_CAN_Frame_t.Flags */
+#define CAN_FRAME_FD 0x01U  /* FD format */
+#define CAN_FRAME_BRS 0x02U /* Data phase at the data rate */
+
+/* An ID the application consumes, turned into acceptance filters */
+typedef struct
+{
+  uint32_t Id;
+  uint8_t Extended;
+  uint8_t Fifo; /* BSP_CAN_Fifo_t */
+} BSP_CAN_RxId_t;
+
+typedef struct
+{
+  uint64_t Timestamp; /* Start of frame, BSP_CAN_GetTimeUs() timebase */
+  uint32_t Id;
+  uint8_t Extended;
+  uint8_t Fifo;
+  uint8_t Len;    /* Bytes, from the DLC */
+  uint8_t Filter; /* Index of the matching filter element */
+  uint8_t Flags;  /* CAN_FRAME_x */
+  uint8_t Data[CAN_DATA_BYTES] __attribute__((aligned(4)));
+} BSP_CAN_Frame_t;
+
+/* A frame that left the controller */
+typedef struct
+{
+  uint64_t Timestamp; /* Start of frame, BSP_CAN_GetTimeUs() timebase */
+  uint32_t LatencyUs; /* From BSP_CAN_Send() or BSP_CAN_SendBuffer() to the start of frame */
+  uint32_t Id;
+  uint8_t Extended;
+  uint8_t Len;
+  uint8_t Flags; /* CAN_FRAME_x */
+} BSP_CAN_TxEvent_t;
+
+/* A gateway route: frames of Id received on a bus are forwarded to the
+ * other bus from the interrupt */
+typedef struct
+{
+  uint32_t Id;            /* On the source bus */
+  uint32_t TxId;          /* On the destination bus, Id to forward unchanged */
+  uint32_t MinIntervalUs; /* Frames closer than this to the last forwarded one are dropped, 0 for no limit */
+  uint8_t Extended;
+  uint8_t TxExtended;
+  uint8_t Fifo;  /* BSP_CAN_Fifo_t, the interrupt line that forwards */
+  uint8_t Local; /* Also delivered to BSP_CAN_Read() */
+} BSP_CAN_Route_t;
+
+typedef struct
+{
+  uint32_t Forwarded;    /* Queued on the destination bus */
+  uint32_t Sent;         /* Started on the destination bus, from the Tx events */
+  uint32_t RateLimited;  /* Dropped by MinIntervalUs */
+  uint32_t Dropped;      /* Destination Tx queue full, or FD frame to a classic bus */
+  uint32_t LatencyMaxUs; /* Start of frame on the source bus to start of frame on the destination */
+  uint64_t LatencySumUs; /* Of the Sent frames */
+} BSP_CAN_RouteStats_t;
+
+typedef struct
+{
+  uint32_t Rx[CAN_FIFO_NBR];       /* Frames moved into the ring */
+  uint32_t FifoLost[CAN_FIFO_NBR]; /* Message RAM FIFO full, frame dropped by the controller */
+  uint32_t RingFull[CAN_FIFO_NBR]; /* Ring full, frame dropped by the interrupt */
+  uint32_t StdFilters;             /* Filter elements in use */
+  uint32_t ExtFilters;
+  uint32_t Tx;                     /* Frames handed to the controller */
+  uint32_t TxFull;                 /* Tx queue full, frame refused */
+  uint32_t TxPending;              /* Dedicated buffer still pending, frame refused */
+  uint32_t TxEvents;               /* Tx events moved into the ring */
+  uint32_t TxEventLost;            /* Tx event FIFO or ring full, event dropped */
+  uint32_t BusOff;                 /* Bus-off events, each followed by a recovery */
+} BSP_CAN_Stats_t;
+
+/* Fault confinement state, from FDCAN_ECR and FDCAN_PSR */
+typedef struct
+{
+  uint8_t Tec;           /* Transmit error counter */
+  uint8_t Rec;           /* Receive error counter, 128 and above reads 127 with Passive set */
+  uint8_t Passive;       /* Error passive */
+  uint8_t BusOff;        /* Bus-off, recovering */
+  uint8_t LastError;     /* Last error code of the arbitration phase, 7 when unchanged */
+  uint8_t DataLastError; /* Last error code of the data phase */
+  uint32_t Errors;       /* Protocol errors since BSP_CAN_Init(), FDCAN_ECR.CEL accumulated */
+} BSP_CAN_Errors_t;
+
+int32_t BSP_CAN_SetConfig(BSP_CAN_Bus_t Bus, const BSP_CAN_Config_t *Config);
+int32_t BSP_CAN_SetRoutes(BSP_CAN_Bus_t Bus, const BSP_CAN_Route_t *Routes, uint32_t Count);
+int32_t BSP_CAN_Init(BSP_CAN_Bus_t Bus, const BSP_CAN_RxId_t *Ids, uint32_t Count);
+int32_t BSP_CAN_Start(BSP_CAN_Bus_t Bus);
+int32_t BSP_CAN_Send(BSP_CAN_Bus_t Bus, const BSP_CAN_Frame_t *Frame);
+int32_t BSP_CAN_SendBuffer(BSP_CAN_Bus_t Bus, uint32_t Buffer, const BSP_CAN_Frame_t *Frame);
+uint32_t BSP_CAN_Read(BSP_CAN_Bus_t Bus, BSP_CAN_Frame_t *Frames, uint32_t Max);
+uint32_t BSP_CAN_ReadTxEvents(BSP_CAN_Bus_t Bus, BSP_CAN_TxEvent_t *Events, uint32_t Max);
+uint64_t BSP_CAN_GetTimeUs(void);
+uint32_t BSP_CAN_GetDataBitrate(BSP_CAN_Bus_t Bus);
+void BSP_CAN_GetErrors(BSP_CAN_Bus_t Bus, BSP_CAN_Errors_t *Errors);
+void BSP_CAN_GetStats(BSP_CAN_Bus_t Bus, BSP_CAN_Stats_t *Stats);
+void BSP_CAN_GetRouteStats(BSP_CAN_Bus_t Bus, uint32_t Route, BSP_CAN_RouteStats_t *Stats);
+void BSP_CAN_IRQHandler(BSP_CAN_Bus_t Bus, uint32_t Line);
+
+#endif /* CAN_H */
@@ -0,0 +1,18 @@
+#ifndef ERRNO_H
+#define ERRNO_H
+
+/* Common Error codes */
+#define BSP_ERROR_NONE                    0
+#define BSP_ERROR_NO_INIT                -1
+#define BSP_ERROR_WRONG_PARAM            -2
+#define BSP_ERROR_BUSY                   -3
+#define BSP_ERROR_PERIPH_FAILURE         -4
+#define BSP_ERROR_COMPONENT_FAILURE      -5
+#define BSP_ERROR_UNKNOWN_FAILURE        -6
+#define BSP_ERROR_UNKNOWN_COMPONENT      -7
+#define BSP_ERROR_BUS_FAILURE            -8
+#define BSP_ERROR_CLOCK_FAILURE          -9
+#define BSP_ERROR_MSP_FAILURE            -10
+#define BSP_ERROR_FEATURE_NOT_SUPPORTED  -11
+
+#endif /* ERRNO_H */
@@ -0,0 +1,31 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "main.h"
+
+/* Free SDRAM past both LTDC layers, used as scratch by the benchmarks */
+#define BENCH_SDRAM_SCRATCH_ADDR 0xD0400000U
+#define BENCH_SDRAM_SCRATCH_SIZE 0x00400000U
+
+void BENCH_Init(void);
+uint32_t BENCH_CyclesToUs(uint32_t Cycles);
+void BENCH_PrintThroughput(const char *Name, uint32_t Bytes, uint32_t Cycles);
+
+void BENCH_QSPI_Run(void);
+void BENCH_ASSET_Run(uint32_t PackAddr);
+void BENCH_TCM_Run(void);
+void BENCH_MEM_Run(void);
+void BENCH_MDMA_Run(void);
+void BENCH_MEMATTR_Run(void);
+void BENCH_IPC_Run(void);
+void BENCH_TLOG_Run(void);
+
+/**
+ * @brief  Current value of the DWT cycle counter, BENCH_Init() must run first.
+ */
+static inline uint32_t BENCH_Cycles(void)
+{
+  return DWT->CYCCNT;
+}
+
+#endif /* BENCH_H */
@@ -73,8 +73,6 @@ void Error_Handler(void);
 #define PWM_RAD_FAN_GPIO_Port GPIOC
 #define PWM_PUMP_Pin GPIO_PIN_9
 #define PWM_PUMP_GPIO_Port GPIOC
-#define TO_MCU_BP_SPEED_Pin GPIO_PIN_8
-#define TO_MCU_BP_SPEED_GPIO_Port GPIOA
 #define PWM_BP_FAN_Pin GPIO_PIN_7
 #define PWM_BP_FAN_GPIO_Port GPIOC
 #define BUTTON_RTD_Pin GPIO_PIN_13
@@ -86,26 +84,10 @@ void Error_Handler(void);
 #define OSC_IN_GPIO_Port GPIOH
 #define LCD_BL_CTRL_Pin GPIO_PIN_0
 #define LCD_BL_CTRL_GPIO_Port GPIOK
-#define NTC_1_Pin GPIO_PIN_0
-#define NTC_1_GPIO_Port GPIOC
-#define NTC_2_Pin GPIO_PIN_1
-#define NTC_2_GPIO_Port GPIOC
-#define TO_MCU_RAD_SPEED_Pin GPIO_PIN_0
-#define TO_MCU_RAD_SPEED_GPIO_Port GPIOA
 #define VCP_TX_Pin GPIO_PIN_10
 #define VCP_TX_GPIO_Port GPIOB
 #define VCP_RX_Pin GPIO_PIN_11
 #define VCP_RX_GPIO_Port GPIOB
-#define VOLTAGE_SENSE_3V3_Pin GPIO_PIN_6
-#define VOLTAGE_SENSE_3V3_GPIO_Port GPIOA
-#define MANETTINO_1_Pin GPIO_PIN_0
-#define MANETTINO_1_GPIO_Port GPIOA
-#define MANETTINO_2_Pin GPIO_PIN_1
-#define MANETTINO_2_GPIO_Port GPIOA
-#define VOLTAGE_SENS_5V_Pin GPIO_PIN_4
-#define VOLTAGE_SENS_5V_GPIO_Port GPIOC
-#define VOLTAGE_SENSE_24V_Pin GPIO_PIN_1
-#define VOLTAGE_SENSE_24V_GPIO_Port GPIOB
 #define LED_BMS_Pin GPIO_PIN_2
 #define LED_BMS_GPIO_Port GPIOJ
 #define LCD_RESET_Pin GPIO_PIN_12
@@ -0,0 +1,40 @@
+#ifndef MEM_SECTIONS_H
+#define MEM_SECTIONS_H
+
+/*
+ * Placement in the tightly coupled memories and the D2 SRAM, see
+ * STM32H745XIHX_FLASH.ld. The startup code copies the initialized sections
+ * and zeroes the others before main().
+ */
+
+/* Code run from the zero-wait-state ITCM (64K). Calls between the flash and
+ * the ITCM go through long-branch veneers added by the linker. */
+#define ITCM_FUNC __attribute__((section(".itcm_text"), noinline))
+
+/* Data in the zero-wait-state DTCM (128K, shared with the stack). Reachable
+ * by the CPU and the MDMA only, not by DMA1/DMA2/DMA2D. */
+#define DTCM_DATA __attribute__((section(".dtcm_data")))
+#define DTCM_BSS __attribute__((section(".dtcm_bss")))
+
+/* DMA buffers in the D2 SRAM2 (128K), reachable by every DMA master. Cache
+ * line aligned so that cache maintenance never touches a neighbour. */
+#define D2_DATA __attribute__((section(".d2_data"), aligned(32)))
+#define D2_BSS __attribute__((section(".d2_bss"), aligned(32)))
+
+/* Rarely executed code and its constants, executed in place from the
+ * memory-mapped QSPI flash when built with XIP_COLD_CODE (CMake option of
+ * the same name), in the internal flash otherwise. Such code must not run
+ * while the flash is out of memory-mapped mode: the QSPI arbiter keeps its
+ * write windows inside BSP_QSPI_ArbProcess() in that build. Neither the
+ * arbiter callers nor the benches that drive the QSPI in indirect mode can
+ * be tagged, and the timed kernels of a tagged bench stay noinline in the
+ * internal flash. */
+#ifdef XIP_COLD_CODE
+#define XIP_FUNC __attribute__((section(".qspi_text"), noinline))
+#define XIP_RODATA __attribute__((section(".qspi_rodata")))
+#else
+#define XIP_FUNC
+#define XIP_RODATA
+#endif
+
+#endif /* MEM_SECTIONS_H */
@@ -59,6 +59,7 @@ void EXTI2_IRQHandler(void);
 void QUADSPI_IRQHandler(void);
 void MDMA_IRQHandler(void);
 /* USER CODE BEGIN EFP */
+void HSEM1_IRQHandler(void);
 
 /* USER CODE END EFP */
 
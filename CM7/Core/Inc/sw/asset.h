@@ -0,0 +1,88 @@
+#ifndef ASSET_H
+#define ASSET_H
+
+#include <stdint.h>
+
+#include "driver/errno.h"
+
+/* Asset pack, built on the host by tools/assetpack and written to the QSPI
+ * flash at ASSET_QSPI_BASE (upper half of the 16 MB code/asset area). */
+#define ASSET_QSPI_BASE 0x00800000U
+
+#define ASSET_MAGIC 0x4B504153U /* "SAPK" */
+#define ASSET_VERSION 1U
+#define ASSET_NAME_MAX 24U
+
+/* LZ4 assets are cut in independent blocks of ASSET_BLOCK_SIZE bytes, which
+ * is also the granule of the streaming decoder */
+#define ASSET_BLOCK_SIZE 0x4000U
+#define ASSET_BLOCK_STORED 0x80000000U /* Block kept raw, LZ4 did not shrink it */
+#define ASSET_MAX_BLOCKS 256U
+
+/* Largest number of entries loaded from the pack */
+#ifndef ASSET_MAX_ENTRIES
+#define ASSET_MAX_ENTRIES 64U
+#endif
+
+/* SDRAM image cache, past the benchmark scratch area */
+#ifndef ASSET_CACHE_ADDR
+#define ASSET_CACHE_ADDR 0xD0800000U
+#endif
+#ifndef ASSET_CACHE_SIZE
+#define ASSET_CACHE_SIZE 0x00800000U
+#endif
+
+typedef enum
+{
+  ASSET_TYPE_BLOB = 0,
+  ASSET_TYPE_IMAGE,
+  ASSET_TYPE_FONT
+} ASSET_Type_t;
+
+typedef enum
+{
+  ASSET_CODEC_RAW = 0,
+  ASSET_CODEC_LZ4 /* Table of ASSET_BLOCK_SIZE block sizes, then the blocks */
+} ASSET_Codec_t;
+
+typedef struct
+{
+  uint32_t Magic;
+  uint16_t Version;
+  uint16_t Count; /* Entries following the header */
+  uint32_t Size;  /* Size of the whole pack */
+  uint32_t Reserved;
+} ASSET_PackHeader_t;
+
+typedef struct
+{
+  char Name[ASSET_NAME_MAX];
+  uint32_t Offset;     /* From the start of the pack */
+  uint32_t RawSize;    /* Size once decoded */
+  uint32_t PackedSize; /* Size in the pack, block table included */
+  uint16_t Type;
+  uint16_t Codec;
+  uint16_t Width; /* Images only, pixels are ARGB8888 */
+  uint16_t Height;
+  uint32_t Reserved;
+} ASSET_Entry_t;
+
+typedef struct
+{
+  uint32_t Loads;       /* Assets decoded into the cache */
+  uint32_t Hits;        /* ASSET_Load() calls served from the cache */
+  uint32_t RawBytes;    /* Bytes decoded */
+  uint32_t PackedBytes; /* Bytes read from the flash */
+  uint32_t CacheUsed;
+} ASSET_Stats_t;
+
+int32_t ASSET_Init(uint32_t PackAddr);
+uint32_t ASSET_GetCount(void);
+const ASSET_Entry_t *ASSET_GetEntry(uint32_t Index);
+int32_t ASSET_Find(const char *Name, const ASSET_Entry_t **Entry);
+int32_t ASSET_Decode(const ASSET_Entry_t *Entry, uint8_t *pDst);
+int32_t ASSET_Load(const char *Name, const uint8_t **pData, const ASSET_Entry_t **Entry);
+void ASSET_CacheReset(void);
+void ASSET_GetStats(ASSET_Stats_t *Stats);
+
+#endif /* ASSET_H */
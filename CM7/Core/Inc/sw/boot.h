@@ -0,0 +1,50 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+
+/* Largest number of boot phases recorded */
+#ifndef BOOT_MAX_PHASES
+#define BOOT_MAX_PHASES 24U
+#endif
+
+/* Backup SRAM word telling that the SDRAM was initialised and refreshed up
+ * to the reset */
+#define BOOT_WARM_MAGIC 0x5741524DU /* "WARM" */
+
+/* Independent watchdog (IWDG1) period, up to 4095 ms. Started by
+ * BOOT_Ready(), its reset boots warm. */
+#ifndef BOOT_WATCHDOG_MS
+#define BOOT_WATCHDOG_MS 500U
+#endif
+
+typedef enum
+{
+  BOOT_MODE_COLD = 0, /* Power-on, brown-out, pin reset or no valid record */
+  BOOT_MODE_WARM      /* Watchdog or software reset after a completed boot */
+} BOOT_Mode_t;
+
+typedef struct
+{
+  const char *Name;
+  uint32_t Us;  /* Duration of the phase */
+  uint32_t End; /* Time since BOOT_Init(), in us */
+} BOOT_Phase_t;
+
+void BOOT_Init(void);
+void BOOT_Mark(const char *Name);
+uint32_t BOOT_GetUs(void);
+uint32_t BOOT_GetCount(void);
+const BOOT_Phase_t *BOOT_GetPhase(uint32_t Index);
+void BOOT_Report(void);
+
+BOOT_Mode_t BOOT_Start(void);
+BOOT_Mode_t BOOT_GetMode(void);
+uint32_t BOOT_GetResetFlags(void);
+uint32_t BOOT_GetFramebuffer(void);
+void BOOT_Ready(uint32_t Framebuffer);
+uint32_t BOOT_IsReady(void);
+void BOOT_WatchdogRefresh(void);
+void BOOT_WarmReset(void);
+
+#endif /* BOOT_H */
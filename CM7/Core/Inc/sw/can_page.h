@@ -0,0 +1,11 @@
+#ifndef CAN_PAGE_H
+#define CAN_PAGE_H
+
+#include "lvgl/lvgl.h"
+
+/* Refresh period of the page, VSTATE_PERIOD_MS or longer */
+#define CAN_PAGE_REFRESH_MS 500U
+
+lv_obj_t *CAN_PAGE_Create(lv_obj_t *Parent);
+
+#endif /* CAN_PAGE_H */
@@ -0,0 +1,14 @@
+#ifndef LEDS_H
+#define LEDS_H
+
+#include <stdint.h>
+
+#include "driver/errno.h"
+
+/* Blink period of LED_RTD while the ready-to-drive state is unknown */
+#define LEDS_BLINK_MS 500U
+
+int32_t LEDS_Init(void);
+void LEDS_Process(void);
+
+#endif /* LEDS_H */
@@ -0,0 +1,9 @@
+#ifndef LVGL_PORT_GESTURE_H
+#define LVGL_PORT_GESTURE_H
+
+#include <stdint.h>
+
+void TS_Gesture_Init(void);
+uint32_t TS_Gesture_GetEvent(void);
+
+#endif /* LVGL_PORT_GESTURE_H */
@@ -0,0 +1,13 @@
+#ifndef LZ4_H
+#define LZ4_H
+
+#include <stdint.h>
+
+#include "driver/errno.h"
+
+/* Worst case size of an LZ4 block holding Size bytes */
+#define LZ4_COMPRESS_BOUND(Size) ((Size) + ((Size) / 255U) + 16U)
+
+int32_t LZ4_DecompressBlock(const uint8_t *pSrc, uint32_t SrcSize, uint8_t *pDst, uint32_t DstCapacity);
+
+#endif /* LZ4_H */
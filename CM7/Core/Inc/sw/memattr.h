@@ -0,0 +1,60 @@
+#ifndef MEMATTR_H
+#define MEMATTR_H
+
+#include <stdint.h>
+
+#include "driver/errno.h"
+
+/* SDRAM bank 2. Everything not listed below (asset cache, benchmark
+ * scratch, free space) is heap class. */
+#define MEMATTR_SDRAM_BASE 0xD0000000U
+#define MEMATTR_SDRAM_SIZE 0x02000000U
+
+/* Both LTDC layers and the LVGL draw buffers */
+#define MEMATTR_FB_BASE 0xD0000000U
+#define MEMATTR_FB_SIZE 0x00400000U
+
+/* Inter-core mailboxes, D2 SRAM3. The second half, the inter-core rings
+ * (ipc.h), is pinned non-cacheable on top of it. */
+#define MEMATTR_SHARED_BASE 0x30040000U
+#define MEMATTR_SHARED_SIZE 0x00008000U
+
+#ifndef MEMATTR_BOOT_PROFILE
+#define MEMATTR_BOOT_PROFILE MEMATTR_PROFILE_FB_WT
+#endif
+
+typedef enum
+{
+  MEMATTR_POLICY_WRITE_BACK = 0, /* Read/write allocate, needs a clean before a DMA reads */
+  MEMATTR_POLICY_WRITE_THROUGH,  /* Memory always up to date, reads still cached */
+  MEMATTR_POLICY_NON_CACHEABLE,
+  MEMATTR_POLICY_COUNT
+} MEMATTR_Policy_t;
+
+typedef enum
+{
+  MEMATTR_CLASS_FRAMEBUFFER = 0, /* Written by the CPU, read by the DMA2D/LTDC */
+  MEMATTR_CLASS_HEAP,            /* CPU working memory, image cache */
+  MEMATTR_CLASS_SHARED,          /* Shared with the CM4, shareable when non-cacheable */
+  MEMATTR_CLASS_IPC,             /* Inter-core rings, both cores write lines of it: non-cacheable in every profile */
+  MEMATTR_CLASS_COUNT
+} MEMATTR_Class_t;
+
+typedef enum
+{
+  MEMATTR_PROFILE_CUBEMX = 0, /* MPU_Config(): SDRAM write-through, SRAM3 default map */
+  MEMATTR_PROFILE_FB_WT,      /* Framebuffers write-through, heap write-back */
+  MEMATTR_PROFILE_FB_NC,      /* Framebuffers non-cacheable, heap write-back */
+  MEMATTR_PROFILE_ALL_WB,     /* Framebuffers and heap write-back, cleaned by range */
+  MEMATTR_PROFILE_COUNT
+} MEMATTR_Profile_t;
+
+int32_t MEMATTR_SetProfile(MEMATTR_Profile_t Profile);
+MEMATTR_Profile_t MEMATTR_GetProfile(void);
+const char *MEMATTR_GetProfileName(MEMATTR_Profile_t Profile);
+MEMATTR_Policy_t MEMATTR_GetPolicy(MEMATTR_Class_t Class);
+MEMATTR_Policy_t MEMATTR_GetAddrPolicy(uint32_t Addr);
+void MEMATTR_CleanRange(const void *Addr, uint32_t Size);
+void MEMATTR_InvalidateRange(void *Addr, uint32_t Size);
+
+#endif /* MEMATTR_H */
@@ -0,0 +1,20 @@
+#ifndef SPLASH_H
+#define SPLASH_H
+
+#include <stdint.h>
+
+#include "driver/errno.h"
+
+/* Image of the asset pack shown at power-on */
+#ifndef SPLASH_ASSET_NAME
+#define SPLASH_ASSET_NAME "splash"
+#endif
+
+#ifndef SPLASH_BRIGHTNESS
+#define SPLASH_BRIGHTNESS 100U
+#endif
+
+int32_t SPLASH_Show(const char *Name, uint32_t Brightness);
+int32_t SPLASH_Resume(uint32_t Framebuffer, uint32_t Brightness);
+
+#endif /* SPLASH_H */
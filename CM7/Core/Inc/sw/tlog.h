@@ -0,0 +1,117 @@
+#ifndef TLOG_H
+#define TLOG_H
+
+#include <stdint.h>
+
+#include "driver/errno.h"
+
+/* Geometry of the log store, in bytes. A sector is the erase unit (the 128K
+ * dual-die block of the MT25TL01G), a page the program unit. */
+#define TLOG_PAGE_SIZE 256U
+#define TLOG_SECTOR_SIZE 0x20000U
+#define TLOG_PAGES_PER_SECTOR (TLOG_SECTOR_SIZE / TLOG_PAGE_SIZE)
+
+/* Upper bound of the sector index kept in RAM (8 bytes per sector) */
+#ifndef TLOG_MAX_SECTORS
+#define TLOG_MAX_SECTORS 1024U
+#endif
+
+/* Number of full pages that can wait in RAM while the flash is busy. A
+ * sector erase blocks programming for ~150 ms, the staging ring has to
+ * absorb the log rate for that long (32 KB covers ~200 KB/s) */
+#ifndef TLOG_STAGE_PAGES
+#define TLOG_STAGE_PAGES 128U
+#endif
+
+/* Sectors kept erased ahead of the write head by TLOG_Process() */
+#ifndef TLOG_PREERASE_SECTORS
+#define TLOG_PREERASE_SECTORS 2U
+#endif
+
+/* Largest payload of a single record */
+#define TLOG_RECORD_MAX_DATA (TLOG_PAGE_SIZE - sizeof(TLOG_PageHeader_t) - sizeof(TLOG_RecordHeader_t))
+
+/* Returned by TLOG_ReadNext() once the cursor reached the write head */
+#define TLOG_EOF 1
+
+/**
+ * Flash backend. Addresses are offsets inside the log area, which starts on
+ * a sector boundary. Write and EraseSector may only start the operation:
+ * completion is polled through IsBusy, so the flash never stalls the caller.
+ * A backend that queues operations and runs them in order may report idle
+ * as long as its queue can take one more.
+ * A backend that can suspend a program/erase to serve a read sets
+ * ReadWhileBusy, otherwise reads wait for the flash to be idle.
+ */
+typedef struct
+{
+  int32_t (*Read)(uint8_t *pData, uint32_t Addr, uint32_t Size);
+  int32_t (*Write)(uint8_t *pData, uint32_t Addr, uint32_t Size);
+  int32_t (*EraseSector)(uint32_t Addr);
+  int32_t (*IsBusy)(void); /* BSP_ERROR_BUSY while no program/erase can start */
+  uint32_t Size;           /* Size of the log area, multiple of TLOG_SECTOR_SIZE */
+  uint32_t ReadWhileBusy;
+} TLOG_Flash_t;
+
+typedef struct
+{
+  uint32_t Magic;
+  uint32_t Seq;            /* Write order of the sector, 0 is never used */
+  uint32_t FirstTimestamp; /* Timestamp of the first record of the sector */
+  uint16_t Version;
+  uint16_t Crc; /* CRC-16 of the fields above */
+} TLOG_SectorHeader_t;
+
+typedef struct
+{
+  uint32_t Timestamp; /* Timestamp of the first record of the page */
+  uint16_t Length;    /* Bytes of records following the header */
+  uint16_t Crc;       /* CRC-16 of the header fields and the records */
+} TLOG_PageHeader_t;
+
+typedef struct
+{
+  uint32_t Timestamp;
+  uint16_t Channel;
+  uint8_t Size;
+  uint8_t Reserved;
+} TLOG_RecordHeader_t;
+
+typedef struct
+{
+  uint32_t Timestamp;
+  uint16_t Channel;
+  uint8_t Size;
+  uint8_t Data[TLOG_PAGE_SIZE];
+} TLOG_Record_t;
+
+typedef struct
+{
+  uint32_t Sector; /* Physical sector */
+  uint32_t Seq;    /* Seq of Sector when the cursor entered it, detects recycling */
+  uint32_t Page;
+  uint32_t Offset; /* Offset inside the cached page */
+  uint32_t Valid;  /* Page cache holds Sector/Page */
+  uint8_t Cache[TLOG_PAGE_SIZE];
+} TLOG_Cursor_t;
+
+typedef struct
+{
+  uint32_t Records;     /* Records accepted by TLOG_Append() */
+  uint32_t Dropped;     /* Records lost because the staging buffers were full */
+  uint32_t Pages;       /* Pages programmed */
+  uint32_t Erases;      /* Sectors erased */
+  uint32_t TornPages;   /* Pages skipped at mount or read because of a bad CRC */
+  uint32_t StageHigh;   /* Staging high-water mark, in pages */
+  uint32_t EraseStalls; /* TLOG_Process() calls that waited on an unfinished erase */
+} TLOG_Stats_t;
+
+int32_t TLOG_Init(const TLOG_Flash_t *Flash);
+int32_t TLOG_Append(uint16_t Channel, uint32_t Timestamp, const void *pData, uint8_t Size);
+int32_t TLOG_Flush(void);
+int32_t TLOG_Process(void);
+int32_t TLOG_Seek(uint32_t Timestamp, TLOG_Cursor_t *Cursor);
+int32_t TLOG_ReadNext(TLOG_Cursor_t *Cursor, TLOG_Record_t *Record);
+void TLOG_GetStats(TLOG_Stats_t *Stats);
+
+#endif /* TLOG_H */
@@ -0,0 +1,13 @@
+#ifndef TLOG_QSPI_H
+#define TLOG_QSPI_H
+
+#include "sw/tlog.h"
+
+/* The first 16 MB of the QSPI flash are left to code and assets (QSPI region
+ * of the linker script), the log uses the rest */
+#define TLOG_QSPI_BASE 0x01000000U
+#define TLOG_QSPI_SIZE 0x07000000U
+
+extern const TLOG_Flash_t TLOG_QSPI_Flash;
+
+#endif /* TLOG_QSPI_H */
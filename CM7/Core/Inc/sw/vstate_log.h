@@ -0,0 +1,17 @@
+#ifndef VSTATE_LOG_H
+#define VSTATE_LOG_H
+
+#include <stdint.h>
+
+#include "driver/errno.h"
+
+/* A partially filled log page reaches the flash at least this often */
+#ifndef VSTATE_LOG_FLUSH_MS
+#define VSTATE_LOG_FLUSH_MS 1000U
+#endif
+
+void VSTATE_LOG_Init(void);
+void VSTATE_LOG_Process(void);
+uint32_t VSTATE_LOG_GetInvalid(void);
+
+#endif /* VSTATE_LOG_H */
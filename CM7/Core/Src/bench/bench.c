@@ -0,0 +1,43 @@
+#include "bench/bench.h"
+#include <stdio.h>
+
+/**
+ * @brief  Start the DWT cycle counter used by every benchmark.
+ * @retval None
+ */
+void BENCH_Init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  /* The Cortex-M7 DWT is locked after reset */
+  DWT->LAR = 0xC5ACCE55U;
+  DWT->CYCCNT = 0U;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief  Convert a cycle count to microseconds at the current core clock.
+ * @param  Cycles DWT cycles
+ * @retval Microseconds
+ */
+uint32_t BENCH_CyclesToUs(uint32_t Cycles)
+{
+  return (uint32_t)(((uint64_t)Cycles * 1000000U) / SystemCoreClock);
+}
+
+/**
+ * @brief  Print a "name: bytes in us -> MB/s" line on the console (USART3).
+ *         Uses integer math only, newlib-nano printf has no float support.
+ * @param  Name   Label of the measurement
+ * @param  Bytes  Bytes moved
+ * @param  Cycles DWT cycles spent
+ * @retval None
+ */
+void BENCH_PrintThroughput(const char *Name, uint32_t Bytes, uint32_t Cycles)
+{
+  uint32_t us = BENCH_CyclesToUs(Cycles);
+  /* MB/s with two decimals, 1 MB = 10^6 bytes */
+  uint32_t mbps_x100 = (us == 0U) ? 0U : (uint32_t)(((uint64_t)Bytes * 100U) / us);
+
+  printf("%-24s %8lu B %8lu us %5lu.%02lu MB/s\r\n", Name, (unsigned long)Bytes, (unsigned long)us,
+         (unsigned long)(mbps_x100 / 100U), (unsigned long)(mbps_x100 % 100U));
+}
@@ -0,0 +1,71 @@
+#include "bench/bench.h"
+#include "driver/qspi.h"
+#include "sw/asset.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief  Compare, for every asset of the pack, the load time of the raw
+ *         pixels read through the memory-mapped flash against the streaming
+ *         LZ4 decoder, both into SDRAM, and print the compression ratio.
+ *         QSPI must be in indirect mode, the pack flashed at PackAddr and
+ *         SDRAM initialised.
+ * @param  PackAddr Flash address of the asset pack
+ * @retval None
+ */
+void BENCH_ASSET_Run(uint32_t PackAddr)
+{
+  uint8_t *dst = (uint8_t *)BENCH_SDRAM_SCRATCH_ADDR;
+  const ASSET_Entry_t *entry;
+  uint32_t start, cycles, i;
+  char name[32];
+  int32_t ret;
+
+  BENCH_Init();
+
+  if (ASSET_Init(PackAddr) != BSP_ERROR_NONE)
+  {
+    printf("asset: no pack at 0x%08lx\r\n", (unsigned long)PackAddr);
+    return;
+  }
+
+  printf("asset pack, %lu entries\r\n", (unsigned long)ASSET_GetCount());
+
+  for (i = 0; i < ASSET_GetCount(); i++)
+  {
+    entry = ASSET_GetEntry(i);
+    if (entry->RawSize > BENCH_SDRAM_SCRATCH_SIZE)
+    {
+      printf("%s: too large\r\n", entry->Name);
+      continue;
+    }
+
+    printf("%-24s raw %7lu B packed %7lu B (%lu%%)\r\n", entry->Name, (unsigned long)entry->RawSize,
+           (unsigned long)entry->PackedSize, (unsigned long)((uint64_t)entry->PackedSize * 100U / entry->RawSize));
+
+    /* Baseline: the same amount of raw pixels copied out of the mapping,
+     * cold D-cache. Only the read time matters, not the content. */
+    if (BSP_QSPI_EnableMemoryMappedMode() == BSP_ERROR_NONE)
+    {
+      SCB_InvalidateDCache_by_Addr((void *)(0x90000000U + PackAddr + entry->Offset), (int32_t)entry->RawSize);
+      start = BENCH_Cycles();
+      memcpy(dst, (const uint8_t *)(0x90000000U + PackAddr + entry->Offset), entry->RawSize);
+      cycles = BENCH_Cycles() - start;
+      BENCH_PrintThroughput("  raw mmp", entry->RawSize, cycles);
+      BSP_QSPI_DisableMemoryMappedMode();
+    }
+
+    start = BENCH_Cycles();
+    ret = ASSET_Decode(entry, dst);
+    cycles = BENCH_Cycles() - start;
+    snprintf(name, sizeof(name), "  %s stream", (entry->Codec == ASSET_CODEC_LZ4) ? "lz4" : "raw");
+    if (ret == BSP_ERROR_NONE)
+    {
+      BENCH_PrintThroughput(name, entry->RawSize, cycles);
+    }
+    else
+    {
+      printf("%s: error %ld\r\n", name, (long)ret);
+    }
+  }
+}
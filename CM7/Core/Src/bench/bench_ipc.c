@@ -0,0 +1,200 @@
+#include "bench/bench.h"
+#include "ipc.h"
+#include "mem_sections.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Round trips per payload size */
+#define BENCH_IPC_ROUNDS 1000U
+/* Messages per throughput run, each direction */
+#define BENCH_IPC_MESSAGES 20000U
+#define BENCH_IPC_TIMEOUT_MS 1000U
+
+static const uint32_t bench_ipc_sizes[] = {0U, 8U, IPC_PAYLOAD_MAX};
+
+static XIP_FUNC uint32_t bench_ipc_ns(uint32_t Cycles)
+{
+  return (uint32_t)(((uint64_t)Cycles * 1000000000U) / SystemCoreClock);
+}
+
+/**
+ * @brief  Waits for a message of a type from the CM4, dropping the others.
+ *         Sleeps between messages: the empty IPC_Receive() armed the
+ *         doorbell, and any interrupt taken sets the event register.
+ */
+static int32_t bench_ipc_wait(uint16_t Type, IPC_Msg_t *pMsg, uint32_t *pOthers)
+{
+  int32_t ret = BSP_ERROR_BUSY;
+  uint32_t start = HAL_GetTick();
+
+  while ((ret != BSP_ERROR_NONE) && ((HAL_GetTick() - start) < BENCH_IPC_TIMEOUT_MS))
+  {
+    if (IPC_Receive(IPC_CH_M4_TO_M7, pMsg) == 0U)
+    {
+      __WFE();
+    }
+    else if (pMsg->Type == Type)
+    {
+      ret = BSP_ERROR_NONE;
+    }
+    else if (pOthers != NULL)
+    {
+      (*pOthers)++;
+    }
+  }
+  return ret;
+}
+
+static int32_t bench_ipc_send(uint16_t Type, const void *pData, uint32_t Len)
+{
+  int32_t ret;
+
+  do
+  {
+    ret = IPC_Send(IPC_CH_M7_TO_M4, Type, pData, Len);
+  } while (ret == BSP_ERROR_BUSY);
+  return ret;
+}
+
+/**
+ * @brief  PING to PONG round trips: doorbell, CM4 main loop pass, doorbell
+ *         back. Half of it is the one-way latency.
+ */
+static __attribute__((noinline)) void bench_ipc_latency(uint32_t Len)
+{
+  uint8_t data[IPC_PAYLOAD_MAX] = {0};
+  IPC_Msg_t msg;
+  uint32_t start, cycles, min = UINT32_MAX, max = 0U, i;
+  uint64_t sum = 0U;
+  int32_t ret = BSP_ERROR_NONE;
+
+  for (i = 0; (i < BENCH_IPC_ROUNDS) && (ret == BSP_ERROR_NONE); i++)
+  {
+    memcpy(data, &i, sizeof(i));
+    start = BENCH_Cycles();
+    ret = bench_ipc_send(IPC_TYPE_PING, data, Len);
+    if (ret == BSP_ERROR_NONE)
+    {
+      ret = bench_ipc_wait(IPC_TYPE_PONG, &msg, NULL);
+    }
+    cycles = BENCH_Cycles() - start;
+    if ((ret == BSP_ERROR_NONE) && ((msg.Len != Len) || (memcmp(msg.Data, data, Len) != 0)))
+    {
+      ret = BSP_ERROR_UNKNOWN_FAILURE;
+    }
+    min = (cycles < min) ? cycles : min;
+    max = (cycles > max) ? cycles : max;
+    sum += cycles;
+  }
+
+  if (ret != BSP_ERROR_NONE)
+  {
+    printf("ipc round trip %lu B: failed (%ld)\r\n", (unsigned long)Len, (long)ret);
+  }
+  else
+  {
+    printf("ipc round trip %2lu B       min %6lu avg %6lu max %6lu ns\r\n", (unsigned long)Len,
+           (unsigned long)bench_ipc_ns(min), (unsigned long)bench_ipc_ns((uint32_t)(sum / BENCH_IPC_ROUNDS)),
+           (unsigned long)bench_ipc_ns(max));
+  }
+}
+
+/**
+ * @brief  Full slots from the CM7 to the CM4, as fast as the CM4 drains,
+ *         closed by a PING: the PONG comes back once every SINK was taken.
+ */
+static __attribute__((noinline)) void bench_ipc_to_m4(void)
+{
+  uint8_t data[IPC_PAYLOAD_MAX] = {0};
+  const IPC_Stats_t *stats = IPC_GetStats();
+  IPC_Msg_t msg;
+  uint32_t start, cycles, full, i;
+  int32_t ret = BSP_ERROR_NONE;
+
+  full = stats->Full;
+  start = BENCH_Cycles();
+  for (i = 0; (i < BENCH_IPC_MESSAGES) && (ret == BSP_ERROR_NONE); i++)
+  {
+    memcpy(data, &i, sizeof(i));
+    ret = bench_ipc_send(IPC_TYPE_SINK, data, sizeof(data));
+  }
+  if (ret == BSP_ERROR_NONE)
+  {
+    ret = bench_ipc_send(IPC_TYPE_PING, NULL, 0U);
+  }
+  if (ret == BSP_ERROR_NONE)
+  {
+    ret = bench_ipc_wait(IPC_TYPE_PONG, &msg, NULL);
+  }
+  cycles = BENCH_Cycles() - start;
+
+  if (ret != BSP_ERROR_NONE)
+  {
+    printf("ipc m7>m4: failed (%ld)\r\n", (long)ret);
+  }
+  else
+  {
+    BENCH_PrintThroughput("ipc m7>m4 payload", BENCH_IPC_MESSAGES * IPC_PAYLOAD_MAX, cycles);
+    printf("%-24s %8lu msg/s, ring full %lu times\r\n", "",
+           (unsigned long)(((uint64_t)BENCH_IPC_MESSAGES * 1000000U) / BENCH_CyclesToUs(cycles)),
+           (unsigned long)(stats->Full - full));
+  }
+}
+
+/**
+ * @brief  Full slots from the CM4 to the CM7 on request (SOURCE), counted
+ *         until the closing PONG. Also the doorbells the CM7 took for them.
+ */
+static __attribute__((noinline)) void bench_ipc_to_m7(void)
+{
+  const IPC_Stats_t *stats = IPC_GetStats();
+  uint32_t count = BENCH_IPC_MESSAGES, sunk = 0U, start, cycles, doorbells;
+  IPC_Msg_t msg;
+  int32_t ret;
+
+  doorbells = stats->Doorbells;
+  start = BENCH_Cycles();
+  ret = bench_ipc_send(IPC_TYPE_SOURCE, &count, sizeof(count));
+  if (ret == BSP_ERROR_NONE)
+  {
+    ret = bench_ipc_wait(IPC_TYPE_PONG, &msg, &sunk);
+  }
+  cycles = BENCH_Cycles() - start;
+  if ((ret == BSP_ERROR_NONE) && (sunk != count))
+  {
+    ret = BSP_ERROR_UNKNOWN_FAILURE;
+  }
+
+  if (ret != BSP_ERROR_NONE)
+  {
+    printf("ipc m4>m7: failed (%ld), %lu of %lu\r\n", (long)ret, (unsigned long)sunk, (unsigned long)count);
+  }
+  else
+  {
+    BENCH_PrintThroughput("ipc m4>m7 payload", count * IPC_PAYLOAD_MAX, cycles);
+    printf("%-24s %8lu msg/s, %lu doorbells\r\n", "",
+           (unsigned long)(((uint64_t)count * 1000000U) / BENCH_CyclesToUs(cycles)),
+           (unsigned long)(stats->Doorbells - doorbells));
+  }
+}
+
+/**
+ * @brief  Inter-core messaging: round-trip latency per payload size, then
+ *         throughput in both directions. IPC_Init() must have run and the
+ *         CM4 must be running IPC_SRV_Process().
+ * @retval None
+ */
+XIP_FUNC void BENCH_IPC_Run(void)
+{
+  uint32_t i;
+
+  BENCH_Init();
+  printf("IPC rings, %lu slots of %lu B, HSEM doorbells\r\n", (unsigned long)IPC_SLOTS,
+         (unsigned long)IPC_SLOT_SIZE);
+  for (i = 0; i < (sizeof(bench_ipc_sizes) / sizeof(bench_ipc_sizes[0])); i++)
+  {
+    bench_ipc_latency(bench_ipc_sizes[i]);
+  }
+  bench_ipc_to_m4();
+  bench_ipc_to_m7();
+}
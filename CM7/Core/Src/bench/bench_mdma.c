@@ -0,0 +1,233 @@
+#include "bench/bench.h"
+#include "driver/mdma_copy.h"
+#include "mem_sections.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Source and destination halves of the SDRAM scratch area */
+#define BENCH_MDMA_SRC ((uint8_t *)BENCH_SDRAM_SCRATCH_ADDR)
+#define BENCH_MDMA_DST ((uint8_t *)(BENCH_SDRAM_SCRATCH_ADDR + BENCH_SDRAM_SCRATCH_SIZE / 2U))
+#define BENCH_MDMA_TIMEOUT 1000U
+/* Back-to-back copies queued at once */
+#define BENCH_MDMA_BATCH 8U
+#define BENCH_MDMA_BATCH_SIZE 0x4000U
+/* Sprite blitted into a framebuffer-sized buffer, ARGB8888 */
+#define BENCH_MDMA_FB_PITCH (800U * 4U)
+#define BENCH_MDMA_SPRITE_W (200U * 4U)
+#define BENCH_MDMA_SPRITE_H 120U
+
+static const uint32_t bench_mdma_sizes[] = {256U, 0x1000U, 0x10000U, 0x40000U, 0x100000U};
+
+static XIP_FUNC void bench_mdma_fill(uint8_t *Buf, uint32_t Size, uint32_t Seed)
+{
+  uint32_t *p = (uint32_t *)Buf;
+  uint32_t i;
+
+  for (i = 0; i < Size / 4U; i++)
+  {
+    p[i] = (i * 0x9E3779B9U) ^ Seed;
+  }
+  SCB_CleanDCache_by_Addr((uint32_t *)Buf, (int32_t)Size);
+}
+
+/* Prints the time the CPU was held, the copy itself runs on */
+static XIP_FUNC void bench_mdma_print_cpu(const char *Name, uint32_t Cycles)
+{
+  printf("%-24s %19lu us cpu\r\n", Name, (unsigned long)BENCH_CyclesToUs(Cycles));
+}
+
+static XIP_FUNC void bench_mdma_print(const char *Name, uint32_t Bytes, uint32_t Cycles, int32_t Status)
+{
+  if (Status == BSP_ERROR_NONE)
+  {
+    BENCH_PrintThroughput(Name, Bytes, Cycles);
+  }
+  else
+  {
+    printf("%s: failed (%ld)\r\n", Name, (long)Status);
+  }
+}
+
+/**
+ * @brief  memcpy() against BSP_MDMA_Memcpy() for one size: total time, and
+ *         time the CPU spends queuing the copy. Cold D-cache, the CPU copy
+ *         is cleaned to the SDRAM so that both end in memory.
+ */
+static __attribute__((noinline)) void bench_mdma_copy(uint32_t Size)
+{
+  char name[40];
+  uint32_t start, submit, cycles;
+  int32_t ret;
+
+  bench_mdma_fill(BENCH_MDMA_SRC, Size, Size);
+
+  SCB_CleanInvalidateDCache();
+  start = BENCH_Cycles();
+  memcpy(BENCH_MDMA_DST, BENCH_MDMA_SRC, Size);
+  SCB_CleanDCache_by_Addr((uint32_t *)BENCH_MDMA_DST, (int32_t)Size);
+  cycles = BENCH_Cycles() - start;
+  snprintf(name, sizeof(name), "memcpy %lu", (unsigned long)Size);
+  BENCH_PrintThroughput(name, Size, cycles);
+
+  memset(BENCH_MDMA_DST, 0, Size);
+  SCB_CleanInvalidateDCache();
+  start = BENCH_Cycles();
+  ret = BSP_MDMA_Memcpy(BENCH_MDMA_DST, BENCH_MDMA_SRC, Size, NULL, NULL);
+  submit = BENCH_Cycles() - start;
+  if (ret == BSP_ERROR_NONE)
+  {
+    ret = BSP_MDMA_CopyWait(BENCH_MDMA_TIMEOUT);
+  }
+  cycles = BENCH_Cycles() - start;
+  if ((ret == BSP_ERROR_NONE) && (memcmp(BENCH_MDMA_DST, BENCH_MDMA_SRC, Size) != 0))
+  {
+    ret = BSP_ERROR_UNKNOWN_FAILURE;
+  }
+  snprintf(name, sizeof(name), "mdma copy %lu", (unsigned long)Size);
+  bench_mdma_print(name, Size, cycles, ret);
+  bench_mdma_print_cpu(name, submit);
+}
+
+/**
+ * @brief  memset() against BSP_MDMA_Memset() for one size.
+ */
+static __attribute__((noinline)) void bench_mdma_set(uint32_t Size)
+{
+  char name[40];
+  uint32_t start, cycles, i;
+  int32_t ret;
+
+  SCB_CleanInvalidateDCache();
+  start = BENCH_Cycles();
+  memset(BENCH_MDMA_DST, 0xA5, Size);
+  SCB_CleanDCache_by_Addr((uint32_t *)BENCH_MDMA_DST, (int32_t)Size);
+  cycles = BENCH_Cycles() - start;
+  snprintf(name, sizeof(name), "memset %lu", (unsigned long)Size);
+  BENCH_PrintThroughput(name, Size, cycles);
+
+  SCB_CleanInvalidateDCache();
+  start = BENCH_Cycles();
+  ret = BSP_MDMA_Memset(BENCH_MDMA_DST, 0x5A, Size, NULL, NULL);
+  if (ret == BSP_ERROR_NONE)
+  {
+    ret = BSP_MDMA_CopyWait(BENCH_MDMA_TIMEOUT);
+  }
+  cycles = BENCH_Cycles() - start;
+  for (i = 0; (i < Size) && (ret == BSP_ERROR_NONE); i++)
+  {
+    if (BENCH_MDMA_DST[i] != 0x5AU)
+    {
+      ret = BSP_ERROR_UNKNOWN_FAILURE;
+    }
+  }
+  snprintf(name, sizeof(name), "mdma set %lu", (unsigned long)Size);
+  bench_mdma_print(name, Size, cycles, ret);
+}
+
+/**
+ * @brief  BENCH_MDMA_BATCH copies queued back to back: the MDMA interrupt
+ *         chains them without waiting for the CPU.
+ */
+static __attribute__((noinline)) void bench_mdma_batch(void)
+{
+  uint32_t start, submit, cycles, i;
+  int32_t ret = BSP_ERROR_NONE;
+
+  bench_mdma_fill(BENCH_MDMA_SRC, BENCH_MDMA_BATCH * BENCH_MDMA_BATCH_SIZE, 0x5EEDU);
+
+  SCB_CleanInvalidateDCache();
+  start = BENCH_Cycles();
+  for (i = 0; i < BENCH_MDMA_BATCH; i++)
+  {
+    memcpy(BENCH_MDMA_DST + i * BENCH_MDMA_BATCH_SIZE, BENCH_MDMA_SRC + i * BENCH_MDMA_BATCH_SIZE,
+           BENCH_MDMA_BATCH_SIZE);
+  }
+  SCB_CleanDCache_by_Addr((uint32_t *)BENCH_MDMA_DST, (int32_t)(BENCH_MDMA_BATCH * BENCH_MDMA_BATCH_SIZE));
+  cycles = BENCH_Cycles() - start;
+  BENCH_PrintThroughput("memcpy batch", BENCH_MDMA_BATCH * BENCH_MDMA_BATCH_SIZE, cycles);
+
+  SCB_CleanInvalidateDCache();
+  start = BENCH_Cycles();
+  for (i = 0; (i < BENCH_MDMA_BATCH) && (ret == BSP_ERROR_NONE); i++)
+  {
+    ret = BSP_MDMA_Memcpy(BENCH_MDMA_DST + i * BENCH_MDMA_BATCH_SIZE, BENCH_MDMA_SRC + i * BENCH_MDMA_BATCH_SIZE,
+                          BENCH_MDMA_BATCH_SIZE, NULL, NULL);
+  }
+  submit = BENCH_Cycles() - start;
+  if (ret == BSP_ERROR_NONE)
+  {
+    ret = BSP_MDMA_CopyWait(BENCH_MDMA_TIMEOUT);
+  }
+  cycles = BENCH_Cycles() - start;
+  bench_mdma_print("mdma batch", BENCH_MDMA_BATCH * BENCH_MDMA_BATCH_SIZE, cycles, ret);
+  bench_mdma_print_cpu("mdma batch", submit);
+}
+
+/**
+ * @brief  Sprite blit into a framebuffer: a memcpy() per row against one
+ *         BSP_MDMA_Copy2D().
+ */
+static __attribute__((noinline)) void bench_mdma_2d(void)
+{
+  uint32_t start, cycles, y;
+  int32_t ret;
+
+  bench_mdma_fill(BENCH_MDMA_SRC, BENCH_MDMA_SPRITE_W * BENCH_MDMA_SPRITE_H, 0x2D2DU);
+
+  SCB_CleanInvalidateDCache();
+  start = BENCH_Cycles();
+  for (y = 0; y < BENCH_MDMA_SPRITE_H; y++)
+  {
+    memcpy(BENCH_MDMA_DST + y * BENCH_MDMA_FB_PITCH, BENCH_MDMA_SRC + y * BENCH_MDMA_SPRITE_W, BENCH_MDMA_SPRITE_W);
+  }
+  SCB_CleanDCache_by_Addr((uint32_t *)BENCH_MDMA_DST, (int32_t)(BENCH_MDMA_SPRITE_H * BENCH_MDMA_FB_PITCH));
+  cycles = BENCH_Cycles() - start;
+  BENCH_PrintThroughput("memcpy 2d", BENCH_MDMA_SPRITE_W * BENCH_MDMA_SPRITE_H, cycles);
+
+  memset(BENCH_MDMA_DST, 0, BENCH_MDMA_SPRITE_H * BENCH_MDMA_FB_PITCH);
+  SCB_CleanInvalidateDCache();
+  start = BENCH_Cycles();
+  ret = BSP_MDMA_Copy2D(BENCH_MDMA_DST, BENCH_MDMA_FB_PITCH, BENCH_MDMA_SRC, BENCH_MDMA_SPRITE_W,
+                        BENCH_MDMA_SPRITE_W, BENCH_MDMA_SPRITE_H, NULL, NULL);
+  if (ret == BSP_ERROR_NONE)
+  {
+    ret = BSP_MDMA_CopyWait(BENCH_MDMA_TIMEOUT);
+  }
+  cycles = BENCH_Cycles() - start;
+  for (y = 0; (y < BENCH_MDMA_SPRITE_H) && (ret == BSP_ERROR_NONE); y++)
+  {
+    if (memcmp(BENCH_MDMA_DST + y * BENCH_MDMA_FB_PITCH, BENCH_MDMA_SRC + y * BENCH_MDMA_SPRITE_W,
+               BENCH_MDMA_SPRITE_W) != 0)
+    {
+      ret = BSP_ERROR_UNKNOWN_FAILURE;
+    }
+  }
+  bench_mdma_print("mdma 2d", BENCH_MDMA_SPRITE_W * BENCH_MDMA_SPRITE_H, cycles, ret);
+}
+
+/**
+ * @brief  The MDMA copy engine against the C library on SDRAM to SDRAM
+ *         copies and fills of growing size, a batch of queued copies and a
+ *         2D sprite blit. Every MDMA result is checked.
+ *         SDRAM and BSP_MDMA_CopyInit() must have been initialised, nothing
+ *         else may use the scratch area or the copy engine meanwhile.
+ * @retval None
+ */
+XIP_FUNC void BENCH_MDMA_Run(void)
+{
+  uint32_t i;
+
+  BENCH_Init();
+  printf("MDMA copy engine, SDRAM to SDRAM, cold D-cache\r\n");
+
+  for (i = 0; i < (sizeof(bench_mdma_sizes) / sizeof(bench_mdma_sizes[0])); i++)
+  {
+    bench_mdma_copy(bench_mdma_sizes[i]);
+  }
+  for (i = 0; i < (sizeof(bench_mdma_sizes) / sizeof(bench_mdma_sizes[0])); i++)
+  {
+    bench_mdma_set(bench_mdma_sizes[i]);
+  }
+  bench_mdma_batch();
+  bench_mdma_2d();
+}
@@ -0,0 +1,334 @@
+#include "bench/bench.h"
+#include "dma2d.h"
+#include "driver/mdma_copy.h"
+#include "driver/qspi_arb.h"
+#include "driver/sdram.h"
+#include "ltdc.h"
+#include "mem_sections.h"
+#include <stdio.h>
+#include <string.h>
+
+/* The D-cache size: with the cache invalidated before each pass every
+ * access of the pass goes to the memory */
+#define BENCH_MEM_SIZE 0x4000U
+#define BENCH_MEM_LINE 32U
+#define BENCH_MEM_NODES (BENCH_MEM_SIZE / BENCH_MEM_LINE)
+/* DMA2D copies lines of 1 KB */
+#define BENCH_MEM_DMA2D_WIDTH 256U
+#define BENCH_MEM_TIMEOUT 100U
+
+typedef struct
+{
+  const char *Name;
+  uint8_t *Buf;
+  uint32_t Writable;
+  uint32_t Dma2d; /* The DMA2D has no access to the TCMs */
+} BENCH_MEM_Region_t;
+
+static uint8_t bench_mem_axi[BENCH_MEM_SIZE] __attribute__((aligned(32)));
+static DTCM_BSS uint8_t bench_mem_dtcm[BENCH_MEM_SIZE] __attribute__((aligned(32)));
+/* Copy target of the read-only QSPI region */
+static uint8_t bench_mem_sink[BENCH_MEM_SIZE / 2U] __attribute__((aligned(32)));
+/* Random visiting order of the lines, in DTCM so that it costs one cycle */
+static DTCM_BSS uint16_t bench_mem_order[BENCH_MEM_NODES];
+static volatile uint32_t bench_mem_zero;
+static volatile uint32_t bench_mem_sum;
+
+/**
+ * @brief  Shuffles the line order (xorshift32, Fisher-Yates).
+ */
+static XIP_FUNC void bench_mem_shuffle(void)
+{
+  uint32_t x = 0x2545F491U;
+  uint32_t i, j;
+  uint16_t t;
+
+  for (i = 0; i < BENCH_MEM_NODES; i++)
+  {
+    bench_mem_order[i] = (uint16_t)(i * BENCH_MEM_LINE);
+  }
+  for (i = BENCH_MEM_NODES - 1U; i > 0U; i--)
+  {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    j = x % (i + 1U);
+    t = bench_mem_order[i];
+    bench_mem_order[i] = bench_mem_order[j];
+    bench_mem_order[j] = t;
+  }
+}
+
+static XIP_FUNC void bench_mem_print_latency(const char *Name, uint32_t Cycles)
+{
+  uint32_t cyc_x100 = (uint32_t)(((uint64_t)Cycles * 100U) / BENCH_MEM_NODES);
+  uint32_t ns = (uint32_t)(((uint64_t)Cycles * 1000000000U) / SystemCoreClock / BENCH_MEM_NODES);
+
+  printf("%-24s %5lu.%02lu cyc %5lu ns/access\r\n", Name, (unsigned long)(cyc_x100 / 100U),
+         (unsigned long)(cyc_x100 % 100U), (unsigned long)ns);
+}
+
+static uint32_t bench_mem_read(const uint8_t *Buf)
+{
+  const uint32_t *p = (const uint32_t *)Buf;
+  uint32_t sum = 0, start, i;
+
+  SCB_InvalidateDCache_by_Addr((uint32_t *)(uint32_t)Buf, BENCH_MEM_SIZE);
+  start = BENCH_Cycles();
+  for (i = 0; i < BENCH_MEM_SIZE / 4U; i += 4U)
+  {
+    sum += p[i] + p[i + 1U] + p[i + 2U] + p[i + 3U];
+  }
+  bench_mem_sum = sum;
+  return BENCH_Cycles() - start;
+}
+
+/* Written back from the cache within the measurement */
+static uint32_t bench_mem_write(uint8_t *Buf)
+{
+  uint32_t *p = (uint32_t *)Buf;
+  uint32_t start, i;
+
+  SCB_CleanInvalidateDCache_by_Addr((uint32_t *)Buf, BENCH_MEM_SIZE);
+  start = BENCH_Cycles();
+  for (i = 0; i < BENCH_MEM_SIZE / 4U; i += 4U)
+  {
+    p[i] = i;
+    p[i + 1U] = i;
+    p[i + 2U] = i;
+    p[i + 3U] = i;
+  }
+  SCB_CleanDCache_by_Addr((uint32_t *)Buf, BENCH_MEM_SIZE);
+  return BENCH_Cycles() - start;
+}
+
+/* Each load depends on the previous one: the time of a miss */
+static uint32_t bench_mem_random_read(const uint8_t *Buf)
+{
+  uint32_t z = bench_mem_zero;
+  uint32_t v = 0, start, i;
+
+  SCB_InvalidateDCache_by_Addr((uint32_t *)(uint32_t)Buf, BENCH_MEM_SIZE);
+  start = BENCH_Cycles();
+  for (i = 0; i < BENCH_MEM_NODES; i++)
+  {
+    v = *(const volatile uint32_t *)(Buf + bench_mem_order[i] + (v & z));
+  }
+  bench_mem_sum = v;
+  return BENCH_Cycles() - start;
+}
+
+static uint32_t bench_mem_random_write(uint8_t *Buf)
+{
+  uint32_t start, i;
+
+  SCB_CleanInvalidateDCache_by_Addr((uint32_t *)Buf, BENCH_MEM_SIZE);
+  start = BENCH_Cycles();
+  for (i = 0; i < BENCH_MEM_NODES; i++)
+  {
+    *(volatile uint32_t *)(Buf + bench_mem_order[i]) = i;
+  }
+  SCB_CleanDCache_by_Addr((uint32_t *)Buf, BENCH_MEM_SIZE);
+  return BENCH_Cycles() - start;
+}
+
+static uint32_t bench_mem_cpu_copy(uint8_t *Dst, const uint8_t *Src, uint32_t Size)
+{
+  uint32_t start;
+
+  SCB_CleanInvalidateDCache();
+  start = BENCH_Cycles();
+  memcpy(Dst, Src, Size);
+  SCB_CleanDCache_by_Addr((uint32_t *)Dst, (int32_t)Size);
+  return BENCH_Cycles() - start;
+}
+
+/* 0 on failure */
+static uint32_t bench_mem_mdma_copy(uint8_t *Dst, const uint8_t *Src, uint32_t Size)
+{
+  uint32_t start, cycles = 0U;
+
+  SCB_CleanInvalidateDCache();
+  start = BENCH_Cycles();
+  if ((BSP_MDMA_Memcpy(Dst, Src, Size, NULL, NULL) == BSP_ERROR_NONE) &&
+      (BSP_MDMA_CopyWait(BENCH_MEM_TIMEOUT) == BSP_ERROR_NONE))
+  {
+    cycles = BENCH_Cycles() - start;
+  }
+  return cycles;
+}
+
+/* 0 on failure */
+static uint32_t bench_mem_dma2d_copy(uint8_t *Dst, const uint8_t *Src, uint32_t Size)
+{
+  uint32_t start, cycles = 0U;
+
+  hdma2d.Init.Mode = DMA2D_M2M;
+  hdma2d.Init.ColorMode = DMA2D_OUTPUT_ARGB8888;
+  hdma2d.Init.OutputOffset = 0U;
+  hdma2d.LayerCfg[1].InputColorMode = DMA2D_INPUT_ARGB8888;
+  hdma2d.LayerCfg[1].InputOffset = 0U;
+  hdma2d.LayerCfg[1].AlphaMode = DMA2D_NO_MODIF_ALPHA;
+
+  SCB_CleanInvalidateDCache();
+  if ((HAL_DMA2D_Init(&hdma2d) == HAL_OK) && (HAL_DMA2D_ConfigLayer(&hdma2d, 1U) == HAL_OK))
+  {
+    start = BENCH_Cycles();
+    if ((HAL_DMA2D_Start(&hdma2d, (uint32_t)Src, (uint32_t)Dst, BENCH_MEM_DMA2D_WIDTH,
+                         Size / (4U * BENCH_MEM_DMA2D_WIDTH)) == HAL_OK) &&
+        (HAL_DMA2D_PollForTransfer(&hdma2d, BENCH_MEM_TIMEOUT) == HAL_OK))
+    {
+      cycles = BENCH_Cycles() - start;
+    }
+  }
+  return cycles;
+}
+
+/**
+ * @brief  Sequential and random CPU accesses, then CPU, MDMA and DMA2D
+ *         copies of half the buffer: into the other half, or into AXI
+ *         SRAM for a read-only region.
+ */
+static void bench_mem_region(const BENCH_MEM_Region_t *Region, const char *Suffix)
+{
+  uint8_t *dst = Region->Writable ? Region->Buf + BENCH_MEM_SIZE / 2U : bench_mem_sink;
+  char name[40];
+  uint32_t cycles;
+
+  snprintf(name, sizeof(name), "%s%s seq read", Region->Name, Suffix);
+  BENCH_PrintThroughput(name, BENCH_MEM_SIZE, bench_mem_read(Region->Buf));
+  snprintf(name, sizeof(name), "%s%s rnd read", Region->Name, Suffix);
+  bench_mem_print_latency(name, bench_mem_random_read(Region->Buf));
+
+  if (Region->Writable)
+  {
+    snprintf(name, sizeof(name), "%s%s seq write", Region->Name, Suffix);
+    BENCH_PrintThroughput(name, BENCH_MEM_SIZE, bench_mem_write(Region->Buf));
+    snprintf(name, sizeof(name), "%s%s rnd write", Region->Name, Suffix);
+    bench_mem_print_latency(name, bench_mem_random_write(Region->Buf));
+  }
+
+  snprintf(name, sizeof(name), "%s%s cpu copy", Region->Name, Suffix);
+  BENCH_PrintThroughput(name, BENCH_MEM_SIZE / 2U, bench_mem_cpu_copy(dst, Region->Buf, BENCH_MEM_SIZE / 2U));
+
+  snprintf(name, sizeof(name), "%s%s mdma copy", Region->Name, Suffix);
+  cycles = bench_mem_mdma_copy(dst, Region->Buf, BENCH_MEM_SIZE / 2U);
+  if (cycles != 0U)
+  {
+    BENCH_PrintThroughput(name, BENCH_MEM_SIZE / 2U, cycles);
+  }
+  else
+  {
+    printf("%s: failed\r\n", name);
+  }
+
+  if (Region->Dma2d)
+  {
+    snprintf(name, sizeof(name), "%s%s dma2d copy", Region->Name, Suffix);
+    cycles = bench_mem_dma2d_copy(dst, Region->Buf, BENCH_MEM_SIZE / 2U);
+    if (cycles != 0U)
+    {
+      BENCH_PrintThroughput(name, BENCH_MEM_SIZE / 2U, cycles);
+    }
+    else
+    {
+      printf("%s: failed\r\n", name);
+    }
+  }
+}
+
+/**
+ * @brief  Writes a pattern through the cache and reads it back from the
+ *         SDRAM, catches a profile the board does not hold.
+ * @retval Number of wrong words
+ */
+static XIP_FUNC uint32_t bench_mem_verify(uint8_t *Buf)
+{
+  uint32_t *p = (uint32_t *)Buf;
+  uint32_t errors = 0U, i;
+
+  for (i = 0; i < BENCH_MEM_SIZE / 4U; i++)
+  {
+    p[i] = (i * 0x9E3779B9U) ^ (uint32_t)&p[i];
+  }
+  SCB_CleanInvalidateDCache_by_Addr((uint32_t *)Buf, BENCH_MEM_SIZE);
+  for (i = 0; i < BENCH_MEM_SIZE / 4U; i++)
+  {
+    if (p[i] != ((i * 0x9E3779B9U) ^ (uint32_t)&p[i]))
+    {
+      errors++;
+    }
+  }
+  return errors;
+}
+
+/**
+ * @brief  Bandwidth (sequential) and latency (random, one cache line per
+ *         access) of the SDRAM, AXI SRAM, DTCM and memory-mapped QSPI
+ *         flash, with CPU, MDMA and DMA2D copies. The SDRAM is measured
+ *         with the LTDC scanout stopped and running, for every SDRAM
+ *         profile; the boot profile is restored at the end.
+ *         SDRAM must be initialised, QSPI in memory-mapped mode through
+ *         the arbiter (skipped otherwise). Nothing else may use the SDRAM
+ *         meanwhile.
+ * @retval None
+ */
+XIP_FUNC void BENCH_MEM_Run(void)
+{
+  const BENCH_MEM_Region_t regions[] = {
+      {"AXI", bench_mem_axi, 1U, 1U},
+      {"DTCM", bench_mem_dtcm, 1U, 0U},
+      {"QSPI", (uint8_t *)QSPI_ARB_MMP_BASE, 0U, 1U},
+  };
+  BENCH_MEM_Region_t sdram = {"SDRAM", (uint8_t *)BENCH_SDRAM_SCRATCH_ADDR, 1U, 1U};
+  BSP_SDRAM_Profile_t boot = BSP_SDRAM_GetProfile();
+  uint32_t ltdc_on = ((LTDC->GCR & LTDC_GCR_LTDCEN) != 0U) ? 1U : 0U;
+  uint32_t i, errors;
+  BSP_SDRAM_Profile_t profile;
+
+  BENCH_Init();
+  bench_mem_shuffle();
+  printf("Memory, %lu bytes, cold D-cache\r\n", (unsigned long)BENCH_MEM_SIZE);
+
+  for (i = 0; i < (sizeof(regions) / sizeof(regions[0])); i++)
+  {
+    if ((regions[i].Buf == (uint8_t *)QSPI_ARB_MMP_BASE) && (BSP_QSPI_ArbAcquireMapped() != BSP_ERROR_NONE))
+    {
+      printf("QSPI: not memory-mapped, skipped\r\n");
+      continue;
+    }
+    bench_mem_region(&regions[i], "");
+    if (regions[i].Buf == (uint8_t *)QSPI_ARB_MMP_BASE)
+    {
+      BSP_QSPI_ArbReleaseMapped();
+    }
+  }
+
+  for (profile = SDRAM_PROFILE_CUBEMX; profile < SDRAM_PROFILE_COUNT; profile++)
+  {
+    __HAL_LTDC_DISABLE(&hltdc);
+    if (BSP_SDRAM_SetProfile(profile) != BSP_ERROR_NONE)
+    {
+      printf("SDRAM %s: switch failed\r\n", BSP_SDRAM_GetProfileName(profile));
+      continue;
+    }
+    errors = bench_mem_verify(sdram.Buf);
+    printf("SDRAM profile %s: %s (%lu bad words)\r\n", BSP_SDRAM_GetProfileName(profile),
+           (errors == 0U) ? "ok" : "CORRUPT", (unsigned long)errors);
+    if (errors != 0U)
+    {
+      continue;
+    }
+
+    bench_mem_region(&sdram, "");
+    __HAL_LTDC_ENABLE(&hltdc);
+    bench_mem_region(&sdram, "+ltdc");
+  }
+
+  __HAL_LTDC_DISABLE(&hltdc);
+  (void)BSP_SDRAM_SetProfile(boot);
+  if (ltdc_on != 0U)
+  {
+    __HAL_LTDC_ENABLE(&hltdc);
+  }
+}
@@ -0,0 +1,218 @@
+#include "bench/bench.h"
+#include "dma2d.h"
+#include "driver_conf.h"
+#include "mem_sections.h"
+#include "sw/memattr.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Draw buffer and target in the LTDC layer 1 area (not scanned out), both
+ * framebuffer class */
+#define BENCH_MEMATTR_DRAW ((uint32_t *)LCD_LAYER_1_ADDRESS)
+#define BENCH_MEMATTR_FB ((uint32_t *)(LCD_LAYER_1_ADDRESS + 0x80000U))
+#define BENCH_MEMATTR_FB_WIDTH 480U
+/* Area redrawn per flush, ARGB8888 */
+#define BENCH_MEMATTR_AREA_W 120U
+#define BENCH_MEMATTR_AREA_H 100U
+#define BENCH_MEMATTR_AREA_BYTES (BENCH_MEMATTR_AREA_W * BENCH_MEMATTR_AREA_H * 4U)
+#define BENCH_MEMATTR_FLUSHES 16U
+#define BENCH_MEMATTR_READ_SIZE 0x10000U
+/* Heap working set, reused like LVGL reuses its buffers */
+#define BENCH_MEMATTR_HEAP_SIZE 0x2000U
+#define BENCH_MEMATTR_HEAP_PASSES 8U
+#define BENCH_MEMATTR_MSG_SIZE 64U
+#define BENCH_MEMATTR_MSGS 256U
+#define BENCH_MEMATTR_TIMEOUT 100U
+
+static volatile uint32_t bench_memattr_sum;
+
+static XIP_FUNC int32_t bench_memattr_dma2d(void)
+{
+  hdma2d.Init.Mode = DMA2D_M2M;
+  hdma2d.Init.ColorMode = DMA2D_OUTPUT_ARGB8888;
+  hdma2d.Init.OutputOffset = BENCH_MEMATTR_FB_WIDTH - BENCH_MEMATTR_AREA_W;
+  hdma2d.LayerCfg[1].InputColorMode = DMA2D_INPUT_ARGB8888;
+  hdma2d.LayerCfg[1].InputOffset = 0U;
+  hdma2d.LayerCfg[1].AlphaMode = DMA2D_NO_MODIF_ALPHA;
+
+  return ((HAL_DMA2D_Init(&hdma2d) == HAL_OK) && (HAL_DMA2D_ConfigLayer(&hdma2d, 1U) == HAL_OK)) ? BSP_ERROR_NONE
+                                                                                               : BSP_ERROR_PERIPH_FAILURE;
+}
+
+/**
+ * @brief  LVGL-like flushes: the CPU renders an area into the draw buffer,
+ *         makes it visible to the DMA2D, the DMA2D copies it into the
+ *         framebuffer. Global selects the whole D-cache clean/invalidate
+ *         the display port used to do.
+ * @retval Cycles, 0 on failure
+ */
+static __attribute__((noinline)) uint32_t bench_memattr_render(uint32_t Global)
+{
+  uint32_t start, cycles = 0U, i, p;
+  int32_t ret = bench_memattr_dma2d();
+
+  SCB_CleanInvalidateDCache();
+  start = BENCH_Cycles();
+  for (i = 0; (i < BENCH_MEMATTR_FLUSHES) && (ret == BSP_ERROR_NONE); i++)
+  {
+    for (p = 0; p < BENCH_MEMATTR_AREA_W * BENCH_MEMATTR_AREA_H; p++)
+    {
+      BENCH_MEMATTR_DRAW[p] = 0xFF000000U | (p * 0x010203U) | i;
+    }
+    if (Global != 0U)
+    {
+      SCB_CleanInvalidateDCache();
+    }
+    else
+    {
+      MEMATTR_CleanRange(BENCH_MEMATTR_DRAW, BENCH_MEMATTR_AREA_BYTES);
+    }
+    if ((HAL_DMA2D_Start(&hdma2d, (uint32_t)BENCH_MEMATTR_DRAW, (uint32_t)BENCH_MEMATTR_FB, BENCH_MEMATTR_AREA_W,
+                         BENCH_MEMATTR_AREA_H) != HAL_OK) ||
+        (HAL_DMA2D_PollForTransfer(&hdma2d, BENCH_MEMATTR_TIMEOUT) != HAL_OK))
+    {
+      ret = BSP_ERROR_PERIPH_FAILURE;
+    }
+  }
+  if (ret == BSP_ERROR_NONE)
+  {
+    cycles = BENCH_Cycles() - start;
+  }
+  return cycles;
+}
+
+/**
+ * @brief  CPU reads back the framebuffer, e.g. for a screenshot or a
+ *         software blend.
+ */
+static __attribute__((noinline)) uint32_t bench_memattr_fb_read(void)
+{
+  const volatile uint32_t *p = BENCH_MEMATTR_FB;
+  uint32_t start, sum = 0U, i;
+
+  SCB_CleanInvalidateDCache();
+  start = BENCH_Cycles();
+  for (i = 0; i < BENCH_MEMATTR_READ_SIZE / 4U; i++)
+  {
+    sum += p[i];
+  }
+  bench_memattr_sum = sum;
+  return BENCH_Cycles() - start;
+}
+
+/**
+ * @brief  Small working set in the heap class written once and read back
+ *         BENCH_MEMATTR_HEAP_PASSES times.
+ */
+static __attribute__((noinline)) uint32_t bench_memattr_heap(void)
+{
+  volatile uint32_t *p = (volatile uint32_t *)BENCH_SDRAM_SCRATCH_ADDR;
+  uint32_t start, sum = 0U, i, pass;
+
+  SCB_CleanInvalidateDCache();
+  start = BENCH_Cycles();
+  for (i = 0; i < BENCH_MEMATTR_HEAP_SIZE / 4U; i++)
+  {
+    p[i] = i;
+  }
+  for (pass = 0; pass < BENCH_MEMATTR_HEAP_PASSES; pass++)
+  {
+    for (i = 0; i < BENCH_MEMATTR_HEAP_SIZE / 4U; i++)
+    {
+      sum += p[i];
+    }
+  }
+  bench_memattr_sum = sum;
+  return BENCH_Cycles() - start;
+}
+
+/**
+ * @brief  Mailbox round trips in the shared class: the sender writes a
+ *         message and publishes it, the receiver drops stale lines and
+ *         reads it. Both sides run here, the cost is the CPU side of one
+ *         exchange.
+ */
+static __attribute__((noinline)) uint32_t bench_memattr_mailbox(void)
+{
+  volatile uint32_t *msg = (volatile uint32_t *)MEMATTR_SHARED_BASE;
+  uint32_t start, sum = 0U, i, w;
+
+  SCB_CleanInvalidateDCache();
+  start = BENCH_Cycles();
+  for (i = 0; i < BENCH_MEMATTR_MSGS; i++)
+  {
+    for (w = 0; w < BENCH_MEMATTR_MSG_SIZE / 4U; w++)
+    {
+      msg[w] = i + w;
+    }
+    MEMATTR_CleanRange((const void *)msg, BENCH_MEMATTR_MSG_SIZE);
+    MEMATTR_InvalidateRange((void *)msg, BENCH_MEMATTR_MSG_SIZE);
+    for (w = 0; w < BENCH_MEMATTR_MSG_SIZE / 4U; w++)
+    {
+      sum += msg[w];
+    }
+  }
+  bench_memattr_sum = sum;
+  return BENCH_Cycles() - start;
+}
+
+/**
+ * @brief  Every memory attribute profile on the workloads its region
+ *         classes see: display flushes (range clean against the old
+ *         whole-cache flush), framebuffer read-back, heap reuse and
+ *         inter-core mailbox exchanges. The boot profile is restored.
+ *         SDRAM must be initialised; the LTDC layer 1 area, the scratch
+ *         area and the SRAM3 mailboxes are overwritten, the CM4 must not
+ *         use them meanwhile.
+ * @retval None
+ */
+XIP_FUNC void BENCH_MEMATTR_Run(void)
+{
+  MEMATTR_Profile_t boot = MEMATTR_GetProfile();
+  MEMATTR_Profile_t profile;
+  char name[40];
+  uint32_t cycles;
+  const char *pname;
+
+  BENCH_Init();
+  printf("Memory attribute profiles, boot profile %s\r\n", MEMATTR_GetProfileName(boot));
+
+  for (profile = MEMATTR_PROFILE_CUBEMX; profile < MEMATTR_PROFILE_COUNT; profile++)
+  {
+    if (MEMATTR_SetProfile(profile) != BSP_ERROR_NONE)
+    {
+      continue;
+    }
+    pname = MEMATTR_GetProfileName(profile);
+
+    snprintf(name, sizeof(name), "%s flush", pname);
+    cycles = bench_memattr_render(0U);
+    if (cycles != 0U)
+    {
+      BENCH_PrintThroughput(name, BENCH_MEMATTR_FLUSHES * BENCH_MEMATTR_AREA_BYTES, cycles);
+    }
+    else
+    {
+      printf("%s: failed\r\n", name);
+    }
+    snprintf(name, sizeof(name), "%s flush+global", pname);
+    cycles = bench_memattr_render(1U);
+    if (cycles != 0U)
+    {
+      BENCH_PrintThroughput(name, BENCH_MEMATTR_FLUSHES * BENCH_MEMATTR_AREA_BYTES, cycles);
+    }
+    else
+    {
+      printf("%s: failed\r\n", name);
+    }
+
+    snprintf(name, sizeof(name), "%s fb read", pname);
+    BENCH_PrintThroughput(name, BENCH_MEMATTR_READ_SIZE, bench_memattr_fb_read());
+    snprintf(name, sizeof(name), "%s heap reuse", pname);
+    BENCH_PrintThroughput(name, BENCH_MEMATTR_HEAP_SIZE * (BENCH_MEMATTR_HEAP_PASSES + 1U), bench_memattr_heap());
+    snprintf(name, sizeof(name), "%s mailbox", pname);
+    BENCH_PrintThroughput(name, BENCH_MEMATTR_MSGS * BENCH_MEMATTR_MSG_SIZE * 2U, bench_memattr_mailbox());
+  }
+
+  (void)MEMATTR_SetProfile(boot);
+}
@@ -0,0 +1,91 @@
+#include "bench/bench.h"
+#include "driver/qspi.h"
+#include <stdio.h>
+
+#define BENCH_QSPI_SIZE (256U * 1024U)
+#define BENCH_QSPI_ADDR 0x00000000U
+
+typedef struct
+{
+  const char *Name;
+  BSP_QSPI_Interface_t Mode;
+  BSP_QSPI_Transfer_t Rate;
+} BENCH_QSPI_Config_t;
+
+static const BENCH_QSPI_Config_t bench_qspi_configs[] = {
+    {"SPI 1-1-1 STR", BSP_QSPI_SPI_MODE, BSP_QSPI_STR_TRANSFER},
+    {"SPI 1-1-1 DTR", BSP_QSPI_SPI_MODE, BSP_QSPI_DTR_TRANSFER},
+    {"SPI 1-4-4 STR", BSP_QSPI_SPI_4IO_MODE, BSP_QSPI_STR_TRANSFER},
+    {"SPI 1-4-4 DTR", BSP_QSPI_SPI_4IO_MODE, BSP_QSPI_DTR_TRANSFER},
+    {"QPI 4-4-4 STR", BSP_QSPI_QPI_MODE, BSP_QSPI_STR_TRANSFER},
+    {"QPI 4-4-4 DTR", BSP_QSPI_QPI_MODE, BSP_QSPI_DTR_TRANSFER},
+};
+
+static volatile int32_t bench_qspi_status;
+static volatile uint32_t bench_qspi_done;
+
+static void bench_qspi_cplt(int32_t Status, void *Context)
+{
+  (void)Context;
+  bench_qspi_status = Status;
+  bench_qspi_done = BENCH_Cycles();
+}
+
+/**
+ * @brief  Measure indirect read throughput of the MT25TL01G pair for every
+ *         interface mode / transfer rate, blocking vs MDMA, into SDRAM.
+ *         QSPI must be in indirect mode and SDRAM initialised.
+ * @retval None
+ */
+void BENCH_QSPI_Run(void)
+{
+  uint8_t *dst = (uint8_t *)BENCH_SDRAM_SCRATCH_ADDR;
+  BSP_QSPI_Interface_t mode = QSPI_Ctx.InterfaceMode;
+  BSP_QSPI_Transfer_t rate = QSPI_Ctx.TransferRate;
+  uint32_t start, cycles;
+  uint32_t i;
+
+  BENCH_Init();
+  printf("QSPI read, %lu bytes\r\n", (unsigned long)BENCH_QSPI_SIZE);
+
+  for (i = 0; i < (sizeof(bench_qspi_configs) / sizeof(bench_qspi_configs[0])); i++)
+  {
+    const BENCH_QSPI_Config_t *cfg = &bench_qspi_configs[i];
+    char name[32];
+
+    if (BSP_QSPI_ConfigFlash(cfg->Mode, cfg->Rate) != BSP_ERROR_NONE)
+    {
+      printf("%s: config failed\r\n", cfg->Name);
+      continue;
+    }
+
+    start = BENCH_Cycles();
+    if (BSP_QSPI_Read(dst, BENCH_QSPI_ADDR, BENCH_QSPI_SIZE) == BSP_ERROR_NONE)
+    {
+      cycles = BENCH_Cycles() - start;
+      snprintf(name, sizeof(name), "%s poll", cfg->Name);
+      BENCH_PrintThroughput(name, BENCH_QSPI_SIZE, cycles);
+    }
+
+    bench_qspi_done = 0U;
+    start = BENCH_Cycles();
+    if (BSP_QSPI_Read_DMA(dst, BENCH_QSPI_ADDR, BENCH_QSPI_SIZE, bench_qspi_cplt, NULL) == BSP_ERROR_NONE)
+    {
+      while (BSP_QSPI_GetTransferState() == BSP_ERROR_BUSY)
+      {
+      }
+      cycles = bench_qspi_done - start;
+      snprintf(name, sizeof(name), "%s mdma", cfg->Name);
+      if (bench_qspi_status == BSP_ERROR_NONE)
+      {
+        BENCH_PrintThroughput(name, BENCH_QSPI_SIZE, cycles);
+      }
+      else
+      {
+        printf("%s: error %ld\r\n", name, (long)bench_qspi_status);
+      }
+    }
+  }
+
+  BSP_QSPI_ConfigFlash(mode, rate);
+}
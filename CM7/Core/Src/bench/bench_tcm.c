@@ -0,0 +1,100 @@
+#include "bench/bench.h"
+#include "mem_sections.h"
+#include <stdio.h>
+
+/* One line of the 480 px display, ARGB8888 */
+#define BENCH_TCM_PIXELS 480U
+#define BENCH_TCM_RUNS 64U
+
+typedef void (*BENCH_TCM_Blend_t)(uint32_t *pDst, const uint32_t *pSrc, uint32_t Count);
+
+static uint32_t bench_tcm_axi[2][BENCH_TCM_PIXELS];
+static DTCM_BSS uint32_t bench_tcm_dtcm[2][BENCH_TCM_PIXELS];
+static D2_BSS uint32_t bench_tcm_d2[2][BENCH_TCM_PIXELS];
+
+/**
+ * @brief  Source-over blend of an ARGB8888 line, the inner loop of the LVGL
+ *         software renderer. Inlined in each placement below.
+ */
+static inline __attribute__((always_inline)) void bench_tcm_blend(uint32_t *pDst, const uint32_t *pSrc,
+                                                                  uint32_t Count)
+{
+  uint32_t s, d, a, rb, g;
+
+  while (Count-- != 0U)
+  {
+    s = *pSrc++;
+    d = *pDst;
+    a = s >> 24;
+    rb = (((s & 0x00FF00FFU) * a) + ((d & 0x00FF00FFU) * (255U - a))) >> 8;
+    g = (((s & 0x0000FF00U) * a) + ((d & 0x0000FF00U) * (255U - a))) >> 8;
+    *pDst++ = 0xFF000000U | (rb & 0x00FF00FFU) | (g & 0x0000FF00U);
+  }
+}
+
+static __attribute__((noinline)) void bench_tcm_blend_flash(uint32_t *pDst, const uint32_t *pSrc, uint32_t Count)
+{
+  bench_tcm_blend(pDst, pSrc, Count);
+}
+
+static ITCM_FUNC void bench_tcm_blend_itcm(uint32_t *pDst, const uint32_t *pSrc, uint32_t Count)
+{
+  bench_tcm_blend(pDst, pSrc, Count);
+}
+
+/**
+ * @brief  Run Blend on a line and print the best and the cold (caches
+ *         invalidated) cycle counts.
+ */
+static XIP_FUNC void bench_tcm_measure(const char *Name, BENCH_TCM_Blend_t Blend, uint32_t (*Buffers)[BENCH_TCM_PIXELS])
+{
+  uint32_t start, cycles, cold, best = UINT32_MAX;
+  uint32_t i;
+
+  for (i = 0; i < BENCH_TCM_PIXELS; i++)
+  {
+    Buffers[0][i] = 0x80000000U | (i * 0x010203U);
+    Buffers[1][i] = 0xFF404040U;
+  }
+
+  SCB_CleanInvalidateDCache();
+  SCB_InvalidateICache();
+  start = BENCH_Cycles();
+  Blend(Buffers[1], Buffers[0], BENCH_TCM_PIXELS);
+  cold = BENCH_Cycles() - start;
+
+  for (i = 0; i < BENCH_TCM_RUNS; i++)
+  {
+    start = BENCH_Cycles();
+    Blend(Buffers[1], Buffers[0], BENCH_TCM_PIXELS);
+    cycles = BENCH_Cycles() - start;
+    if (cycles < best)
+    {
+      best = cycles;
+    }
+  }
+
+  printf("%-24s cold %6lu warm %6lu cycles, %3lu.%02lu cyc/px\r\n", Name, (unsigned long)cold, (unsigned long)best,
+         (unsigned long)(best / BENCH_TCM_PIXELS), (unsigned long)((best * 100U / BENCH_TCM_PIXELS) % 100U));
+}
+
+/**
+ * @brief  Cycle counts of an ARGB8888 blend line with the code in flash or
+ *         in the ITCM and the pixels in AXI SRAM, DTCM, D2 SRAM or SDRAM.
+ *         SDRAM must be initialised.
+ * @retval None
+ */
+XIP_FUNC void BENCH_TCM_Run(void)
+{
+  uint32_t(*sdram)[BENCH_TCM_PIXELS] = (uint32_t(*)[BENCH_TCM_PIXELS])BENCH_SDRAM_SCRATCH_ADDR;
+
+  BENCH_Init();
+  printf("ARGB8888 blend, %lu px\r\n", (unsigned long)BENCH_TCM_PIXELS);
+
+  bench_tcm_measure("flash code, AXI data", bench_tcm_blend_flash, bench_tcm_axi);
+  bench_tcm_measure("flash code, DTCM data", bench_tcm_blend_flash, bench_tcm_dtcm);
+  bench_tcm_measure("ITCM code, AXI data", bench_tcm_blend_itcm, bench_tcm_axi);
+  bench_tcm_measure("ITCM code, DTCM data", bench_tcm_blend_itcm, bench_tcm_dtcm);
+  bench_tcm_measure("ITCM code, D2 data", bench_tcm_blend_itcm, bench_tcm_d2);
+  bench_tcm_measure("ITCM code, SDRAM data", bench_tcm_blend_itcm, sdram);
+}
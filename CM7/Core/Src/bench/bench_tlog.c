@@ -0,0 +1,63 @@
+#include "bench/bench.h"
+#include "driver/qspi_arb.h"
+#include "sw/tlog.h"
+#include <stdio.h>
+
+/* Length of the saturation run */
+#define BENCH_TLOG_MS 2000U
+/* Payload of one sample, a CAN frame */
+#define BENCH_TLOG_DATA 8U
+/* Channel of the bench records, outside the message indexes */
+#define BENCH_TLOG_CHANNEL 0xFFFFU
+
+extern uint64_t __time_uptime(void);
+
+/**
+ * @brief  Sustained telemetry log throughput on the MT25TL01G, through the
+ *         QSPI arbiter and scheduler as in the main loop: samples are
+ *         appended faster than the flash takes them for BENCH_TLOG_MS, the
+ *         pages programmed meanwhile give the rate. The records land in the
+ *         mounted log, on channel BENCH_TLOG_CHANNEL. TLOG_Init() on
+ *         TLOG_QSPI_Flash and BSP_QSPI_ArbInit() must have run.
+ * @retval None
+ */
+void BENCH_TLOG_Run(void)
+{
+  uint8_t data[BENCH_TLOG_DATA] = {0};
+  TLOG_Stats_t before, after;
+  BSP_QSPI_ArbStats_t arb_before, arb_after;
+  BSP_QSPI_SchedStats_t sched;
+  uint32_t start, cycles, tick, pages, windows, us, per_page;
+
+  BENCH_Init();
+  TLOG_GetStats(&before);
+  BSP_QSPI_ArbGetStats(&arb_before);
+
+  start = BENCH_Cycles();
+  tick = HAL_GetTick();
+  while ((HAL_GetTick() - tick) < BENCH_TLOG_MS)
+  {
+    data[0]++;
+    (void)TLOG_Append(BENCH_TLOG_CHANNEL, (uint32_t)__time_uptime(), data, sizeof(data));
+    (void)BSP_QSPI_ArbProcess();
+    (void)TLOG_Process();
+  }
+  cycles = BENCH_Cycles() - start;
+
+  TLOG_GetStats(&after);
+  BSP_QSPI_ArbGetStats(&arb_after);
+  BSP_QSPI_SchedGetStats(&sched);
+  pages = after.Pages - before.Pages;
+  windows = arb_after.Windows - arb_before.Windows;
+  us = BENCH_CyclesToUs(cycles);
+  per_page = (TLOG_PAGE_SIZE - sizeof(TLOG_PageHeader_t)) / (sizeof(TLOG_RecordHeader_t) + BENCH_TLOG_DATA);
+
+  printf("TLOG through the QSPI arbiter, %lu B samples\r\n", (unsigned long)BENCH_TLOG_DATA);
+  BENCH_PrintThroughput("tlog pages", pages * TLOG_PAGE_SIZE, cycles);
+  printf("%lu pages/s, %lu samples/s, %lu erases, %lu windows, %lu pages/window, stage high %lu, %lu flash errors\r\n",
+         (unsigned long)((us == 0U) ? 0U : (uint32_t)(((uint64_t)pages * 1000000U) / us)),
+         (unsigned long)((us == 0U) ? 0U : (uint32_t)(((uint64_t)pages * per_page * 1000000U) / us)),
+         (unsigned long)(after.Erases - before.Erases), (unsigned long)windows,
+         (unsigned long)((windows == 0U) ? 0U : (pages / windows)), (unsigned long)after.StageHigh,
+         (unsigned long)sched.Errors);
+}
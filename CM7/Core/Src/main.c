@@ -18,9 +18,7 @@
 /* USER CODE END Header */
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
-#include "adc.h"
 #include "dma2d.h"
-#include "fdcan.h"
 #include "i2c.h"
 #include "ltdc.h"
 #include "mdma.h"
@@ -34,10 +32,25 @@
 /* USER CODE BEGIN Includes */
 #include <stdio.h>
 #include "driver/qspi.h"
+#include "driver/mdma_copy.h"
+#include "driver/qspi_arb.h"
+#include "driver/sdram.h"
+#include "driver/ts.h"
 #include "lvgl/lvgl.h"
 #include "lvgl/demos/lv_demos.h"
 #include "sw/lvgl_port_lcd.h"
 #include "sw/lvgl_port_touchpad.h"
+#include "sw/lvgl_port_gesture.h"
+#include "sw/boot.h"
+#include "sw/can_page.h"
+#include "sw/leds.h"
+#include "sw/memattr.h"
+#include "sw/splash.h"
+#include "sw/tlog.h"
+#include "sw/tlog_qspi.h"
+#include "sw/vstate_log.h"
+#include "ipc.h"
+#include "vstate.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -61,7 +74,10 @@
 /* Private variables ---------------------------------------------------------*/
 
 /* USER CODE BEGIN PV */
-
+/* System time of the last vehicle state snapshot and the local tick it was
+ * taken at, __time_uptime() goes on from them */
+static uint64_t uptime_base_ms;
+static uint32_t uptime_base_tick;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -69,6 +85,11 @@ void SystemClock_Config(void);
 void PeriphCommonClock_Config(void);
 static void MPU_Config(void);
 /* USER CODE BEGIN PFP */
+static void QSPI_Start(void);
+static void Uptime_Sync(void);
+#ifdef XIP_COLD_CODE
+static void XIP_Init(void);
+#endif
 
 /* USER CODE END PFP */
 
@@ -89,7 +110,9 @@ int __io_getchar(void)
 
 uint64_t __time_uptime(void)
 {
-  return HAL_GetTick();
+  /* Milliseconds of the system timebase, BSP_CAN_GetTimeUs() on the CM4:
+   * the time of the last snapshot plus the local ticks since */
+  return uptime_base_ms + (uint32_t)(HAL_GetTick() - uptime_base_tick);
 }
 /* USER CODE END 0 */
 
@@ -100,7 +123,9 @@ uint64_t __time_uptime(void)
 int main(void)
 {
   /* USER CODE BEGIN 1 */
+  BOOT_Mode_t boot_mode;
 
+  BOOT_Init();
   /* USER CODE END 1 */
 /* USER CODE BEGIN Boot_Mode_Sequence_0 */
   int32_t timeout;
@@ -123,6 +148,7 @@ int main(void)
   {
   Error_Handler();
   }
+  BOOT_Mark("MPU, caches, CM4 stop");
 /* USER CODE END Boot_Mode_Sequence_1 */
   /* MCU Configuration--------------------------------------------------------*/
 
@@ -130,7 +156,7 @@ int main(void)
   HAL_Init();
 
   /* USER CODE BEGIN Init */
-
+  BOOT_Mark("HAL_Init");
   /* USER CODE END Init */
 
   /* Configure the system clock */
@@ -143,6 +169,11 @@ int main(void)
 HSEM notification */
 /*HW semaphore Clock enable*/
 __HAL_RCC_HSEM_CLK_ENABLE();
+/* Inter-core rings cleared while the CM4 still waits */
+if (IPC_Init() != BSP_ERROR_NONE)
+{
+Error_Handler();
+}
 /*Take HSEM */
 HAL_HSEM_FastTake(HSEM_ID_0);
 /*Release HSEM in order to notify the CPU2(CM4)*/
@@ -154,10 +185,13 @@ if ( timeout < 0 )
 {
 Error_Handler();
 }
+BOOT_Mark("clocks, CM4 wake-up");
 /* USER CODE END Boot_Mode_Sequence_2 */
 
   /* USER CODE BEGIN SysInit */
-
+  /* Per-class cache policies over the single SDRAM region of MPU_Config() */
+  (void)MEMATTR_SetProfile(MEMATTR_BOOT_PROFILE);
+  boot_mode = BOOT_Start();
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
@@ -170,35 +204,86 @@ Error_Handler();
   MX_DMA2D_Init();
   MX_TIM8_Init();
   MX_USART3_UART_Init();
-  MX_ADC1_Init();
-  MX_ADC2_Init();
-  MX_ADC3_Init();
-  MX_FDCAN1_Init();
-  MX_FDCAN2_Init();
-  MX_TIM1_Init();
-  MX_TIM2_Init();
   MX_TIM3_Init();
   MX_TIM4_Init();
   /* USER CODE BEGIN 2 */
+  if (BSP_MDMA_CopyInit() != BSP_ERROR_NONE)
+  {
+    Error_Handler();
+  }
+  BOOT_Mark("MX_*_Init");
 
-  // BSP_QSPI_Init_t qspi_init;
-  // qspi_init.InterfaceMode = MT25TL01G_QPI_MODE;
-  // qspi_init.TransferRate = MT25TL01G_DTR_TRANSFER;
-  // qspi_init.DualFlashMode = MT25TL01G_DUALFLASH_ENABLE;
-  // BSP_QSPI_Init(&qspi_init);
-  // BSP_QSPI_EnableMemoryMappedMode(0);
+  if (boot_mode == BOOT_MODE_WARM)
+  {
+    /* Watchdog or fault reset: the SDRAM kept the last frame, it goes back
+     * on screen as soon as the refresh runs again */
+    if ((BSP_SDRAM_WarmInit() != BSP_ERROR_NONE) ||
+        (SPLASH_Resume(BOOT_GetFramebuffer(), SPLASH_BRIGHTNESS) != BSP_ERROR_NONE))
+    {
+      Error_Handler();
+    }
+    BOOT_Mark("SDRAM, last frame (warm)");
+    /* The cold code is reachable from here on, the SDRAM could not wait */
+    QSPI_Start();
+    BOOT_Mark("QSPI");
+  }
+  else
+  {
+    /* The QSPI mapping first, the cold code is reachable from here on.
+     * Then the picture: the LTDC already scans layer 0, the backlight
+     * stays off until the splash is in the framebuffer */
+    QSPI_Start();
+    BOOT_Mark("QSPI");
+    if (BSP_SDRAM_Init() != BSP_ERROR_NONE)
+    {
+      Error_Handler();
+    }
+    BOOT_Mark("SDRAM");
+    (void)SPLASH_Show(SPLASH_ASSET_NAME, SPLASH_BRIGHTNESS);
+    BOOT_Mark("splash, backlight");
+  }
+
+  /* Telemetry log in the QSPI flash past the code and assets, through the
+   * arbiter started by QSPI_Start() */
+  if (TLOG_Init(&TLOG_QSPI_Flash) != BSP_ERROR_NONE)
+  {
+    Error_Handler();
+  }
+  BOOT_Mark("telemetry log");
+
+  /* CAN, ADC and tachometers run on the CM4, the vehicle state comes
+   * through the SRAM3 snapshot */
+  VSTATE_Init();
+  if (LEDS_Init() != BSP_ERROR_NONE)
+  {
+    Error_Handler();
+  }
+  /* The frames to log come from the CM4 over the inter-core ring */
+  VSTATE_LOG_Init();
+  BOOT_Mark("vehicle state, LEDs");
 
   // lv_init();
   // LCD_Init();
   // TS_Init();
   // lv_demo_widgets();
-  // printf("Hello World!\n");
+  // CAN_PAGE_Create(lv_scr_act());
+  BOOT_Ready(hltdc.LayerCfg[0].FBStartAdress);
+  BOOT_Report();
   /* USER CODE END 2 */
 
   /* Infinite loop */
   /* USER CODE BEGIN WHILE */
   while (1)
   {
+    BOOT_WatchdogRefresh();
+    if (VSTATE_Refresh() != 0U)
+    {
+      Uptime_Sync();
+    }
+    LEDS_Process();
+    VSTATE_LOG_Process();
+    (void)TLOG_Process();
+    (void)BSP_QSPI_ArbProcess();
 		// lv_task_handler();
 		// HAL_Delay(5);
     /* USER CODE END WHILE */
@@ -296,7 +381,78 @@ void PeriphCommonClock_Config(void)
 }
 
 /* USER CODE BEGIN 4 */
+/**
+  * @brief  Initialises the QSPI flash and puts it in memory-mapped mode
+  *         through the arbiter.
+  * @retval None
+  */
+static void QSPI_Start(void)
+{
+  BSP_QSPI_Init_t qspi_init;
+
+  qspi_init.InterfaceMode = MT25TL01G_QPI_MODE;
+  qspi_init.TransferRate = MT25TL01G_DTR_TRANSFER;
+  qspi_init.DualFlashMode = MT25TL01G_DUALFLASH_ENABLE;
+  if (BSP_QSPI_Init(&qspi_init) != BSP_ERROR_NONE || BSP_QSPI_ArbInit() != BSP_ERROR_NONE)
+  {
+    Error_Handler();
+  }
+
+#ifdef XIP_COLD_CODE
+  /* Cold code runs from the QSPI flash, map it before anything calls it.
+   * Not sooner: a cacheable region over a flash that is not memory-mapped
+   * yet invites speculative reads. */
+  XIP_Init();
+#endif
+}
 
+/**
+  * @brief  Rebases __time_uptime() on the system time of the snapshot just
+  *         taken by VSTATE_Refresh().
+  * @retval None
+  */
+static void Uptime_Sync(void)
+{
+  uptime_base_ms = VSTATE_Get()->TimeUs / 1000U;
+  uptime_base_tick = HAL_GetTick();
+}
+
+#ifdef XIP_COLD_CODE
+/**
+  * @brief  Makes the code area of the memory-mapped QSPI flash (first 16 MB,
+  *         QSPI region of the linker script) executable.
+  * @retval None
+  */
+static void XIP_Init(void)
+{
+  MPU_Region_InitTypeDef MPU_InitStruct = {0};
+
+  /* Overrides region 2 (128 MB, no execute) on the code area. Not shareable
+   * so that the lines are cached, read-only to catch stray writes. */
+  HAL_MPU_Disable();
+  MPU_InitStruct.Enable = MPU_REGION_ENABLE;
+  MPU_InitStruct.Number = MPU_REGION_NUMBER3;
+  MPU_InitStruct.BaseAddress = 0x90000000;
+  MPU_InitStruct.Size = MPU_REGION_SIZE_16MB;
+  MPU_InitStruct.SubRegionDisable = 0x0;
+  MPU_InitStruct.TypeExtField = MPU_TEX_LEVEL1;
+  MPU_InitStruct.AccessPermission = MPU_REGION_PRIV_RO;
+  MPU_InitStruct.DisableExec = MPU_INSTRUCTION_ACCESS_ENABLE;
+  MPU_InitStruct.IsShareable = MPU_ACCESS_NOT_SHAREABLE;
+  MPU_InitStruct.IsCacheable = MPU_ACCESS_CACHEABLE;
+  MPU_InitStruct.IsBufferable = MPU_ACCESS_BUFFERABLE;
+  HAL_MPU_ConfigRegion(&MPU_InitStruct);
+  HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+}
+#endif
+
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+  if (GPIO_Pin == LCD_INT_Pin)
+  {
+    BSP_TS_IRQHandler();
+  }
+}
 /* USER CODE END 4 */
 
 /* MPU Configuration */
@@ -362,6 +518,11 @@ void Error_Handler(void)
   /* USER CODE BEGIN Error_Handler_Debug */
   /* User can add his own implementation to report the HAL error return state */
   __disable_irq();
+  /* Once booted, start again warm on the last frame */
+  if (BOOT_IsReady() != 0U)
+  {
+    BOOT_WarmReset();
+  }
   while (1)
   {
   }
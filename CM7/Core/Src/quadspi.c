@@ -21,7 +21,7 @@
 #include "quadspi.h"
 
 /* USER CODE BEGIN 0 */
-
+MDMA_HandleTypeDef hmdma_quadspi_fifo_th;
 /* USER CODE END 0 */
 
 QSPI_HandleTypeDef hqspi;
@@ -50,7 +50,11 @@ void MX_QUADSPI_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN QUADSPI_Init 2 */
-
+  /* MDMA moves one FIFO threshold worth of bytes per request */
+  if (HAL_QSPI_SetFifoThreshold(&hqspi, 4) != HAL_OK)
+  {
+    Error_Handler();
+  }
   /* USER CODE END QUADSPI_Init 2 */
 
 }
@@ -140,7 +144,28 @@ void HAL_QSPI_MspInit(QSPI_HandleTypeDef* qspiHandle)
     HAL_NVIC_SetPriority(QUADSPI_IRQn, 15, 0);
     HAL_NVIC_EnableIRQ(QUADSPI_IRQn);
   /* USER CODE BEGIN QUADSPI_MspInit 1 */
+    /* QUADSPI MDMA Init, clock is enabled by MX_MDMA_Init() */
+    hmdma_quadspi_fifo_th.Instance = MDMA_Channel1;
+    hmdma_quadspi_fifo_th.Init.Request = MDMA_REQUEST_QUADSPI_FIFO_TH;
+    hmdma_quadspi_fifo_th.Init.TransferTriggerMode = MDMA_BUFFER_TRANSFER;
+    hmdma_quadspi_fifo_th.Init.Priority = MDMA_PRIORITY_HIGH;
+    hmdma_quadspi_fifo_th.Init.Endianness = MDMA_LITTLE_ENDIANNESS_PRESERVE;
+    hmdma_quadspi_fifo_th.Init.SourceInc = MDMA_SRC_INC_DISABLE;
+    hmdma_quadspi_fifo_th.Init.DestinationInc = MDMA_DEST_INC_BYTE;
+    hmdma_quadspi_fifo_th.Init.SourceDataSize = MDMA_SRC_DATASIZE_BYTE;
+    hmdma_quadspi_fifo_th.Init.DestDataSize = MDMA_DEST_DATASIZE_BYTE;
+    hmdma_quadspi_fifo_th.Init.DataAlignment = MDMA_DATAALIGN_PACKENABLE;
+    hmdma_quadspi_fifo_th.Init.BufferTransferLength = 4;
+    hmdma_quadspi_fifo_th.Init.SourceBurst = MDMA_SOURCE_BURST_SINGLE;
+    hmdma_quadspi_fifo_th.Init.DestBurst = MDMA_DEST_BURST_SINGLE;
+    hmdma_quadspi_fifo_th.Init.SourceBlockAddressOffset = 0;
+    hmdma_quadspi_fifo_th.Init.DestBlockAddressOffset = 0;
+    if (HAL_MDMA_Init(&hmdma_quadspi_fifo_th) != HAL_OK)
+    {
+      Error_Handler();
+    }
 
+    __HAL_LINKDMA(qspiHandle,hmdma,hmdma_quadspi_fifo_th);
   /* USER CODE END QUADSPI_MspInit 1 */
   }
 }
@@ -179,7 +204,7 @@ void HAL_QSPI_MspDeInit(QSPI_HandleTypeDef* qspiHandle)
     /* QUADSPI interrupt Deinit */
     HAL_NVIC_DisableIRQ(QUADSPI_IRQn);
   /* USER CODE BEGIN QUADSPI_MspDeInit 1 */
-
+    HAL_MDMA_DeInit(qspiHandle->hmdma);
   /* USER CODE END QUADSPI_MspDeInit 1 */
   }
 }
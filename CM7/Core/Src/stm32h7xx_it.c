@@ -22,7 +22,9 @@
 #include "stm32h7xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "ipc.h"
 #include "lvgl/lvgl.h"
+#include "sw/boot.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -59,7 +61,7 @@
 extern MDMA_HandleTypeDef hmdma_mdma_channel40_sw_0;
 extern QSPI_HandleTypeDef hqspi;
 /* USER CODE BEGIN EV */
-
+extern MDMA_HandleTypeDef hmdma_quadspi_fifo_th;
 /* USER CODE END EV */
 
 /******************************************************************************/
@@ -86,7 +88,11 @@ void NMI_Handler(void)
 void HardFault_Handler(void)
 {
   /* USER CODE BEGIN HardFault_IRQn 0 */
-
+  /* Once booted, start again warm on the last frame */
+  if (BOOT_IsReady() != 0U)
+  {
+    BOOT_WarmReset();
+  }
   /* USER CODE END HardFault_IRQn 0 */
   while (1)
   {
@@ -238,10 +244,18 @@ void MDMA_IRQHandler(void)
   /* USER CODE END MDMA_IRQn 0 */
   HAL_MDMA_IRQHandler(&hmdma_mdma_channel40_sw_0);
   /* USER CODE BEGIN MDMA_IRQn 1 */
+  HAL_MDMA_IRQHandler(&hmdma_quadspi_fifo_th);
 
   /* USER CODE END MDMA_IRQn 1 */
 }
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles HSEM1 global interrupt, the inter-core doorbell.
+  */
+void HSEM1_IRQHandler(void)
+{
+  IPC_IRQHandler();
+}
 
 /* USER CODE END 1 */
@@ -0,0 +1,360 @@
+#include "sw/asset.h"
+
+#include <string.h>
+
+#include "driver/qspi_arb.h"
+#include "mem_sections.h"
+#include "sw/lz4.h"
+
+/*
+ * Compressed asset store on the QSPI flash.
+ *
+ * The pack index is read once by ASSET_Init(). ASSET_Load() decodes an asset
+ * into the SDRAM cache the first time it is asked for and hands out the
+ * cached copy afterwards. Decoding streams the compressed blocks with the
+ * QSPI MDMA into two internal buffers: block n+1 is in flight while the CPU
+ * decompresses block n into SDRAM, so the flash read time hides behind the
+ * decompression.
+ *
+ * The cache is a bump allocator: when it is full, ASSET_CacheReset() drops
+ * every asset at once (e.g. on a theme change).
+ */
+
+#define ASSET_ALIGN 32U /* D-cache line, required by BSP_QSPI_Read_DMA() */
+
+typedef struct
+{
+  uint32_t PackAddr;
+  uint32_t Count;
+  ASSET_Entry_t Entries[ASSET_MAX_ENTRIES];
+  uint8_t *Cached[ASSET_MAX_ENTRIES];
+  uint32_t CacheUsed;
+  ASSET_Stats_t Stats;
+} ASSET_Ctx_t;
+
+static ASSET_Ctx_t ASSET_Ctx;
+
+/* Compressed block double buffer, filled by MDMA */
+static D2_BSS uint8_t ASSET_Buffer[2][ASSET_BLOCK_SIZE];
+static D2_BSS uint32_t ASSET_Table[ASSET_MAX_BLOCKS];
+
+static volatile uint32_t ASSET_ReadDone;
+static volatile int32_t ASSET_ReadStatus;
+
+static void ASSET_ReadCplt(int32_t Status, void *Context);
+static int32_t ASSET_ReadStart(uint8_t *pData, uint32_t Addr, uint32_t Size);
+static int32_t ASSET_ReadWait(void);
+static int32_t ASSET_DecodeLz4(const ASSET_Entry_t *Entry, uint8_t *pDst);
+
+/**
+ * @brief  Reads the pack index and empties the cache.
+ * @param  PackAddr Flash address of the pack, usually ASSET_QSPI_BASE
+ * @retval BSP status
+ */
+int32_t ASSET_Init(uint32_t PackAddr)
+{
+  int32_t ret;
+  ASSET_PackHeader_t header;
+
+  memset(&ASSET_Ctx, 0, sizeof(ASSET_Ctx));
+  ASSET_Ctx.PackAddr = PackAddr;
+
+  ret = BSP_QSPI_ArbRead((uint8_t *)&header, PackAddr, sizeof(header));
+  if (ret == BSP_ERROR_NONE)
+  {
+    if (header.Magic != ASSET_MAGIC || header.Version != ASSET_VERSION || header.Count > ASSET_MAX_ENTRIES)
+    {
+      ret = BSP_ERROR_WRONG_PARAM;
+    }
+    else
+    {
+      ret = BSP_QSPI_ArbRead((uint8_t *)ASSET_Ctx.Entries, PackAddr + sizeof(header),
+                             header.Count * sizeof(ASSET_Entry_t));
+      if (ret == BSP_ERROR_NONE)
+      {
+        ASSET_Ctx.Count = header.Count;
+      }
+    }
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Number of assets in the pack.
+ */
+uint32_t ASSET_GetCount(void)
+{
+  return ASSET_Ctx.Count;
+}
+
+/**
+ * @brief  Index entry of an asset, Index below ASSET_GetCount().
+ */
+const ASSET_Entry_t *ASSET_GetEntry(uint32_t Index)
+{
+  return &ASSET_Ctx.Entries[Index];
+}
+
+/**
+ * @brief  Looks an asset up by name.
+ * @param  Name  Name given to the packer
+ * @param  Entry Set to the index entry
+ * @retval BSP status, BSP_ERROR_WRONG_PARAM if there is no such asset
+ */
+int32_t ASSET_Find(const char *Name, const ASSET_Entry_t **Entry)
+{
+  int32_t ret = BSP_ERROR_WRONG_PARAM;
+  uint32_t i;
+
+  for (i = 0; i < ASSET_Ctx.Count; i++)
+  {
+    if (strncmp(ASSET_Ctx.Entries[i].Name, Name, ASSET_NAME_MAX) == 0)
+    {
+      *Entry = &ASSET_Ctx.Entries[i];
+      ret = BSP_ERROR_NONE;
+      break;
+    }
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Decodes an asset to memory, bypassing the cache. The flash is
+ *         leased in indirect mode for the duration (see qspi_arb.h).
+ * @param  Entry Index entry
+ * @param  pDst  Destination of Entry->RawSize bytes, aligned on 32 bytes and
+ *         owning every cache line it touches
+ * @retval BSP status
+ */
+int32_t ASSET_Decode(const ASSET_Entry_t *Entry, uint8_t *pDst)
+{
+  int32_t ret;
+
+  if (((uint32_t)pDst % ASSET_ALIGN) != 0U)
+  {
+    return BSP_ERROR_WRONG_PARAM;
+  }
+
+  ret = BSP_QSPI_ArbAcquireIndirect();
+  if (ret != BSP_ERROR_NONE)
+  {
+    return ret;
+  }
+
+  if (Entry->Codec == ASSET_CODEC_RAW)
+  {
+    ret = ASSET_ReadStart(pDst, ASSET_Ctx.PackAddr + Entry->Offset, Entry->RawSize);
+    if (ret == BSP_ERROR_NONE)
+    {
+      ret = ASSET_ReadWait();
+    }
+  }
+  else if (Entry->Codec == ASSET_CODEC_LZ4)
+  {
+    ret = ASSET_DecodeLz4(Entry, pDst);
+    /* The CPU wrote the pixels, push them out for DMA2D/LTDC */
+    SCB_CleanDCache_by_Addr((uint32_t *)pDst, (int32_t)Entry->RawSize);
+  }
+  else
+  {
+    ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+  }
+
+  BSP_QSPI_ArbReleaseIndirect();
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    ASSET_Ctx.Stats.RawBytes += Entry->RawSize;
+    ASSET_Ctx.Stats.PackedBytes += Entry->PackedSize;
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Returns an asset decoded in the SDRAM cache, decoding it first if
+ *         needed.
+ * @param  Name  Name given to the packer
+ * @param  pData Set to the decoded asset
+ * @param  Entry Set to the index entry, may be NULL
+ * @retval BSP status, BSP_ERROR_BUSY if the flash cannot be leased right now
+ *         or the cache is full (see ASSET_CacheReset())
+ */
+int32_t ASSET_Load(const char *Name, const uint8_t **pData, const ASSET_Entry_t **Entry)
+{
+  const ASSET_Entry_t *entry;
+  uint32_t index, size;
+  int32_t ret;
+
+  ret = ASSET_Find(Name, &entry);
+  if (ret != BSP_ERROR_NONE)
+  {
+    return ret;
+  }
+  index = (uint32_t)(entry - ASSET_Ctx.Entries);
+
+  if (ASSET_Ctx.Cached[index] != NULL)
+  {
+    ASSET_Ctx.Stats.Hits++;
+  }
+  else
+  {
+    size = (entry->RawSize + ASSET_ALIGN - 1U) & ~(ASSET_ALIGN - 1U);
+    if (size > ASSET_CACHE_SIZE - ASSET_Ctx.CacheUsed)
+    {
+      return BSP_ERROR_BUSY;
+    }
+
+    ret = ASSET_Decode(entry, (uint8_t *)(ASSET_CACHE_ADDR + ASSET_Ctx.CacheUsed));
+    if (ret != BSP_ERROR_NONE)
+    {
+      return ret;
+    }
+    ASSET_Ctx.Cached[index] = (uint8_t *)(ASSET_CACHE_ADDR + ASSET_Ctx.CacheUsed);
+    ASSET_Ctx.CacheUsed += size;
+    ASSET_Ctx.Stats.Loads++;
+  }
+
+  *pData = ASSET_Ctx.Cached[index];
+  if (Entry != NULL)
+  {
+    *Entry = entry;
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Drops every cached asset. Pointers returned by ASSET_Load() must
+ *         not be used anymore.
+ */
+void ASSET_CacheReset(void)
+{
+  memset(ASSET_Ctx.Cached, 0, sizeof(ASSET_Ctx.Cached));
+  ASSET_Ctx.CacheUsed = 0U;
+}
+
+void ASSET_GetStats(ASSET_Stats_t *Stats)
+{
+  *Stats = ASSET_Ctx.Stats;
+  Stats->CacheUsed = ASSET_Ctx.CacheUsed;
+}
+
+static void ASSET_ReadCplt(int32_t Status, void *Context)
+{
+  (void)Context;
+  ASSET_ReadStatus = Status;
+  ASSET_ReadDone = 1U;
+}
+
+static int32_t ASSET_ReadStart(uint8_t *pData, uint32_t Addr, uint32_t Size)
+{
+  ASSET_ReadDone = 0U;
+  return BSP_QSPI_Read_DMA(pData, Addr, Size, ASSET_ReadCplt, NULL);
+}
+
+static int32_t ASSET_ReadWait(void)
+{
+  while (ASSET_ReadDone == 0U)
+  {
+  }
+  return ASSET_ReadStatus;
+}
+
+/**
+ * @brief  Streams an LZ4 asset: the block table is read first, then every
+ *         block is fetched by MDMA while the previous one is decompressed.
+ */
+static int32_t ASSET_DecodeLz4(const ASSET_Entry_t *Entry, uint8_t *pDst)
+{
+  uint32_t blocks = (Entry->RawSize + ASSET_BLOCK_SIZE - 1U) / ASSET_BLOCK_SIZE;
+  uint32_t addr = ASSET_Ctx.PackAddr + Entry->Offset;
+  uint32_t i, packed, raw, next_packed;
+  int32_t ret, size;
+
+  if (blocks == 0U || blocks > ASSET_MAX_BLOCKS)
+  {
+    return BSP_ERROR_WRONG_PARAM;
+  }
+
+  ret = ASSET_ReadStart((uint8_t *)ASSET_Table, addr, blocks * sizeof(uint32_t));
+  if (ret == BSP_ERROR_NONE)
+  {
+    ret = ASSET_ReadWait();
+  }
+  addr += blocks * sizeof(uint32_t);
+
+  packed = ASSET_Table[0] & ~ASSET_BLOCK_STORED;
+  if (ret == BSP_ERROR_NONE && (packed == 0U || packed > ASSET_BLOCK_SIZE))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  if (ret == BSP_ERROR_NONE)
+  {
+    ret = ASSET_ReadStart(ASSET_Buffer[0], addr, packed);
+  }
+
+  for (i = 0; i < blocks && ret == BSP_ERROR_NONE; i++)
+  {
+    ret = ASSET_ReadWait();
+    addr += packed;
+
+    /* Fetch the next block while this one is decoded */
+    next_packed = 0U;
+    if (ret == BSP_ERROR_NONE && i + 1U < blocks)
+    {
+      next_packed = ASSET_Table[i + 1U] & ~ASSET_BLOCK_STORED;
+      if (next_packed == 0U || next_packed > ASSET_BLOCK_SIZE)
+      {
+        ret = BSP_ERROR_WRONG_PARAM;
+      }
+      else
+      {
+        ret = ASSET_ReadStart(ASSET_Buffer[(i + 1U) & 1U], addr, next_packed);
+      }
+    }
+
+    if (ret == BSP_ERROR_NONE)
+    {
+      raw = Entry->RawSize - i * ASSET_BLOCK_SIZE;
+      if (raw > ASSET_BLOCK_SIZE)
+      {
+        raw = ASSET_BLOCK_SIZE;
+      }
+
+      if ((ASSET_Table[i] & ASSET_BLOCK_STORED) != 0U)
+      {
+        size = (packed == raw) ? (int32_t)raw : BSP_ERROR_WRONG_PARAM;
+        if (size > 0)
+        {
+          memcpy(pDst, ASSET_Buffer[i & 1U], raw);
+        }
+      }
+      else
+      {
+        size = LZ4_DecompressBlock(ASSET_Buffer[i & 1U], packed, pDst, raw);
+      }
+
+      if (size != (int32_t)raw)
+      {
+        ret = BSP_ERROR_WRONG_PARAM;
+      }
+      pDst += raw;
+    }
+    packed = next_packed;
+  }
+
+  /* Never leave with the MDMA still writing a buffer */
+  if (ret != BSP_ERROR_NONE && BSP_QSPI_GetTransferState() == BSP_ERROR_BUSY)
+  {
+    (void)ASSET_ReadWait();
+  }
+
+  return ret;
+}
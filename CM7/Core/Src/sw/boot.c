@@ -0,0 +1,284 @@
+#include "sw/boot.h"
+
+#include <stdio.h>
+
+#include "driver/sdram.h"
+#include "main.h"
+#include "mem_sections.h"
+
+/*
+ * Boot phase profiler.
+ *
+ * BOOT_Init() starts the DWT cycle counter first thing in main(), every
+ * BOOT_Mark() closes the phase that started at the previous mark. The cycle
+ * count is converted at the core clock that ran the phase, SystemCoreClock
+ * goes from 64 MHz (HSI) to 480 MHz in SystemClock_Config(): the phase that
+ * switches the PLL on is counted at the clock it started with. Time spent
+ * in the startup code before main() is not seen.
+ *
+ * The DWT counter wraps after ~8.9 s at 480 MHz, a longer phase reads short.
+ * The benchmarks restart the counter, run them after BOOT_Report().
+ *
+ * Warm boot. A record in the backup SRAM, which only a power-on or
+ * brown-out reset clears, carries BOOT_WARM_MAGIC once a boot completed
+ * (BOOT_Ready()). BOOT_Start() takes a watchdog or software reset with a
+ * valid record as warm: the SDRAM still holds the framebuffer, it only
+ * needs its refresh restarted. The record is invalidated for the length of
+ * every boot, a reset in the middle of a warm boot makes the next one cold.
+ * The record also keeps the duration of the last cold and warm boots.
+ *
+ * The resets that boot warm: BOOT_Ready() starts the independent watchdog
+ * (IWDG1), which the main loop refreshes with BOOT_WatchdogRefresh(), and
+ * the fault and error handlers call BOOT_WarmReset() once BOOT_IsReady().
+ * During the boot they still stop in place.
+ */
+
+#define BOOT_BACKUP ((BOOT_Backup_t *)D3_BKPSRAM_BASE)
+
+/* IWDG1 key register values */
+#define BOOT_IWDG_START 0xCCCCU
+#define BOOT_IWDG_UNLOCK 0x5555U
+#define BOOT_IWDG_RELOAD 0xAAAAU
+
+_Static_assert((BOOT_WATCHDOG_MS > 0U) && (BOOT_WATCHDOG_MS <= IWDG_RLR_RL_Msk),
+               "BOOT_WATCHDOG_MS out of the IWDG reload range");
+
+typedef struct
+{
+  uint32_t Magic;       /* BOOT_WARM_MAGIC between two boots */
+  uint32_t Framebuffer; /* LTDC layer 0 address */
+  uint32_t ColdUs;      /* Last cold boot */
+  uint32_t WarmUs;      /* Last warm boot */
+  uint32_t WarmCount;   /* Warm boots since the last cold one */
+} BOOT_Backup_t;
+
+typedef struct
+{
+  uint32_t Count;
+  uint32_t Cycles; /* DWT count at the previous mark */
+  uint32_t Clock;  /* Core clock since the previous mark */
+  uint32_t Us;
+  BOOT_Mode_t Mode;
+  uint32_t ResetFlags;     /* RCC_RSR at BOOT_Start() */
+  volatile uint32_t Ready; /* BOOT_Ready() ran, faults reset warm */
+  BOOT_Phase_t Phases[BOOT_MAX_PHASES];
+} BOOT_Ctx_t;
+
+static BOOT_Ctx_t BOOT_Ctx;
+
+/**
+ * @brief  Starts the DWT cycle counter, time zero of the boot report.
+ * @retval None
+ */
+void BOOT_Init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  /* The Cortex-M7 DWT is locked after reset */
+  DWT->LAR = 0xC5ACCE55U;
+  DWT->CYCCNT = 0U;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  BOOT_Ctx.Count = 0U;
+  BOOT_Ctx.Cycles = 0U;
+  BOOT_Ctx.Clock = SystemCoreClock;
+  BOOT_Ctx.Us = 0U;
+}
+
+/**
+ * @brief  Ends the current boot phase.
+ * @param  Name Label of the phase that just ended, must be a literal
+ * @retval None
+ */
+void BOOT_Mark(const char *Name)
+{
+  uint32_t now = DWT->CYCCNT;
+  uint32_t us = (uint32_t)(((uint64_t)(now - BOOT_Ctx.Cycles) * 1000000U) / BOOT_Ctx.Clock);
+
+  BOOT_Ctx.Cycles = now;
+  BOOT_Ctx.Clock = SystemCoreClock;
+  BOOT_Ctx.Us += us;
+
+  /* Past the table the time still adds up to the total */
+  if (BOOT_Ctx.Count < BOOT_MAX_PHASES)
+  {
+    BOOT_Ctx.Phases[BOOT_Ctx.Count].Name = Name;
+    BOOT_Ctx.Phases[BOOT_Ctx.Count].Us = us;
+    BOOT_Ctx.Phases[BOOT_Ctx.Count].End = BOOT_Ctx.Us;
+    BOOT_Ctx.Count++;
+  }
+}
+
+/**
+ * @brief  Time from BOOT_Init() to the last BOOT_Mark().
+ * @retval Microseconds
+ */
+uint32_t BOOT_GetUs(void)
+{
+  return BOOT_Ctx.Us;
+}
+
+uint32_t BOOT_GetCount(void)
+{
+  return BOOT_Ctx.Count;
+}
+
+const BOOT_Phase_t *BOOT_GetPhase(uint32_t Index)
+{
+  return (Index < BOOT_Ctx.Count) ? &BOOT_Ctx.Phases[Index] : NULL;
+}
+
+/**
+ * @brief  Prints the recorded phases on the console (USART3).
+ * @retval None
+ */
+XIP_FUNC void BOOT_Report(void)
+{
+  uint32_t i;
+
+  printf("%-28s %10s %10s\r\n", "boot phase", "us", "at us");
+  for (i = 0; i < BOOT_Ctx.Count; i++)
+  {
+    printf("%-28s %10lu %10lu\r\n", BOOT_Ctx.Phases[i].Name, (unsigned long)BOOT_Ctx.Phases[i].Us,
+           (unsigned long)BOOT_Ctx.Phases[i].End);
+  }
+  printf("%-28s %10lu\r\n", "total", (unsigned long)BOOT_Ctx.Us);
+  printf("%s boot, RCC_RSR 0x%08lx, last cold %lu us, last warm %lu us, %lu warm since cold\r\n",
+         (BOOT_Ctx.Mode == BOOT_MODE_WARM) ? "warm" : "cold", (unsigned long)BOOT_Ctx.ResetFlags,
+         (unsigned long)BOOT_BACKUP->ColdUs, (unsigned long)BOOT_BACKUP->WarmUs,
+         (unsigned long)BOOT_BACKUP->WarmCount);
+}
+
+/**
+ * @brief  Reads the reset cause and the backup SRAM record, then
+ *         invalidates the record until BOOT_Ready(). Call once the clocks
+ *         are configured.
+ * @retval BOOT_MODE_WARM if the SDRAM content can be trusted
+ */
+BOOT_Mode_t BOOT_Start(void)
+{
+  BOOT_Backup_t *bkp = BOOT_BACKUP;
+  uint32_t watchdog_or_soft;
+
+  HAL_PWR_EnableBkUpAccess();
+  __HAL_RCC_BKPRAM_CLK_ENABLE();
+
+  watchdog_or_soft = __HAL_RCC_GET_FLAG(RCC_FLAG_IWDG1RST) | __HAL_RCC_GET_FLAG(RCC_FLAG_WWDG1RST) |
+                     __HAL_RCC_GET_FLAG(RCC_FLAG_SFTR1ST) | __HAL_RCC_GET_FLAG(RCC_FLAG_IWDG2RST) |
+                     __HAL_RCC_GET_FLAG(RCC_FLAG_WWDG2RST) | __HAL_RCC_GET_FLAG(RCC_FLAG_SFTR2ST);
+
+  BOOT_Ctx.Mode = BOOT_MODE_COLD;
+  if ((__HAL_RCC_GET_FLAG(RCC_FLAG_PORRST) == 0U) && (__HAL_RCC_GET_FLAG(RCC_FLAG_BORRST) == 0U) &&
+      (watchdog_or_soft != 0U) && (bkp->Magic == BOOT_WARM_MAGIC))
+  {
+    BOOT_Ctx.Mode = BOOT_MODE_WARM;
+  }
+  else if (bkp->Magic != BOOT_WARM_MAGIC)
+  {
+    /* Power-on: the record holds garbage */
+    bkp->ColdUs = 0U;
+    bkp->WarmUs = 0U;
+    bkp->WarmCount = 0U;
+  }
+
+  BOOT_Ctx.ResetFlags = RCC->RSR;
+  __HAL_RCC_CLEAR_RESET_FLAGS();
+
+  bkp->Magic = 0U;
+  /* The backup SRAM is cacheable, the record must reach it before a reset */
+  SCB_CleanDCache_by_Addr((uint32_t *)bkp, sizeof(*bkp));
+
+  return BOOT_Ctx.Mode;
+}
+
+BOOT_Mode_t BOOT_GetMode(void)
+{
+  return BOOT_Ctx.Mode;
+}
+
+uint32_t BOOT_GetResetFlags(void)
+{
+  return BOOT_Ctx.ResetFlags;
+}
+
+/**
+ * @brief  Framebuffer on screen when the previous boot completed, valid on
+ *         a warm boot.
+ * @retval LTDC layer 0 address
+ */
+uint32_t BOOT_GetFramebuffer(void)
+{
+  return BOOT_BACKUP->Framebuffer;
+}
+
+/**
+ * @brief  Ends the boot: records its duration (up to the last BOOT_Mark()),
+ *         allows the next watchdog or software reset to boot warm and starts
+ *         the watchdog.
+ * @param  Framebuffer LTDC layer 0 address
+ * @retval None
+ */
+void BOOT_Ready(uint32_t Framebuffer)
+{
+  BOOT_Backup_t *bkp = BOOT_BACKUP;
+
+  if (BOOT_Ctx.Mode == BOOT_MODE_WARM)
+  {
+    bkp->WarmUs = BOOT_Ctx.Us;
+    bkp->WarmCount++;
+  }
+  else
+  {
+    bkp->ColdUs = BOOT_Ctx.Us;
+    bkp->WarmCount = 0U;
+  }
+  bkp->Framebuffer = Framebuffer;
+  bkp->Magic = BOOT_WARM_MAGIC;
+  SCB_CleanDCache_by_Addr((uint32_t *)bkp, sizeof(*bkp));
+
+  /* Held while the core is halted by the debugger */
+  __HAL_DBGMCU_FREEZE_IWDG1();
+  /* LSI (32 kHz) / 32: one count per millisecond */
+  IWDG1->KR = BOOT_IWDG_START;
+  IWDG1->KR = BOOT_IWDG_UNLOCK;
+  IWDG1->PR = IWDG_PR_PR_1 | IWDG_PR_PR_0;
+  IWDG1->RLR = BOOT_WATCHDOG_MS;
+  while ((IWDG1->SR & (IWDG_SR_PVU | IWDG_SR_RVU)) != 0U)
+  {
+  }
+  IWDG1->KR = BOOT_IWDG_RELOAD;
+
+  BOOT_Ctx.Ready = 1U;
+}
+
+/**
+ * @brief  Whether BOOT_Ready() ran: a reset from here on boots warm.
+ * @retval 1 after BOOT_Ready(), 0 during the boot
+ */
+uint32_t BOOT_IsReady(void)
+{
+  return BOOT_Ctx.Ready;
+}
+
+/**
+ * @brief  Restarts the watchdog count. Main loop, at least every
+ *         BOOT_WATCHDOG_MS once BOOT_Ready() ran.
+ * @retval None
+ */
+void BOOT_WatchdogRefresh(void)
+{
+  IWDG1->KR = BOOT_IWDG_RELOAD;
+}
+
+/**
+ * @brief  Resets the system so that it boots warm: the cached framebuffer
+ *         lines are written back and the SDRAM refreshes itself during the
+ *         reset. For fault and error handlers, once BOOT_IsReady().
+ * @retval None
+ */
+void BOOT_WarmReset(void)
+{
+  __disable_irq();
+  SCB_CleanDCache();
+  (void)BSP_SDRAM_EnterSelfRefresh();
+  NVIC_SystemReset();
+}
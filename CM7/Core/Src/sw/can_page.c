@@ -0,0 +1,117 @@
+#include "sw/can_page.h"
+
+#include "mem_sections.h"
+#include "vstate.h"
+
+/*
+ * CAN debug page: one line per bus (load, frames/s, fault confinement
+ * state and counters), the gateway totals, the measured cost of the
+ * statistics update and a table with a row per DBC message. It reads the
+ * CM4 snapshot (vstate.h), refreshed by an LVGL timer deleted with the
+ * page. Integer formatting throughout, LV_SPRINTF_USE_FLOAT is off.
+ */
+
+#define CAN_PAGE_COLS 6U
+
+typedef struct
+{
+  lv_obj_t *Bus[VSTATE_BUS_NBR];
+  lv_obj_t *Table;
+  lv_obj_t *Gateway;
+  lv_obj_t *Cost;
+  lv_timer_t *Timer;
+} CAN_PAGE_t;
+
+static CAN_PAGE_t CAN_PAGE;
+
+static XIP_FUNC void CAN_PAGE_Refresh(lv_timer_t *Timer);
+static XIP_FUNC void CAN_PAGE_Deleted(lv_event_t *Event);
+
+/**
+ * @brief  Builds the page in Parent and starts its refresh. One page at a
+ *         time.
+ * @param  Parent Screen or container, scrolled vertically
+ * @retval Page object
+ */
+XIP_FUNC lv_obj_t *CAN_PAGE_Create(lv_obj_t *Parent)
+{
+  static XIP_RODATA const char *const header[CAN_PAGE_COLS] = {"Message", "Bus", "Fps", "Jitter us", "Missed", "Data"};
+  static XIP_RODATA const lv_coord_t widths[CAN_PAGE_COLS] = {170, 50, 60, 100, 80, 70};
+  lv_obj_t *page;
+  uint32_t bus, i;
+
+  page = lv_obj_create(Parent);
+  lv_obj_set_size(page, lv_pct(100), lv_pct(100));
+  lv_obj_set_flex_flow(page, LV_FLEX_FLOW_COLUMN);
+  lv_obj_add_event_cb(page, CAN_PAGE_Deleted, LV_EVENT_DELETE, NULL);
+
+  for (bus = 0; bus < VSTATE_BUS_NBR; bus++)
+  {
+    CAN_PAGE.Bus[bus] = lv_label_create(page);
+  }
+  CAN_PAGE.Gateway = lv_label_create(page);
+  CAN_PAGE.Cost = lv_label_create(page);
+
+  CAN_PAGE.Table = lv_table_create(page);
+  lv_table_set_col_cnt(CAN_PAGE.Table, CAN_PAGE_COLS);
+  lv_table_set_row_cnt(CAN_PAGE.Table, CAN_MSGS_COUNT + 1U);
+  for (i = 0; i < CAN_PAGE_COLS; i++)
+  {
+    lv_table_set_col_width(CAN_PAGE.Table, i, widths[i]);
+    lv_table_set_cell_value(CAN_PAGE.Table, 0, i, header[i]);
+  }
+  for (i = 0; i < CAN_MSGS_COUNT; i++)
+  {
+    lv_table_set_cell_value(CAN_PAGE.Table, i + 1U, 0, CAN_MSGS_Table[i].Name);
+    lv_table_set_cell_value_fmt(CAN_PAGE.Table, i + 1U, 1, "%u", (unsigned)CAN_MSGS_Table[i].Bus);
+  }
+
+  CAN_PAGE.Timer = lv_timer_create(CAN_PAGE_Refresh, CAN_PAGE_REFRESH_MS, NULL);
+  CAN_PAGE_Refresh(CAN_PAGE.Timer);
+  return page;
+}
+
+static XIP_FUNC void CAN_PAGE_Refresh(lv_timer_t *Timer)
+{
+  const VSTATE_t *vs = VSTATE_Get();
+  const VSTATE_Bus_t *bus;
+  const VSTATE_Msg_t *msg;
+  const char *state;
+  uint32_t i;
+
+  (void)Timer;
+  for (i = 0; i < VSTATE_BUS_NBR; i++)
+  {
+    bus = &vs->Buses[i];
+    state = (bus->Off != 0U) ? "bus-off" : ((bus->Passive != 0U) ? "passive" : "active");
+    lv_label_set_text_fmt(CAN_PAGE.Bus[i], "CAN%lu  load %lu.%lu %%  %lu fps  %s  TEC %u REC %u  err %lu  bus-off %lu",
+                          (unsigned long)(i + 1U), (unsigned long)(bus->LoadPermille / 10U),
+                          (unsigned long)(bus->LoadPermille % 10U), (unsigned long)bus->Rate, state,
+                          (unsigned)bus->Tec, (unsigned)bus->Rec, (unsigned long)bus->Errors,
+                          (unsigned long)bus->BusOff);
+  }
+  lv_label_set_text_fmt(CAN_PAGE.Gateway, "CAN1>2  fwd %lu  sent %lu  limited %lu  dropped %lu  latency avg %lu max %lu us",
+                        (unsigned long)vs->Gateway.Forwarded, (unsigned long)vs->Gateway.Sent,
+                        (unsigned long)vs->Gateway.RateLimited, (unsigned long)vs->Gateway.Dropped,
+                        (unsigned long)vs->Gateway.LatencyAvgUs, (unsigned long)vs->Gateway.LatencyMaxUs);
+  lv_label_set_text_fmt(CAN_PAGE.Cost, "stats %lu cyc/frame, max %lu, budget %lu, %lu over",
+                        (unsigned long)vs->Cost.AvgCycles, (unsigned long)vs->Cost.MaxCycles,
+                        (unsigned long)vs->Cost.BudgetCycles, (unsigned long)vs->Cost.OverBudget);
+
+  for (i = 0; i < CAN_MSGS_COUNT; i++)
+  {
+    msg = &vs->Msgs[i];
+    lv_table_set_cell_value_fmt(CAN_PAGE.Table, i + 1U, 2, "%lu", (unsigned long)msg->Rate);
+    lv_table_set_cell_value_fmt(CAN_PAGE.Table, i + 1U, 3, "%lu", (unsigned long)msg->JitterMaxUs);
+    lv_table_set_cell_value_fmt(CAN_PAGE.Table, i + 1U, 4, "%lu", (unsigned long)msg->Missed);
+    lv_table_set_cell_value(CAN_PAGE.Table, i + 1U, 5, (VSTATE_Test(vs->Stale, i) != 0U) ? "STALE" : "");
+  }
+}
+
+static XIP_FUNC void CAN_PAGE_Deleted(lv_event_t *Event)
+{
+  (void)Event;
+  lv_timer_del(CAN_PAGE.Timer);
+  CAN_PAGE.Timer = NULL;
+  CAN_PAGE.Table = NULL;
+}
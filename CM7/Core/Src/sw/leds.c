@@ -0,0 +1,117 @@
+#include "sw/leds.h"
+
+#include "main.h"
+#include "tim.h"
+#include "vstate.h"
+
+/*
+ * Dash indicator LEDs.
+ *
+ * LED_BMS (GPIO) is lit while the BMS reports a fault or while any of its
+ * supervised messages is stale. LED_RTD (TIM4 channel 1) is lit while the
+ * VCU reports ready-to-drive, and blinks while the VCU or an inverter
+ * status is stale: the last state shown cannot be trusted.
+ *
+ * Signals and staleness come from the CM4 snapshot (vstate.h): the stale
+ * messages of each LED are one mask test per word of the Stale bitmap.
+ */
+
+#define LEDS_BMS 0x01U
+#define LEDS_RTD 0x02U
+
+typedef struct
+{
+  uint32_t MaskBms[VSTATE_MSG_WORDS]; /* Messages of each LED, VSTATE_t.Stale layout */
+  uint32_t MaskRtd[VSTATE_MSG_WORDS];
+} LEDS_State_t;
+
+static LEDS_State_t LEDS_State;
+
+/* LEDs each supervised message weighs on */
+static const uint8_t LEDS_Groups[CAN_MSGS_COUNT] = {
+    [CAN_MSG_BMS_STATUS_INDEX] = LEDS_BMS,   [CAN_MSG_BMS_CELLS_INDEX] = LEDS_BMS,
+    [CAN_MSG_BMS_TEMPS_INDEX] = LEDS_BMS,    [CAN_MSG_VCU_STATUS_INDEX] = LEDS_RTD,
+    [CAN_MSG_INV_L_STATUS_INDEX] = LEDS_RTD, [CAN_MSG_INV_R_STATUS_INDEX] = LEDS_RTD,
+};
+
+static uint32_t LEDS_Stale(const VSTATE_t *pState, const uint32_t *pMask);
+
+/**
+ * @brief  Starts the LED_RTD PWM and builds the stale masks of both
+ *         LEDs. After VSTATE_Init() and MX_TIM4_Init().
+ * @retval BSP status
+ */
+int32_t LEDS_Init(void)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t i;
+
+  LEDS_State = (LEDS_State_t){0};
+  for (i = 0; i < CAN_MSGS_COUNT; i++)
+  {
+    if ((LEDS_Groups[i] & LEDS_BMS) != 0U)
+    {
+      LEDS_State.MaskBms[i / 32U] |= (1UL << (i % 32U));
+    }
+    if ((LEDS_Groups[i] & LEDS_RTD) != 0U)
+    {
+      LEDS_State.MaskRtd[i / 32U] |= (1UL << (i % 32U));
+    }
+  }
+
+  if (HAL_TIM_PWM_Start(&htim4, TIM_CHANNEL_1) != HAL_OK)
+  {
+    ret = BSP_ERROR_PERIPH_FAILURE;
+  }
+  else
+  {
+    LEDS_Process();
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Drives both LEDs from the last snapshot. Main loop context,
+ *         after VSTATE_Refresh().
+ */
+void LEDS_Process(void)
+{
+  const VSTATE_t *state = VSTATE_Get();
+  uint32_t fault = 0U, rtd = 0U;
+
+  if (VSTATE_Test(state->Received, CAN_MSG_BMS_STATUS_INDEX) != 0U)
+  {
+    fault = state->Signals[CAN_MSG_BMS_STATUS_INDEX].BMS_STATUS.Fault;
+  }
+  HAL_GPIO_WritePin(LED_BMS_GPIO_Port, LED_BMS_Pin,
+                    ((fault != 0U) || (LEDS_Stale(state, LEDS_State.MaskBms) != 0U)) ? GPIO_PIN_SET : GPIO_PIN_RESET);
+
+  if (LEDS_Stale(state, LEDS_State.MaskRtd) != 0U)
+  {
+    rtd = ((HAL_GetTick() / (LEDS_BLINK_MS / 2U)) & 1U);
+  }
+  else if (VSTATE_Test(state->Received, CAN_MSG_VCU_STATUS_INDEX) != 0U)
+  {
+    rtd = state->Signals[CAN_MSG_VCU_STATUS_INDEX].VCU_STATUS.ReadyToDrive;
+  }
+  /* Above the auto-reload the PWM1 output stays high */
+  __HAL_TIM_SET_COMPARE(&htim4, TIM_CHANNEL_1, (rtd != 0U) ? (__HAL_TIM_GET_AUTORELOAD(&htim4) + 1U) : 0U);
+}
+
+static uint32_t LEDS_Stale(const VSTATE_t *pState, const uint32_t *pMask)
+{
+  uint32_t i, stale = 0U;
+
+  /* Nothing from the CM4 yet, every message counts as stale */
+  if (pState->Seq == 0U)
+  {
+    return 1U;
+  }
+  for (i = 0; i < VSTATE_MSG_WORDS; i++)
+  {
+    stale |= pState->Stale[i] & pMask[i];
+  }
+  return stale;
+}
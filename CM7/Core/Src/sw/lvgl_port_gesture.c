@@ -0,0 +1,121 @@
+#include "sw/lvgl_port_gesture.h"
+#include "lvgl/lvgl.h"
+
+#include "driver/ts.h"
+
+/* FT5336 gesture engine thresholds, same values as the ST reference BSP */
+#define TS_GESTURE_RADIAN 0x0AU
+#define TS_GESTURE_OFFSET_LEFT_RIGHT 0x19U
+#define TS_GESTURE_OFFSET_UP_DOWN 0x19U
+#define TS_GESTURE_DISTANCE_LEFT_RIGHT 0x19U
+#define TS_GESTURE_DISTANCE_UP_DOWN 0x19U
+#define TS_GESTURE_DISTANCE_ZOOM 0x32U
+
+static void gesture_read(lv_indev_drv_t *drv, lv_indev_data_t *data);
+
+/* Key emitted for each GESTURE_ID_*: swipes page through the default group,
+ * zoom maps to +/- so spinboxes and sliders react without extra glue */
+static const uint32_t gesture_keys[GESTURE_ID_NB_MAX] = {
+    [GESTURE_ID_NO_GESTURE] = 0,
+    [GESTURE_ID_MOVE_UP] = LV_KEY_UP,
+    [GESTURE_ID_MOVE_RIGHT] = LV_KEY_PREV,
+    [GESTURE_ID_MOVE_DOWN] = LV_KEY_DOWN,
+    [GESTURE_ID_MOVE_LEFT] = LV_KEY_NEXT,
+    [GESTURE_ID_ZOOM_IN] = '+',
+    [GESTURE_ID_ZOOM_OUT] = '-',
+};
+
+static volatile uint8_t gesture_pending = 0;
+static uint32_t gesture_event = 0;
+
+/**
+ * Register the FT5336 gesture engine as an LVGL keypad device, bound to the
+ * default group: the focusable widgets created afterwards join it and receive
+ * the gesture keys. Called by TS_Init() once the controller is probed.
+ */
+void TS_Gesture_Init(void)
+{
+  FT5336_Gesture_InitTypeDef gesture_cfg;
+  lv_group_t *group;
+  lv_indev_t *indev;
+
+  gesture_cfg.Radian = TS_GESTURE_RADIAN;
+  gesture_cfg.OffsetLeftRight = TS_GESTURE_OFFSET_LEFT_RIGHT;
+  gesture_cfg.OffsetUpDown = TS_GESTURE_OFFSET_UP_DOWN;
+  gesture_cfg.DistanceLeftRight = TS_GESTURE_DISTANCE_LEFT_RIGHT;
+  gesture_cfg.DistanceUpDown = TS_GESTURE_DISTANCE_UP_DOWN;
+  gesture_cfg.DistanceZoom = TS_GESTURE_DISTANCE_ZOOM;
+  BSP_TS_GestureConfig(&gesture_cfg);
+  BSP_TS_EnableIT();
+
+  gesture_event = lv_event_register_id();
+
+  static lv_indev_drv_t indev_drv;
+  lv_indev_drv_init(&indev_drv);
+  indev_drv.type = LV_INDEV_TYPE_KEYPAD;
+  indev_drv.read_cb = gesture_read;
+
+  indev = lv_indev_drv_register(&indev_drv);
+
+  group = lv_group_get_default();
+  if (group == NULL)
+  {
+    group = lv_group_create();
+    lv_group_set_default(group);
+  }
+  lv_indev_set_group(indev, group);
+}
+
+/**
+ * Custom LVGL event sent to the active screen for every recognised gesture.
+ * The event parameter points to the GESTURE_ID_* value.
+ */
+uint32_t TS_Gesture_GetEvent(void)
+{
+  return gesture_event;
+}
+
+/**
+ * Called from the LCD_INT EXTI: only flag the event, the I2C read of the
+ * gesture register is deferred to the LVGL input task.
+ */
+void BSP_TS_Callback()
+{
+  gesture_pending = 1;
+}
+
+/**
+ * Read the gesture device. Touches the I2C bus only after an interrupt, and
+ * emits a one-cycle key press so LVGL sees a press/release pair per gesture.
+ */
+static void gesture_read(lv_indev_drv_t *drv, lv_indev_data_t *data)
+{
+  static uint32_t last_key = 0;
+  uint32_t gesture_id = GESTURE_ID_NO_GESTURE;
+
+  data->state = LV_INDEV_STATE_RELEASED;
+  data->key = last_key;
+
+  if (last_key != 0)
+  {
+    last_key = 0;
+    return;
+  }
+
+  if (gesture_pending == 0)
+    return;
+  gesture_pending = 0;
+
+  if (BSP_TS_GetGestureId(&gesture_id) != BSP_ERROR_NONE || gesture_id == GESTURE_ID_NO_GESTURE ||
+      gesture_id >= GESTURE_ID_NB_MAX)
+    return;
+
+  lv_event_send(lv_scr_act(), gesture_event, &gesture_id);
+
+  if (gesture_keys[gesture_id] != 0)
+  {
+    last_key = gesture_keys[gesture_id];
+    data->key = last_key;
+    data->state = LV_INDEV_STATE_PRESSED;
+  }
+}
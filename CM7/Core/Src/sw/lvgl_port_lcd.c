@@ -1,13 +1,15 @@
 #include "sw/lvgl_port_lcd.h"
 #include "driver/lcd.h"
 #include "lvgl/lvgl.h"
+#include "mem_sections.h"
+#include "sw/memattr.h"
 #include <stdlib.h>
 
 #define LVGL_BUFFER_ADDR_AT_SDRAM (0xD007F810)
 #define LVGL_BUFFER_2_ADDR_AT_SDRAM (0xD00FF020)
-static void disp_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p);
+static ITCM_FUNC void disp_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p);
 static void disp_clean_dcache(lv_disp_drv_t *drv);
-static uint8_t CopyImageToLcdFrameBuffer(void *pSrc, void *pDst, uint32_t xSize, uint32_t ySize);
+static ITCM_FUNC uint8_t CopyImageToLcdFrameBuffer(void *pSrc, void *pDst, uint32_t xSize, uint32_t ySize);
 
 static lv_disp_t *display = NULL;
 static lv_disp_drv_t disp_drv;
@@ -50,7 +52,7 @@ void LCD_Init()
 /* Flush the content of the internal buffer the specific area on the display
  * You can use DMA or any hardware acceleration to do this operation in the background but
  * 'lv_disp_flush_ready()' has to be called when finished*/
-static void disp_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p)
+static ITCM_FUNC void disp_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p)
 {
   /*Return if the area is out the screen*/
   if (area->x2 < 0)
@@ -62,8 +64,8 @@ static void disp_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *co
   if (area->y1 > Lcd_Ctx.YSize - 1)
     return;
   // BSP_LED_Toggle(LED2);
-  SCB_CleanInvalidateDCache();
-  SCB_InvalidateICache();
+  /* Only a write-back draw buffer has to reach the SDRAM before the DMA2D reads it */
+  MEMATTR_CleanRange(color_p, lv_area_get_width(area) * lv_area_get_height(area) * sizeof(lv_color_t));
 
   uint32_t address =
       hltdc.LayerCfg[Lcd_Ctx.ActiveLayer].FBStartAdress + (((Lcd_Ctx.XSize * area->y1) + area->x1) * Lcd_Ctx.BppFactor);
@@ -76,7 +78,7 @@ static void disp_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *co
 
 static void disp_clean_dcache(lv_disp_drv_t *drv)
 {
-  SCB_CleanInvalidateDCache();
+  MEMATTR_CleanRange(drv->draw_buf->buf_act, drv->draw_buf->size * sizeof(lv_color_t));
 }
 
 /**
@@ -88,7 +90,7 @@ static void disp_clean_dcache(lv_disp_drv_t *drv)
  * @param  ySize: Buffer height
  * @retval LCD Status : BSP_ERROR_NONE or BSP_ERROR_BUS_DMA_FAILURE
  */
-static uint8_t CopyImageToLcdFrameBuffer(void *pSrc, void *pDst, uint32_t xSize, uint32_t ySize)
+static ITCM_FUNC uint8_t CopyImageToLcdFrameBuffer(void *pSrc, void *pDst, uint32_t xSize, uint32_t ySize)
 {
   HAL_StatusTypeDef hal_status = HAL_OK;
   uint8_t lcd_status;
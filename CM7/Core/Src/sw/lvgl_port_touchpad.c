@@ -5,6 +5,8 @@
 
 #include "driver/lcd.h"
 
+#include "sw/lvgl_port_gesture.h"
+
 static void touchpad_read(lv_indev_drv_t *drv, lv_indev_data_t *data);
 
 static TS_State_t TS_State;
@@ -25,6 +27,9 @@ void TS_Init(void)
 	indev_drv.read_cb = touchpad_read;
 
 	lv_indev_drv_register(&indev_drv);
+
+	/* Swipes and zoom of the same controller, as keys */
+	TS_Gesture_Init();
 }
 
 /**
@@ -0,0 +1,131 @@
+#include "sw/lz4.h"
+
+#include <string.h>
+
+/*
+ * Decoder of the LZ4 block format (lz4.org, "LZ4 Block Format Description").
+ *
+ * A block is a run of sequences: a token whose high nibble is the literal
+ * length and low nibble the match length minus 4 (15 means more length
+ * bytes follow, each added until one is below 255), the literals, then a
+ * 16-bit little-endian match offset. The last sequence has no match.
+ *
+ * Every read and write is bounds checked, a corrupted block cannot make the
+ * decoder leave its buffers.
+ */
+
+#define LZ4_MIN_MATCH 4U
+
+static int32_t LZ4_ReadLength(const uint8_t **pIp, const uint8_t *IpEnd, uint32_t *Length);
+
+/**
+ * @brief  Decompresses one LZ4 block.
+ * @param  pSrc        Compressed block
+ * @param  SrcSize     Size of the compressed block
+ * @param  pDst        Destination
+ * @param  DstCapacity Size of the destination
+ * @retval Decompressed size, or BSP_ERROR_WRONG_PARAM if the block is corrupt
+ *         or does not fit
+ */
+int32_t LZ4_DecompressBlock(const uint8_t *pSrc, uint32_t SrcSize, uint8_t *pDst, uint32_t DstCapacity)
+{
+  const uint8_t *ip = pSrc;
+  const uint8_t *ip_end = pSrc + SrcSize;
+  uint8_t *op = pDst;
+  uint8_t *op_end = pDst + DstCapacity;
+  const uint8_t *match;
+  uint32_t token, length, offset, chunk;
+
+  while (ip < ip_end)
+  {
+    token = *ip++;
+
+    /* Literals */
+    length = token >> 4;
+    if (length == 15U && LZ4_ReadLength(&ip, ip_end, &length) != BSP_ERROR_NONE)
+    {
+      return BSP_ERROR_WRONG_PARAM;
+    }
+    if (length > (uint32_t)(ip_end - ip) || length > (uint32_t)(op_end - op))
+    {
+      return BSP_ERROR_WRONG_PARAM;
+    }
+    memcpy(op, ip, length);
+    ip += length;
+    op += length;
+
+    /* The last sequence ends with its literals */
+    if (ip == ip_end)
+    {
+      break;
+    }
+
+    /* Match */
+    if ((ip_end - ip) < 2)
+    {
+      return BSP_ERROR_WRONG_PARAM;
+    }
+    offset = (uint32_t)ip[0] | ((uint32_t)ip[1] << 8);
+    ip += 2;
+    if (offset == 0U || offset > (uint32_t)(op - pDst))
+    {
+      return BSP_ERROR_WRONG_PARAM;
+    }
+
+    length = token & 0x0FU;
+    if (length == 15U && LZ4_ReadLength(&ip, ip_end, &length) != BSP_ERROR_NONE)
+    {
+      return BSP_ERROR_WRONG_PARAM;
+    }
+    length += LZ4_MIN_MATCH;
+    if (length > (uint32_t)(op_end - op))
+    {
+      return BSP_ERROR_WRONG_PARAM;
+    }
+
+    match = op - offset;
+    if (offset >= length)
+    {
+      memcpy(op, match, length);
+      op += length;
+    }
+    else
+    {
+      /* Overlapping match repeats the last offset bytes (runs of pixels):
+       * copy the pattern in non-overlapping chunks that double each time */
+      while (length != 0U)
+      {
+        chunk = (uint32_t)(op - match);
+        if (chunk > length)
+        {
+          chunk = length;
+        }
+        memcpy(op, match, chunk);
+        op += chunk;
+        length -= chunk;
+      }
+    }
+  }
+
+  return (int32_t)(op - pDst);
+}
+
+/**
+ * @brief  Adds the extra length bytes following a nibble of 15.
+ */
+static int32_t LZ4_ReadLength(const uint8_t **pIp, const uint8_t *IpEnd, uint32_t *Length)
+{
+  uint32_t byte;
+
+  do
+  {
+    if (*pIp >= IpEnd)
+    {
+      return BSP_ERROR_WRONG_PARAM;
+    }
+    byte = *(*pIp)++;
+    *Length += byte;
+  } while (byte == 255U);
+
+  return BSP_ERROR_NONE;
+}
@@ -0,0 +1,218 @@
+#include "sw/memattr.h"
+
+#include "driver/lcd.h"
+#include "ipc.h"
+#include "main.h"
+#include "sw/asset.h"
+
+/*
+ * Memory attributes per region class.
+ *
+ * MPU_Config() (CubeMX) maps the whole SDRAM with a single attribute. Here
+ * the SDRAM layout is split in classes, each with the cache policy of the
+ * active profile: the framebuffer window overrides the SDRAM region, and
+ * the SRAM3 mailboxes get a region of their own. A higher MPU region number
+ * wins where regions overlap.
+ *
+ * The inter-core rings are the exception to the profiles: both cores write
+ * words that share a cache line (the doorbell flag next to the consumer
+ * index), which no clean or invalidate by line can keep coherent. Their
+ * region is non-cacheable and shareable in every profile.
+ *
+ * A write-back class needs MEMATTR_CleanRange() before a DMA master reads
+ * it; write-through and non-cacheable classes need nothing, so the display
+ * port no longer cleans the whole D-cache on every flush. The Cortex-M7 does
+ * not cache shareable memory, the shared class is only marked shareable
+ * when it is non-cacheable.
+ */
+
+typedef struct
+{
+  uint32_t Base;
+  uint8_t Size;   /* MPU_REGION_SIZE_xxx */
+  uint8_t Number; /* MPU_REGION_NUMBERx */
+  MEMATTR_Class_t Class;
+  uint32_t Length; /* Bytes, for the address lookup */
+} MEMATTR_Region_t;
+
+typedef struct
+{
+  const char *Name;
+  MEMATTR_Policy_t Policy[MEMATTR_CLASS_COUNT];
+} MEMATTR_ProfileDef_t;
+
+/* Regions 0-2 are MPU_Config(), 3 is the XIP code window */
+static const MEMATTR_Region_t MEMATTR_Layout[] = {
+    {MEMATTR_SDRAM_BASE, MPU_REGION_SIZE_32MB, MPU_REGION_NUMBER1, MEMATTR_CLASS_HEAP, MEMATTR_SDRAM_SIZE},
+    {MEMATTR_FB_BASE, MPU_REGION_SIZE_4MB, MPU_REGION_NUMBER4, MEMATTR_CLASS_FRAMEBUFFER, MEMATTR_FB_SIZE},
+    {MEMATTR_SHARED_BASE, MPU_REGION_SIZE_32KB, MPU_REGION_NUMBER5, MEMATTR_CLASS_SHARED, MEMATTR_SHARED_SIZE},
+    {IPC_ADDR, MPU_REGION_SIZE_16KB, MPU_REGION_NUMBER6, MEMATTR_CLASS_IPC, IPC_SIZE},
+};
+
+static const MEMATTR_ProfileDef_t MEMATTR_Profiles[MEMATTR_PROFILE_COUNT] = {
+    [MEMATTR_PROFILE_CUBEMX] = {"cubemx",
+                                {MEMATTR_POLICY_WRITE_THROUGH, MEMATTR_POLICY_WRITE_THROUGH, MEMATTR_POLICY_WRITE_BACK,
+                                 MEMATTR_POLICY_NON_CACHEABLE}},
+    [MEMATTR_PROFILE_FB_WT] = {"fb-wt",
+                               {MEMATTR_POLICY_WRITE_THROUGH, MEMATTR_POLICY_WRITE_BACK, MEMATTR_POLICY_NON_CACHEABLE,
+                                MEMATTR_POLICY_NON_CACHEABLE}},
+    [MEMATTR_PROFILE_FB_NC] = {"fb-nc",
+                               {MEMATTR_POLICY_NON_CACHEABLE, MEMATTR_POLICY_WRITE_BACK, MEMATTR_POLICY_NON_CACHEABLE,
+                                MEMATTR_POLICY_NON_CACHEABLE}},
+    [MEMATTR_PROFILE_ALL_WB] = {"all-wb",
+                                {MEMATTR_POLICY_WRITE_BACK, MEMATTR_POLICY_WRITE_BACK, MEMATTR_POLICY_NON_CACHEABLE,
+                                 MEMATTR_POLICY_NON_CACHEABLE}},
+};
+
+/* The layout must hold what the drivers put in the SDRAM */
+_Static_assert(LCD_LAYER_1_ADDRESS + LCD_DEFAULT_WIDTH * LCD_DEFAULT_HEIGHT * 4U <= MEMATTR_FB_BASE + MEMATTR_FB_SIZE,
+               "LTDC layer 1 outside the framebuffer window");
+_Static_assert(ASSET_CACHE_ADDR >= MEMATTR_FB_BASE + MEMATTR_FB_SIZE, "asset cache inside the framebuffers");
+_Static_assert(ASSET_CACHE_ADDR + ASSET_CACHE_SIZE <= MEMATTR_SDRAM_BASE + MEMATTR_SDRAM_SIZE, "asset cache past the SDRAM");
+_Static_assert((IPC_SIZE == 0x4000U) && ((IPC_ADDR % IPC_SIZE) == 0U), "inter-core rings not one 16 KB MPU region");
+_Static_assert((IPC_ADDR >= MEMATTR_SHARED_BASE) && (IPC_ADDR + IPC_SIZE <= MEMATTR_SHARED_BASE + MEMATTR_SHARED_SIZE),
+               "inter-core rings outside the shared window");
+
+static MEMATTR_Profile_t MEMATTR_Active = MEMATTR_PROFILE_CUBEMX;
+
+/**
+ * @brief  Programs the MPU regions of the layout with the policies of a
+ *         profile. The D-cache is cleaned and invalidated first, no line
+ *         survives a policy change. Interrupts are masked meanwhile.
+ * @param  Profile Profile to apply
+ * @retval BSP status
+ */
+int32_t MEMATTR_SetProfile(MEMATTR_Profile_t Profile)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  MPU_Region_InitTypeDef region = {0};
+  MEMATTR_Policy_t policy;
+  uint32_t primask, i;
+
+  if (Profile >= MEMATTR_PROFILE_COUNT)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    SCB_CleanInvalidateDCache();
+    HAL_MPU_Disable();
+
+    for (i = 0; i < (sizeof(MEMATTR_Layout) / sizeof(MEMATTR_Layout[0])); i++)
+    {
+      policy = MEMATTR_Profiles[Profile].Policy[MEMATTR_Layout[i].Class];
+
+      region.Enable = MPU_REGION_ENABLE;
+      region.Number = MEMATTR_Layout[i].Number;
+      region.BaseAddress = MEMATTR_Layout[i].Base;
+      region.Size = MEMATTR_Layout[i].Size;
+      region.SubRegionDisable = 0x0;
+      region.AccessPermission = MPU_REGION_FULL_ACCESS;
+      region.DisableExec = (MEMATTR_Layout[i].Class == MEMATTR_CLASS_HEAP) ? MPU_INSTRUCTION_ACCESS_ENABLE
+                                                                            : MPU_INSTRUCTION_ACCESS_DISABLE;
+      region.IsShareable = MPU_ACCESS_NOT_SHAREABLE;
+
+      if (policy == MEMATTR_POLICY_WRITE_BACK)
+      {
+        region.TypeExtField = MPU_TEX_LEVEL1;
+        region.IsCacheable = MPU_ACCESS_CACHEABLE;
+        region.IsBufferable = MPU_ACCESS_BUFFERABLE;
+      }
+      else if (policy == MEMATTR_POLICY_WRITE_THROUGH)
+      {
+        region.TypeExtField = MPU_TEX_LEVEL0;
+        region.IsCacheable = MPU_ACCESS_CACHEABLE;
+        region.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+      }
+      else
+      {
+        region.TypeExtField = MPU_TEX_LEVEL1;
+        region.IsCacheable = MPU_ACCESS_NOT_CACHEABLE;
+        region.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+        if ((MEMATTR_Layout[i].Class == MEMATTR_CLASS_SHARED) || (MEMATTR_Layout[i].Class == MEMATTR_CLASS_IPC))
+        {
+          region.IsShareable = MPU_ACCESS_SHAREABLE;
+        }
+      }
+      HAL_MPU_ConfigRegion(&region);
+    }
+
+    HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+    MEMATTR_Active = Profile;
+    __set_PRIMASK(primask);
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Active profile, MEMATTR_PROFILE_CUBEMX until the first
+ *         MEMATTR_SetProfile().
+ */
+MEMATTR_Profile_t MEMATTR_GetProfile(void)
+{
+  return MEMATTR_Active;
+}
+
+const char *MEMATTR_GetProfileName(MEMATTR_Profile_t Profile)
+{
+  return (Profile < MEMATTR_PROFILE_COUNT) ? MEMATTR_Profiles[Profile].Name : "?";
+}
+
+/**
+ * @brief  Policy of a class in the active profile.
+ */
+MEMATTR_Policy_t MEMATTR_GetPolicy(MEMATTR_Class_t Class)
+{
+  return (Class < MEMATTR_CLASS_COUNT) ? MEMATTR_Profiles[MEMATTR_Active].Policy[Class] : MEMATTR_POLICY_WRITE_BACK;
+}
+
+/**
+ * @brief  Policy at an address: the last layout region holding it, the
+ *         default memory map (write-back for the SRAMs) otherwise.
+ */
+MEMATTR_Policy_t MEMATTR_GetAddrPolicy(uint32_t Addr)
+{
+  MEMATTR_Policy_t policy = MEMATTR_POLICY_WRITE_BACK;
+  uint32_t i;
+
+  for (i = 0; i < (sizeof(MEMATTR_Layout) / sizeof(MEMATTR_Layout[0])); i++)
+  {
+    if ((Addr - MEMATTR_Layout[i].Base) < MEMATTR_Layout[i].Length)
+    {
+      policy = MEMATTR_GetPolicy(MEMATTR_Layout[i].Class);
+    }
+  }
+  return policy;
+}
+
+/**
+ * @brief  Makes CPU writes to a range visible to the DMA masters: cleans it
+ *         when it is write-back, nothing otherwise.
+ * @param  Addr Start of the range
+ * @param  Size Bytes
+ */
+void MEMATTR_CleanRange(const void *Addr, uint32_t Size)
+{
+  if ((Size != 0U) && (MEMATTR_GetAddrPolicy((uint32_t)Addr) == MEMATTR_POLICY_WRITE_BACK))
+  {
+    SCB_CleanDCache_by_Addr((uint32_t *)Addr, (int32_t)Size);
+  }
+}
+
+/**
+ * @brief  Drops cached copies of a range a DMA master wrote, unless it is
+ *         non-cacheable. Lines shared with other data are lost if dirty.
+ * @param  Addr Start of the range
+ * @param  Size Bytes
+ */
+void MEMATTR_InvalidateRange(void *Addr, uint32_t Size)
+{
+  if ((Size != 0U) && (MEMATTR_GetAddrPolicy((uint32_t)Addr) != MEMATTR_POLICY_NON_CACHEABLE))
+  {
+    SCB_InvalidateDCache_by_Addr((uint32_t *)Addr, (int32_t)Size);
+  }
+}
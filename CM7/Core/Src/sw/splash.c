@@ -0,0 +1,191 @@
+#include "sw/splash.h"
+
+#include "driver/lcd.h"
+#include "driver/qspi_arb.h"
+#include "sw/asset.h"
+
+/*
+ * Power-on splash, drawn before LVGL exists.
+ *
+ * The DMA2D clears the LTDC layer 0 framebuffer and copies the image to its
+ * centre, then the backlight goes on: the driver never sees the SDRAM
+ * content left over or the frame being filled. A stored image is read in
+ * place from the memory-mapped flash, an LZ4 one is decoded into the SDRAM
+ * asset cache first.
+ *
+ * Needs the SDRAM, the QSPI flash and its arbiter, nothing else: the touch
+ * controller probed by BSP_LCD_Init() comes later.
+ *
+ * On a warm boot SPLASH_Resume() lights the frame left in the SDRAM instead.
+ */
+
+/* A full 480x272 ARGB8888 frame takes about 2 ms */
+#define SPLASH_DMA2D_TIMEOUT 50U
+
+static int32_t SPLASH_Fill(uint32_t Dst, uint32_t Width, uint32_t Height, uint32_t Color);
+static int32_t SPLASH_Copy(uint32_t Src, uint32_t Dst, uint32_t Width, uint32_t Height, uint32_t OffLine);
+
+/**
+ * @brief  Draws an image of the asset pack in the middle of the screen and
+ *         turns the backlight on. The screen is lit, black, even if the
+ *         image cannot be drawn.
+ * @param  Name       Image in the asset pack, at most the screen size
+ * @param  Brightness Backlight [0: off, 100: max]
+ * @retval BSP status
+ */
+int32_t SPLASH_Show(const char *Name, uint32_t Brightness)
+{
+  int32_t ret;
+  const ASSET_Entry_t *entry = NULL;
+  const uint8_t *data = NULL;
+  uint32_t fb = hltdc.LayerCfg[0].FBStartAdress;
+  uint32_t width = hltdc.LayerCfg[0].ImageWidth;
+  uint32_t height = hltdc.LayerCfg[0].ImageHeight;
+  uint32_t mapped = 0U;
+  uint32_t dst;
+
+  ret = SPLASH_Fill(fb, width, height, LCD_COLOR_ARGB8888_BLACK);
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    ret = ASSET_Init(ASSET_QSPI_BASE);
+  }
+  if (ret == BSP_ERROR_NONE)
+  {
+    ret = ASSET_Find(Name, &entry);
+  }
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    if ((entry->Type != ASSET_TYPE_IMAGE) || (entry->Width > width) || (entry->Height > height))
+    {
+      ret = BSP_ERROR_WRONG_PARAM;
+    }
+    else if (entry->Codec == ASSET_CODEC_RAW)
+    {
+      ret = BSP_QSPI_ArbAcquireMapped();
+      if (ret == BSP_ERROR_NONE)
+      {
+        mapped = 1U;
+        data = (const uint8_t *)(QSPI_ARB_MMP_BASE + ASSET_QSPI_BASE + entry->Offset);
+      }
+    }
+    else
+    {
+      ret = ASSET_Load(Name, &data, NULL);
+      if (ret == BSP_ERROR_NONE)
+      {
+        /* Decoded by the CPU, the DMA2D reads the SDRAM */
+        SCB_CleanDCache_by_Addr((uint32_t *)(uint32_t)data, (int32_t)entry->RawSize);
+      }
+    }
+  }
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    dst = fb + 4U * (((height - entry->Height) / 2U) * width + (width - entry->Width) / 2U);
+    ret = SPLASH_Copy((uint32_t)data, dst, entry->Width, entry->Height, width - entry->Width);
+  }
+  if (mapped != 0U)
+  {
+    BSP_QSPI_ArbReleaseMapped();
+  }
+
+  (void)BSP_LCD_SetBrightness(Brightness);
+  (void)BSP_LCD_DisplayOn();
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Shows the framebuffer left in the SDRAM by the previous boot and
+ *         turns the backlight on.
+ * @param  Framebuffer LTDC layer 0 address
+ * @param  Brightness  Backlight [0: off, 100: max]
+ * @retval BSP status
+ */
+int32_t SPLASH_Resume(uint32_t Framebuffer, uint32_t Brightness)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (HAL_LTDC_SetAddress(&hltdc, Framebuffer, 0U) != HAL_OK)
+  {
+    ret = BSP_ERROR_PERIPH_FAILURE;
+  }
+  else
+  {
+    (void)BSP_LCD_SetBrightness(Brightness);
+    (void)BSP_LCD_DisplayOn();
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Fills a rectangle of the framebuffer with the DMA2D.
+ * @param  Dst    Address of the top-left pixel
+ * @param  Width  Rectangle width
+ * @param  Height Rectangle height
+ * @param  Color  ARGB8888 color
+ * @retval BSP status
+ */
+static int32_t SPLASH_Fill(uint32_t Dst, uint32_t Width, uint32_t Height, uint32_t Color)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  hdma2d.Instance = DMA2D;
+  hdma2d.Init.Mode = DMA2D_R2M;
+  hdma2d.Init.ColorMode = DMA2D_OUTPUT_ARGB8888;
+  hdma2d.Init.OutputOffset = 0U;
+  hdma2d.Init.AlphaInverted = DMA2D_REGULAR_ALPHA;
+  hdma2d.Init.RedBlueSwap = DMA2D_RB_REGULAR;
+
+  if ((HAL_DMA2D_Init(&hdma2d) != HAL_OK) || (HAL_DMA2D_Start(&hdma2d, Color, Dst, Width, Height) != HAL_OK) ||
+      (HAL_DMA2D_PollForTransfer(&hdma2d, SPLASH_DMA2D_TIMEOUT) != HAL_OK))
+  {
+    ret = BSP_ERROR_PERIPH_FAILURE;
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Copies an ARGB8888 image into the framebuffer with the DMA2D.
+ * @param  Src     First pixel of the image
+ * @param  Dst     Framebuffer address of the top-left pixel
+ * @param  Width   Image width
+ * @param  Height  Image height
+ * @param  OffLine Framebuffer pixels skipped at the end of each line
+ * @retval BSP status
+ */
+static int32_t SPLASH_Copy(uint32_t Src, uint32_t Dst, uint32_t Width, uint32_t Height, uint32_t OffLine)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  hdma2d.Instance = DMA2D;
+  hdma2d.Init.Mode = DMA2D_M2M;
+  hdma2d.Init.ColorMode = DMA2D_OUTPUT_ARGB8888;
+  hdma2d.Init.OutputOffset = OffLine;
+  hdma2d.Init.AlphaInverted = DMA2D_REGULAR_ALPHA;
+  hdma2d.Init.RedBlueSwap = DMA2D_RB_REGULAR;
+
+  hdma2d.LayerCfg[1].InputColorMode = DMA2D_INPUT_ARGB8888;
+  hdma2d.LayerCfg[1].InputOffset = 0U;
+  hdma2d.LayerCfg[1].AlphaMode = DMA2D_NO_MODIF_ALPHA;
+  hdma2d.LayerCfg[1].InputAlpha = 0xFFU;
+  hdma2d.LayerCfg[1].AlphaInverted = DMA2D_REGULAR_ALPHA;
+  hdma2d.LayerCfg[1].RedBlueSwap = DMA2D_RB_REGULAR;
+
+  if ((HAL_DMA2D_Init(&hdma2d) != HAL_OK) || (HAL_DMA2D_ConfigLayer(&hdma2d, 1U) != HAL_OK) ||
+      (HAL_DMA2D_Start(&hdma2d, Src, Dst, Width, Height) != HAL_OK) ||
+      (HAL_DMA2D_PollForTransfer(&hdma2d, SPLASH_DMA2D_TIMEOUT) != HAL_OK))
+  {
+    ret = BSP_ERROR_PERIPH_FAILURE;
+  }
+
+  /* Return BSP status */
+  return ret;
+}
@@ -0,0 +1,643 @@
+#include "sw/tlog.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * Append-only telemetry log.
+ *
+ * The log area is a ring of sectors written in physical order. Each used
+ * sector starts with a TLOG_SectorHeader_t page carrying an increasing Seq,
+ * followed by data pages. Records are packed in RAM staging pages and only
+ * whole pages are programmed, each protected by its own CRC, so a power loss
+ * costs at most the staged pages and one torn page.
+ *
+ * Mount trusts nothing that is not covered by a CRC: the sectors ahead of the
+ * head are erased again before use, and the first free page of the head is
+ * checked to be fully erased before it is programmed.
+ *
+ * The producer side (TLOG_Append, TLOG_Flush) and the consumer side (all the
+ * other calls) may live in different contexts, e.g. a CAN interrupt and the
+ * main loop, as long as each side stays in its own. Timestamps must not go
+ * backwards.
+ */
+
+#define TLOG_MAGIC 0x474F4C54U /* "TLOG" */
+#define TLOG_VERSION 1U
+
+#define TLOG_PAGE_DATA (TLOG_PAGE_SIZE - sizeof(TLOG_PageHeader_t))
+#define TLOG_ERASED_LENGTH 0xFFFFU
+
+typedef struct
+{
+  const TLOG_Flash_t *Flash;
+  uint32_t Sectors;
+
+  /* RAM index: Seq and first timestamp of every physical sector, Seq 0 when
+   * the sector holds no log data */
+  uint32_t Seq[TLOG_MAX_SECTORS];
+  uint32_t FirstTs[TLOG_MAX_SECTORS];
+
+  uint32_t Tail;     /* Oldest sector of the log */
+  uint32_t Count;    /* Sectors holding log data, Tail..Head */
+  uint32_t Head;     /* Sector being written */
+  uint32_t HeadPage; /* Next page to program in Head, 0 before the header */
+  uint32_t NextSeq;
+  uint32_t Erased;  /* Sectors after Head known to be erased */
+  uint32_t Erasing; /* Erase of sector Head + Erased + 1 in flight */
+
+  /* Staging ring: pages [StageTail, StageHead) are full, StageHead fills */
+  uint8_t Stage[TLOG_STAGE_PAGES][TLOG_PAGE_SIZE];
+  volatile uint32_t StageHead;
+  volatile uint32_t StageTail;
+  uint32_t Fill;
+
+  TLOG_Stats_t Stats;
+} TLOG_Ctx_t;
+
+static TLOG_Ctx_t TLOG_Ctx;
+
+static uint16_t TLOG_Crc16(uint16_t Crc, const uint8_t *pData, uint32_t Size);
+static uint16_t TLOG_SectorCrc(const TLOG_SectorHeader_t *Header);
+static uint16_t TLOG_PageCrc(const uint8_t *pPage);
+static void TLOG_WaitIdle(void);
+static int32_t TLOG_Mount(void);
+static int32_t TLOG_FindHeadPage(void);
+static void TLOG_StageOpen(void);
+static void TLOG_StageCommit(void);
+static int32_t TLOG_ProgramPage(void);
+static int32_t TLOG_LoadPage(TLOG_Cursor_t *Cursor);
+static int32_t TLOG_PeekRecord(TLOG_Cursor_t *Cursor, TLOG_RecordHeader_t *Header);
+static uint32_t TLOG_PageTimestamp(uint32_t Sector, uint32_t Page);
+
+/**
+ * Mount the log stored on Flash, rebuilding the RAM index from the sector
+ * headers. A blank or foreign area is formatted lazily by TLOG_Process().
+ * @param Flash backend, must stay valid while the log is in use
+ * @return BSP status
+ */
+int32_t TLOG_Init(const TLOG_Flash_t *Flash)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  memset(&TLOG_Ctx, 0, sizeof(TLOG_Ctx));
+
+  if (Flash == NULL || (Flash->Size % TLOG_SECTOR_SIZE) != 0U ||
+      (Flash->Size / TLOG_SECTOR_SIZE) > TLOG_MAX_SECTORS ||
+      (Flash->Size / TLOG_SECTOR_SIZE) < (TLOG_PREERASE_SECTORS + 2U))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    TLOG_Ctx.Flash = Flash;
+    TLOG_Ctx.Sectors = Flash->Size / TLOG_SECTOR_SIZE;
+    ret = TLOG_Mount();
+    TLOG_StageOpen();
+  }
+
+  return ret;
+}
+
+/**
+ * Append a record to the staging buffers. Never touches the flash.
+ * @param Channel user channel id
+ * @param Timestamp sample time, monotonic
+ * @param pData payload
+ * @param Size payload size, up to TLOG_RECORD_MAX_DATA
+ * @return BSP_ERROR_BUSY when the record was dropped because the staging
+ *         buffers are full
+ */
+int32_t TLOG_Append(uint16_t Channel, uint32_t Timestamp, const void *pData, uint8_t Size)
+{
+  TLOG_RecordHeader_t record;
+  TLOG_PageHeader_t *page;
+  uint32_t need = sizeof(record) + Size;
+
+  if (TLOG_Ctx.Flash == NULL)
+    return BSP_ERROR_NO_INIT;
+  if (Size > TLOG_RECORD_MAX_DATA || (Size != 0U && pData == NULL))
+    return BSP_ERROR_WRONG_PARAM;
+
+  if (TLOG_Ctx.Fill + need > TLOG_PAGE_DATA)
+  {
+    TLOG_StageCommit();
+  }
+
+  /* The filling slot is still queued for programming */
+  if (TLOG_Ctx.StageHead - TLOG_Ctx.StageTail >= TLOG_STAGE_PAGES)
+  {
+    TLOG_Ctx.Stats.Dropped++;
+    return BSP_ERROR_BUSY;
+  }
+
+  page = (TLOG_PageHeader_t *)TLOG_Ctx.Stage[TLOG_Ctx.StageHead % TLOG_STAGE_PAGES];
+  if (TLOG_Ctx.Fill == 0U)
+  {
+    page->Timestamp = Timestamp;
+  }
+
+  record.Timestamp = Timestamp;
+  record.Channel = Channel;
+  record.Size = Size;
+  record.Reserved = 0xFFU;
+  memcpy((uint8_t *)page + sizeof(*page) + TLOG_Ctx.Fill, &record, sizeof(record));
+  if (Size != 0U)
+    memcpy((uint8_t *)page + sizeof(*page) + TLOG_Ctx.Fill + sizeof(record), pData, Size);
+  TLOG_Ctx.Fill += need;
+  TLOG_Ctx.Stats.Records++;
+
+  return BSP_ERROR_NONE;
+}
+
+/**
+ * Queue the partially filled staging page, so that it reaches the flash on
+ * the next TLOG_Process() calls. Costs the unused tail of the page.
+ * @return BSP status
+ */
+int32_t TLOG_Flush(void)
+{
+  if (TLOG_Ctx.Flash == NULL)
+    return BSP_ERROR_NO_INIT;
+
+  if (TLOG_Ctx.Fill != 0U && TLOG_Ctx.StageHead - TLOG_Ctx.StageTail < TLOG_STAGE_PAGES)
+  {
+    TLOG_StageCommit();
+  }
+
+  return BSP_ERROR_NONE;
+}
+
+/**
+ * Background step: program at most one staged page or start one erase, and
+ * never wait for the flash. Call it periodically from the main loop.
+ * @return BSP status, BSP_ERROR_BUSY while the flash is working
+ */
+int32_t TLOG_Process(void)
+{
+  const TLOG_Flash_t *flash = TLOG_Ctx.Flash;
+  uint32_t sector;
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (flash == NULL)
+    return BSP_ERROR_NO_INIT;
+
+  if (flash->IsBusy() == BSP_ERROR_BUSY)
+    return BSP_ERROR_BUSY;
+
+  if (TLOG_Ctx.Erasing != 0U)
+  {
+    TLOG_Ctx.Erasing = 0U;
+    TLOG_Ctx.Erased++;
+    TLOG_Ctx.Stats.Erases++;
+  }
+
+  /* Move to the next sector once the head is full and its successor erased */
+  if (TLOG_Ctx.HeadPage >= TLOG_PAGES_PER_SECTOR && TLOG_Ctx.Erased != 0U)
+  {
+    TLOG_Ctx.Head = (TLOG_Ctx.Head + 1U) % TLOG_Ctx.Sectors;
+    TLOG_Ctx.HeadPage = 0U;
+    TLOG_Ctx.Erased--;
+  }
+
+  if (TLOG_Ctx.StageTail != TLOG_Ctx.StageHead && TLOG_Ctx.HeadPage < TLOG_PAGES_PER_SECTOR)
+  {
+    ret = TLOG_ProgramPage();
+  }
+  else if (TLOG_Ctx.Erased < TLOG_PREERASE_SECTORS)
+  {
+    if (TLOG_Ctx.StageTail != TLOG_Ctx.StageHead)
+      TLOG_Ctx.Stats.EraseStalls++;
+
+    /* Recycle the sector after the erased ones, dropping the oldest data */
+    sector = (TLOG_Ctx.Head + TLOG_Ctx.Erased + 1U) % TLOG_Ctx.Sectors;
+    if (TLOG_Ctx.Count != 0U && sector == TLOG_Ctx.Tail)
+    {
+      TLOG_Ctx.Tail = (TLOG_Ctx.Tail + 1U) % TLOG_Ctx.Sectors;
+      TLOG_Ctx.Count--;
+    }
+    TLOG_Ctx.Seq[sector] = 0U;
+
+    ret = flash->EraseSector(sector * TLOG_SECTOR_SIZE);
+    if (ret == BSP_ERROR_NONE)
+      TLOG_Ctx.Erasing = 1U;
+  }
+
+  return ret;
+}
+
+/**
+ * Position Cursor on the first record with a timestamp not older than
+ * Timestamp, or on the oldest record if the log starts later. Binary search
+ * on the RAM index, then on the page headers of one sector.
+ * @param Timestamp time to seek to
+ * @param Cursor cursor to initialise
+ * @return BSP status, TLOG_EOF if no such record is on flash
+ */
+int32_t TLOG_Seek(uint32_t Timestamp, TLOG_Cursor_t *Cursor)
+{
+  TLOG_RecordHeader_t record;
+  uint32_t lo, hi, mid, sector, last;
+  int32_t ret;
+
+  if (TLOG_Ctx.Flash == NULL)
+    return BSP_ERROR_NO_INIT;
+  if (TLOG_Ctx.Count == 0U)
+    return TLOG_EOF;
+
+  /* Last sector starting before Timestamp: records equal to it may start in
+   * the previous sector or page */
+  lo = 0U;
+  hi = TLOG_Ctx.Count;
+  while (hi - lo > 1U)
+  {
+    mid = lo + (hi - lo) / 2U;
+    if (TLOG_Ctx.FirstTs[(TLOG_Ctx.Tail + mid) % TLOG_Ctx.Sectors] < Timestamp)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  sector = (TLOG_Ctx.Tail + lo) % TLOG_Ctx.Sectors;
+
+  /* Last page starting before Timestamp */
+  last = (sector == TLOG_Ctx.Head) ? TLOG_Ctx.HeadPage : TLOG_PAGES_PER_SECTOR;
+  lo = 1U;
+  hi = (last > 1U) ? last : 2U;
+  while (hi - lo > 1U)
+  {
+    mid = lo + (hi - lo) / 2U;
+    if (TLOG_PageTimestamp(sector, mid) < Timestamp)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  Cursor->Sector = sector;
+  Cursor->Seq = TLOG_Ctx.Seq[sector];
+  Cursor->Page = lo;
+  Cursor->Valid = 0U;
+
+  while ((ret = TLOG_PeekRecord(Cursor, &record)) == BSP_ERROR_NONE && record.Timestamp < Timestamp)
+  {
+    Cursor->Offset += sizeof(record) + record.Size;
+  }
+
+  return ret;
+}
+
+/**
+ * Read the record under Cursor and advance it. Torn pages are skipped.
+ * @param Cursor cursor set up by TLOG_Seek()
+ * @param Record output record
+ * @return BSP status, TLOG_EOF once all programmed records were read; the
+ *         cursor can be used again after more data reached the flash
+ */
+int32_t TLOG_ReadNext(TLOG_Cursor_t *Cursor, TLOG_Record_t *Record)
+{
+  TLOG_RecordHeader_t record;
+  int32_t ret;
+
+  if (TLOG_Ctx.Flash == NULL)
+    return BSP_ERROR_NO_INIT;
+
+  ret = TLOG_PeekRecord(Cursor, &record);
+  if (ret == BSP_ERROR_NONE)
+  {
+    Record->Timestamp = record.Timestamp;
+    Record->Channel = record.Channel;
+    Record->Size = record.Size;
+    memcpy(Record->Data, &Cursor->Cache[Cursor->Offset + sizeof(record)], record.Size);
+    Cursor->Offset += sizeof(record) + record.Size;
+  }
+
+  return ret;
+}
+
+/**
+ * Copy the logger counters.
+ * @param Stats output
+ */
+void TLOG_GetStats(TLOG_Stats_t *Stats)
+{
+  *Stats = TLOG_Ctx.Stats;
+}
+
+/**
+ * CRC-16/CCITT-FALSE, nibble table.
+ */
+static uint16_t TLOG_Crc16(uint16_t Crc, const uint8_t *pData, uint32_t Size)
+{
+  static const uint16_t table[16] = {0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+                                     0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF};
+
+  while (Size-- != 0U)
+  {
+    Crc = (uint16_t)((Crc << 4) ^ table[(Crc >> 12) ^ (*pData >> 4)]);
+    Crc = (uint16_t)((Crc << 4) ^ table[(Crc >> 12) ^ (*pData & 0x0FU)]);
+    pData++;
+  }
+
+  return Crc;
+}
+
+static uint16_t TLOG_SectorCrc(const TLOG_SectorHeader_t *Header)
+{
+  return TLOG_Crc16(0xFFFFU, (const uint8_t *)Header, offsetof(TLOG_SectorHeader_t, Crc));
+}
+
+static uint16_t TLOG_PageCrc(const uint8_t *pPage)
+{
+  const TLOG_PageHeader_t *header = (const TLOG_PageHeader_t *)pPage;
+  uint16_t crc;
+
+  crc = TLOG_Crc16(0xFFFFU, pPage, offsetof(TLOG_PageHeader_t, Crc));
+  return TLOG_Crc16(crc, pPage + sizeof(*header), header->Length);
+}
+
+/**
+ * Reads are not possible while the array programs or erases, unless the
+ * backend suspends the operation itself.
+ */
+static void TLOG_WaitIdle(void)
+{
+  if (TLOG_Ctx.Flash->ReadWhileBusy != 0U)
+    return;
+
+  while (TLOG_Ctx.Flash->IsBusy() == BSP_ERROR_BUSY)
+  {
+  }
+}
+
+/**
+ * Rebuild the sector index and find the write head.
+ */
+static int32_t TLOG_Mount(void)
+{
+  TLOG_SectorHeader_t header;
+  uint32_t sector, newest = 0U, i;
+  int32_t ret = BSP_ERROR_NONE;
+
+  TLOG_WaitIdle();
+
+  for (sector = 0U; sector < TLOG_Ctx.Sectors && ret == BSP_ERROR_NONE; sector++)
+  {
+    ret = TLOG_Ctx.Flash->Read((uint8_t *)&header, sector * TLOG_SECTOR_SIZE, sizeof(header));
+    if (ret == BSP_ERROR_NONE && header.Magic == TLOG_MAGIC && header.Version == TLOG_VERSION &&
+        header.Seq != 0U && header.Crc == TLOG_SectorCrc(&header))
+    {
+      TLOG_Ctx.Seq[sector] = header.Seq;
+      TLOG_Ctx.FirstTs[sector] = header.FirstTimestamp;
+      if (header.Seq > newest)
+      {
+        newest = header.Seq;
+        TLOG_Ctx.Head = sector;
+      }
+    }
+  }
+
+  if (ret != BSP_ERROR_NONE)
+    return ret;
+
+  if (newest == 0U)
+  {
+    /* Blank log: pretend the sector before 0 is full so that sector 0 is
+     * erased and used first */
+    TLOG_Ctx.Head = TLOG_Ctx.Sectors - 1U;
+    TLOG_Ctx.HeadPage = TLOG_PAGES_PER_SECTOR;
+    TLOG_Ctx.NextSeq = 1U;
+    return BSP_ERROR_NONE;
+  }
+
+  /* The log is the run of sectors with decreasing Seq ending at the head */
+  TLOG_Ctx.Count = 1U;
+  for (i = 1U; i < TLOG_Ctx.Sectors; i++)
+  {
+    sector = (TLOG_Ctx.Head + TLOG_Ctx.Sectors - i) % TLOG_Ctx.Sectors;
+    if (TLOG_Ctx.Seq[sector] == 0U || TLOG_Ctx.Seq[sector] >= TLOG_Ctx.Seq[(sector + 1U) % TLOG_Ctx.Sectors])
+      break;
+    TLOG_Ctx.Count++;
+  }
+  TLOG_Ctx.Tail = (TLOG_Ctx.Head + TLOG_Ctx.Sectors + 1U - TLOG_Ctx.Count) % TLOG_Ctx.Sectors;
+  TLOG_Ctx.NextSeq = newest + 1U;
+
+  /* Whatever is outside the run is garbage that will be erased before use */
+  for (i = TLOG_Ctx.Count; i < TLOG_Ctx.Sectors; i++)
+  {
+    TLOG_Ctx.Seq[(TLOG_Ctx.Tail + i) % TLOG_Ctx.Sectors] = 0U;
+  }
+
+  return TLOG_FindHeadPage();
+}
+
+/**
+ * Pages are programmed in order, so the first page with an erased header is
+ * found by binary search. It is only reused if the whole page is still
+ * erased: a torn program may have left the header blank and the data not.
+ */
+static int32_t TLOG_FindHeadPage(void)
+{
+  TLOG_PageHeader_t header;
+  uint8_t page[TLOG_PAGE_SIZE];
+  uint32_t base = TLOG_Ctx.Head * TLOG_SECTOR_SIZE;
+  uint32_t lo = 1U, hi = TLOG_PAGES_PER_SECTOR, mid, i;
+  int32_t ret = BSP_ERROR_NONE;
+
+  /* First page in [lo, hi) with an erased header, hi if none */
+  while (lo < hi && ret == BSP_ERROR_NONE)
+  {
+    mid = lo + (hi - lo) / 2U;
+    ret = TLOG_Ctx.Flash->Read((uint8_t *)&header, base + mid * TLOG_PAGE_SIZE, sizeof(header));
+    if (header.Length == TLOG_ERASED_LENGTH && header.Timestamp == 0xFFFFFFFFU)
+      hi = mid;
+    else
+      lo = mid + 1U;
+  }
+  TLOG_Ctx.HeadPage = lo;
+
+  if (ret == BSP_ERROR_NONE && lo < TLOG_PAGES_PER_SECTOR)
+  {
+    ret = TLOG_Ctx.Flash->Read(page, base + lo * TLOG_PAGE_SIZE, sizeof(page));
+    for (i = 0U; i < sizeof(page); i++)
+    {
+      if (page[i] != 0xFFU)
+      {
+        TLOG_Ctx.HeadPage = lo + 1U;
+        TLOG_Ctx.Stats.TornPages++;
+        break;
+      }
+    }
+  }
+
+  return ret;
+}
+
+static void TLOG_StageOpen(void)
+{
+  memset(TLOG_Ctx.Stage[TLOG_Ctx.StageHead % TLOG_STAGE_PAGES], 0xFF, TLOG_PAGE_SIZE);
+  TLOG_Ctx.Fill = 0U;
+}
+
+static void TLOG_StageCommit(void)
+{
+  uint8_t *page = TLOG_Ctx.Stage[TLOG_Ctx.StageHead % TLOG_STAGE_PAGES];
+  TLOG_PageHeader_t *header = (TLOG_PageHeader_t *)page;
+  uint32_t depth;
+
+  header->Length = (uint16_t)TLOG_Ctx.Fill;
+  header->Crc = TLOG_PageCrc(page);
+
+  TLOG_Ctx.StageHead++;
+  depth = TLOG_Ctx.StageHead - TLOG_Ctx.StageTail;
+  if (depth > TLOG_Ctx.Stats.StageHigh)
+    TLOG_Ctx.Stats.StageHigh = depth;
+
+  if (depth < TLOG_STAGE_PAGES)
+    TLOG_StageOpen();
+  else
+    TLOG_Ctx.Fill = 0U;
+}
+
+/**
+ * Program the oldest staged page at the head, writing the sector header
+ * first when the head is a fresh sector.
+ */
+static int32_t TLOG_ProgramPage(void)
+{
+  const TLOG_Flash_t *flash = TLOG_Ctx.Flash;
+  uint8_t *page = TLOG_Ctx.Stage[TLOG_Ctx.StageTail % TLOG_STAGE_PAGES];
+  uint32_t base = TLOG_Ctx.Head * TLOG_SECTOR_SIZE;
+  TLOG_SectorHeader_t header;
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (TLOG_Ctx.HeadPage == 0U)
+  {
+    header.Magic = TLOG_MAGIC;
+    header.Seq = TLOG_Ctx.NextSeq;
+    header.FirstTimestamp = ((TLOG_PageHeader_t *)page)->Timestamp;
+    header.Version = TLOG_VERSION;
+    header.Crc = TLOG_SectorCrc(&header);
+
+    ret = flash->Write((uint8_t *)&header, base, sizeof(header));
+    if (ret != BSP_ERROR_NONE)
+      return ret;
+
+    TLOG_Ctx.NextSeq++;
+    TLOG_Ctx.Seq[TLOG_Ctx.Head] = header.Seq;
+    TLOG_Ctx.FirstTs[TLOG_Ctx.Head] = header.FirstTimestamp;
+    if (TLOG_Ctx.Count == 0U)
+      TLOG_Ctx.Tail = TLOG_Ctx.Head;
+    TLOG_Ctx.Count++;
+    TLOG_Ctx.HeadPage = 1U;
+
+    /* One flash operation per call */
+    return BSP_ERROR_NONE;
+  }
+
+  ret = flash->Write(page, base + TLOG_Ctx.HeadPage * TLOG_PAGE_SIZE, TLOG_PAGE_SIZE);
+  if (ret == BSP_ERROR_NONE)
+  {
+    TLOG_Ctx.HeadPage++;
+    TLOG_Ctx.Stats.Pages++;
+
+    /* The producer left the filling slot closed because the ring was full:
+     * it is the page just programmed, reopen it before releasing it */
+    if (TLOG_Ctx.StageHead - TLOG_Ctx.StageTail == TLOG_STAGE_PAGES)
+      TLOG_StageOpen();
+    TLOG_Ctx.StageTail++;
+  }
+
+  return ret;
+}
+
+/**
+ * Make sure the cursor cache holds a valid page with a record at Offset,
+ * walking across pages and sectors.
+ */
+static int32_t TLOG_LoadPage(TLOG_Cursor_t *Cursor)
+{
+  TLOG_PageHeader_t *header = (TLOG_PageHeader_t *)Cursor->Cache;
+  uint32_t last;
+  int32_t ret;
+
+  for (;;)
+  {
+    /* Sector recycled under the cursor: restart from the oldest data */
+    if (TLOG_Ctx.Seq[Cursor->Sector] != Cursor->Seq || Cursor->Seq == 0U)
+    {
+      if (TLOG_Ctx.Count == 0U)
+        return TLOG_EOF;
+      Cursor->Sector = TLOG_Ctx.Tail;
+      Cursor->Seq = TLOG_Ctx.Seq[TLOG_Ctx.Tail];
+      Cursor->Page = 1U;
+      Cursor->Valid = 0U;
+    }
+
+    last = (Cursor->Sector == TLOG_Ctx.Head) ? TLOG_Ctx.HeadPage : TLOG_PAGES_PER_SECTOR;
+    if (Cursor->Page >= last)
+    {
+      /* End of the log, possibly a new head without its header yet: stay
+       * here so the next call picks up what gets programmed meanwhile */
+      if (Cursor->Sector == TLOG_Ctx.Head || TLOG_Ctx.Seq[(Cursor->Sector + 1U) % TLOG_Ctx.Sectors] == 0U)
+        return TLOG_EOF;
+      Cursor->Sector = (Cursor->Sector + 1U) % TLOG_Ctx.Sectors;
+      Cursor->Seq = TLOG_Ctx.Seq[Cursor->Sector];
+      Cursor->Page = 1U;
+      Cursor->Valid = 0U;
+      continue;
+    }
+
+    if (Cursor->Valid == 0U)
+    {
+      TLOG_WaitIdle();
+      ret = TLOG_Ctx.Flash->Read(Cursor->Cache, Cursor->Sector * TLOG_SECTOR_SIZE + Cursor->Page * TLOG_PAGE_SIZE,
+                                 TLOG_PAGE_SIZE);
+      if (ret != BSP_ERROR_NONE)
+        return ret;
+
+      if (header->Length > TLOG_PAGE_DATA || header->Crc != TLOG_PageCrc(Cursor->Cache))
+      {
+        TLOG_Ctx.Stats.TornPages++;
+        Cursor->Page++;
+        continue;
+      }
+      Cursor->Valid = 1U;
+      Cursor->Offset = sizeof(*header);
+    }
+
+    if (Cursor->Offset + sizeof(TLOG_RecordHeader_t) > sizeof(*header) + header->Length)
+    {
+      Cursor->Page++;
+      Cursor->Valid = 0U;
+      continue;
+    }
+
+    return BSP_ERROR_NONE;
+  }
+}
+
+static int32_t TLOG_PeekRecord(TLOG_Cursor_t *Cursor, TLOG_RecordHeader_t *Header)
+{
+  int32_t ret = TLOG_LoadPage(Cursor);
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    memcpy(Header, &Cursor->Cache[Cursor->Offset], sizeof(*Header));
+  }
+
+  return ret;
+}
+
+/**
+ * Timestamp of a page for the seek, erased or unreadable pages sort last.
+ */
+static uint32_t TLOG_PageTimestamp(uint32_t Sector, uint32_t Page)
+{
+  TLOG_PageHeader_t header;
+
+  TLOG_WaitIdle();
+  if (TLOG_Ctx.Flash->Read((uint8_t *)&header, Sector * TLOG_SECTOR_SIZE + Page * TLOG_PAGE_SIZE, sizeof(header)) !=
+      BSP_ERROR_NONE)
+    return 0xFFFFFFFFU;
+
+  return header.Timestamp;
+}
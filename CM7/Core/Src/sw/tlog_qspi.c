@@ -0,0 +1,56 @@
+#include "sw/tlog_qspi.h"
+
+#include "driver/qspi_arb.h"
+
+static int32_t TLOG_QSPI_Read(uint8_t *pData, uint32_t Addr, uint32_t Size);
+static int32_t TLOG_QSPI_Write(uint8_t *pData, uint32_t Addr, uint32_t Size);
+static int32_t TLOG_QSPI_EraseSector(uint32_t Addr);
+static int32_t TLOG_QSPI_IsBusy(void);
+
+/**
+ * Telemetry log backend on the MT25TL01G. Programs and erases go through the
+ * QSPI arbiter (BSP_QSPI_ArbInit() must have been called) and are batched into
+ * its write windows, the flash stays memory-mapped for the assets in between.
+ * Seeks during a window suspend the operation in flight instead of waiting.
+ */
+const TLOG_Flash_t TLOG_QSPI_Flash = {
+    .Read = TLOG_QSPI_Read,
+    .Write = TLOG_QSPI_Write,
+    .EraseSector = TLOG_QSPI_EraseSector,
+    .IsBusy = TLOG_QSPI_IsBusy,
+    .Size = TLOG_QSPI_SIZE,
+    .ReadWhileBusy = 1U,
+};
+
+static int32_t TLOG_QSPI_Read(uint8_t *pData, uint32_t Addr, uint32_t Size)
+{
+  return BSP_QSPI_ArbRead(pData, TLOG_QSPI_BASE + Addr, Size);
+}
+
+static int32_t TLOG_QSPI_Write(uint8_t *pData, uint32_t Addr, uint32_t Size)
+{
+  return BSP_QSPI_ArbWrite(pData, TLOG_QSPI_BASE + Addr, Size);
+}
+
+static int32_t TLOG_QSPI_EraseSector(uint32_t Addr)
+{
+  return BSP_QSPI_ArbErase(TLOG_QSPI_BASE + Addr, BSP_QSPI_ERASE_128K);
+}
+
+/**
+ * The log polls the flash from TLOG_Process(), let it pump the arbiter. The
+ * scheduler runs its queue in order, an erase before the programs queued
+ * after it, so the log only waits once the queue cannot take one more
+ * operation: it keeps enough queued for the arbiter to open a write window
+ * at QSPI_ARB_BATCH_OPS instead of one operation per batching delay.
+ */
+static int32_t TLOG_QSPI_IsBusy(void)
+{
+  int32_t ret = BSP_QSPI_ArbProcess();
+
+  if (ret == BSP_ERROR_BUSY)
+  {
+    ret = (BSP_QSPI_SchedGetPending() >= QSPI_SCHED_QUEUE_DEPTH) ? BSP_ERROR_BUSY : BSP_ERROR_NONE;
+  }
+  return ret;
+}
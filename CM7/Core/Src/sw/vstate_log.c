@@ -0,0 +1,101 @@
+#include "sw/vstate_log.h"
+
+#include <string.h>
+
+#include "can_msgs.h"
+#include "ipc.h"
+#include "main.h"
+#include "sw/tlog.h"
+
+/*
+ * Vehicle telemetry recorder.
+ *
+ * The CM4 forwards every frame of the logged messages (CAN_DB_Logged, up to
+ * the interval of each channel) over the inter-core ring as it dispatches
+ * it. Each one becomes a telemetry log record: channel = message index,
+ * payload = its decoded CAN_MSG_<NAME>_t, stamped with the start of the
+ * frame in milliseconds of the system timebase, the clock of
+ * __time_uptime(). The two buses are dispatched in turn, a frame can come
+ * in behind a newer one of the other bus: it takes the newer stamp, the log
+ * does not go back. A record the log could not stage is lost and counted
+ * in its statistics.
+ */
+
+typedef struct
+{
+  uint32_t LastMs; /* Stamp of the last record */
+  uint32_t FlushMs;
+  uint32_t Invalid; /* Forwarded frames of an unknown message or length */
+} VSTATE_LOG_Ctx_t;
+
+static VSTATE_LOG_Ctx_t VSTATE_LOG_Ctx;
+
+_Static_assert(IPC_CAN_LOG_DATA_MAX >= CAN_MSGS_DATA_MIN, "Unpack reads past IPC_CanLog_t.Data");
+
+static void VSTATE_LOG_Record(const IPC_CanLog_t *pFrame);
+
+/**
+ * @brief  Starts the recorder. After TLOG_Init() and IPC_Init().
+ */
+void VSTATE_LOG_Init(void)
+{
+  memset(&VSTATE_LOG_Ctx, 0, sizeof(VSTATE_LOG_Ctx));
+  VSTATE_LOG_Ctx.FlushMs = HAL_GetTick();
+}
+
+/**
+ * @brief  Logs the frames the CM4 forwarded, and flushes the staged page
+ *         every VSTATE_LOG_FLUSH_MS. Main loop context; TLOG_Process()
+ *         programs the pages.
+ */
+void VSTATE_LOG_Process(void)
+{
+  IPC_Msg_t msg;
+  IPC_CanLog_t frame;
+  uint32_t now = HAL_GetTick();
+
+  /* The empty receive that ends the pass arms the doorbell */
+  while (IPC_Receive(IPC_CH_M4_TO_M7, &msg) != 0U)
+  {
+    if ((msg.Type == IPC_TYPE_CAN_LOG) && (msg.Len <= sizeof(frame)))
+    {
+      memset(&frame, 0, sizeof(frame));
+      memcpy(&frame, msg.Data, msg.Len);
+      VSTATE_LOG_Record(&frame);
+    }
+  }
+
+  if ((now - VSTATE_LOG_Ctx.FlushMs) >= VSTATE_LOG_FLUSH_MS)
+  {
+    VSTATE_LOG_Ctx.FlushMs = now;
+    (void)TLOG_Flush();
+  }
+}
+
+/**
+ * @brief  Forwarded frames dropped for an unknown message or a length that
+ *         is not the DBC one.
+ */
+uint32_t VSTATE_LOG_GetInvalid(void)
+{
+  return VSTATE_LOG_Ctx.Invalid;
+}
+
+static void VSTATE_LOG_Record(const IPC_CanLog_t *pFrame)
+{
+  CAN_MSGS_Any_t signals;
+
+  if ((pFrame->Msg >= CAN_MSGS_COUNT) || (pFrame->Len != CAN_MSGS_Table[pFrame->Msg].Dlc))
+  {
+    VSTATE_LOG_Ctx.Invalid++;
+    return;
+  }
+
+  if ((int32_t)(pFrame->TimeMs - VSTATE_LOG_Ctx.LastMs) > 0)
+  {
+    VSTATE_LOG_Ctx.LastMs = pFrame->TimeMs;
+  }
+  /* The bytes past the DLC are zero, Unpack reads CAN_MSGS_DATA_MIN */
+  CAN_MSGS_Table[pFrame->Msg].Unpack(&signals, pFrame->Data);
+  (void)TLOG_Append(pFrame->Msg, VSTATE_LOG_Ctx.LastMs, &signals, (uint8_t)CAN_MSGS_Table[pFrame->Msg].Size);
+}
@@ -93,6 +93,38 @@ LoopFillZerobss:
   cmp r2, r4
   bcc FillZerobss
 
+/* Copy the hot code to the ITCM */
+  ldr r0, =_sitcm
+  ldr r1, =_eitcm
+  ldr r2, =_siitcm
+  bl CopySection
+
+/* Copy the hot data to the DTCM and zero the rest of it */
+  ldr r0, =_sdtcm_data
+  ldr r1, =_edtcm_data
+  ldr r2, =_sidtcm_data
+  bl CopySection
+  ldr r0, =_sdtcm_bss
+  ldr r1, =_edtcm_bss
+  bl ZeroSection
+
+/* Enable the D2 SRAM1/2/3 clocks (RCC_AHB2ENR), then copy and zero the
+ * D2 DMA buffers */
+  ldr r0, =0x580244DC
+  ldr r1, [r0]
+  orr r1, r1, #0xE0000000
+  str r1, [r0]
+  ldr r1, [r0]
+  ldr r0, =_sd2_data
+  ldr r1, =_ed2_data
+  ldr r2, =_sid2_data
+  bl CopySection
+  ldr r0, =_sd2_bss
+  ldr r1, =_ed2_bss
+  bl ZeroSection
+  dsb
+  isb
+
 /* Call static constructors */
     bl __libc_init_array
 /* Call the application's entry point.*/
@@ -100,6 +132,34 @@ LoopFillZerobss:
   bx  lr
 .size  Reset_Handler, .-Reset_Handler
 
+/* Copy [r0, r1) from r2, word by word */
+  .section  .text.CopySection,"ax",%progbits
+  .type  CopySection, %function
+CopySection:
+  b LoopCopySection
+CopySectionWord:
+  ldr r3, [r2], #4
+  str r3, [r0], #4
+LoopCopySection:
+  cmp r0, r1
+  bcc CopySectionWord
+  bx lr
+.size  CopySection, .-CopySection
+
+/* Zero [r0, r1), word by word */
+  .section  .text.ZeroSection,"ax",%progbits
+  .type  ZeroSection, %function
+ZeroSection:
+  movs r3, #0
+  b LoopZeroSection
+ZeroSectionWord:
+  str r3, [r0], #4
+LoopZeroSection:
+  cmp r0, r1
+  bcc ZeroSectionWord
+  bx lr
+.size  ZeroSection, .-ZeroSection
+
 /**
  * @brief  This is the code that gets called when the processor receives an
  *         unexpected interrupt.  This simply enters an infinite loop, preserving
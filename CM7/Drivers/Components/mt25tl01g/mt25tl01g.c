@@ -1,5 +1,10 @@
 #include "mt25tl01g.h"
 
+static void MT25TL01G_ReadCommandDTR(MT25TL01G_InterfaceTypeDef Mode, QSPI_CommandTypeDef *s_command,
+                                     uint32_t ReadAddr, uint32_t Size);
+static void MT25TL01G_ReadCommandSTR(MT25TL01G_InterfaceTypeDef Mode, QSPI_CommandTypeDef *s_command,
+                                     uint32_t ReadAddr, uint32_t Size);
+
 /**
  * @brief  Return the configuration of the QSPI memory.
  * @param  pInfo pointer on the configuration structure
@@ -278,48 +283,8 @@ MT25TL01G_StatusTypeDef MT25TL01G_ReadDTR(QSPI_HandleTypeDef *Ctx, MT25TL01G_Int
                                           uint32_t ReadAddr, uint32_t Size)
 {
     QSPI_CommandTypeDef s_command;
-    switch (Mode)
-    {
-    case MT25TL01G_SPI_MODE: /* 1-1-1 commands, Power on H/W default setting */
-        s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;
-        s_command.Instruction = MT25TL01G_FAST_READ_4_BYTE_DTR_CMD;
-        s_command.AddressMode = QSPI_ADDRESS_1_LINE;
-        s_command.DataMode = QSPI_DATA_1_LINE;
-
-        break;
-    case MT25TL01G_SPI_2IO_MODE: /* 1-1-2 read commands */
-
-        s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;
-        s_command.Instruction = MT25TL01G_DUAL_OUT_FAST_READ_DTR_CMD;
-        s_command.AddressMode = QSPI_ADDRESS_1_LINE;
-        s_command.DataMode = QSPI_DATA_2_LINES;
-
-        break;
-    case MT25TL01G_SPI_4IO_MODE: /* 1-4-4 read commands */
-
-        s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;
-        s_command.Instruction = MT25TL01G_QUAD_INOUT_FAST_READ_4_BYTE_DTR_CMD;
-        s_command.AddressMode = QSPI_ADDRESS_4_LINES;
-        s_command.DataMode = QSPI_DATA_4_LINES;
-
-        break;
-    case MT25TL01G_QPI_MODE: /* 4-4-4 commands */
-        s_command.InstructionMode = QSPI_INSTRUCTION_4_LINES;
-        s_command.Instruction = MT25TL01G_QUAD_INOUT_FAST_READ_DTR_CMD;
-        s_command.AddressMode = QSPI_ADDRESS_4_LINES;
-        s_command.DataMode = QSPI_DATA_4_LINES;
 
-        break;
-    }
-    /* Initialize the read command */
-    s_command.DummyCycles = MT25TL01G_DUMMY_CYCLES_READ_QUAD_DTR;
-    s_command.AddressSize = QSPI_ADDRESS_32_BITS;
-    s_command.Address = ReadAddr;
-    s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
-    s_command.NbData = Size;
-    s_command.DdrMode = QSPI_DDR_MODE_ENABLE;
-    s_command.DdrHoldHalfCycle = QSPI_DDR_HHC_HALF_CLK_DELAY;
-    s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD;
+    MT25TL01G_ReadCommandDTR(Mode, &s_command, ReadAddr, Size);
 
     /* Configure the command */
     if (HAL_QSPI_Command(Ctx, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK)
@@ -351,48 +316,8 @@ MT25TL01G_StatusTypeDef MT25TL01G_ReadSTR(QSPI_HandleTypeDef *Ctx, MT25TL01G_Int
                                           uint32_t ReadAddr, uint32_t Size)
 {
     QSPI_CommandTypeDef s_command;
-    switch (Mode)
-    {
-    case MT25TL01G_SPI_MODE: /* 1-1-1 read commands */
-        s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;
-        s_command.Instruction = MT25TL01G_FAST_READ_4_BYTE_ADDR_CMD;
-        s_command.AddressMode = QSPI_ADDRESS_1_LINE;
-        s_command.DataMode = QSPI_DATA_1_LINE;
-
-        break;
-    case MT25TL01G_SPI_2IO_MODE: /* 1-2-2 read commands */
-
-        s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;
-        s_command.Instruction = MT25TL01G_DUAL_INOUT_FAST_READ_4_BYTE_ADDR_CMD;
-        s_command.AddressMode = QSPI_ADDRESS_2_LINES;
-        s_command.DataMode = QSPI_DATA_2_LINES;
-
-        break;
-    case MT25TL01G_SPI_4IO_MODE: /* 1-4-4 read commands */
-
-        s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;
-        s_command.Instruction = MT25TL01G_QUAD_INOUT_FAST_READ_4_BYTE_ADDR_CMD;
-        s_command.AddressMode = QSPI_ADDRESS_4_LINES;
-        s_command.DataMode = QSPI_DATA_4_LINES;
 
-        break;
-    case MT25TL01G_QPI_MODE: /* 4-4-4 commands */
-        s_command.InstructionMode = QSPI_INSTRUCTION_4_LINES;
-        s_command.Instruction = MT25TL01G_QUAD_INOUT_FAST_READ_CMD;
-        s_command.AddressMode = QSPI_ADDRESS_4_LINES;
-        s_command.DataMode = QSPI_DATA_4_LINES;
-
-        break;
-    }
-    /* Initialize the read command */
-    s_command.DummyCycles = MT25TL01G_DUMMY_CYCLES_READ;
-    s_command.AddressSize = QSPI_ADDRESS_32_BITS;
-    s_command.Address = ReadAddr;
-    s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
-    s_command.NbData = Size;
-    s_command.DdrMode = QSPI_DDR_MODE_DISABLE;
-    s_command.DdrHoldHalfCycle = QSPI_DDR_HHC_ANALOG_DELAY;
-    s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD;
+    MT25TL01G_ReadCommandSTR(Mode, &s_command, ReadAddr, Size);
 
     /* Configure the command */
     if (HAL_QSPI_Command(Ctx, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK)
@@ -533,6 +458,74 @@ MT25TL01G_StatusTypeDef MT25TL01G_ReadStatusRegister(QSPI_HandleTypeDef *Ctx, MT
     return MT25TL01G_OK;
 }
 
+/**
+ * @brief  Read Flag Status register value of both dies
+ *         SPI/QPI; 1-0-1/4-0-4
+ * @param  Ctx Component object pointer
+ * @param  Mode Interface mode
+ * @param  Value pointer to 2 bytes, one flag status register per die
+ * @retval QSPI memory status
+ */
+MT25TL01G_StatusTypeDef MT25TL01G_ReadFlagStatusRegister(QSPI_HandleTypeDef *Ctx, MT25TL01G_InterfaceTypeDef Mode,
+                                                         uint8_t *Value)
+{
+    QSPI_CommandTypeDef s_command;
+    /* Initialize the read flag status register command */
+    s_command.InstructionMode = (Mode == MT25TL01G_QPI_MODE) ? QSPI_INSTRUCTION_4_LINES : QSPI_INSTRUCTION_1_LINE;
+    s_command.Instruction = MT25TL01G_READ_FLAG_STATUS_REG_CMD;
+    s_command.AddressMode = QSPI_ADDRESS_NONE;
+    s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+    s_command.DataMode = (Mode == MT25TL01G_QPI_MODE) ? QSPI_DATA_4_LINES : QSPI_DATA_1_LINE;
+    s_command.DummyCycles = 0;
+    s_command.NbData = 2;
+    s_command.DdrMode = QSPI_DDR_MODE_DISABLE;
+    s_command.DdrHoldHalfCycle = QSPI_DDR_HHC_ANALOG_DELAY;
+    s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD;
+
+    /* Configure the command */
+    if (HAL_QSPI_Command(Ctx, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK)
+    {
+        return MT25TL01G_ERROR_COMMAND;
+    }
+
+    /* Reception of the data */
+    if (HAL_QSPI_Receive(Ctx, Value, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK)
+    {
+        return MT25TL01G_ERROR_RECEIVE;
+    }
+
+    return MT25TL01G_OK;
+}
+
+/**
+ * @brief  Clear the error and suspend bits of the Flag Status register
+ *         SPI/QPI; 1-0-0/4-0-0
+ * @param  Ctx Component object pointer
+ * @param  Mode Interface mode
+ * @retval QSPI memory status
+ */
+MT25TL01G_StatusTypeDef MT25TL01G_ClearFlagStatusRegister(QSPI_HandleTypeDef *Ctx, MT25TL01G_InterfaceTypeDef Mode)
+{
+    QSPI_CommandTypeDef s_command;
+
+    s_command.InstructionMode = (Mode == MT25TL01G_QPI_MODE) ? QSPI_INSTRUCTION_4_LINES : QSPI_INSTRUCTION_1_LINE;
+    s_command.Instruction = MT25TL01G_CLEAR_FLAG_STATUS_REG_CMD;
+    s_command.AddressMode = QSPI_ADDRESS_NONE;
+    s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+    s_command.DataMode = QSPI_DATA_NONE;
+    s_command.DummyCycles = 0;
+    s_command.DdrMode = QSPI_DDR_MODE_DISABLE;
+    s_command.DdrHoldHalfCycle = QSPI_DDR_HHC_ANALOG_DELAY;
+    s_command.SIOOMode = QSPI_SIOO_INST_EVERY_CMD;
+
+    if (HAL_QSPI_Command(Ctx, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK)
+    {
+        return MT25TL01G_ERROR_COMMAND;
+    }
+
+    return MT25TL01G_OK;
+}
+
 /**
  * @brief  This function put QSPI memory in QPI mode (Quad I/O) from SPI mode.
  *         SPI -> QPI; 1-x-x -> 4-4-4
@@ -993,3 +986,179 @@ MT25TL01G_StatusTypeDef MT25TL01G_ReadSPBLockRegister(QSPI_HandleTypeDef *Ctx, M
 
     return MT25TL01G_OK;
 }
+
+/**
+ * @brief  Starts an MDMA read of an amount of data from the QSPI memory on
+ *         DTR mode. Completion is reported through HAL_QSPI_RxCpltCallback().
+ *         SPI/QPI; 1-1-1/1-1-2/1-4-4/4-4-4
+ * @param  Ctx Component object pointer, hmdma must be linked
+ * @param  Mode Interface mode
+ * @param  pData Pointer to data to be read
+ * @param  ReadAddr Read start address
+ * @param  Size Size of data to read, at most 64KB per MDMA block
+ * @retval QSPI memory status
+ */
+MT25TL01G_StatusTypeDef MT25TL01G_ReadDTR_DMA(QSPI_HandleTypeDef *Ctx, MT25TL01G_InterfaceTypeDef Mode, uint8_t *pData,
+                                              uint32_t ReadAddr, uint32_t Size)
+{
+    QSPI_CommandTypeDef s_command;
+
+    MT25TL01G_ReadCommandDTR(Mode, &s_command, ReadAddr, Size);
+
+    /* Configure the command */
+    if (HAL_QSPI_Command(Ctx, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK)
+    {
+        return MT25TL01G_ERROR_COMMAND;
+    }
+
+    /* Start the reception of the data */
+    if (HAL_QSPI_Receive_DMA(Ctx, pData) != HAL_OK)
+    {
+        return MT25TL01G_ERROR_RECEIVE;
+    }
+
+    return MT25TL01G_OK;
+}
+
+/**
+ * @brief  Starts an MDMA read of an amount of data from the QSPI memory on
+ *         STR mode. Completion is reported through HAL_QSPI_RxCpltCallback().
+ *         SPI/QPI; 1-1-1/1-2-2/1-4-4/4-4-4
+ * @param  Ctx Component object pointer, hmdma must be linked
+ * @param  Mode Interface mode
+ * @param  pData Pointer to data to be read
+ * @param  ReadAddr Read start address
+ * @param  Size Size of data to read, at most 64KB per MDMA block
+ * @retval QSPI memory status
+ */
+MT25TL01G_StatusTypeDef MT25TL01G_ReadSTR_DMA(QSPI_HandleTypeDef *Ctx, MT25TL01G_InterfaceTypeDef Mode, uint8_t *pData,
+                                              uint32_t ReadAddr, uint32_t Size)
+{
+    QSPI_CommandTypeDef s_command;
+
+    MT25TL01G_ReadCommandSTR(Mode, &s_command, ReadAddr, Size);
+
+    /* Configure the command */
+    if (HAL_QSPI_Command(Ctx, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE) != HAL_OK)
+    {
+        return MT25TL01G_ERROR_COMMAND;
+    }
+
+    /* Start the reception of the data */
+    if (HAL_QSPI_Receive_DMA(Ctx, pData) != HAL_OK)
+    {
+        return MT25TL01G_ERROR_RECEIVE;
+    }
+
+    return MT25TL01G_OK;
+}
+
+/**
+ * @brief  Builds the indirect read command for DTR mode.
+ * @param  Mode Interface mode
+ * @param  s_command Command to fill
+ * @param  ReadAddr Read start address
+ * @param  Size Size of data to read
+ * @retval None
+ */
+static void MT25TL01G_ReadCommandDTR(MT25TL01G_InterfaceTypeDef Mode, QSPI_CommandTypeDef *s_command, uint32_t ReadAddr,
+                                     uint32_t Size)
+{
+    switch (Mode)
+    {
+    case MT25TL01G_SPI_MODE: /* 1-1-1 commands, Power on H/W default setting */
+        s_command->InstructionMode = QSPI_INSTRUCTION_1_LINE;
+        s_command->Instruction = MT25TL01G_FAST_READ_4_BYTE_DTR_CMD;
+        s_command->AddressMode = QSPI_ADDRESS_1_LINE;
+        s_command->DataMode = QSPI_DATA_1_LINE;
+
+        break;
+    case MT25TL01G_SPI_2IO_MODE: /* 1-1-2 read commands */
+
+        s_command->InstructionMode = QSPI_INSTRUCTION_1_LINE;
+        s_command->Instruction = MT25TL01G_DUAL_OUT_FAST_READ_DTR_CMD;
+        s_command->AddressMode = QSPI_ADDRESS_1_LINE;
+        s_command->DataMode = QSPI_DATA_2_LINES;
+
+        break;
+    case MT25TL01G_SPI_4IO_MODE: /* 1-4-4 read commands */
+
+        s_command->InstructionMode = QSPI_INSTRUCTION_1_LINE;
+        s_command->Instruction = MT25TL01G_QUAD_INOUT_FAST_READ_4_BYTE_DTR_CMD;
+        s_command->AddressMode = QSPI_ADDRESS_4_LINES;
+        s_command->DataMode = QSPI_DATA_4_LINES;
+
+        break;
+    case MT25TL01G_QPI_MODE: /* 4-4-4 commands */
+        s_command->InstructionMode = QSPI_INSTRUCTION_4_LINES;
+        s_command->Instruction = MT25TL01G_QUAD_INOUT_FAST_READ_DTR_CMD;
+        s_command->AddressMode = QSPI_ADDRESS_4_LINES;
+        s_command->DataMode = QSPI_DATA_4_LINES;
+
+        break;
+    }
+    /* Initialize the read command */
+    s_command->DummyCycles = MT25TL01G_DUMMY_CYCLES_READ_QUAD_DTR;
+    s_command->AddressSize = QSPI_ADDRESS_32_BITS;
+    s_command->Address = ReadAddr;
+    s_command->AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+    s_command->NbData = Size;
+    s_command->DdrMode = QSPI_DDR_MODE_ENABLE;
+    s_command->DdrHoldHalfCycle = QSPI_DDR_HHC_HALF_CLK_DELAY;
+    s_command->SIOOMode = QSPI_SIOO_INST_EVERY_CMD;
+}
+
+/**
+ * @brief  Builds the indirect read command for STR mode.
+ * @param  Mode Interface mode
+ * @param  s_command Command to fill
+ * @param  ReadAddr Read start address
+ * @param  Size Size of data to read
+ * @retval None
+ */
+static void MT25TL01G_ReadCommandSTR(MT25TL01G_InterfaceTypeDef Mode, QSPI_CommandTypeDef *s_command, uint32_t ReadAddr,
+                                     uint32_t Size)
+{
+    switch (Mode)
+    {
+    case MT25TL01G_SPI_MODE: /* 1-1-1 read commands */
+        s_command->InstructionMode = QSPI_INSTRUCTION_1_LINE;
+        s_command->Instruction = MT25TL01G_FAST_READ_4_BYTE_ADDR_CMD;
+        s_command->AddressMode = QSPI_ADDRESS_1_LINE;
+        s_command->DataMode = QSPI_DATA_1_LINE;
+
+        break;
+    case MT25TL01G_SPI_2IO_MODE: /* 1-2-2 read commands */
+
+        s_command->InstructionMode = QSPI_INSTRUCTION_1_LINE;
+        s_command->Instruction = MT25TL01G_DUAL_INOUT_FAST_READ_4_BYTE_ADDR_CMD;
+        s_command->AddressMode = QSPI_ADDRESS_2_LINES;
+        s_command->DataMode = QSPI_DATA_2_LINES;
+
+        break;
+    case MT25TL01G_SPI_4IO_MODE: /* 1-4-4 read commands */
+
+        s_command->InstructionMode = QSPI_INSTRUCTION_1_LINE;
+        s_command->Instruction = MT25TL01G_QUAD_INOUT_FAST_READ_4_BYTE_ADDR_CMD;
+        s_command->AddressMode = QSPI_ADDRESS_4_LINES;
+        s_command->DataMode = QSPI_DATA_4_LINES;
+
+        break;
+    case MT25TL01G_QPI_MODE: /* 4-4-4 commands */
+        s_command->InstructionMode = QSPI_INSTRUCTION_4_LINES;
+        s_command->Instruction = MT25TL01G_QUAD_INOUT_FAST_READ_CMD;
+        s_command->AddressMode = QSPI_ADDRESS_4_LINES;
+        s_command->DataMode = QSPI_DATA_4_LINES;
+
+        break;
+    }
+    /* Initialize the read command */
+    s_command->DummyCycles = MT25TL01G_DUMMY_CYCLES_READ;
+    s_command->AddressSize = QSPI_ADDRESS_32_BITS;
+    s_command->Address = ReadAddr;
+    s_command->AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+    s_command->NbData = Size;
+    s_command->DdrMode = QSPI_DDR_MODE_DISABLE;
+    s_command->DdrHoldHalfCycle = QSPI_DDR_HHC_ANALOG_DELAY;
+    s_command->SIOOMode = QSPI_SIOO_INST_EVERY_CMD;
+}
@@ -253,8 +253,15 @@ MT25TL01G_StatusTypeDef MT25TL01G_ReadSTR(QSPI_HandleTypeDef *Ctx, MT25TL01G_Int
                                           uint32_t ReadAddr, uint32_t Size);
 MT25TL01G_StatusTypeDef MT25TL01G_ReadDTR(QSPI_HandleTypeDef *Ctx, MT25TL01G_InterfaceTypeDef Mode, uint8_t *pData,
                                           uint32_t ReadAddr, uint32_t Size);
+MT25TL01G_StatusTypeDef MT25TL01G_ReadSTR_DMA(QSPI_HandleTypeDef *Ctx, MT25TL01G_InterfaceTypeDef Mode, uint8_t *pData,
+                                              uint32_t ReadAddr, uint32_t Size);
+MT25TL01G_StatusTypeDef MT25TL01G_ReadDTR_DMA(QSPI_HandleTypeDef *Ctx, MT25TL01G_InterfaceTypeDef Mode, uint8_t *pData,
+                                              uint32_t ReadAddr, uint32_t Size);
 MT25TL01G_StatusTypeDef MT25TL01G_ReadStatusRegister(QSPI_HandleTypeDef *Ctx, MT25TL01G_InterfaceTypeDef Mode,
                                                      uint8_t *Value);
+MT25TL01G_StatusTypeDef MT25TL01G_ReadFlagStatusRegister(QSPI_HandleTypeDef *Ctx, MT25TL01G_InterfaceTypeDef Mode,
+                                                         uint8_t *Value);
+MT25TL01G_StatusTypeDef MT25TL01G_ClearFlagStatusRegister(QSPI_HandleTypeDef *Ctx, MT25TL01G_InterfaceTypeDef Mode);
 MT25TL01G_StatusTypeDef MT25TL01G_EnterQPIMode(QSPI_HandleTypeDef *Ctx);
 MT25TL01G_StatusTypeDef MT25TL01G_ExitQPIMode(QSPI_HandleTypeDef *Ctx);
 
@@ -2,8 +2,6 @@
 #include "sdram.h"
 #include "ts.h"
 
-static TIM_HandleTypeDef hlcd_tim;
-
 BSP_LCD_Ctx_t Lcd_Ctx;
 
 #define CONVERTRGB5652ARGB8888(Color)                                                                                  \
@@ -107,7 +105,7 @@ int32_t BSP_LCD_DeInit()
   else
   {
     /* DeInit TIM PWM */
-    HAL_TIM_PWM_DeInit(&hlcd_tim);
+    HAL_TIM_PWM_DeInit(&htim8);
 
     Lcd_Ctx.IsMspCallbacksValid = 0;
   }
@@ -415,7 +413,7 @@ int32_t BSP_LCD_SetBrightness(uint32_t Brightness)
   TIM_OC_InitTypeDef LCD_TIM_Config;
 
   /* Stop PWM Timer channel */
-  HAL_TIM_PWM_Stop(&hlcd_tim, LCD_TIMx_CHANNEL);
+  HAL_TIM_PWM_Stop(&htim8, LCD_TIMx_CHANNEL);
 
   /* Common configuration for all channels */
   LCD_TIM_Config.OCMode = TIM_OCMODE_PWM1;
@@ -428,10 +426,10 @@ int32_t BSP_LCD_SetBrightness(uint32_t Brightness)
   /* Set the pulse value for channel */
   LCD_TIM_Config.Pulse = (uint32_t)((LCD_TIMX_PERIOD_VALUE * Brightness) / 100);
 
-  HAL_TIM_PWM_ConfigChannel(&hlcd_tim, &LCD_TIM_Config, LCD_TIMx_CHANNEL);
+  HAL_TIM_PWM_ConfigChannel(&htim8, &LCD_TIM_Config, LCD_TIMx_CHANNEL);
 
   /* Start PWM Timer channel */
-  HAL_TIM_PWM_Start(&hlcd_tim, LCD_TIMx_CHANNEL);
+  HAL_TIM_PWM_Start(&htim8, LCD_TIMx_CHANNEL);
 
   Lcd_Ctx.Brightness = Brightness;
 
@@ -158,6 +158,7 @@ typedef struct
 
 extern DMA2D_HandleTypeDef hdma2d;
 extern LTDC_HandleTypeDef hltdc;
+extern TIM_HandleTypeDef htim8; /* Backlight PWM, LCD_TIMx */
 extern BSP_LCD_Ctx_t Lcd_Ctx;
 
 /* Initialization APIs */
@@ -0,0 +1,522 @@
+#include "mdma_copy.h"
+
+#include <string.h>
+
+/*
+ * Asynchronous memcpy/memset/2D copy engine on MDMA channel 0.
+ *
+ * Each request is turned into a short MDMA linked list (a node of repeated
+ * 64 KB blocks and a node for the remainder, or a single node with a row per
+ * block for a 2D copy) and queued. The channel runs one list per software
+ * request, the MDMA interrupt completes it and starts the next queued one, so
+ * back-to-back requests do not wait for the CPU.
+ *
+ * The source is cleaned and the destination cleaned/invalidated before a
+ * transfer starts, and the destination is invalidated again on completion,
+ * before the callback. Lines the destination shares with other data must not
+ * be written by the CPU while the transfer is in flight. The TCMs are reached
+ * through the MDMA AHB port and need no cache maintenance.
+ *
+ * The element size is the largest of byte/halfword/word the addresses and
+ * the size allow, with 8-beat bursts when source and destination are
+ * cache-line aligned.
+ */
+
+#define MDMA_COPY_LINE 32U
+#define MDMA_COPY_TLEN 128U /* Buffer transfer length, the FIFO size */
+#define MDMA_COPY_NODES 2U
+
+#define MDMA_COPY_ITCM_END 0x00010000U
+#define MDMA_COPY_DTCM_BASE 0x20000000U
+#define MDMA_COPY_DTCM_END 0x20020000U
+
+typedef struct
+{
+  /* Nodes and pattern are read by the MDMA over AXI, keep them on their own lines */
+  MDMA_LinkNodeTypeDef Nodes[MDMA_COPY_NODES] __attribute__((aligned(MDMA_COPY_LINE)));
+  uint32_t Pattern __attribute__((aligned(MDMA_COPY_LINE)));
+  uint32_t SrcAddr; /* Range cleaned before the transfer, 0 for none */
+  uint32_t SrcSize;
+  uint32_t DstAddr; /* Range invalidated on completion */
+  uint32_t DstSize;
+  uint32_t Bytes;
+  BSP_MDMA_CopyCallback_t Callback;
+  void *Context;
+} MDMA_CopyJob_t;
+
+typedef struct
+{
+  MDMA_CopyJob_t Queue[MDMA_COPY_QUEUE_DEPTH];
+  volatile uint32_t Head;
+  volatile uint32_t Tail;
+  volatile uint32_t Running; /* Queue[Tail] is on the channel */
+  uint32_t IsInitialized;
+  BSP_MDMA_CopyStats_t Stats;
+} MDMA_Copy_t;
+
+static MDMA_Copy_t MDMA_Copy;
+
+static MDMA_CopyJob_t *MDMA_CopyAlloc();
+static void MDMA_CopyNode(MDMA_LinkNodeTypeDef *Node, uint32_t Src, uint32_t Dst, uint32_t Unit, uint32_t SrcInc,
+                          uint32_t Block, uint32_t Count);
+static uint32_t MDMA_CopyUnit(uint32_t Value);
+static uint32_t MDMA_CopyIsTcm(uint32_t Addr);
+static void MDMA_CopyClean(uint32_t Addr, uint32_t Size);
+static void MDMA_CopyInvalidate(uint32_t Addr, uint32_t Size, uint32_t Clean);
+static void MDMA_CopySubmit(MDMA_CopyJob_t *Job);
+static void MDMA_CopyStart();
+static void MDMA_CopyComplete(int32_t Status);
+static void MDMA_CopyCpltCallback(MDMA_HandleTypeDef *hmdma);
+static void MDMA_CopyErrorCallback(MDMA_HandleTypeDef *hmdma);
+
+/**
+ * @brief  Takes over MDMA channel 0, MX_MDMA_Init() must have been called.
+ *         The channel must not be used through the HAL afterwards.
+ * @retval BSP status
+ */
+int32_t BSP_MDMA_CopyInit()
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (HAL_MDMA_GetState(&hmdma_mdma_channel40_sw_0) != HAL_MDMA_STATE_READY)
+  {
+    ret = BSP_ERROR_BUSY;
+  }
+  else
+  {
+    memset(&MDMA_Copy, 0, sizeof(MDMA_Copy));
+    hmdma_mdma_channel40_sw_0.XferCpltCallback = MDMA_CopyCpltCallback;
+    hmdma_mdma_channel40_sw_0.XferErrorCallback = MDMA_CopyErrorCallback;
+    MDMA_Copy.IsInitialized = 1U;
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Queues a copy of Size bytes, the buffers must not overlap.
+ * @param  pDst     Destination
+ * @param  pSrc     Source
+ * @param  Size     Number of bytes, at most MDMA_COPY_SIZE_MAX
+ * @param  Callback Called on completion, may be NULL
+ * @param  Context  Passed to the callback
+ * @retval BSP status, BSP_ERROR_BUSY when the queue is full
+ */
+int32_t BSP_MDMA_Memcpy(void *pDst, const void *pSrc, uint32_t Size, BSP_MDMA_CopyCallback_t Callback,
+                        void *Context)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t dst = (uint32_t)pDst, src = (uint32_t)pSrc;
+  uint32_t unit, head;
+  MDMA_CopyJob_t *job;
+
+  if (MDMA_Copy.IsInitialized == 0U)
+  {
+    ret = BSP_ERROR_NO_INIT;
+  }
+  else if ((pDst == NULL) || (pSrc == NULL) || (Size == 0U) || (Size > MDMA_COPY_SIZE_MAX))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if ((job = MDMA_CopyAlloc()) == NULL)
+  {
+    ret = BSP_ERROR_BUSY;
+  }
+  else
+  {
+    unit = MDMA_CopyUnit(dst | src | Size);
+    head = Size - (Size % MDMA_COPY_BLOCK_MAX);
+
+    if (head == 0U)
+    {
+      MDMA_CopyNode(&job->Nodes[0], src, dst, unit, 1U, Size, 1U);
+    }
+    else
+    {
+      MDMA_CopyNode(&job->Nodes[0], src, dst, unit, 1U, MDMA_COPY_BLOCK_MAX, head / MDMA_COPY_BLOCK_MAX);
+      if (head != Size)
+      {
+        MDMA_CopyNode(&job->Nodes[1], src + head, dst + head, unit, 1U, Size - head, 1U);
+        job->Nodes[0].CLAR = (uint32_t)&job->Nodes[1];
+      }
+    }
+
+    job->SrcAddr = src;
+    job->SrcSize = Size;
+    job->DstAddr = dst;
+    job->DstSize = Size;
+    job->Bytes = Size;
+    job->Callback = Callback;
+    job->Context = Context;
+    MDMA_CopySubmit(job);
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Queues a fill of Size bytes with Value.
+ * @param  pDst     Destination
+ * @param  Value    Fill byte
+ * @param  Size     Number of bytes, at most MDMA_COPY_SIZE_MAX
+ * @param  Callback Called on completion, may be NULL
+ * @param  Context  Passed to the callback
+ * @retval BSP status, BSP_ERROR_BUSY when the queue is full
+ */
+int32_t BSP_MDMA_Memset(void *pDst, uint8_t Value, uint32_t Size, BSP_MDMA_CopyCallback_t Callback, void *Context)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t dst = (uint32_t)pDst;
+  uint32_t unit, head, src;
+  MDMA_CopyJob_t *job;
+
+  if (MDMA_Copy.IsInitialized == 0U)
+  {
+    ret = BSP_ERROR_NO_INIT;
+  }
+  else if ((pDst == NULL) || (Size == 0U) || (Size > MDMA_COPY_SIZE_MAX))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if ((job = MDMA_CopyAlloc()) == NULL)
+  {
+    ret = BSP_ERROR_BUSY;
+  }
+  else
+  {
+    /* The source is the pattern word, read again for every element */
+    job->Pattern = 0x01010101U * Value;
+    src = (uint32_t)&job->Pattern;
+    unit = MDMA_CopyUnit(dst | Size);
+    head = Size - (Size % MDMA_COPY_BLOCK_MAX);
+
+    if (head == 0U)
+    {
+      MDMA_CopyNode(&job->Nodes[0], src, dst, unit, 0U, Size, 1U);
+    }
+    else
+    {
+      MDMA_CopyNode(&job->Nodes[0], src, dst, unit, 0U, MDMA_COPY_BLOCK_MAX, head / MDMA_COPY_BLOCK_MAX);
+      if (head != Size)
+      {
+        MDMA_CopyNode(&job->Nodes[1], src, dst + head, unit, 0U, Size - head, 1U);
+        job->Nodes[0].CLAR = (uint32_t)&job->Nodes[1];
+      }
+    }
+
+    job->SrcAddr = 0U;
+    job->SrcSize = 0U;
+    job->DstAddr = dst;
+    job->DstSize = Size;
+    job->Bytes = Size;
+    job->Callback = Callback;
+    job->Context = Context;
+    MDMA_CopySubmit(job);
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Queues a copy of a Width x Height bytes rectangle between two
+ *         pitched buffers, e.g. a sprite into a framebuffer.
+ * @param  pDst     First byte of the destination rectangle
+ * @param  DstPitch Bytes between two destination rows
+ * @param  pSrc     First byte of the source rectangle
+ * @param  SrcPitch Bytes between two source rows
+ * @param  Width    Bytes per row, at most MDMA_COPY_BLOCK_MAX
+ * @param  Height   Rows, at most MDMA_COPY_BLOCKS_MAX
+ * @param  Callback Called on completion, may be NULL
+ * @param  Context  Passed to the callback
+ * @retval BSP status, BSP_ERROR_BUSY when the queue is full
+ */
+int32_t BSP_MDMA_Copy2D(void *pDst, uint32_t DstPitch, const void *pSrc, uint32_t SrcPitch, uint32_t Width,
+                        uint32_t Height, BSP_MDMA_CopyCallback_t Callback, void *Context)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t dst = (uint32_t)pDst, src = (uint32_t)pSrc;
+  uint32_t unit;
+  MDMA_CopyJob_t *job;
+
+  if (MDMA_Copy.IsInitialized == 0U)
+  {
+    ret = BSP_ERROR_NO_INIT;
+  }
+  else if ((pDst == NULL) || (pSrc == NULL) || (Width == 0U) || (Height == 0U) || (Width > MDMA_COPY_BLOCK_MAX) ||
+           (Height > MDMA_COPY_BLOCKS_MAX) || (SrcPitch < Width) || (DstPitch < Width) ||
+           ((SrcPitch - Width) > 0xFFFFU) || ((DstPitch - Width) > 0xFFFFU))
+  {
+    /* The address update between rows is a 16-bit field */
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if ((job = MDMA_CopyAlloc()) == NULL)
+  {
+    ret = BSP_ERROR_BUSY;
+  }
+  else
+  {
+    unit = MDMA_CopyUnit(dst | src | Width | SrcPitch | DstPitch);
+    MDMA_CopyNode(&job->Nodes[0], src, dst, unit, 1U, Width, Height);
+    job->Nodes[0].CBRUR = ((DstPitch - Width) << MDMA_CBRUR_DUV_Pos) | ((SrcPitch - Width) << MDMA_CBRUR_SUV_Pos);
+
+    job->SrcAddr = src;
+    job->SrcSize = (Height - 1U) * SrcPitch + Width;
+    job->DstAddr = dst;
+    job->DstSize = (Height - 1U) * DstPitch + Width;
+    job->Bytes = Width * Height;
+    job->Callback = Callback;
+    job->Context = Context;
+    MDMA_CopySubmit(job);
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Number of queued transfers, the one in flight included.
+ */
+uint32_t BSP_MDMA_CopyGetPending()
+{
+  return MDMA_Copy.Head - MDMA_Copy.Tail;
+}
+
+/**
+ * @brief  Waits for every queued transfer to complete.
+ * @param  Timeout Timeout in milliseconds
+ * @retval BSP status, BSP_ERROR_BUSY on timeout
+ */
+int32_t BSP_MDMA_CopyWait(uint32_t Timeout)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t tickstart = HAL_GetTick();
+
+  while ((MDMA_Copy.Head != MDMA_Copy.Tail) && (ret == BSP_ERROR_NONE))
+  {
+    if ((HAL_GetTick() - tickstart) > Timeout)
+    {
+      ret = BSP_ERROR_BUSY;
+    }
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Copies the engine counters.
+ */
+void BSP_MDMA_CopyGetStats(BSP_MDMA_CopyStats_t *Stats)
+{
+  *Stats = MDMA_Copy.Stats;
+}
+
+/* Free queue slot, NULL when full. Only one context may submit. */
+static MDMA_CopyJob_t *MDMA_CopyAlloc()
+{
+  MDMA_CopyJob_t *job = NULL;
+
+  if ((MDMA_Copy.Head - MDMA_Copy.Tail) < MDMA_COPY_QUEUE_DEPTH)
+  {
+    job = &MDMA_Copy.Queue[MDMA_Copy.Head % MDMA_COPY_QUEUE_DEPTH];
+    memset(job->Nodes, 0, sizeof(job->Nodes));
+  }
+  else
+  {
+    MDMA_Copy.Stats.QueueFull++;
+  }
+  return job;
+}
+
+/* log2 of the largest element size Value is a multiple of */
+static uint32_t MDMA_CopyUnit(uint32_t Value)
+{
+  uint32_t unit = 2U;
+
+  if ((Value & 1U) != 0U)
+  {
+    unit = 0U;
+  }
+  else if ((Value & 2U) != 0U)
+  {
+    unit = 1U;
+  }
+  return unit;
+}
+
+static uint32_t MDMA_CopyIsTcm(uint32_t Addr)
+{
+  return (Addr < MDMA_COPY_ITCM_END) || ((Addr >= MDMA_COPY_DTCM_BASE) && (Addr < MDMA_COPY_DTCM_END));
+}
+
+/* Count blocks of Block bytes, software triggered, one request runs the whole list */
+static void MDMA_CopyNode(MDMA_LinkNodeTypeDef *Node, uint32_t Src, uint32_t Dst, uint32_t Unit, uint32_t SrcInc,
+                          uint32_t Block, uint32_t Count)
+{
+  uint32_t ctcr;
+
+  ctcr = MDMA_CTCR_SWRM | MDMA_FULL_TRANSFER | ((MDMA_COPY_TLEN - 1U) << MDMA_CTCR_TLEN_Pos) |
+         (Unit << MDMA_CTCR_SSIZE_Pos) | (Unit << MDMA_CTCR_DSIZE_Pos) | MDMA_CTCR_DINC_1 |
+         (Unit << MDMA_CTCR_DINCOS_Pos);
+  if (SrcInc != 0U)
+  {
+    ctcr |= MDMA_CTCR_SINC_1 | (Unit << MDMA_CTCR_SINCOS_Pos);
+  }
+
+  /* Bursts of one cache line, they never cross the 1 KB AXI boundary */
+  if ((((Src | Dst | Block) % MDMA_COPY_LINE) == 0U) && (SrcInc != 0U))
+  {
+    ctcr |= ((5U - Unit) << MDMA_CTCR_SBURST_Pos) | ((5U - Unit) << MDMA_CTCR_DBURST_Pos);
+  }
+  else if ((Dst % MDMA_COPY_LINE) == 0U && ((Block % MDMA_COPY_LINE) == 0U))
+  {
+    ctcr |= (5U - Unit) << MDMA_CTCR_DBURST_Pos;
+  }
+
+  Node->CTCR = ctcr;
+  Node->CBNDTR = ((Count - 1U) << MDMA_CBNDTR_BRC_Pos) | (Block & MDMA_CBNDTR_BNDT);
+  Node->CSAR = Src;
+  Node->CDAR = Dst;
+  Node->CBRUR = 0U;
+  Node->CLAR = 0U;
+  Node->CTBR = (MDMA_CopyIsTcm(Src) ? MDMA_CTBR_SBUS : 0U) | (MDMA_CopyIsTcm(Dst) ? MDMA_CTBR_DBUS : 0U);
+  Node->CMAR = 0U;
+  Node->CMDR = 0U;
+}
+
+static void MDMA_CopyClean(uint32_t Addr, uint32_t Size)
+{
+  if ((Size == 0U) || MDMA_CopyIsTcm(Addr))
+  {
+    return;
+  }
+  if (Size > MDMA_COPY_CACHE_LIMIT)
+  {
+    SCB_CleanDCache();
+    MDMA_Copy.Stats.Full++;
+  }
+  else
+  {
+    SCB_CleanDCache_by_Addr((uint32_t *)Addr, (int32_t)Size);
+  }
+}
+
+/* Clean first when lines may still hold CPU writes, the whole cache is never
+ * invalidated without a clean */
+static void MDMA_CopyInvalidate(uint32_t Addr, uint32_t Size, uint32_t Clean)
+{
+  if (MDMA_CopyIsTcm(Addr))
+  {
+    return;
+  }
+  if (Size > MDMA_COPY_CACHE_LIMIT)
+  {
+    SCB_CleanInvalidateDCache();
+    MDMA_Copy.Stats.Full++;
+  }
+  else if (Clean != 0U)
+  {
+    SCB_CleanInvalidateDCache_by_Addr((uint32_t *)Addr, (int32_t)Size);
+  }
+  else
+  {
+    SCB_InvalidateDCache_by_Addr((uint32_t *)Addr, (int32_t)Size);
+  }
+}
+
+/* Cache maintenance of the new job, then queued and started if the channel is idle */
+static void MDMA_CopySubmit(MDMA_CopyJob_t *Job)
+{
+  uint32_t primask;
+
+  MDMA_CopyClean(Job->SrcAddr, Job->SrcSize);
+  MDMA_CopyInvalidate(Job->DstAddr, Job->DstSize, 1U);
+  SCB_CleanDCache_by_Addr((uint32_t *)Job, (int32_t)sizeof(*Job));
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  MDMA_Copy.Head++;
+  if (MDMA_Copy.Running == 0U)
+  {
+    MDMA_CopyStart();
+  }
+  __set_PRIMASK(primask);
+}
+
+/* Loads the first node of Queue[Tail] in the channel and triggers the list */
+static void MDMA_CopyStart()
+{
+  MDMA_CopyJob_t *job = &MDMA_Copy.Queue[MDMA_Copy.Tail % MDMA_COPY_QUEUE_DEPTH];
+  MDMA_Channel_TypeDef *ch = hmdma_mdma_channel40_sw_0.Instance;
+  const MDMA_LinkNodeTypeDef *node = &job->Nodes[0];
+
+  MDMA_Copy.Running = 1U;
+  hmdma_mdma_channel40_sw_0.State = HAL_MDMA_STATE_BUSY;
+  hmdma_mdma_channel40_sw_0.ErrorCode = HAL_MDMA_ERROR_NONE;
+
+  ch->CIFCR = MDMA_CIFCR_CTEIF | MDMA_CIFCR_CCTCIF | MDMA_CIFCR_CBRTIF | MDMA_CIFCR_CBTIF | MDMA_CIFCR_CLTCIF;
+  ch->CTCR = node->CTCR;
+  ch->CBNDTR = node->CBNDTR;
+  ch->CSAR = node->CSAR;
+  ch->CDAR = node->CDAR;
+  ch->CBRUR = node->CBRUR;
+  ch->CLAR = node->CLAR;
+  ch->CTBR = node->CTBR;
+  ch->CMAR = 0U;
+  ch->CMDR = 0U;
+  ch->CCR = hmdma_mdma_channel40_sw_0.Init.Priority | MDMA_CCR_CTCIE | MDMA_CCR_TEIE;
+  ch->CCR |= MDMA_CCR_EN;
+  ch->CCR |= MDMA_CCR_SWRQ;
+}
+
+/* Interrupt context: finishes Queue[Tail], starts the next one, then calls back */
+static void MDMA_CopyComplete(int32_t Status)
+{
+  MDMA_CopyJob_t *job = &MDMA_Copy.Queue[MDMA_Copy.Tail % MDMA_COPY_QUEUE_DEPTH];
+  BSP_MDMA_CopyCallback_t callback = job->Callback;
+  void *context = job->Context;
+
+  if (MDMA_Copy.Running == 0U)
+  {
+    return;
+  }
+
+  /* Drop lines speculatively fetched while the MDMA was writing */
+  MDMA_CopyInvalidate(job->DstAddr, job->DstSize, 0U);
+  if (Status == BSP_ERROR_NONE)
+  {
+    MDMA_Copy.Stats.Jobs++;
+    MDMA_Copy.Stats.Bytes += job->Bytes;
+  }
+  else
+  {
+    MDMA_Copy.Stats.Errors++;
+  }
+
+  MDMA_Copy.Running = 0U;
+  MDMA_Copy.Tail++;
+  if (MDMA_Copy.Head != MDMA_Copy.Tail)
+  {
+    MDMA_CopyStart();
+  }
+
+  if (callback != NULL)
+  {
+    callback(Status, context);
+  }
+}
+
+static void MDMA_CopyCpltCallback(MDMA_HandleTypeDef *hmdma)
+{
+  UNUSED(hmdma);
+  MDMA_CopyComplete(BSP_ERROR_NONE);
+}
+
+static void MDMA_CopyErrorCallback(MDMA_HandleTypeDef *hmdma)
+{
+  UNUSED(hmdma);
+  MDMA_CopyComplete(BSP_ERROR_PERIPH_FAILURE);
+}
@@ -0,0 +1,49 @@
+#ifndef MDMA_COPY_H
+#define MDMA_COPY_H
+
+#include "mdma.h"
+#include "errno.h"
+
+/* Transfers waiting for the copy engine, the one in flight included */
+#ifndef MDMA_COPY_QUEUE_DEPTH
+#define MDMA_COPY_QUEUE_DEPTH 8U
+#endif
+
+/* Ranges larger than this are cleaned/invalidated with whole-cache
+ * operations, which cost less than walking them line by line */
+#ifndef MDMA_COPY_CACHE_LIMIT
+#define MDMA_COPY_CACHE_LIMIT 0x8000U
+#endif
+
+/* Limits of one linked-list node: blocks of at most 64 KB repeated at most
+ * 4096 times. A 2D copy is one node, a row per block. */
+#define MDMA_COPY_BLOCK_MAX 0x10000U
+#define MDMA_COPY_BLOCKS_MAX 0x1000U
+#define MDMA_COPY_SIZE_MAX (MDMA_COPY_BLOCK_MAX * MDMA_COPY_BLOCKS_MAX)
+
+/**
+ * @brief Completion callback of a copy, called from the MDMA interrupt once
+ *        the destination is visible to the CPU, with the BSP status.
+ */
+typedef void (*BSP_MDMA_CopyCallback_t)(int32_t Status, void *Context);
+
+typedef struct
+{
+  uint32_t Jobs;      /* Transfers completed */
+  uint32_t Errors;    /* Transfers ended by an MDMA error */
+  uint32_t Bytes;     /* Bytes written by completed transfers */
+  uint32_t Full;      /* Whole-cache maintenance on large ranges */
+  uint32_t QueueFull; /* Submissions refused with BSP_ERROR_BUSY */
+} BSP_MDMA_CopyStats_t;
+
+int32_t BSP_MDMA_CopyInit();
+int32_t BSP_MDMA_Memcpy(void *pDst, const void *pSrc, uint32_t Size, BSP_MDMA_CopyCallback_t Callback,
+                        void *Context);
+int32_t BSP_MDMA_Memset(void *pDst, uint8_t Value, uint32_t Size, BSP_MDMA_CopyCallback_t Callback, void *Context);
+int32_t BSP_MDMA_Copy2D(void *pDst, uint32_t DstPitch, const void *pSrc, uint32_t SrcPitch, uint32_t Width,
+                        uint32_t Height, BSP_MDMA_CopyCallback_t Callback, void *Context);
+uint32_t BSP_MDMA_CopyGetPending();
+int32_t BSP_MDMA_CopyWait(uint32_t Timeout);
+void BSP_MDMA_CopyGetStats(BSP_MDMA_CopyStats_t *Stats);
+
+#endif /* MDMA_COPY_H */
@@ -2,8 +2,26 @@
 
 BSP_QSPI_Ctx_t QSPI_Ctx;
 
+/* State of the asynchronous read in flight, split in MDMA sized chunks */
+typedef struct
+{
+	uint8_t *pData;
+	uint32_t ReadAddr;
+	uint32_t Remaining;
+	uint32_t ChunkSize;
+	uint8_t *pStart;
+	uint32_t Size;
+	BSP_QSPI_Callback_t Callback;
+	void *Context;
+	volatile uint32_t Busy;
+} QSPI_Xfer_t;
+
+static QSPI_Xfer_t QSPI_Xfer;
+
 static int32_t QSPI_ResetMemory();
 static int32_t QSPI_DummyCyclesCfg();
+static int32_t QSPI_StartChunk();
+static void QSPI_FinishXfer(int32_t Status);
 
 /**
  * @brief  Initializes the QSPI interface.
@@ -102,6 +120,102 @@ int32_t BSP_QSPI_Read(uint8_t *pData, uint32_t ReadAddr, uint32_t Size)
 	return ret;
 }
 
+/**
+ * @brief  Starts an asynchronous read of an amount of data from the QSPI memory.
+ *         Data is streamed by MDMA from the QUADSPI FIFO; reads larger than
+ *         QSPI_DMA_MAX_CHUNK are chained from the completion interrupt.
+ *         pData must be aligned on QSPI_DMA_CACHE_LINE and the buffer must own
+ *         every cache line it touches, as they are invalidated on completion.
+ * @param  pData     Pointer to data to be read (SDRAM, AXI SRAM or D2 SRAM)
+ * @param  ReadAddr  Read start address
+ * @param  Size      Size of data to read
+ * @param  Callback  Called from interrupt context when done, may be NULL
+ * @param  Context   User pointer handed back to Callback
+ * @retval BSP status
+ */
+int32_t BSP_QSPI_Read_DMA(uint8_t *pData, uint32_t ReadAddr, uint32_t Size,
+		BSP_QSPI_Callback_t Callback, void *Context)
+{
+	int32_t ret = BSP_ERROR_NONE;
+
+	if ((pData == NULL) || (Size == 0U)
+			|| (((uint32_t) pData % QSPI_DMA_CACHE_LINE) != 0U)) {
+		ret = BSP_ERROR_WRONG_PARAM;
+	} else if (QSPI_Ctx.IsInitialized != QSPI_ACCESS_INDIRECT) {
+		ret = BSP_ERROR_QSPI_MMP_LOCK_FAILURE;
+	} else if (QSPI_Xfer.Busy != 0U) {
+		ret = BSP_ERROR_BUSY;
+	} else {
+		QSPI_Xfer.Busy = 1U;
+		QSPI_Xfer.pData = pData;
+		QSPI_Xfer.pStart = pData;
+		QSPI_Xfer.ReadAddr = ReadAddr;
+		QSPI_Xfer.Remaining = Size;
+		QSPI_Xfer.Size = Size;
+		QSPI_Xfer.Callback = Callback;
+		QSPI_Xfer.Context = Context;
+
+		/* Write back dirty lines now so no eviction lands on top of the MDMA data */
+		SCB_CleanInvalidateDCache_by_Addr((uint32_t*) pData, (int32_t) Size);
+
+		ret = QSPI_StartChunk();
+		if (ret != BSP_ERROR_NONE) {
+			QSPI_Xfer.Busy = 0U;
+		}
+	}
+
+	/* Return BSP status */
+	return ret;
+}
+
+/**
+ * @brief  Reports whether an asynchronous read is still in progress.
+ * @retval BSP_ERROR_BUSY while a BSP_QSPI_Read_DMA() is running
+ */
+int32_t BSP_QSPI_GetTransferState()
+{
+	return (QSPI_Xfer.Busy != 0U) ? BSP_ERROR_BUSY : BSP_ERROR_NONE;
+}
+
+/**
+ * @brief  Rx Transfer completed callback.
+ * @param  qspiHandle QSPI handle
+ * @retval None
+ */
+void HAL_QSPI_RxCpltCallback(QSPI_HandleTypeDef *qspiHandle)
+{
+	int32_t ret;
+
+	if (QSPI_Xfer.Busy == 0U) {
+		return;
+	}
+
+	QSPI_Xfer.pData += QSPI_Xfer.ChunkSize;
+	QSPI_Xfer.ReadAddr += QSPI_Xfer.ChunkSize;
+	QSPI_Xfer.Remaining -= QSPI_Xfer.ChunkSize;
+
+	if (QSPI_Xfer.Remaining == 0U) {
+		QSPI_FinishXfer(BSP_ERROR_NONE);
+	} else {
+		ret = QSPI_StartChunk();
+		if (ret != BSP_ERROR_NONE) {
+			QSPI_FinishXfer(ret);
+		}
+	}
+}
+
+/**
+ * @brief  Transfer Error callback.
+ * @param  qspiHandle QSPI handle
+ * @retval None
+ */
+void HAL_QSPI_ErrorCallback(QSPI_HandleTypeDef *qspiHandle)
+{
+	if (QSPI_Xfer.Busy != 0U) {
+		QSPI_FinishXfer(BSP_ERROR_BUS_DMA_FAILURE);
+	}
+}
+
 /**
  * @brief  Writes an amount of data to the QSPI memory.
  * @param  pData      Pointer to data to be written
@@ -439,6 +553,55 @@ static int32_t QSPI_ResetMemory()
 	return ret;
 }
 
+/**
+ * @brief  Issue the indirect read command for the next chunk of the
+ *         asynchronous transfer and hand the data phase to MDMA.
+ * @retval BSP status
+ */
+static int32_t QSPI_StartChunk()
+{
+	int32_t ret = BSP_ERROR_NONE;
+
+	QSPI_Xfer.ChunkSize =
+			(QSPI_Xfer.Remaining > QSPI_DMA_MAX_CHUNK) ?
+					QSPI_DMA_MAX_CHUNK : QSPI_Xfer.Remaining;
+
+	if (QSPI_Ctx.TransferRate == BSP_QSPI_STR_TRANSFER) {
+		if (MT25TL01G_ReadSTR_DMA(&hqspi, QSPI_Ctx.InterfaceMode,
+				QSPI_Xfer.pData, QSPI_Xfer.ReadAddr,
+				QSPI_Xfer.ChunkSize) != MT25TL01G_OK) {
+			ret = BSP_ERROR_COMPONENT_FAILURE;
+		}
+	} else {
+		if (MT25TL01G_ReadDTR_DMA(&hqspi, QSPI_Ctx.InterfaceMode,
+				QSPI_Xfer.pData, QSPI_Xfer.ReadAddr,
+				QSPI_Xfer.ChunkSize) != MT25TL01G_OK) {
+			ret = BSP_ERROR_COMPONENT_FAILURE;
+		}
+	}
+
+	/* Return BSP status */
+	return ret;
+}
+
+/**
+ * @brief  Close the asynchronous transfer: drop the stale cache lines of the
+ *         destination and notify the caller.
+ * @param  Status BSP status of the transfer
+ * @retval None
+ */
+static void QSPI_FinishXfer(int32_t Status)
+{
+	BSP_QSPI_Callback_t callback = QSPI_Xfer.Callback;
+
+	SCB_InvalidateDCache_by_Addr(QSPI_Xfer.pStart, (int32_t) QSPI_Xfer.Size);
+
+	QSPI_Xfer.Busy = 0U;
+	if (callback != NULL) {
+		callback(Status, QSPI_Xfer.Context);
+	}
+}
+
 /**
  * @brief  This function configure the dummy cycles on memory side.
  *         Dummy cycle bit locate in Configuration Register[7:6]
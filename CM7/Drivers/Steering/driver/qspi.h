@@ -45,6 +45,12 @@ typedef struct
     BSP_QSPI_DualFlash_t DualFlashMode; /*!<  Dual Flash mode              */
 } BSP_QSPI_Init_t;
 
+/**
+ * @brief Completion callback of an asynchronous transfer, called from the MDMA
+ *        or QUADSPI interrupt with the BSP status of the whole transfer.
+ */
+typedef void (*BSP_QSPI_Callback_t)(int32_t Status, void *Context);
+
 typedef struct
 {
     uint32_t FlashSize;
@@ -90,12 +96,20 @@ typedef struct
 /* QSPI Base Address */
 #define QSPI_BASE_ADDRESS 0x90000000
 
+/* Largest indirect read handed to a single MDMA block (BNDT is 17 bits) */
+#define QSPI_DMA_MAX_CHUNK 0x10000U
+/* Cortex-M7 D-cache line, asynchronous read buffers must be aligned on it */
+#define QSPI_DMA_CACHE_LINE 32U
+
 extern QSPI_HandleTypeDef hqspi;
 extern BSP_QSPI_Ctx_t QSPI_Ctx;
 
 int32_t BSP_QSPI_Init(BSP_QSPI_Init_t *Init);
 int32_t BSP_QSPI_DeInit();
 int32_t BSP_QSPI_Read(uint8_t *pData, uint32_t ReadAddr, uint32_t Size);
+int32_t BSP_QSPI_Read_DMA(uint8_t *pData, uint32_t ReadAddr, uint32_t Size, BSP_QSPI_Callback_t Callback,
+                          void *Context);
+int32_t BSP_QSPI_GetTransferState();
 int32_t BSP_QSPI_Write(uint8_t *pData, uint32_t WriteAddr, uint32_t Size);
 int32_t BSP_QSPI_EraseBlock(uint32_t BlockAddress, BSP_QSPI_Erase_t BlockSize);
 int32_t BSP_QSPI_EraseChip();
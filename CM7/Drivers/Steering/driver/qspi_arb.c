@@ -0,0 +1,568 @@
+#include "qspi_arb.h"
+
+#include <string.h>
+
+/*
+ * Memory-mapped/indirect mode arbiter for the QSPI flash.
+ *
+ * The flash sits in memory-mapped mode most of the time so that assets can be
+ * read in place (CPU, DMA2D, LTDC). Programs and erases are queued in the
+ * QSPI scheduler and batched into write windows: BSP_QSPI_ArbProcess() leaves
+ * memory-mapped mode once enough operations are queued (or the oldest one
+ * waited QSPI_ARB_BATCH_DELAY_US), drains the queue in indirect mode and goes
+ * back to memory-mapped mode. A window is cut after QSPI_ARB_WINDOW_US if a
+ * mapped reader is waiting, the operation in flight is then suspended and
+ * resumed at the next window. Nothing new is issued once the window is due
+ * to close; it closes as soon as the operation in flight may be suspended
+ * (QSPI_SCHED_MIN_RUN_US after it started) or is done.
+ *
+ * MPU region 2 maps the 0x90000000 window shareable, which the Cortex-M7
+ * does not cache. The XIP_COLD_CODE build overrides its first 16 MB with the
+ * non-shareable, write-back region 3 (XIP_Init()), and there lines fetched
+ * before a write would survive it: the flash ranges touched by the window
+ * are invalidated from the D-cache, by address, before memory-mapped mode is
+ * entered again. Without XIP_COLD_CODE the invalidation finds no line.
+ *
+ * Mapped readers bracket their accesses with BSP_QSPI_ArbAcquireMapped() and
+ * BSP_QSPI_ArbReleaseMapped(), a window never opens while they hold the
+ * mapping. The release may be called from a DMA completion interrupt.
+ * BSP_QSPI_ArbRead() works in both modes. Bulk readers that need the flash
+ * in indirect mode for themselves (MDMA streaming) take a lease with
+ * BSP_QSPI_ArbAcquireIndirect(): queued operations are held while it lasts.
+ *
+ * With XIP_COLD_CODE, cold code executes from the mapping, so the flash may
+ * only leave memory-mapped mode while nothing of it can run: a write window
+ * opens and closes within one BSP_QSPI_ArbProcess() call (at most
+ * QSPI_ARB_WINDOW_US plus QSPI_SCHED_MIN_RUN_US), and a window that was cut
+ * is reopened at the next call. The code calling the arbiter must itself stay out of the flash.
+ */
+
+typedef struct
+{
+  uint32_t Start;
+  uint32_t End;
+} QSPI_ArbRange_t;
+
+typedef struct
+{
+  BSP_QSPI_ArbMode_t Mode;
+  uint32_t Initialized;
+  volatile uint32_t Users; /* Mapped readers holding the mapping */
+  uint32_t Lease;          /* Indirect mode is leased by BSP_QSPI_ArbAcquireIndirect() */
+  uint32_t WindowOpen;     /* Indirect mode was entered for queued operations */
+  uint32_t MappedWanted;   /* A mapped reader was refused during the window */
+  uint32_t Flush;          /* Open a window regardless of the batching */
+  uint32_t Cut;            /* The last window closed with operations left */
+  uint32_t Waiting;        /* Operations are queued since WaitCycles */
+  uint32_t WaitCycles;
+  uint32_t WindowCycles; /* DWT cycle count when the window opened */
+  QSPI_ArbRange_t Dirty[QSPI_ARB_DIRTY_RANGES];
+  uint32_t DirtyCount;
+  uint32_t DirtyOverflow;
+  BSP_QSPI_ArbStats_t Stats;
+} QSPI_Arb_t;
+
+static QSPI_Arb_t QSPI_Arb;
+
+static uint32_t QSPI_ArbElapsedUs(uint32_t Start);
+static int32_t QSPI_ArbWindowStep();
+static int32_t QSPI_ArbEnterMapped();
+static int32_t QSPI_ArbExitMapped();
+static void QSPI_ArbRecordSwitch(BSP_QSPI_ArbSwitch_t *Switch, uint32_t Us);
+static void QSPI_ArbAddDirty(uint32_t Addr, uint32_t Size);
+static void QSPI_ArbInvalidate();
+
+/**
+ * @brief  Initializes the arbiter and the QSPI scheduler, and puts the flash
+ *         in memory-mapped mode. BSP_QSPI_Init() must have been called.
+ * @retval BSP status
+ */
+int32_t BSP_QSPI_ArbInit()
+{
+  int32_t ret;
+
+  memset(&QSPI_Arb, 0, sizeof(QSPI_Arb));
+  QSPI_Arb.Mode = QSPI_ARB_MODE_INDIRECT;
+
+  ret = BSP_QSPI_SchedInit();
+  if (ret == BSP_ERROR_NONE)
+  {
+    ret = QSPI_ArbEnterMapped();
+  }
+  if (ret == BSP_ERROR_NONE)
+  {
+    QSPI_Arb.Initialized = 1U;
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Takes a reference on the memory-mapped mode, no write window opens
+ *         until it is released.
+ * @retval BSP status, BSP_ERROR_BUSY during a write window: the window is
+ *         closed at the next BSP_QSPI_ArbProcess() past QSPI_ARB_WINDOW_US
+ */
+int32_t BSP_QSPI_ArbAcquireMapped()
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t primask;
+
+  if (QSPI_Arb.Mode != QSPI_ARB_MODE_MAPPED)
+  {
+    QSPI_Arb.MappedWanted = 1U;
+    QSPI_Arb.Stats.MappedDenied++;
+    ret = BSP_ERROR_BUSY;
+  }
+  else
+  {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    QSPI_Arb.Users++;
+    __set_PRIMASK(primask);
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Drops a reference taken by BSP_QSPI_ArbAcquireMapped().
+ */
+void BSP_QSPI_ArbReleaseMapped()
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  if (QSPI_Arb.Users != 0U)
+  {
+    QSPI_Arb.Users--;
+  }
+  __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Takes the flash in indirect mode for exclusive use, e.g. for
+ *         BSP_QSPI_Read_DMA(). The program/erase in flight is suspended and
+ *         nothing is issued until BSP_QSPI_ArbReleaseIndirect(). Without
+ *         BSP_QSPI_ArbInit() the caller owns the flash and this is a no-op.
+ * @retval BSP status, BSP_ERROR_BUSY while mapped readers hold the mapping,
+ *         the lease is taken or the operation in flight may not be
+ *         suspended yet
+ */
+int32_t BSP_QSPI_ArbAcquireIndirect()
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (QSPI_Arb.Initialized == 0U)
+  {
+    ret = BSP_ERROR_NONE;
+  }
+  else if ((QSPI_Arb.Lease != 0U) || (QSPI_Arb.Users != 0U))
+  {
+    ret = BSP_ERROR_BUSY;
+  }
+  else if (QSPI_Arb.Mode == QSPI_ARB_MODE_MAPPED)
+  {
+    ret = QSPI_ArbExitMapped();
+  }
+  else
+  {
+    ret = BSP_QSPI_SchedSuspend();
+  }
+
+  if ((ret == BSP_ERROR_NONE) && (QSPI_Arb.Initialized != 0U))
+  {
+    QSPI_Arb.Lease = 1U;
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Ends the lease taken by BSP_QSPI_ArbAcquireIndirect(). The next
+ *         BSP_QSPI_ArbProcess() resumes the queue and goes back to
+ *         memory-mapped mode once it is empty (right away in the
+ *         XIP_COLD_CODE build).
+ */
+void BSP_QSPI_ArbReleaseIndirect()
+{
+  QSPI_Arb.Lease = 0U;
+#ifdef XIP_COLD_CODE
+  /* Cold code may run from the mapping as soon as this returns */
+  if (QSPI_Arb.Initialized != 0U)
+  {
+    (void)QSPI_ArbEnterMapped();
+  }
+#endif
+}
+
+/**
+ * @brief  Reads an amount of data in either mode: copied from the mapping in
+ *         memory-mapped mode, through the scheduler (which suspends the
+ *         program/erase in flight) during a write window.
+ * @param  pData    Pointer to data to be read
+ * @param  ReadAddr Read start address
+ * @param  Size     Size of data to read
+ * @retval BSP status
+ */
+int32_t BSP_QSPI_ArbRead(uint8_t *pData, uint32_t ReadAddr, uint32_t Size)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (QSPI_Ctx.IsInitialized == QSPI_ACCESS_MMP)
+  {
+    memcpy(pData, (const uint8_t *)(QSPI_ARB_MMP_BASE + ReadAddr), Size);
+  }
+  else
+  {
+    ret = BSP_QSPI_SchedRead(pData, ReadAddr, Size);
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Queues a write for the next write window. The data is copied.
+ * @param  pData     Pointer to data to be written
+ * @param  WriteAddr Write start address
+ * @param  Size      Size of data to write
+ * @retval BSP status, BSP_ERROR_BUSY when the queue is too full
+ */
+int32_t BSP_QSPI_ArbWrite(const uint8_t *pData, uint32_t WriteAddr, uint32_t Size)
+{
+  int32_t ret = BSP_QSPI_SchedWrite(pData, WriteAddr, Size);
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    QSPI_ArbAddDirty(WriteAddr, Size);
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Queues a block erase for the next write window.
+ * @param  BlockAddress Block address to erase
+ * @param  BlockSize    Erase Block size
+ * @retval BSP status, BSP_ERROR_BUSY when the queue is full
+ */
+int32_t BSP_QSPI_ArbErase(uint32_t BlockAddress, BSP_QSPI_Erase_t BlockSize)
+{
+  int32_t ret = BSP_QSPI_SchedErase(BlockAddress, BlockSize);
+  uint32_t size;
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    switch (BlockSize)
+    {
+    case BSP_QSPI_ERASE_8K:
+      size = 2U * MT25TL01G_SUBSECTOR_SIZE;
+      break;
+    case BSP_QSPI_ERASE_64K:
+      size = MT25TL01G_SECTOR_SIZE;
+      break;
+    default:
+      size = 2U * MT25TL01G_SECTOR_SIZE;
+      break;
+    }
+    QSPI_ArbAddDirty(BlockAddress & ~(size - 1U), size);
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Opens, runs and closes the write windows. To be called from the
+ *         main loop.
+ * @retval BSP status, BSP_ERROR_BUSY while operations are queued
+ */
+int32_t BSP_QSPI_ArbProcess()
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t pending = BSP_QSPI_SchedGetPending();
+
+  if (QSPI_Arb.Lease != 0U)
+  {
+    ret = BSP_ERROR_BUSY;
+  }
+  else if (QSPI_Arb.Mode == QSPI_ARB_MODE_MAPPED)
+  {
+    if (pending == 0U)
+    {
+      QSPI_Arb.Waiting = 0U;
+      QSPI_Arb.Flush = 0U;
+    }
+    else
+    {
+      if (QSPI_Arb.Waiting == 0U)
+      {
+        QSPI_Arb.Waiting = 1U;
+        QSPI_Arb.WaitCycles = DWT->CYCCNT;
+      }
+
+      /* A window cut short is reopened right away, the operation it
+       * suspended has to make progress */
+      if ((QSPI_Arb.Users == 0U) && ((pending >= QSPI_ARB_BATCH_OPS) || (QSPI_Arb.Flush != 0U) ||
+                                     (QSPI_Arb.Cut != 0U) ||
+                                     (QSPI_ArbElapsedUs(QSPI_Arb.WaitCycles) >= QSPI_ARB_BATCH_DELAY_US)))
+      {
+        ret = QSPI_ArbExitMapped();
+        if (ret == BSP_ERROR_NONE)
+        {
+          QSPI_Arb.WindowOpen = 1U;
+          QSPI_Arb.WindowCycles = DWT->CYCCNT;
+          QSPI_Arb.Stats.Windows++;
+#ifdef XIP_COLD_CODE
+          /* Cold code runs from the mapping as soon as this returns: the
+           * window is confined to this call and cut after QSPI_ARB_WINDOW_US */
+          QSPI_Arb.MappedWanted = 1U;
+          do
+          {
+            ret = QSPI_ArbWindowStep();
+          } while ((ret == BSP_ERROR_BUSY) && (QSPI_Arb.Mode == QSPI_ARB_MODE_INDIRECT));
+#endif
+        }
+      }
+
+      if ((ret == BSP_ERROR_NONE) && (BSP_QSPI_SchedGetPending() != 0U))
+      {
+        ret = BSP_ERROR_BUSY;
+      }
+    }
+  }
+  else
+  {
+    ret = QSPI_ArbWindowStep();
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Opens a write window at the next BSP_QSPI_ArbProcess() call,
+ *         without waiting for the batching delay.
+ * @retval BSP status
+ */
+int32_t BSP_QSPI_ArbFlush()
+{
+  QSPI_Arb.Flush = 1U;
+
+  /* Return BSP status */
+  return BSP_ERROR_NONE;
+}
+
+/**
+ * @brief  Current access mode of the flash.
+ * @retval Mode
+ */
+BSP_QSPI_ArbMode_t BSP_QSPI_ArbGetMode()
+{
+  return QSPI_Arb.Mode;
+}
+
+/**
+ * @brief  Copies the mode switch and write window counters.
+ * @param  Stats Destination
+ */
+void BSP_QSPI_ArbGetStats(BSP_QSPI_ArbStats_t *Stats)
+{
+  *Stats = QSPI_Arb.Stats;
+}
+
+static uint32_t QSPI_ArbElapsedUs(uint32_t Start)
+{
+  return (DWT->CYCCNT - Start) / (SystemCoreClock / 1000000U);
+}
+
+/**
+ * @brief  Runs the queue during a write window and closes the window once
+ *         the queue is empty, or past QSPI_ARB_WINDOW_US if a mapped reader
+ *         is waiting.
+ * @retval BSP status, BSP_ERROR_BUSY while operations are queued
+ */
+static int32_t QSPI_ArbWindowStep()
+{
+  int32_t ret, enter;
+  uint32_t cut = 0U;
+
+  if ((QSPI_Arb.MappedWanted != 0U) && (QSPI_ArbElapsedUs(QSPI_Arb.WindowCycles) >= QSPI_ARB_WINDOW_US))
+  {
+    cut = 1U;
+  }
+
+  /* Picks up the operation suspended by the previous window or lease. Once
+   * the window is due to close nothing new is issued: a fresh operation
+   * could not be suspended before QSPI_SCHED_MIN_RUN_US */
+  ret = BSP_QSPI_SchedResume();
+  if ((ret == BSP_ERROR_NONE) && (cut == 0U))
+  {
+    ret = BSP_QSPI_SchedProcess();
+  }
+
+  /* The switch is retried at the next step while the operation in flight
+   * may not be suspended yet */
+  if ((ret != BSP_ERROR_BUSY) || (cut != 0U))
+  {
+    enter = QSPI_ArbEnterMapped();
+    if (ret == BSP_ERROR_NONE)
+    {
+      ret = enter;
+    }
+    if ((ret == BSP_ERROR_NONE) && (BSP_QSPI_SchedGetPending() != 0U))
+    {
+      ret = BSP_ERROR_BUSY;
+    }
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Closes the write window: suspends the operation in flight, if any,
+ *         invalidates the written ranges from the D-cache and enters
+ *         memory-mapped mode.
+ * @retval BSP status, BSP_ERROR_BUSY (still in indirect mode) while the
+ *         operation in flight may not be suspended yet
+ */
+static int32_t QSPI_ArbEnterMapped()
+{
+  int32_t ret;
+  uint32_t start = DWT->CYCCNT;
+
+  ret = BSP_QSPI_SchedSuspend();
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    /* The flash is out of memory-mapped mode, no line of the region can be
+     * refilled before the mapping is back */
+    QSPI_ArbInvalidate();
+    ret = BSP_QSPI_EnableMemoryMappedMode();
+  }
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    if (QSPI_Arb.WindowOpen != 0U)
+    {
+      QSPI_Arb.Stats.WindowUs += QSPI_ArbElapsedUs(QSPI_Arb.WindowCycles);
+      QSPI_Arb.WindowOpen = 0U;
+    }
+    QSPI_Arb.Mode = QSPI_ARB_MODE_MAPPED;
+    QSPI_Arb.MappedWanted = 0U;
+    QSPI_Arb.Flush = 0U;
+    QSPI_Arb.Waiting = 0U;
+    QSPI_Arb.Cut = (BSP_QSPI_SchedGetPending() != 0U) ? 1U : 0U;
+    QSPI_ArbRecordSwitch(&QSPI_Arb.Stats.Enter, QSPI_ArbElapsedUs(start));
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Leaves memory-mapped mode.
+ * @retval BSP status
+ */
+static int32_t QSPI_ArbExitMapped()
+{
+  int32_t ret;
+  uint32_t start = DWT->CYCCNT;
+
+  ret = BSP_QSPI_DisableMemoryMappedMode();
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    QSPI_Arb.Mode = QSPI_ARB_MODE_INDIRECT;
+    QSPI_ArbRecordSwitch(&QSPI_Arb.Stats.Exit, QSPI_ArbElapsedUs(start));
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+static void QSPI_ArbRecordSwitch(BSP_QSPI_ArbSwitch_t *Switch, uint32_t Us)
+{
+  Switch->Count++;
+  Switch->TotalUs += Us;
+  if (Us > Switch->MaxUs)
+  {
+    Switch->MaxUs = Us;
+  }
+}
+
+/**
+ * @brief  Remembers a flash range to invalidate, merged with an overlapping
+ *         or adjacent one when possible.
+ */
+static void QSPI_ArbAddDirty(uint32_t Addr, uint32_t Size)
+{
+  uint32_t end = Addr + Size;
+  uint32_t i;
+
+  for (i = 0; i < QSPI_Arb.DirtyCount; i++)
+  {
+    if (Addr <= QSPI_Arb.Dirty[i].End && end >= QSPI_Arb.Dirty[i].Start)
+    {
+      if (Addr < QSPI_Arb.Dirty[i].Start)
+      {
+        QSPI_Arb.Dirty[i].Start = Addr;
+      }
+      if (end > QSPI_Arb.Dirty[i].End)
+      {
+        QSPI_Arb.Dirty[i].End = end;
+      }
+      return;
+    }
+  }
+
+  if (QSPI_Arb.DirtyCount < QSPI_ARB_DIRTY_RANGES)
+  {
+    QSPI_Arb.Dirty[QSPI_Arb.DirtyCount].Start = Addr;
+    QSPI_Arb.Dirty[QSPI_Arb.DirtyCount].End = end;
+    QSPI_Arb.DirtyCount++;
+  }
+  else
+  {
+    QSPI_Arb.DirtyOverflow = 1U;
+  }
+}
+
+/**
+ * @brief  Invalidates the dirty ranges from the D-cache. Ranges are kept
+ *         while operations are still queued: the window may close before
+ *         they are done, they are invalidated again after the next one.
+ */
+static void QSPI_ArbInvalidate()
+{
+  uint32_t i, start, end;
+
+  if (QSPI_Arb.DirtyOverflow != 0U)
+  {
+    SCB_CleanInvalidateDCache();
+    QSPI_Arb.Stats.FullInvalidations++;
+  }
+  else
+  {
+    for (i = 0; i < QSPI_Arb.DirtyCount; i++)
+    {
+      start = (QSPI_ARB_MMP_BASE + QSPI_Arb.Dirty[i].Start) & ~(__SCB_DCACHE_LINE_SIZE - 1U);
+      end = (QSPI_ARB_MMP_BASE + QSPI_Arb.Dirty[i].End + __SCB_DCACHE_LINE_SIZE - 1U) &
+            ~(__SCB_DCACHE_LINE_SIZE - 1U);
+      SCB_InvalidateDCache_by_Addr((void *)start, (int32_t)(end - start));
+      QSPI_Arb.Stats.InvalidatedBytes += end - start;
+    }
+  }
+
+  if (BSP_QSPI_SchedGetPending() == 0U)
+  {
+    QSPI_Arb.DirtyCount = 0U;
+    QSPI_Arb.DirtyOverflow = 0U;
+  }
+}
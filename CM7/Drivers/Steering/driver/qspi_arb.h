@@ -0,0 +1,68 @@
+#ifndef QSPI_ARB_H
+#define QSPI_ARB_H
+
+#include "qspi_sched.h"
+
+/* Base of the memory-mapped QSPI flash */
+#define QSPI_ARB_MMP_BASE 0x90000000U
+
+/* Longest time the flash is kept out of memory-mapped mode for queued
+ * programs/erases once a mapped reader is waiting */
+#ifndef QSPI_ARB_WINDOW_US
+#define QSPI_ARB_WINDOW_US 2000U
+#endif
+
+/* Longest time queued operations wait for a write window */
+#ifndef QSPI_ARB_BATCH_DELAY_US
+#define QSPI_ARB_BATCH_DELAY_US 20000U
+#endif
+
+/* Queued operations that open a write window right away */
+#ifndef QSPI_ARB_BATCH_OPS
+#define QSPI_ARB_BATCH_OPS (QSPI_SCHED_QUEUE_DEPTH / 2U)
+#endif
+
+/* Flash ranges remembered for D-cache invalidation, the whole cache is
+ * cleaned and invalidated when they overflow */
+#ifndef QSPI_ARB_DIRTY_RANGES
+#define QSPI_ARB_DIRTY_RANGES 8U
+#endif
+
+typedef enum
+{
+  QSPI_ARB_MODE_MAPPED = 0, /* Memory-mapped reads, queued writes wait */
+  QSPI_ARB_MODE_INDIRECT    /* Write window, mapped reads wait */
+} BSP_QSPI_ArbMode_t;
+
+typedef struct
+{
+  uint32_t Count;   /* Mode switches */
+  uint32_t TotalUs; /* Time spent switching */
+  uint32_t MaxUs;
+} BSP_QSPI_ArbSwitch_t;
+
+typedef struct
+{
+  BSP_QSPI_ArbSwitch_t Enter;   /* Indirect to memory-mapped */
+  BSP_QSPI_ArbSwitch_t Exit;    /* Memory-mapped to indirect */
+  uint32_t Windows;             /* Write windows opened */
+  uint32_t WindowUs;            /* Time spent in write windows */
+  uint32_t InvalidatedBytes;    /* D-cache invalidated by address */
+  uint32_t FullInvalidations;   /* Whole D-cache clean/invalidate on range overflow */
+  uint32_t MappedDenied;        /* BSP_QSPI_ArbAcquireMapped() calls refused */
+} BSP_QSPI_ArbStats_t;
+
+int32_t BSP_QSPI_ArbInit();
+int32_t BSP_QSPI_ArbAcquireMapped();
+void BSP_QSPI_ArbReleaseMapped();
+int32_t BSP_QSPI_ArbAcquireIndirect();
+void BSP_QSPI_ArbReleaseIndirect();
+int32_t BSP_QSPI_ArbRead(uint8_t *pData, uint32_t ReadAddr, uint32_t Size);
+int32_t BSP_QSPI_ArbWrite(const uint8_t *pData, uint32_t WriteAddr, uint32_t Size);
+int32_t BSP_QSPI_ArbErase(uint32_t BlockAddress, BSP_QSPI_Erase_t BlockSize);
+int32_t BSP_QSPI_ArbProcess();
+int32_t BSP_QSPI_ArbFlush();
+BSP_QSPI_ArbMode_t BSP_QSPI_ArbGetMode();
+void BSP_QSPI_ArbGetStats(BSP_QSPI_ArbStats_t *Stats);
+
+#endif /* QSPI_ARB_H */
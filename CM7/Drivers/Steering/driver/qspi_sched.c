@@ -0,0 +1,597 @@
+#include "qspi_sched.h"
+
+#include <string.h>
+
+/*
+ * Background program/erase scheduler for the QSPI flash.
+ *
+ * Programs and erases are queued and issued one at a time by
+ * BSP_QSPI_SchedProcess(), which only looks at the flag status register and
+ * never waits for the array. BSP_QSPI_SchedRead() serves latency sensitive
+ * reads at any time: a running program/erase is suspended for the read and
+ * resumed right after, and the read latency is recorded in a histogram.
+ *
+ * An operation is not suspended before it ran QSPI_SCHED_MIN_RUN_US since
+ * it was issued or resumed, or back-to-back reads would starve it. The
+ * earliest suspend time is recorded at issue and resume; a suspend asked
+ * for before it does not wait, it reports BSP_ERROR_BUSY and the caller
+ * retries (from its own loop, the read is not served meanwhile).
+ *
+ * While the scheduler is in use, program and erase must go through it: the
+ * blocking BSP_QSPI_Write()/BSP_QSPI_EraseBlock() would wait for (or collide
+ * with) the operation in flight.
+ */
+
+typedef enum
+{
+  QSPI_SCHED_OP_PROGRAM = 0,
+  QSPI_SCHED_OP_ERASE
+} QSPI_SchedOpType_t;
+
+typedef struct
+{
+  QSPI_SchedOpType_t Type;
+  BSP_QSPI_Erase_t EraseSize;
+  uint32_t Addr;
+  uint32_t Size;
+  uint8_t Data[MT25TL01G_PAGE_SIZE];
+} QSPI_SchedOp_t;
+
+typedef struct
+{
+  QSPI_SchedOp_t Queue[QSPI_SCHED_QUEUE_DEPTH];
+  uint32_t Head;
+  uint32_t Tail;
+  uint32_t Running;     /* Queue[Tail] was issued to the flash */
+  uint32_t Suspended;   /* and is suspended by BSP_QSPI_SchedSuspend() */
+  uint32_t StartCycles; /* DWT cycle count when it was issued or resumed */
+  uint32_t SuspendAt;   /* DWT cycle count from which it may be suspended */
+  uint32_t Histogram[QSPI_SCHED_READ_NBR][QSPI_SCHED_LAT_BUCKETS];
+  uint32_t Max[QSPI_SCHED_READ_NBR];
+  BSP_QSPI_SchedStats_t Stats;
+} QSPI_Sched_t;
+
+static QSPI_Sched_t QSPI_Sched;
+
+static uint32_t QSPI_SchedElapsedUs(uint32_t Start);
+static void QSPI_SchedStarted();
+static int32_t QSPI_SchedReadFlags(uint8_t *Flags);
+static int32_t QSPI_SchedSuspend(uint32_t *Suspended);
+static int32_t QSPI_SchedResume();
+static int32_t QSPI_SchedIssue();
+static void QSPI_SchedComplete(uint8_t Flags);
+static void QSPI_SchedRecord(BSP_QSPI_SchedRead_t Type, uint32_t Us);
+static uint32_t QSPI_SchedBucket(uint32_t Us);
+static uint32_t QSPI_SchedBucketValue(uint32_t Bucket);
+
+/**
+ * @brief  Initializes the scheduler. BSP_QSPI_Init() must have been called.
+ * @retval BSP status
+ */
+int32_t BSP_QSPI_SchedInit()
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  memset(&QSPI_Sched, 0, sizeof(QSPI_Sched));
+
+  /* Latencies are measured with the cycle counter */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->LAR = 0xC5ACCE55U;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  if (QSPI_Ctx.IsInitialized != QSPI_ACCESS_INDIRECT)
+  {
+    ret = BSP_ERROR_NO_INIT;
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Queues a write. The data is copied, the caller buffer is free on
+ *         return. Nothing is queued if the write does not fit entirely.
+ * @param  pData      Pointer to data to be written
+ * @param  WriteAddr  Write start address
+ * @param  Size       Size of data to write
+ * @retval BSP status, BSP_ERROR_BUSY when the queue is too full
+ */
+int32_t BSP_QSPI_SchedWrite(const uint8_t *pData, uint32_t WriteAddr, uint32_t Size)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t pages, free_ops, chunk;
+  QSPI_SchedOp_t *op;
+
+  pages = ((WriteAddr % MT25TL01G_PAGE_SIZE) + Size + MT25TL01G_PAGE_SIZE - 1U) / MT25TL01G_PAGE_SIZE;
+  free_ops = QSPI_SCHED_QUEUE_DEPTH - (QSPI_Sched.Head - QSPI_Sched.Tail);
+
+  if ((pData == NULL) || (Size == 0U))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if (pages > free_ops)
+  {
+    ret = BSP_ERROR_BUSY;
+  }
+  else
+  {
+    /* Split on page boundaries, one program per page */
+    while (Size != 0U)
+    {
+      chunk = MT25TL01G_PAGE_SIZE - (WriteAddr % MT25TL01G_PAGE_SIZE);
+      if (chunk > Size)
+      {
+        chunk = Size;
+      }
+
+      op = &QSPI_Sched.Queue[QSPI_Sched.Head % QSPI_SCHED_QUEUE_DEPTH];
+      op->Type = QSPI_SCHED_OP_PROGRAM;
+      op->Addr = WriteAddr;
+      op->Size = chunk;
+      memcpy(op->Data, pData, chunk);
+      QSPI_Sched.Head++;
+
+      pData += chunk;
+      WriteAddr += chunk;
+      Size -= chunk;
+    }
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Queues a block erase.
+ * @param  BlockAddress Block address to erase
+ * @param  BlockSize    Erase Block size
+ * @retval BSP status, BSP_ERROR_BUSY when the queue is full
+ */
+int32_t BSP_QSPI_SchedErase(uint32_t BlockAddress, BSP_QSPI_Erase_t BlockSize)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  QSPI_SchedOp_t *op;
+
+  if (BlockSize == BSP_QSPI_ERASE_CHIP)
+  {
+    ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+  }
+  else if ((QSPI_Sched.Head - QSPI_Sched.Tail) >= QSPI_SCHED_QUEUE_DEPTH)
+  {
+    ret = BSP_ERROR_BUSY;
+  }
+  else
+  {
+    op = &QSPI_Sched.Queue[QSPI_Sched.Head % QSPI_SCHED_QUEUE_DEPTH];
+    op->Type = QSPI_SCHED_OP_ERASE;
+    op->Addr = BlockAddress;
+    op->EraseSize = BlockSize;
+    QSPI_Sched.Head++;
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Reads an amount of data, suspending the program/erase in flight
+ *         if needed. The latency is added to the histogram of its kind.
+ * @param  pData     Pointer to data to be read
+ * @param  ReadAddr  Read start address
+ * @param  Size      Size of data to read
+ * @retval BSP status, BSP_ERROR_BUSY (nothing read) while the operation in
+ *         flight may not be suspended yet
+ */
+int32_t BSP_QSPI_SchedRead(uint8_t *pData, uint32_t ReadAddr, uint32_t Size)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t start = DWT->CYCCNT;
+  uint32_t suspended = 0U, preempt = 0U;
+
+  if (QSPI_Sched.Running != 0U && QSPI_Sched.Suspended == 0U)
+  {
+    preempt = 1U;
+    ret = QSPI_SchedSuspend(&suspended);
+  }
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    ret = BSP_QSPI_Read(pData, ReadAddr, Size);
+  }
+
+  if (suspended != 0U && QSPI_SchedResume() != BSP_ERROR_NONE)
+  {
+    ret = BSP_ERROR_COMPONENT_FAILURE;
+  }
+
+  /* A deferred read is timed when it is served */
+  if (ret != BSP_ERROR_BUSY)
+  {
+    QSPI_SchedRecord(preempt ? QSPI_SCHED_READ_PREEMPT : QSPI_SCHED_READ_IDLE, QSPI_SchedElapsedUs(start));
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Background step: retires the operation in flight when the flash
+ *         reports ready and issues the next one. Never waits for the array,
+ *         call it periodically from the main loop.
+ * @retval BSP_ERROR_BUSY while operations are pending, BSP_ERROR_NONE when
+ *         the queue is empty, or the failure
+ */
+int32_t BSP_QSPI_SchedProcess()
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint8_t flags[2];
+
+  if (QSPI_Ctx.IsInitialized != QSPI_ACCESS_INDIRECT)
+  {
+    ret = BSP_ERROR_QSPI_MMP_LOCK_FAILURE;
+  }
+  else if (QSPI_Sched.Suspended != 0U)
+  {
+    ret = BSP_ERROR_BUSY;
+  }
+  else if (QSPI_Sched.Running != 0U)
+  {
+    ret = QSPI_SchedReadFlags(flags);
+    if (ret == BSP_ERROR_NONE && (flags[0] & flags[1] & MT25TL01G_FSR_READY) != 0U)
+    {
+      QSPI_SchedComplete((uint8_t)(flags[0] | flags[1]));
+    }
+  }
+
+  if (ret == BSP_ERROR_NONE && QSPI_Sched.Running == 0U && QSPI_Sched.Head != QSPI_Sched.Tail)
+  {
+    ret = QSPI_SchedIssue();
+  }
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    ret = BSP_QSPI_SchedGetState();
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Suspends the program/erase in flight until BSP_QSPI_SchedResume(),
+ *         e.g. to leave the QSPI to memory-mapped reads for a while.
+ * @retval BSP status, BSP_ERROR_BUSY while the operation in flight may not
+ *         be suspended yet
+ */
+int32_t BSP_QSPI_SchedSuspend()
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (QSPI_Sched.Running != 0U && QSPI_Sched.Suspended == 0U)
+  {
+    ret = QSPI_SchedSuspend(&QSPI_Sched.Suspended);
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Resumes the operation suspended by BSP_QSPI_SchedSuspend().
+ * @retval BSP status
+ */
+int32_t BSP_QSPI_SchedResume()
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (QSPI_Sched.Suspended != 0U)
+  {
+    ret = QSPI_SchedResume();
+    QSPI_Sched.Suspended = 0U;
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Reports whether program/erase operations are pending.
+ * @retval BSP_ERROR_BUSY while the queue is not empty
+ */
+int32_t BSP_QSPI_SchedGetState()
+{
+  return (QSPI_Sched.Head != QSPI_Sched.Tail) ? BSP_ERROR_BUSY : BSP_ERROR_NONE;
+}
+
+/**
+ * @brief  Number of queued operations, the one in flight included.
+ * @retval Operation count
+ */
+uint32_t BSP_QSPI_SchedGetPending()
+{
+  return QSPI_Sched.Head - QSPI_Sched.Tail;
+}
+
+/**
+ * @brief  Computes the read latency percentiles of one kind of read.
+ * @param  Type     Reads on an idle flash or reads that suspended an operation
+ * @param  Latency  Output
+ * @retval BSP status
+ */
+int32_t BSP_QSPI_SchedGetLatency(BSP_QSPI_SchedRead_t Type, BSP_QSPI_SchedLatency_t *Latency)
+{
+  static const uint32_t percent[3] = {50U, 90U, 99U};
+  int32_t ret = BSP_ERROR_NONE;
+  const uint32_t *histogram;
+  uint32_t *out[3];
+  uint32_t bucket, sum = 0U, next = 0U;
+
+  if ((Type >= QSPI_SCHED_READ_NBR) || (Latency == NULL))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    histogram = QSPI_Sched.Histogram[Type];
+    memset(Latency, 0, sizeof(*Latency));
+    out[0] = &Latency->P50;
+    out[1] = &Latency->P90;
+    out[2] = &Latency->P99;
+
+    for (bucket = 0U; bucket < QSPI_SCHED_LAT_BUCKETS; bucket++)
+    {
+      Latency->Count += histogram[bucket];
+    }
+
+    for (bucket = 0U; bucket < QSPI_SCHED_LAT_BUCKETS && Latency->Count != 0U; bucket++)
+    {
+      sum += histogram[bucket];
+      while (next < 3U && sum * 100U >= Latency->Count * percent[next])
+      {
+        *out[next++] = QSPI_SchedBucketValue(bucket);
+      }
+    }
+    Latency->Max = QSPI_Sched.Max[Type];
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Clears the read latency histograms.
+ * @retval None
+ */
+void BSP_QSPI_SchedResetLatency()
+{
+  memset(QSPI_Sched.Histogram, 0, sizeof(QSPI_Sched.Histogram));
+  memset(QSPI_Sched.Max, 0, sizeof(QSPI_Sched.Max));
+}
+
+/**
+ * @brief  Copies the scheduler counters.
+ * @param  Stats Output
+ * @retval None
+ */
+void BSP_QSPI_SchedGetStats(BSP_QSPI_SchedStats_t *Stats)
+{
+  *Stats = QSPI_Sched.Stats;
+}
+
+static uint32_t QSPI_SchedElapsedUs(uint32_t Start)
+{
+  return (DWT->CYCCNT - Start) / (SystemCoreClock / 1000000U);
+}
+
+/**
+ * @brief  Reads the flag status register of both dies.
+ * @param  Flags 2 bytes
+ * @retval BSP status
+ */
+static int32_t QSPI_SchedReadFlags(uint8_t *Flags)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (MT25TL01G_ReadFlagStatusRegister(&hqspi, QSPI_Ctx.InterfaceMode, Flags) != MT25TL01G_OK)
+  {
+    ret = BSP_ERROR_COMPONENT_FAILURE;
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Records the start of the operation in flight, issued or resumed,
+ *         and the earliest time it may be suspended.
+ * @retval None
+ */
+static void QSPI_SchedStarted()
+{
+  QSPI_Sched.StartCycles = DWT->CYCCNT;
+  QSPI_Sched.SuspendAt = QSPI_Sched.StartCycles + QSPI_SCHED_MIN_RUN_US * (SystemCoreClock / 1000000U);
+}
+
+/**
+ * @brief  Suspends the operation in flight, once it ran for
+ *         QSPI_SCHED_MIN_RUN_US since it was issued or resumed.
+ * @param  Suspended Set to 1 if the operation is suspended, left to 0 if it
+ *         completed before the suspend was taken
+ * @retval BSP status, BSP_ERROR_BUSY before the earliest suspend time if
+ *         the operation is still running
+ */
+static int32_t QSPI_SchedSuspend(uint32_t *Suspended)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  uint32_t start = DWT->CYCCNT;
+  uint8_t flags[2];
+
+  /* Let the operation make progress since its last resume, unless it is
+   * already done */
+  if ((int32_t)(start - QSPI_Sched.SuspendAt) < 0)
+  {
+    ret = QSPI_SchedReadFlags(flags);
+    if (ret == BSP_ERROR_NONE && (flags[0] & flags[1] & MT25TL01G_FSR_READY) == 0U)
+    {
+      ret = BSP_ERROR_BUSY;
+    }
+  }
+  else if (MT25TL01G_ProgEraseSuspend(&hqspi, QSPI_Ctx.InterfaceMode) != MT25TL01G_OK)
+  {
+    ret = BSP_ERROR_COMPONENT_FAILURE;
+  }
+
+  /* Both dies report ready once suspended, or once done if the operation
+   * completed before the suspend was taken */
+  do
+  {
+    if (ret == BSP_ERROR_NONE)
+    {
+      ret = QSPI_SchedReadFlags(flags);
+    }
+    if (ret == BSP_ERROR_NONE && QSPI_SchedElapsedUs(start) > QSPI_SCHED_SUSPEND_TIMEOUT_US)
+    {
+      ret = BSP_ERROR_PERIPH_FAILURE;
+    }
+  } while (ret == BSP_ERROR_NONE && ((flags[0] & flags[1] & MT25TL01G_FSR_READY) == 0U));
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    if (((flags[0] | flags[1]) & (MT25TL01G_FSR_PGSUS | MT25TL01G_FSR_ERSUS)) != 0U)
+    {
+      *Suspended = 1U;
+      QSPI_Sched.Stats.Suspends++;
+    }
+    else
+    {
+      QSPI_SchedComplete((uint8_t)(flags[0] | flags[1]));
+    }
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+static int32_t QSPI_SchedResume()
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (MT25TL01G_ProgEraseResume(&hqspi, QSPI_Ctx.InterfaceMode) != MT25TL01G_OK)
+  {
+    ret = BSP_ERROR_COMPONENT_FAILURE;
+  }
+  QSPI_SchedStarted();
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Issues the operation at the tail of the queue. Only the command and
+ *         the page data are sent, the array works in the background.
+ * @retval BSP status
+ */
+static int32_t QSPI_SchedIssue()
+{
+  int32_t ret = BSP_ERROR_NONE;
+  QSPI_SchedOp_t *op = &QSPI_Sched.Queue[QSPI_Sched.Tail % QSPI_SCHED_QUEUE_DEPTH];
+
+  if (MT25TL01G_WriteEnable(&hqspi, QSPI_Ctx.InterfaceMode) != MT25TL01G_OK)
+  {
+    ret = BSP_ERROR_COMPONENT_FAILURE;
+  }
+  else if (op->Type == QSPI_SCHED_OP_PROGRAM)
+  {
+    if (MT25TL01G_PageProgram(&hqspi, QSPI_Ctx.InterfaceMode, op->Data, op->Addr, op->Size) != MT25TL01G_OK)
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+  }
+  else
+  {
+    if (MT25TL01G_BlockErase(&hqspi, QSPI_Ctx.InterfaceMode, op->Addr, (MT25TL01G_EraseTypeDef)op->EraseSize) !=
+        MT25TL01G_OK)
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+  }
+
+  if (ret == BSP_ERROR_NONE)
+  {
+    QSPI_Sched.Running = 1U;
+    QSPI_SchedStarted();
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Retires the operation in flight.
+ * @param  Flags Flag status register of both dies ORed together
+ * @retval None
+ */
+static void QSPI_SchedComplete(uint8_t Flags)
+{
+  QSPI_SchedOp_t *op = &QSPI_Sched.Queue[QSPI_Sched.Tail % QSPI_SCHED_QUEUE_DEPTH];
+
+  if ((Flags & (MT25TL01G_FSR_PRERR | MT25TL01G_FSR_PGERR | MT25TL01G_FSR_ERERR)) != 0U)
+  {
+    QSPI_Sched.Stats.Errors++;
+    (void)MT25TL01G_ClearFlagStatusRegister(&hqspi, QSPI_Ctx.InterfaceMode);
+  }
+  else if (op->Type == QSPI_SCHED_OP_PROGRAM)
+  {
+    QSPI_Sched.Stats.Programs++;
+  }
+  else
+  {
+    QSPI_Sched.Stats.Erases++;
+  }
+
+  QSPI_Sched.Running = 0U;
+  QSPI_Sched.Tail++;
+}
+
+static void QSPI_SchedRecord(BSP_QSPI_SchedRead_t Type, uint32_t Us)
+{
+  QSPI_Sched.Histogram[Type][QSPI_SchedBucket(Us)]++;
+  if (Us > QSPI_Sched.Max[Type])
+  {
+    QSPI_Sched.Max[Type] = Us;
+  }
+}
+
+/**
+ * @brief  Bucket of a latency: exact below 4 us, then 4 buckets per power of
+ *         two, i.e. better than 25% resolution up to 2^31 us.
+ */
+static uint32_t QSPI_SchedBucket(uint32_t Us)
+{
+  uint32_t exp;
+
+  if (Us < 4U)
+  {
+    return Us;
+  }
+
+  exp = 31U - (uint32_t)__CLZ(Us);
+  return (exp - 1U) * 4U + ((Us >> (exp - 2U)) & 3U);
+}
+
+/**
+ * @brief  Largest latency falling in a bucket.
+ */
+static uint32_t QSPI_SchedBucketValue(uint32_t Bucket)
+{
+  uint32_t exp, mantissa;
+
+  if (Bucket < 4U)
+  {
+    return Bucket;
+  }
+
+  exp = Bucket / 4U + 1U;
+  mantissa = Bucket % 4U;
+  return ((5U + mantissa) << (exp - 2U)) - 1U;
+}
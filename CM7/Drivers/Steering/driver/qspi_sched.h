@@ -0,0 +1,61 @@
+#ifndef QSPI_SCHED_H
+#define QSPI_SCHED_H
+
+#include "qspi.h"
+
+/* Program/erase operations waiting in the scheduler, one page or one block each */
+#ifndef QSPI_SCHED_QUEUE_DEPTH
+#define QSPI_SCHED_QUEUE_DEPTH 16U
+#endif
+
+/* Time a program/erase is left running after it was issued or resumed
+ * before it may be suspended again, so that back-to-back reads cannot starve
+ * it. A suspend asked for sooner returns BSP_ERROR_BUSY. */
+#ifndef QSPI_SCHED_MIN_RUN_US
+#define QSPI_SCHED_MIN_RUN_US 300U
+#endif
+
+/* Upper bound of the suspend latency (tSUS is 40 us on the MT25Q) */
+#define QSPI_SCHED_SUSPEND_TIMEOUT_US 200U
+
+/* Log-linear latency histogram, 4 buckets per power of two of microseconds */
+#define QSPI_SCHED_LAT_BUCKETS 128U
+
+typedef enum
+{
+  QSPI_SCHED_READ_IDLE = 0, /* Read found the flash idle */
+  QSPI_SCHED_READ_PREEMPT,  /* Read suspended a program/erase */
+  QSPI_SCHED_READ_NBR
+} BSP_QSPI_SchedRead_t;
+
+typedef struct
+{
+  uint32_t Count;
+  uint32_t P50; /* Latencies in microseconds, upper bound of the bucket */
+  uint32_t P90;
+  uint32_t P99;
+  uint32_t Max;
+} BSP_QSPI_SchedLatency_t;
+
+typedef struct
+{
+  uint32_t Programs; /* Pages programmed */
+  uint32_t Erases;   /* Blocks erased */
+  uint32_t Suspends; /* Program/erase suspended for a read or a mode switch */
+  uint32_t Errors;   /* Program/erase failures reported by the flag status register */
+} BSP_QSPI_SchedStats_t;
+
+int32_t BSP_QSPI_SchedInit();
+int32_t BSP_QSPI_SchedWrite(const uint8_t *pData, uint32_t WriteAddr, uint32_t Size);
+int32_t BSP_QSPI_SchedErase(uint32_t BlockAddress, BSP_QSPI_Erase_t BlockSize);
+int32_t BSP_QSPI_SchedRead(uint8_t *pData, uint32_t ReadAddr, uint32_t Size);
+int32_t BSP_QSPI_SchedProcess();
+int32_t BSP_QSPI_SchedSuspend();
+int32_t BSP_QSPI_SchedResume();
+int32_t BSP_QSPI_SchedGetState();
+uint32_t BSP_QSPI_SchedGetPending();
+int32_t BSP_QSPI_SchedGetLatency(BSP_QSPI_SchedRead_t Type, BSP_QSPI_SchedLatency_t *Latency);
+void BSP_QSPI_SchedResetLatency();
+void BSP_QSPI_SchedGetStats(BSP_QSPI_SchedStats_t *Stats);
+
+#endif /* QSPI_SCHED_H */
@@ -1,7 +1,44 @@
 #include "sdram.h"
 
+/* FMC and mode register settings of a profile */
+typedef struct
+{
+	const char *Name;
+	uint32_t CASLatency;    /* FMC_SDRAM_CAS_LATENCY_x, the mode register follows */
+	uint32_t ReadBurst;     /* FMC_SDRAM_RBURST_x */
+	uint32_t ReadPipeDelay; /* FMC_SDRAM_RPIPE_DELAY_x */
+	uint32_t BurstLength;   /* MT48LC4M32B2_BURST_LENGTH_x */
+	uint32_t WriteBurstMode;
+} SDRAM_Profile_t;
+
+/*
+ * The FMC turns every AXI burst into one READ/WRITE command per beat and
+ * prefetches with its read FIFO (RBURST), so the device keeps a burst
+ * length of 1: the profiles tune the FMC side and the CAS latency. CAS 2
+ * is within the -6A speed grade at the 100 MHz SDCLK.
+ */
+static const SDRAM_Profile_t SdramProfiles[SDRAM_PROFILE_COUNT] = {
+	[SDRAM_PROFILE_CUBEMX] = {"cubemx", FMC_SDRAM_CAS_LATENCY_3, FMC_SDRAM_RBURST_ENABLE, FMC_SDRAM_RPIPE_DELAY_0,
+				  MT48LC4M32B2_BURST_LENGTH_1, MT48LC4M32B2_WRITEBURST_MODE_SINGLE},
+	[SDRAM_PROFILE_CL2] = {"cl2", FMC_SDRAM_CAS_LATENCY_2, FMC_SDRAM_RBURST_ENABLE, FMC_SDRAM_RPIPE_DELAY_0,
+			       MT48LC4M32B2_BURST_LENGTH_1, MT48LC4M32B2_WRITEBURST_MODE_SINGLE},
+	[SDRAM_PROFILE_CL2_RPIPE1] = {"cl2-rpipe1", FMC_SDRAM_CAS_LATENCY_2, FMC_SDRAM_RBURST_ENABLE,
+				      FMC_SDRAM_RPIPE_DELAY_1, MT48LC4M32B2_BURST_LENGTH_1,
+				      MT48LC4M32B2_WRITEBURST_MODE_SINGLE},
+	[SDRAM_PROFILE_NO_RBURST] = {"no-rburst", FMC_SDRAM_CAS_LATENCY_3, FMC_SDRAM_RBURST_DISABLE,
+				     FMC_SDRAM_RPIPE_DELAY_0, MT48LC4M32B2_BURST_LENGTH_1,
+				     MT48LC4M32B2_WRITEBURST_MODE_SINGLE},
+};
+
+/* The splash brings the SDRAM up before BSP_LCD_Init() asks for it again */
+static uint32_t SdramInitialized;
+static BSP_SDRAM_Profile_t SdramProfile = SDRAM_BOOT_PROFILE;
+
+static void SDRAM_ApplyFmc(const SDRAM_Profile_t *Profile);
+static void SDRAM_GetRegMode(const SDRAM_Profile_t *Profile, MT48LC4M32B2_ContextTypeDef *RegMode);
+
 /**
- * @brief  Initializes the SDRAM device.
+ * @brief  Initializes the SDRAM device, once, with SDRAM_BOOT_PROFILE.
  * @retval BSP status
  */
 int32_t BSP_SDRAM_Init()
@@ -9,19 +46,125 @@ int32_t BSP_SDRAM_Init()
 	int32_t ret = BSP_ERROR_NONE;
 	static MT48LC4M32B2_ContextTypeDef pRegMode;
 
-	/* External memory mode register configuration */
-	pRegMode.TargetBank = FMC_SDRAM_CMD_TARGET_BANK2;
-	pRegMode.RefreshMode = MT48LC4M32B2_AUTOREFRESH_MODE_CMD;
-	pRegMode.RefreshRate = REFRESH_COUNT;
-	pRegMode.BurstLength = MT48LC4M32B2_BURST_LENGTH_1;
-	pRegMode.BurstType = MT48LC4M32B2_BURST_TYPE_SEQUENTIAL;
-	pRegMode.CASLatency = MT48LC4M32B2_CAS_LATENCY_3;
-	pRegMode.OperationMode = MT48LC4M32B2_OPERATING_MODE_STANDARD;
-	pRegMode.WriteBurstMode = MT48LC4M32B2_WRITEBURST_MODE_SINGLE;
-
 	/* SDRAM initialization sequence */
-	if (MT48LC4M32B2_Init(&hsdram1, &pRegMode) != MT48LC4M32B2_OK) {
+	if (SdramInitialized != 0U) {
+		/* Nothing to do */
+	} else {
+		SDRAM_ApplyFmc(&SdramProfiles[SdramProfile]);
+		SDRAM_GetRegMode(&SdramProfiles[SdramProfile], &pRegMode);
+		if (MT48LC4M32B2_Init(&hsdram1, &pRegMode) != MT48LC4M32B2_OK) {
+			ret = BSP_ERROR_COMPONENT_FAILURE;
+		} else {
+			SdramInitialized = 1U;
+		}
+	}
+
+	return ret;
+}
+
+/**
+ * @brief  Restarts an SDRAM that kept its content through a system reset
+ *         (warm boot): the power-up delay is skipped. The mode register is
+ *         programmed again, the previous boot may have switched profile.
+ *         The FMC must be configured (MX_FMC_Init).
+ * @retval BSP status
+ */
+int32_t BSP_SDRAM_WarmInit()
+{
+	int32_t ret = BSP_ERROR_NONE;
+	MT48LC4M32B2_ContextTypeDef reg_mode;
+
+	SDRAM_ApplyFmc(&SdramProfiles[SdramProfile]);
+	SDRAM_GetRegMode(&SdramProfiles[SdramProfile], &reg_mode);
+
+	/* Clock enable also leaves self-refresh, then a refresh burst makes up
+	 * for the rows missed during the reset */
+	if (MT48LC4M32B2_ClockEnable(&hsdram1, FMC_SDRAM_CMD_TARGET_BANK2) != MT48LC4M32B2_OK) {
+		ret = BSP_ERROR_COMPONENT_FAILURE;
+	} else if (MT48LC4M32B2_Precharge(&hsdram1, FMC_SDRAM_CMD_TARGET_BANK2) != MT48LC4M32B2_OK) {
+		ret = BSP_ERROR_COMPONENT_FAILURE;
+	} else if (MT48LC4M32B2_RefreshMode(&hsdram1, FMC_SDRAM_CMD_TARGET_BANK2, MT48LC4M32B2_AUTOREFRESH_MODE_CMD) !=
+		   MT48LC4M32B2_OK) {
+		ret = BSP_ERROR_COMPONENT_FAILURE;
+	} else if (MT48LC4M32B2_ModeRegConfig(&hsdram1, &reg_mode) != MT48LC4M32B2_OK) {
+		ret = BSP_ERROR_COMPONENT_FAILURE;
+	} else if (MT48LC4M32B2_RefreshRate(&hsdram1, REFRESH_COUNT) != MT48LC4M32B2_OK) {
+		ret = BSP_ERROR_COMPONENT_FAILURE;
+	} else {
+		SdramInitialized = 1U;
+	}
+
+	return ret;
+}
+
+/**
+ * @brief  Switches the FMC and the SDRAM mode register to another profile,
+ *         the content is kept. Nothing else (LTDC, DMA2D, MDMA, the other
+ *         core) may access the SDRAM meanwhile; interrupts are masked and
+ *         the D-cache is cleaned and invalidated for the SDRAM to be read
+ *         back with the new timings.
+ * @param  Profile SDRAM_PROFILE_x
+ * @retval BSP status
+ */
+int32_t BSP_SDRAM_SetProfile(BSP_SDRAM_Profile_t Profile)
+{
+	int32_t ret = BSP_ERROR_NONE;
+	MT48LC4M32B2_ContextTypeDef reg_mode;
+	uint32_t primask;
+
+	if (Profile >= SDRAM_PROFILE_COUNT) {
+		ret = BSP_ERROR_WRONG_PARAM;
+	} else if (SdramInitialized == 0U) {
+		ret = BSP_ERROR_NO_INIT;
+	} else {
+		SCB_CleanInvalidateDCache();
+		SDRAM_GetRegMode(&SdramProfiles[Profile], &reg_mode);
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+		SDRAM_ApplyFmc(&SdramProfiles[Profile]);
+		/* Mode register loads need every bank precharged */
+		if ((MT48LC4M32B2_Precharge(&hsdram1, FMC_SDRAM_CMD_TARGET_BANK2) != MT48LC4M32B2_OK) ||
+		    (MT48LC4M32B2_ModeRegConfig(&hsdram1, &reg_mode) != MT48LC4M32B2_OK)) {
+			ret = BSP_ERROR_COMPONENT_FAILURE;
+		} else {
+			SdramProfile = Profile;
+		}
+		__set_PRIMASK(primask);
+	}
+
+	return ret;
+}
+
+BSP_SDRAM_Profile_t BSP_SDRAM_GetProfile()
+{
+	return SdramProfile;
+}
+
+/**
+ * @brief  Short name of a profile, for reports.
+ * @param  Profile SDRAM_PROFILE_x
+ * @retval Name, "?" for an unknown profile
+ */
+const char *BSP_SDRAM_GetProfileName(BSP_SDRAM_Profile_t Profile)
+{
+	return (Profile < SDRAM_PROFILE_COUNT) ? SdramProfiles[Profile].Name : "?";
+}
+
+/**
+ * @brief  Puts the SDRAM in self-refresh, it keeps its content without the
+ *         FMC until BSP_SDRAM_WarmInit(). Used right before a system reset.
+ * @retval BSP status
+ */
+int32_t BSP_SDRAM_EnterSelfRefresh()
+{
+	int32_t ret = BSP_ERROR_NONE;
+
+	if (MT48LC4M32B2_RefreshMode(&hsdram1, FMC_SDRAM_CMD_TARGET_BANK2, MT48LC4M32B2_SELFREFRESH_MODE_CMD) !=
+	    MT48LC4M32B2_OK) {
 		ret = BSP_ERROR_COMPONENT_FAILURE;
+	} else {
+		SdramInitialized = 0U;
 	}
 
 	return ret;
@@ -34,6 +177,7 @@ int32_t BSP_SDRAM_Init()
 int32_t BSP_SDRAM_DeInit()
 {
 	HAL_SDRAM_DeInit(&hsdram1);
+	SdramInitialized = 0U;
 
 	return BSP_ERROR_NONE;
 }
@@ -51,3 +195,42 @@ int32_t BSP_SDRAM_SendCmd(FMC_SDRAM_CommandTypeDef *SdramCmd)
 
 	return BSP_ERROR_NONE;
 }
+
+/**
+ * @brief  Programs the FMC side of a profile. RBURST and RPIPE are common
+ *         to both banks and live in SDCR1, CAS in the bank 2 register. The
+ *         FMC is stopped meanwhile.
+ * @param  Profile Profile to apply
+ * @retval None
+ */
+static void SDRAM_ApplyFmc(const SDRAM_Profile_t *Profile)
+{
+	__FMC_DISABLE();
+	MODIFY_REG(FMC_SDRAM_DEVICE->SDCR[FMC_SDRAM_BANK1], FMC_SDCRx_RBURST | FMC_SDCRx_RPIPE,
+		   Profile->ReadBurst | Profile->ReadPipeDelay);
+	MODIFY_REG(FMC_SDRAM_DEVICE->SDCR[FMC_SDRAM_BANK2], FMC_SDCRx_CAS, Profile->CASLatency);
+	__FMC_ENABLE();
+
+	hsdram1.Init.CASLatency = Profile->CASLatency;
+	hsdram1.Init.ReadBurst = Profile->ReadBurst;
+	hsdram1.Init.ReadPipeDelay = Profile->ReadPipeDelay;
+}
+
+/**
+ * @brief  Mode register settings of a profile.
+ * @param  Profile Profile to apply
+ * @param  RegMode Filled in
+ * @retval None
+ */
+static void SDRAM_GetRegMode(const SDRAM_Profile_t *Profile, MT48LC4M32B2_ContextTypeDef *RegMode)
+{
+	RegMode->TargetBank = FMC_SDRAM_CMD_TARGET_BANK2;
+	RegMode->RefreshMode = MT48LC4M32B2_AUTOREFRESH_MODE_CMD;
+	RegMode->RefreshRate = REFRESH_COUNT;
+	RegMode->BurstLength = Profile->BurstLength;
+	RegMode->BurstType = MT48LC4M32B2_BURST_TYPE_SEQUENTIAL;
+	RegMode->CASLatency = (Profile->CASLatency == FMC_SDRAM_CAS_LATENCY_2) ? MT48LC4M32B2_CAS_LATENCY_2
+									      : MT48LC4M32B2_CAS_LATENCY_3;
+	RegMode->OperationMode = MT48LC4M32B2_OPERATING_MODE_STANDARD;
+	RegMode->WriteBurstMode = Profile->WriteBurstMode;
+}
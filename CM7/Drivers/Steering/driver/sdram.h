@@ -8,10 +8,29 @@
 #define SDRAM_DEVICE_ADDR                  0xD0000000U
 #define SDRAM_DEVICE_SIZE                  0x200000U
 
+typedef enum
+{
+  SDRAM_PROFILE_CUBEMX = 0, /* CAS 3, FMC read burst, no read pipe delay (MX_FMC_Init) */
+  SDRAM_PROFILE_CL2,        /* CAS 2 */
+  SDRAM_PROFILE_CL2_RPIPE1, /* CAS 2, one HCLK of read pipe delay for more read margin */
+  SDRAM_PROFILE_NO_RBURST,  /* CubeMX without the FMC read burst, reference for the read FIFO */
+  SDRAM_PROFILE_COUNT
+} BSP_SDRAM_Profile_t;
+
+/* Profile programmed by BSP_SDRAM_Init() */
+#ifndef SDRAM_BOOT_PROFILE
+#define SDRAM_BOOT_PROFILE SDRAM_PROFILE_CUBEMX
+#endif
+
 extern SDRAM_HandleTypeDef hsdram1;
 
 int32_t BSP_SDRAM_Init();
+int32_t BSP_SDRAM_WarmInit();
+int32_t BSP_SDRAM_EnterSelfRefresh();
 int32_t BSP_SDRAM_DeInit();
 int32_t BSP_SDRAM_SendCmd(FMC_SDRAM_CommandTypeDef *SdramCmd);
+int32_t BSP_SDRAM_SetProfile(BSP_SDRAM_Profile_t Profile);
+BSP_SDRAM_Profile_t BSP_SDRAM_GetProfile();
+const char *BSP_SDRAM_GetProfileName(BSP_SDRAM_Profile_t Profile);
 
 #endif /*SDRAM_H */
@@ -304,6 +304,58 @@ int32_t BSP_TS_GetGestureId(uint32_t *GestureId)
 }
 #endif /* USE_TS_GESTURE == 1 */
 
+/**
+ * @brief  Configures the FT5336 to pulse its INT line on touch and gesture
+ *         events. The LCD_INT EXTI line itself is set up by MX_GPIO_Init().
+ * @retval BSP status
+ */
+int32_t BSP_TS_EnableIT()
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (FT5336_EnableIT() < 0)
+  {
+    ret = BSP_ERROR_COMPONENT_FAILURE;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Configures the FT5336 back to polling mode.
+ * @retval BSP status
+ */
+int32_t BSP_TS_DisableIT()
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (FT5336_DisableIT() < 0)
+  {
+    ret = BSP_ERROR_COMPONENT_FAILURE;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  TS interrupt handler, to be called from the LCD_INT EXTI callback.
+ * @retval None
+ */
+void BSP_TS_IRQHandler()
+{
+  BSP_TS_Callback();
+}
+
+/**
+ * @brief  TS interrupt callback. Runs in interrupt context, keep it short.
+ * @retval None
+ */
+__weak void BSP_TS_Callback()
+{
+  /* This function should be implemented by the user application.
+     It is called into this driver when an event on TS touch detection */
+}
+
 /**
  * @brief  Set TS orientation
  * @param  Orientation Orientation to be set
@@ -0,0 +1,87 @@
+#ifndef IPC_H
+#define IPC_H
+
+#include <stdint.h>
+
+#include "driver/errno.h"
+
+/* Inter-core rings, the second half of the D2 SRAM3 after the vehicle state
+ * snapshot (vstate.h). Non-cacheable on the CM7 in every memory profile, in
+ * an MPU region of its own (memattr.c), the CM4 has no data cache. */
+#define IPC_ADDR 0x30044000U
+#define IPC_SIZE 0x00004000U
+
+/* Doorbell of each channel: hardware semaphore IPC_HSEM_BASE + channel,
+ * released by the producer, notified to the consumer only */
+#define IPC_HSEM_BASE 2U
+
+/* Interrupt priority of the doorbells, below the CAN receive lines */
+#define IPC_IRQ_PRIO 8U
+
+/* Slots per ring, power of two. One slot is one message. */
+#ifndef IPC_SLOTS
+#define IPC_SLOTS 64U
+#endif
+
+/* Slot size, a multiple of the 32-byte Cortex-M7 cache line */
+#define IPC_SLOT_SIZE 64U
+#define IPC_PAYLOAD_MAX (IPC_SLOT_SIZE - 4U)
+
+typedef enum
+{
+  IPC_CH_M7_TO_M4 = 0,
+  IPC_CH_M4_TO_M7,
+  IPC_CH_NBR
+} IPC_Channel_t;
+
+/* Message types, the payload layout belongs to each type */
+typedef enum
+{
+  IPC_TYPE_PING = 1, /* Answered with IPC_TYPE_PONG and the same payload */
+  IPC_TYPE_PONG,
+  IPC_TYPE_SINK,     /* Counted and dropped */
+  IPC_TYPE_SOURCE,   /* uint32_t count: as many IPC_TYPE_SINK back, then IPC_TYPE_PONG */
+  IPC_TYPE_CAN_LOG,  /* IPC_CanLog_t, CM4 to CM7: a received frame of a logged message */
+} IPC_Type_t;
+
+/* Data bytes of IPC_CanLog_t, the longest DLC of the DBC */
+#define IPC_CAN_LOG_DATA_MAX 48U
+
+typedef struct
+{
+  uint32_t TimeMs; /* Start of frame, milliseconds of the BSP_CAN_GetTimeUs() timebase */
+  uint16_t Msg;    /* CAN_MSG_<NAME>_INDEX */
+  uint8_t Len;     /* Data bytes, the DLC of the message */
+  uint8_t Reserved;
+  uint8_t Data[IPC_CAN_LOG_DATA_MAX];
+} IPC_CanLog_t;
+
+_Static_assert(sizeof(IPC_CanLog_t) <= IPC_PAYLOAD_MAX, "logged frame larger than a message");
+
+typedef struct
+{
+  uint16_t Type;
+  uint16_t Len; /* Payload bytes */
+  uint8_t Data[IPC_PAYLOAD_MAX];
+} IPC_Msg_t;
+
+typedef struct
+{
+  uint32_t Sent;
+  uint32_t Full;      /* IPC_Send() on a full ring */
+  uint32_t Rung;      /* Doorbells rung by IPC_Send() */
+  uint32_t Received;
+  uint32_t Doorbells; /* Doorbell interrupts taken */
+} IPC_Stats_t;
+
+/* Called from the doorbell interrupt of the receive channel */
+typedef void (*IPC_Doorbell_t)(IPC_Channel_t Channel, void *Context);
+
+int32_t IPC_Init(void);
+int32_t IPC_SetDoorbell(IPC_Channel_t Channel, IPC_Doorbell_t Handler, void *Context);
+int32_t IPC_Send(IPC_Channel_t Channel, uint16_t Type, const void *pData, uint32_t Len);
+uint32_t IPC_Receive(IPC_Channel_t Channel, IPC_Msg_t *pMsg);
+const IPC_Stats_t *IPC_GetStats(void);
+void IPC_IRQHandler(void);
+
+#endif /* IPC_H */
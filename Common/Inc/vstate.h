@@ -0,0 +1,125 @@
+#ifndef VSTATE_H
+#define VSTATE_H
+
+#include <stdint.h>
+
+#include "can_msgs.h"
+
+/* Vehicle state snapshot, published by the CM4 (CAN, ADC, fan tachometers)
+ * for the CM7 user interface. It sits at the start of the D2 SRAM3, outside
+ * both linker scripts (MEMATTR_SHARED_BASE on the CM7); the other half of
+ * the SRAM3 holds the inter-core rings (ipc.h). */
+#define VSTATE_ADDR 0x30040000U
+#define VSTATE_SIZE 0x00004000U
+
+/* Cache line of the shared layout, 32 bytes on the Cortex-M7. The host
+ * stress build sets its own. */
+#ifndef VSTATE_LINE
+#define VSTATE_LINE 32U
+#endif
+
+/* Attempts of a reader before it keeps its previous copy */
+#ifndef VSTATE_RETRIES
+#define VSTATE_RETRIES 4U
+#endif
+
+/* Publication period on the CM4 */
+#ifndef VSTATE_PERIOD_MS
+#define VSTATE_PERIOD_MS 10U
+#endif
+
+#define VSTATE_BUS_NBR 2U
+#define VSTATE_MSG_WORDS ((CAN_MSGS_COUNT + 31U) / 32U)
+
+typedef enum
+{
+  VSTATE_SENSE_3V3 = 0,     /* ADC2 INP3, VOLTAGE_SENSE_3V3 */
+  VSTATE_SENSE_5V,          /* ADC2 INP4, VOLTAGE_SENS_5V */
+  VSTATE_SENSE_24V,         /* ADC2 INP5, VOLTAGE_SENSE_24V */
+  VSTATE_SENSE_NTC_1,       /* ADC3 INP10 */
+  VSTATE_SENSE_NTC_2,       /* ADC3 INP11 */
+  VSTATE_SENSE_MANETTINO_1, /* ADC1 INP0 */
+  VSTATE_SENSE_MANETTINO_2, /* ADC1 INP1 */
+  VSTATE_SENSE_NBR
+} VSTATE_Sense_t;
+
+typedef enum
+{
+  VSTATE_FAN_BP = 0, /* TIM1 CH1, TO_MCU_BP_SPEED */
+  VSTATE_FAN_RAD,    /* TIM2 CH1, TO_MCU_RAD_SPEED */
+  VSTATE_FAN_NBR
+} VSTATE_Fan_t;
+
+typedef struct
+{
+  uint32_t LoadPermille; /* Of the last statistics window */
+  uint32_t Rate;         /* Frames per second, both directions */
+  uint32_t Frames;
+  uint32_t Unknown;      /* Frames with an ID outside the DBC */
+  uint32_t BusOff;       /* Bus-off events */
+  uint32_t Errors;       /* Protocol errors */
+  uint8_t Tec;
+  uint8_t Rec;
+  uint8_t Passive;
+  uint8_t Off;           /* Bus-off now, recovering */
+} VSTATE_Bus_t;
+
+typedef struct
+{
+  uint32_t Rate;        /* Frames per second */
+  uint32_t Missed;      /* Deadlines missed */
+  uint32_t JitterMaxUs; /* Of the last statistics window */
+  uint32_t Timeouts;    /* Supervised messages only */
+} VSTATE_Msg_t;
+
+/* Routes from bus 1 to bus 2, summed */
+typedef struct
+{
+  uint32_t Forwarded;
+  uint32_t Sent;
+  uint32_t RateLimited;
+  uint32_t Dropped;
+  uint32_t LatencyAvgUs;
+  uint32_t LatencyMaxUs;
+} VSTATE_Gateway_t;
+
+/* Measured cost of the CAN statistics update, CM4 cycles per frame */
+typedef struct
+{
+  uint32_t AvgCycles;
+  uint32_t MaxCycles;
+  uint32_t BudgetCycles;
+  uint32_t OverBudget;
+} VSTATE_Cost_t;
+
+typedef struct
+{
+  uint32_t Seq;                           /* Publications, 0 before the first */
+  uint64_t TimeUs;                        /* Publication, BSP_CAN_GetTimeUs() system timebase */
+  uint32_t Received[VSTATE_MSG_WORDS];    /* Bit per message index, signals valid */
+  uint32_t Stale[VSTATE_MSG_WORDS];       /* Bit per message index, supervised and timed out */
+  CAN_MSGS_Any_t Signals[CAN_MSGS_COUNT]; /* Last decoded frame, CAN_MSG_<NAME>_t */
+  VSTATE_Msg_t Msgs[CAN_MSGS_COUNT];
+  VSTATE_Bus_t Buses[VSTATE_BUS_NBR];
+  VSTATE_Gateway_t Gateway;
+  VSTATE_Cost_t Cost;
+  uint16_t SenseMv[VSTATE_SENSE_NBR]; /* At the pin, before the board dividers */
+  int16_t NtcDeciC[2];                /* NTC_1, NTC_2, INT16_MIN if open or shorted */
+  uint32_t FanRpm[VSTATE_FAN_NBR];    /* 0 when the tachometer is silent */
+} VSTATE_t;
+
+void VSTATE_Init(void);
+void VSTATE_Publish(const VSTATE_t *pState);
+uint32_t VSTATE_Read(VSTATE_t *pState);
+uint32_t VSTATE_Refresh(void);
+const VSTATE_t *VSTATE_Get(void);
+
+/**
+ * @brief  Bit of message Msg in a Received or Stale mask.
+ */
+static inline uint32_t VSTATE_Test(const uint32_t *pMask, uint32_t Msg)
+{
+  return (pMask[Msg / 32U] >> (Msg % 32U)) & 1U;
+}
+
+#endif /* VSTATE_H */
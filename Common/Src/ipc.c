@@ -0,0 +1,276 @@
+#include "ipc.h"
+
+#include <string.h>
+
+#include "main.h"
+
+/*
+ * Inter-core messaging.
+ *
+ * One single-producer/single-consumer ring per direction in the SRAM3.
+ * Head is written by the producer only, Tail by the consumer only, each on
+ * its own cache line, and every message is one slot of whole cache lines:
+ * no lock, the only word both cores write is the Waiting flag below.
+ *
+ * The consumer never polls the shared memory. IPC_Receive() on an empty ring
+ * sets Waiting, then looks at Head once more for a message that raced with
+ * it. IPC_Send() publishes Head, then rings the doorbell if Waiting was set:
+ * a release of the channel's hardware semaphore, which raises the HSEM
+ * interrupt of the other core only. Both sides order the store before the
+ * load with a DMB, so a message is either seen by the second look or rings.
+ * A busy consumer takes no interrupts, an idle one takes one per burst.
+ *
+ * The CM7 clears both rings before the CM4 is released from its boot stop,
+ * each core then opens the ring it consumes; IPC_Send() waits for that
+ * (BSP_ERROR_NO_INIT).
+ */
+
+#define IPC_READY 0x49504331U
+#define IPC_LINE 32U
+
+#if defined(CORE_CM7)
+#define IPC_TX_CH IPC_CH_M7_TO_M4
+#define IPC_RX_CH IPC_CH_M4_TO_M7
+#define IPC_IRQn HSEM1_IRQn
+#else
+#define IPC_TX_CH IPC_CH_M4_TO_M7
+#define IPC_RX_CH IPC_CH_M7_TO_M4
+#define IPC_IRQn HSEM2_IRQn
+#endif
+
+#define IPC_HSEM_ID(Channel) (IPC_HSEM_BASE + (uint32_t)(Channel))
+
+typedef struct
+{
+  volatile uint32_t Head; /* Producer, free-running */
+  uint32_t Reserved0[(IPC_LINE / 4U) - 1U];
+  volatile uint32_t Tail;    /* Consumer, free-running */
+  volatile uint32_t Waiting; /* Set by the consumer on an empty ring, cleared by the doorbell */
+  volatile uint32_t Ready;   /* IPC_READY once the consumer opened the ring */
+  uint32_t Reserved1[(IPC_LINE / 4U) - 3U];
+  IPC_Msg_t Slots[IPC_SLOTS];
+} IPC_Ring_t;
+
+typedef struct
+{
+  IPC_Doorbell_t Handler;
+  void *Context;
+  IPC_Stats_t Stats;
+} IPC_Ctx_t;
+
+_Static_assert((IPC_SLOTS & (IPC_SLOTS - 1U)) == 0U, "IPC_SLOTS must be a power of two");
+_Static_assert(sizeof(IPC_Msg_t) == IPC_SLOT_SIZE, "message header and payload must fill one slot");
+_Static_assert((IPC_SLOT_SIZE % IPC_LINE) == 0U, "slots must be whole cache lines");
+_Static_assert(sizeof(IPC_Ring_t) * IPC_CH_NBR <= IPC_SIZE, "rings larger than their SRAM3 area");
+
+#define IPC_RINGS ((IPC_Ring_t *)IPC_ADDR)
+
+static IPC_Ctx_t IPC_Ctx;
+
+static void IPC_Ring(IPC_Channel_t Channel);
+
+/**
+ * @brief  Opens the receive ring of the calling core and enables its
+ *         doorbell interrupt. On the CM7, before the CM4 is released (boot
+ *         sequence, HSEM clock on), also clears both rings.
+ * @retval BSP status
+ */
+int32_t IPC_Init(void)
+{
+  IPC_Ring_t *rx = &IPC_RINGS[IPC_RX_CH];
+
+  memset(&IPC_Ctx, 0, sizeof(IPC_Ctx));
+  __HAL_RCC_D2SRAM3_CLK_ENABLE();
+
+#if defined(CORE_CM7)
+  memset(IPC_RINGS, 0, sizeof(IPC_Ring_t) * IPC_CH_NBR);
+  /* The MPU profile is not applied yet, the SRAM3 may still be cached */
+  SCB_CleanDCache_by_Addr((uint32_t *)IPC_ADDR, (int32_t)(sizeof(IPC_Ring_t) * IPC_CH_NBR));
+#endif
+
+  /* Idle consumer: the first message rings */
+  rx->Tail = rx->Head;
+  rx->Waiting = 1U;
+  __DMB();
+  rx->Ready = IPC_READY;
+#if defined(CORE_CM7)
+  SCB_CleanDCache_by_Addr((uint32_t *)&rx->Tail, (int32_t)IPC_LINE);
+#endif
+
+  __HAL_HSEM_CLEAR_FLAG(__HAL_HSEM_SEMID_TO_MASK(IPC_HSEM_ID(IPC_RX_CH)));
+  HAL_HSEM_ActivateNotification(__HAL_HSEM_SEMID_TO_MASK(IPC_HSEM_ID(IPC_RX_CH)));
+  HAL_NVIC_SetPriority(IPC_IRQn, IPC_IRQ_PRIO, 0);
+  HAL_NVIC_EnableIRQ(IPC_IRQn);
+
+  /* Return BSP status */
+  return BSP_ERROR_NONE;
+}
+
+/**
+ * @brief  Sets the function called from the doorbell interrupt.
+ * @param  Channel Receive channel of the calling core
+ * @param  Handler Interrupt context, NULL for none
+ * @param  Context Passed to Handler
+ * @retval BSP status
+ */
+int32_t IPC_SetDoorbell(IPC_Channel_t Channel, IPC_Doorbell_t Handler, void *Context)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (Channel != IPC_RX_CH)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    HAL_NVIC_DisableIRQ(IPC_IRQn);
+    IPC_Ctx.Handler = Handler;
+    IPC_Ctx.Context = Context;
+    HAL_NVIC_EnableIRQ(IPC_IRQn);
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Queues a message for the other core, ringing its doorbell if it
+ *         is waiting. Never blocks. One producer per channel: the main loop
+ *         or a single interrupt, not both.
+ * @param  Channel Transmit channel of the calling core
+ * @param  Type    IPC_Type_t or application type
+ * @param  pData   Payload, may be NULL when Len is 0
+ * @param  Len     Payload bytes, up to IPC_PAYLOAD_MAX
+ * @retval BSP status, BSP_ERROR_BUSY when the ring is full, BSP_ERROR_NO_INIT
+ *         until the other core called IPC_Init()
+ */
+int32_t IPC_Send(IPC_Channel_t Channel, uint16_t Type, const void *pData, uint32_t Len)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  IPC_Ring_t *ring = &IPC_RINGS[IPC_TX_CH];
+  IPC_Msg_t *slot;
+  uint32_t head;
+
+  if ((Channel != IPC_TX_CH) || (Len > IPC_PAYLOAD_MAX) || ((pData == NULL) && (Len != 0U)))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if (ring->Ready != IPC_READY)
+  {
+    ret = BSP_ERROR_NO_INIT;
+  }
+  else
+  {
+    head = ring->Head;
+    if ((head - ring->Tail) >= IPC_SLOTS)
+    {
+      IPC_Ctx.Stats.Full++;
+      ret = BSP_ERROR_BUSY;
+    }
+    else
+    {
+      slot = &ring->Slots[head & (IPC_SLOTS - 1U)];
+      slot->Type = Type;
+      slot->Len = (uint16_t)Len;
+      if (Len != 0U)
+      {
+        memcpy(slot->Data, pData, Len);
+      }
+      /* The slot before the head that publishes it */
+      __DMB();
+      ring->Head = head + 1U;
+      /* The head before Waiting, against the second look of IPC_Receive() */
+      __DMB();
+      if (ring->Waiting != 0U)
+      {
+        ring->Waiting = 0U;
+        IPC_Ring(Channel);
+      }
+      IPC_Ctx.Stats.Sent++;
+    }
+  }
+
+  /* Return BSP status */
+  return ret;
+}
+
+/**
+ * @brief  Takes the oldest message of the receive ring. An empty ring arms
+ *         the doorbell: the next IPC_Send() of the other core interrupts.
+ * @param  Channel Receive channel of the calling core
+ * @param  pMsg    Header and Len payload bytes are written
+ * @retval 1 if a message was taken, 0 if the ring is empty
+ */
+uint32_t IPC_Receive(IPC_Channel_t Channel, IPC_Msg_t *pMsg)
+{
+  IPC_Ring_t *ring = &IPC_RINGS[IPC_RX_CH];
+  const IPC_Msg_t *slot;
+  uint32_t tail, len;
+
+  if (Channel != IPC_RX_CH)
+  {
+    return 0U;
+  }
+
+  tail = ring->Tail;
+  if (ring->Head == tail)
+  {
+    /* Empty: arm the doorbell, then look again */
+    ring->Waiting = 1U;
+    __DMB();
+    if (ring->Head == tail)
+    {
+      return 0U;
+    }
+  }
+
+  /* The head before the slot it published */
+  __DMB();
+  slot = &ring->Slots[tail & (IPC_SLOTS - 1U)];
+  len = (slot->Len <= IPC_PAYLOAD_MAX) ? slot->Len : IPC_PAYLOAD_MAX;
+  pMsg->Type = slot->Type;
+  pMsg->Len = (uint16_t)len;
+  memcpy(pMsg->Data, slot->Data, len);
+  /* The slot is read before it is given back */
+  __DMB();
+  ring->Tail = tail + 1U;
+  IPC_Ctx.Stats.Received++;
+  return 1U;
+}
+
+const IPC_Stats_t *IPC_GetStats(void)
+{
+  return &IPC_Ctx.Stats;
+}
+
+/**
+ * @brief  Doorbell interrupt, from HSEM1_IRQHandler() on the CM7 and
+ *         HSEM2_IRQHandler() on the CM4. The notification stays enabled,
+ *         unlike HAL_HSEM_IRQHandler().
+ */
+void IPC_IRQHandler(void)
+{
+  uint32_t mask = __HAL_HSEM_SEMID_TO_MASK(IPC_HSEM_ID(IPC_RX_CH));
+
+  /* Raw flag, the only one enabled here: __HAL_HSEM_GET_IT() of this HAL
+   * release names a C2MISR1 register that does not exist */
+  if (__HAL_HSEM_GET_FLAG(mask) != 0U)
+  {
+    __HAL_HSEM_CLEAR_FLAG(mask);
+    IPC_Ctx.Stats.Doorbells++;
+    if (IPC_Ctx.Handler != NULL)
+    {
+      IPC_Ctx.Handler(IPC_RX_CH, IPC_Ctx.Context);
+    }
+  }
+}
+
+/* Take and release: the release raises the free interrupt on the consumer */
+static void IPC_Ring(IPC_Channel_t Channel)
+{
+  if (HAL_HSEM_FastTake(IPC_HSEM_ID(Channel)) == HAL_OK)
+  {
+    HAL_HSEM_Release(IPC_HSEM_ID(Channel), 0U);
+    IPC_Ctx.Stats.Rung++;
+  }
+}
@@ -0,0 +1,217 @@
+#include "vstate.h"
+
+#include <string.h>
+
+/*
+ * Vehicle state snapshot shared by the two cores.
+ *
+ * Two slots, each under a sequence lock. The writer fills the slot the
+ * readers are not directed to: it makes the slot's Seq odd, copies the whole
+ * state, makes Seq even again, then points Latest at it. A reader takes
+ * Latest, copies that slot between two reads of its Seq and keeps the copy
+ * if both were the same even value and Latest still points at that slot. The
+ * last check keeps the copies of a reader in order: a slot can be complete
+ * again, two publications later, while Latest still names the other one, and
+ * handing it out would let the next read go back to that other slot. The
+ * writer never waits for a reader and a reader never stops the writer; a
+ * reader only retries when the writer came back to its slot during the copy,
+ * and gives up after VSTATE_RETRIES keeping its previous copy.
+ *
+ * Every field written by the writer at its own pace (Latest, each Seq, each
+ * state) starts a cache line. The SRAM3 is non-cacheable on the CM7 in the
+ * default memory profiles and write-back in MEMATTR_PROFILE_CUBEMX, so the
+ * reader invalidates what it is about to read; the CM4 has no data cache.
+ *
+ * With VSTATE_HOST the same code runs on the host against a static area,
+ * threads in place of the cores (tools/vstate).
+ */
+
+#if defined(VSTATE_HOST)
+#define VSTATE_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#include "main.h"
+#define VSTATE_BARRIER() __DMB()
+#endif
+
+/* VSTATE_Shared_t.Magic once the publisher cleared the area, the SRAM3
+ * holds noise after a power-up */
+#define VSTATE_MAGIC 0x56535432U
+
+typedef struct
+{
+  volatile uint32_t Seq; /* Odd while the writer is in the slot */
+  VSTATE_t State __attribute__((aligned(VSTATE_LINE)));
+} __attribute__((aligned(VSTATE_LINE))) VSTATE_Slot_t;
+
+typedef struct
+{
+  volatile uint32_t Magic;
+  volatile uint32_t Latest; /* Slot of the last complete publication */
+  VSTATE_Slot_t Slots[2];
+} VSTATE_Shared_t;
+
+_Static_assert(sizeof(VSTATE_Shared_t) <= VSTATE_SIZE, "snapshot slots larger than their SRAM3 area");
+
+#if defined(VSTATE_HOST)
+static VSTATE_Shared_t VSTATE_HostShared;
+#define VSTATE_SHARED (&VSTATE_HostShared)
+#else
+#define VSTATE_SHARED ((VSTATE_Shared_t *)VSTATE_ADDR)
+#endif
+
+static uint32_t VSTATE_Seq; /* Publisher */
+
+static VSTATE_t VSTATE_Copies[2]; /* Reader, the one in use and the next */
+static uint32_t VSTATE_Current;
+
+static void VSTATE_Invalidate(const volatile void *Addr, uint32_t Size);
+static uint32_t VSTATE_Peek(void);
+
+/**
+ * @brief  Enables the SRAM3 clock of the calling core, after the boot
+ *         handshake (HSEM clock on). The publisher, the CM4 or the host,
+ *         also marks both slots as being written: no reader takes one
+ *         before the first publication.
+ */
+void VSTATE_Init(void)
+{
+#if !defined(VSTATE_HOST)
+  __HAL_RCC_D2SRAM3_CLK_ENABLE();
+#endif
+
+#if !defined(CORE_CM7)
+  VSTATE_Seq = 0U;
+  VSTATE_SHARED->Magic = 0U;
+  VSTATE_BARRIER();
+  VSTATE_SHARED->Slots[0].Seq = 1U;
+  VSTATE_SHARED->Slots[1].Seq = 1U;
+  VSTATE_SHARED->Latest = 0U;
+  VSTATE_BARRIER();
+  VSTATE_SHARED->Magic = VSTATE_MAGIC;
+#endif
+}
+
+/**
+ * @brief  Publishes a new snapshot, CM4 main loop. Never waits. A single
+ *         calling context.
+ * @param  pState Complete state, Seq is filled in
+ */
+void VSTATE_Publish(const VSTATE_t *pState)
+{
+  VSTATE_Shared_t *shared = VSTATE_SHARED;
+  uint32_t next = shared->Latest ^ 1U;
+  VSTATE_Slot_t *slot = &shared->Slots[next];
+  uint32_t seq = slot->Seq | 1U;
+
+  VSTATE_Seq = (VSTATE_Seq == UINT32_MAX) ? 1U : (VSTATE_Seq + 1U);
+
+  slot->Seq = seq;
+  /* Odd before the first byte of the state changes */
+  VSTATE_BARRIER();
+  memcpy(&slot->State, pState, sizeof(VSTATE_t));
+  slot->State.Seq = VSTATE_Seq;
+  /* The whole state before Seq is even again */
+  VSTATE_BARRIER();
+  slot->Seq = seq + 1U;
+  /* A complete slot before the readers are sent to it */
+  VSTATE_BARRIER();
+  shared->Latest = next;
+}
+
+/**
+ * @brief  Copies the last complete snapshot, consistent as a whole. Any
+ *         number of readers, none of them blocks the writer.
+ * @param  pState Written in any case, valid only if the return is not 0
+ * @retval Attempts taken, 1 to VSTATE_RETRIES; 0 if nothing was published
+ *         yet or the writer lapped every attempt
+ */
+uint32_t VSTATE_Read(VSTATE_t *pState)
+{
+  const VSTATE_Shared_t *shared = VSTATE_SHARED;
+  const VSTATE_Slot_t *slot;
+  uint32_t attempt, latest, seq, done = 0U;
+
+  VSTATE_Invalidate(shared, VSTATE_LINE);
+  for (attempt = 1U; (attempt <= VSTATE_RETRIES) && (done == 0U) && (shared->Magic == VSTATE_MAGIC); attempt++)
+  {
+    latest = shared->Latest & 1U;
+    slot = &shared->Slots[latest];
+    /* Latest before the slot it points to */
+    VSTATE_BARRIER();
+    VSTATE_Invalidate(slot, sizeof(VSTATE_Slot_t));
+    seq = slot->Seq;
+    if ((seq & 1U) == 0U)
+    {
+      VSTATE_BARRIER();
+      memcpy(pState, (const void *)&slot->State, sizeof(VSTATE_t));
+      /* The copy before the second look at Seq */
+      VSTATE_BARRIER();
+      VSTATE_Invalidate(&slot->Seq, VSTATE_LINE);
+      if (slot->Seq == seq)
+      {
+        /* Seq before the second look at Latest: the slot is still the last
+         * publication, not a newer one the readers are not sent to yet */
+        VSTATE_BARRIER();
+        VSTATE_Invalidate(shared, VSTATE_LINE);
+        done = ((shared->Latest & 1U) == latest) ? attempt : 0U;
+      }
+    }
+    VSTATE_Invalidate(shared, VSTATE_LINE);
+  }
+  return done;
+}
+
+/**
+ * @brief  Takes a copy of the shared snapshot if a new one was published,
+ *         CM7 main loop. Never waits, a torn copy is never handed out.
+ * @retval 1 if VSTATE_Get() changed, 0 if nothing new or the copy failed
+ */
+uint32_t VSTATE_Refresh(void)
+{
+  uint32_t fresh = 0U;
+
+  if ((VSTATE_Peek() != VSTATE_Copies[VSTATE_Current].Seq) && (VSTATE_Read(&VSTATE_Copies[VSTATE_Current ^ 1U]) != 0U))
+  {
+    VSTATE_Current ^= 1U;
+    fresh = 1U;
+  }
+  return fresh;
+}
+
+/**
+ * @brief  Last snapshot taken by VSTATE_Refresh(), all zero (Seq 0) until
+ *         the first one.
+ */
+const VSTATE_t *VSTATE_Get(void)
+{
+  return &VSTATE_Copies[VSTATE_Current];
+}
+
+/* Publication count of the latest slot, a hint that skips the copy when
+ * nothing changed; 0 before the first publication */
+static uint32_t VSTATE_Peek(void)
+{
+  const VSTATE_Shared_t *shared = VSTATE_SHARED;
+  const VSTATE_Slot_t *slot;
+  uint32_t seq = 0U;
+
+  VSTATE_Invalidate(shared, VSTATE_LINE);
+  if (shared->Magic == VSTATE_MAGIC)
+  {
+    slot = &shared->Slots[shared->Latest & 1U];
+    VSTATE_BARRIER();
+    VSTATE_Invalidate(&slot->State, VSTATE_LINE);
+    seq = *(const volatile uint32_t *)&slot->State.Seq;
+  }
+  return seq;
+}
+
+static void VSTATE_Invalidate(const volatile void *Addr, uint32_t Size)
+{
+#if defined(CORE_CM7)
+  SCB_InvalidateDCache_by_Addr((void *)Addr, (int32_t)Size);
+#else
+  (void)Addr;
+  (void)Size;
+#endif
+}
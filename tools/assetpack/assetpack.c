@@ -0,0 +1,298 @@
+/*
+ * Builds the asset pack read by sw/asset.c.
+ *
+ *   assetpack [--raw] OUT.bin SPEC...
+ *
+ * SPEC is one of
+ *   image:NAME:WxH:FILE  raw ARGB8888 pixels, B G R A byte order (LVGL),
+ *                        e.g. from `convert bg.png -depth 8 BGRA:bg.raw`
+ *   rawimage:NAME:WxH:FILE
+ *                        same, always stored raw so that it can be read in
+ *                        place from the mapped flash (the boot splash)
+ *   font:NAME:FILE       LVGL binary font
+ *   blob:NAME:FILE       anything else
+ *
+ * Every asset is cut in ASSET_BLOCK_SIZE blocks compressed independently
+ * with LZ4, a block that does not shrink is stored. An asset that does not
+ * shrink at all, a rawimage, or every asset with --raw, is stored raw. Each asset is
+ * decoded back with the firmware decoder before the pack is written, and
+ * the compression ratios are printed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lz4_compress.h"
+#include "sw/asset.h"
+#include "sw/lz4.h"
+
+#define PACK_ALIGN 4U
+
+typedef struct
+{
+  ASSET_Entry_t Entry;
+  uint8_t *Data; /* Packed bytes */
+  int Raw;       /* Never compressed */
+} Asset_t;
+
+static uint8_t *read_file(const char *Path, uint32_t *Size)
+{
+  FILE *f = fopen(Path, "rb");
+  uint8_t *data = NULL;
+  long len;
+
+  if (f == NULL)
+  {
+    return NULL;
+  }
+  if (fseek(f, 0, SEEK_END) == 0 && (len = ftell(f)) > 0 && fseek(f, 0, SEEK_SET) == 0)
+  {
+    data = malloc((size_t)len);
+    if (data != NULL && fread(data, 1, (size_t)len, f) != (size_t)len)
+    {
+      free(data);
+      data = NULL;
+    }
+    *Size = (uint32_t)len;
+  }
+  fclose(f);
+  return data;
+}
+
+static int parse_spec(char *Spec, Asset_t *Asset, const char **Path)
+{
+  char *type = strtok(Spec, ":");
+  char *name = strtok(NULL, ":");
+  char *field = strtok(NULL, ":");
+  char *path = strtok(NULL, "");
+  unsigned w, h;
+
+  memset(Asset, 0, sizeof(*Asset));
+  if (type == NULL || name == NULL || field == NULL || strlen(name) >= ASSET_NAME_MAX)
+  {
+    return -1;
+  }
+  strcpy(Asset->Entry.Name, name);
+
+  if (strcmp(type, "image") == 0 || strcmp(type, "rawimage") == 0)
+  {
+    if (path == NULL || sscanf(field, "%ux%u", &w, &h) != 2 || w > 0xFFFFU || h > 0xFFFFU)
+    {
+      return -1;
+    }
+    Asset->Entry.Type = ASSET_TYPE_IMAGE;
+    Asset->Entry.Width = (uint16_t)w;
+    Asset->Entry.Height = (uint16_t)h;
+    Asset->Raw = (type[0] == 'r');
+    *Path = path;
+  }
+  else if (strcmp(type, "font") == 0 || strcmp(type, "blob") == 0)
+  {
+    if (path != NULL)
+    {
+      return -1;
+    }
+    Asset->Entry.Type = (type[0] == 'f') ? ASSET_TYPE_FONT : ASSET_TYPE_BLOB;
+    *Path = field;
+  }
+  else
+  {
+    return -1;
+  }
+  return 0;
+}
+
+/* Block table followed by the blocks, see ASSET_CODEC_LZ4 */
+static uint8_t *compress(const uint8_t *Raw, uint32_t RawSize, uint32_t *PackedSize)
+{
+  uint32_t blocks = (RawSize + ASSET_BLOCK_SIZE - 1U) / ASSET_BLOCK_SIZE;
+  uint8_t *out = malloc(blocks * sizeof(uint32_t) + blocks * ASSET_BLOCK_SIZE);
+  uint8_t *op = out + blocks * sizeof(uint32_t);
+  uint32_t i, raw, size;
+
+  if (out == NULL)
+  {
+    return NULL;
+  }
+
+  for (i = 0; i < blocks; i++)
+  {
+    raw = RawSize - i * ASSET_BLOCK_SIZE;
+    if (raw > ASSET_BLOCK_SIZE)
+    {
+      raw = ASSET_BLOCK_SIZE;
+    }
+
+    /* Anything not smaller than the raw block is stored */
+    size = (uint32_t)LZ4_CompressBlock(Raw + i * ASSET_BLOCK_SIZE, raw, op, raw - 1U);
+    if (size == 0U)
+    {
+      memcpy(op, Raw + i * ASSET_BLOCK_SIZE, raw);
+      size = raw | ASSET_BLOCK_STORED;
+    }
+    memcpy(out + i * sizeof(uint32_t), &size, sizeof(size));
+    op += size & ~ASSET_BLOCK_STORED;
+  }
+
+  *PackedSize = (uint32_t)(op - out);
+  return out;
+}
+
+/* Decodes the packed asset the way the firmware does and compares */
+static int verify(const Asset_t *Asset, const uint8_t *Raw)
+{
+  uint32_t blocks = (Asset->Entry.RawSize + ASSET_BLOCK_SIZE - 1U) / ASSET_BLOCK_SIZE;
+  const uint8_t *ip = Asset->Data + blocks * sizeof(uint32_t);
+  uint8_t out[ASSET_BLOCK_SIZE];
+  uint32_t i, raw, size;
+  int32_t n;
+
+  if (Asset->Entry.Codec == ASSET_CODEC_RAW)
+  {
+    return memcmp(Asset->Data, Raw, Asset->Entry.RawSize) == 0 ? 0 : -1;
+  }
+
+  for (i = 0; i < blocks; i++)
+  {
+    raw = Asset->Entry.RawSize - i * ASSET_BLOCK_SIZE;
+    if (raw > ASSET_BLOCK_SIZE)
+    {
+      raw = ASSET_BLOCK_SIZE;
+    }
+    memcpy(&size, Asset->Data + i * sizeof(uint32_t), sizeof(size));
+
+    if ((size & ASSET_BLOCK_STORED) != 0U)
+    {
+      size &= ~ASSET_BLOCK_STORED;
+      memcpy(out, ip, size);
+      n = (int32_t)size;
+    }
+    else
+    {
+      n = LZ4_DecompressBlock(ip, size, out, raw);
+    }
+    if (n != (int32_t)raw || memcmp(out, Raw + i * ASSET_BLOCK_SIZE, raw) != 0)
+    {
+      return -1;
+    }
+    ip += size;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  ASSET_PackHeader_t header = {ASSET_MAGIC, ASSET_VERSION, 0, 0, 0};
+  static const uint8_t pad[PACK_ALIGN] = {0};
+  uint64_t total_raw = 0, total_packed = 0;
+  uint32_t offset, raw_size;
+  int store_raw = 0, argi = 1, i, count;
+  const char *path, *out_path;
+  uint8_t *raw;
+  Asset_t *assets;
+  FILE *out;
+
+  if (argc > argi && strcmp(argv[argi], "--raw") == 0)
+  {
+    store_raw = 1;
+    argi++;
+  }
+  if (argc - argi < 2)
+  {
+    fprintf(stderr, "usage: %s [--raw] OUT.bin image:NAME:WxH:FILE|rawimage:NAME:WxH:FILE|font:NAME:FILE|blob:NAME:FILE...\n", argv[0]);
+    return 2;
+  }
+  out_path = argv[argi++];
+  count = argc - argi;
+  if (count > (int)ASSET_MAX_ENTRIES)
+  {
+    fprintf(stderr, "at most %u assets\n", ASSET_MAX_ENTRIES);
+    return 2;
+  }
+
+  assets = calloc((size_t)count, sizeof(*assets));
+  offset = sizeof(header) + (uint32_t)count * sizeof(ASSET_Entry_t);
+
+  printf("%-24s %10s %10s %6s\n", "asset", "raw", "packed", "ratio");
+  for (i = 0; i < count; i++)
+  {
+    Asset_t *a = &assets[i];
+
+    if (parse_spec(argv[argi + i], a, &path) != 0)
+    {
+      fprintf(stderr, "bad asset spec: %s\n", argv[argi + i]);
+      return 2;
+    }
+    raw = read_file(path, &raw_size);
+    if (raw == NULL)
+    {
+      fprintf(stderr, "%s: cannot read\n", path);
+      return 1;
+    }
+    if (a->Entry.Type == ASSET_TYPE_IMAGE && raw_size != (uint32_t)a->Entry.Width * a->Entry.Height * 4U)
+    {
+      fprintf(stderr, "%s: %u bytes, expected %ux%u ARGB8888\n", path, raw_size, a->Entry.Width, a->Entry.Height);
+      return 1;
+    }
+    if (raw_size > ASSET_MAX_BLOCKS * ASSET_BLOCK_SIZE)
+    {
+      fprintf(stderr, "%s: larger than %u bytes\n", path, ASSET_MAX_BLOCKS * ASSET_BLOCK_SIZE);
+      return 1;
+    }
+
+    a->Entry.RawSize = raw_size;
+    a->Entry.Codec = ASSET_CODEC_LZ4;
+    a->Data = (store_raw || a->Raw) ? NULL : compress(raw, raw_size, &a->Entry.PackedSize);
+    if (a->Data == NULL || a->Entry.PackedSize >= raw_size)
+    {
+      free(a->Data);
+      a->Data = raw;
+      a->Entry.Codec = ASSET_CODEC_RAW;
+      a->Entry.PackedSize = raw_size;
+      raw = NULL;
+    }
+    if (verify(a, (raw != NULL) ? raw : a->Data) != 0)
+    {
+      fprintf(stderr, "%s: round trip failed\n", a->Entry.Name);
+      return 1;
+    }
+    free(raw);
+
+    a->Entry.Offset = offset;
+    offset = (offset + a->Entry.PackedSize + PACK_ALIGN - 1U) & ~(PACK_ALIGN - 1U);
+    total_raw += a->Entry.RawSize;
+    total_packed += a->Entry.PackedSize;
+    printf("%-24s %10u %10u %5.1f%%%s\n", a->Entry.Name, a->Entry.RawSize, a->Entry.PackedSize,
+           100.0 * a->Entry.PackedSize / a->Entry.RawSize, (a->Entry.Codec == ASSET_CODEC_RAW) ? " raw" : "");
+  }
+  printf("%-24s %10llu %10llu %5.1f%%\n", "total", (unsigned long long)total_raw, (unsigned long long)total_packed,
+         (total_raw != 0U) ? 100.0 * (double)total_packed / (double)total_raw : 0.0);
+
+  header.Count = (uint16_t)count;
+  header.Size = offset;
+
+  out = fopen(out_path, "wb");
+  if (out == NULL)
+  {
+    fprintf(stderr, "%s: cannot create\n", out_path);
+    return 1;
+  }
+  fwrite(&header, sizeof(header), 1, out);
+  for (i = 0; i < count; i++)
+  {
+    fwrite(&assets[i].Entry, sizeof(ASSET_Entry_t), 1, out);
+  }
+  for (i = 0; i < count; i++)
+  {
+    fwrite(assets[i].Data, 1, assets[i].Entry.PackedSize, out);
+    fwrite(pad, 1, (PACK_ALIGN - assets[i].Entry.PackedSize % PACK_ALIGN) % PACK_ALIGN, out);
+  }
+  if (fclose(out) != 0)
+  {
+    fprintf(stderr, "%s: write failed\n", out_path);
+    return 1;
+  }
+  printf("%s: %u bytes, %d assets\n", out_path, header.Size, count);
+  return 0;
+}
@@ -0,0 +1,142 @@
+#include "lz4_compress.h"
+
+#include <string.h>
+
+/*
+ * Greedy LZ4 block compressor: one hash table of the last position of every
+ * 4-byte sequence, matches are extended backwards over pending literals and
+ * forwards as far as they go. The output follows the block format end rules
+ * (last 5 bytes are literals, no match starts in the last 12 bytes) so any
+ * LZ4 decoder accepts it, not only sw/lz4.c.
+ */
+
+#define HASH_LOG 14
+#define MIN_MATCH 4U
+#define LAST_LITERALS 5U
+#define MF_LIMIT 12U
+#define MAX_OFFSET 65535U
+
+static uint32_t read32(const uint8_t *p)
+{
+  uint32_t v;
+
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static uint32_t hash4(uint32_t v)
+{
+  return (v * 2654435761U) >> (32 - HASH_LOG);
+}
+
+static uint8_t *put_length(uint8_t *op, uint8_t *op_end, size_t length)
+{
+  for (; length >= 255U; length -= 255U)
+  {
+    if (op >= op_end)
+    {
+      return NULL;
+    }
+    *op++ = 255U;
+  }
+  if (op >= op_end)
+  {
+    return NULL;
+  }
+  *op++ = (uint8_t)length;
+  return op;
+}
+
+/* Token, literals and, unless Match is 0, the match offset and length */
+static uint8_t *put_sequence(uint8_t *op, uint8_t *op_end, const uint8_t *literals, size_t lit_len, size_t offset,
+                             size_t match_len)
+{
+  uint8_t *token = op++;
+  size_t ml = (match_len != 0U) ? match_len - MIN_MATCH : 0U;
+
+  if (op > op_end)
+  {
+    return NULL;
+  }
+  *token = (uint8_t)(((lit_len < 15U) ? lit_len : 15U) << 4);
+  if (lit_len >= 15U && (op = put_length(op, op_end, lit_len - 15U)) == NULL)
+  {
+    return NULL;
+  }
+  if ((size_t)(op_end - op) < lit_len)
+  {
+    return NULL;
+  }
+  memcpy(op, literals, lit_len);
+  op += lit_len;
+
+  if (match_len != 0U)
+  {
+    if (op_end - op < 2)
+    {
+      return NULL;
+    }
+    *op++ = (uint8_t)offset;
+    *op++ = (uint8_t)(offset >> 8);
+    *token |= (uint8_t)((ml < 15U) ? ml : 15U);
+    if (ml >= 15U && (op = put_length(op, op_end, ml - 15U)) == NULL)
+    {
+      return NULL;
+    }
+  }
+  return op;
+}
+
+/**
+ * Compresses SrcSize bytes into one LZ4 block.
+ * Returns the block size, 0 if it does not fit in DstCapacity.
+ */
+size_t LZ4_CompressBlock(const uint8_t *pSrc, size_t SrcSize, uint8_t *pDst, size_t DstCapacity)
+{
+  static int32_t table[1 << HASH_LOG];
+  const uint8_t *ip = pSrc, *anchor = pSrc, *end = pSrc + SrcSize;
+  const uint8_t *mf_limit = (SrcSize > MF_LIMIT) ? end - MF_LIMIT : pSrc;
+  const uint8_t *match_limit = end - LAST_LITERALS;
+  uint8_t *op = pDst, *op_end = pDst + DstCapacity;
+  const uint8_t *ref;
+  uint32_t v, h;
+  size_t len;
+
+  memset(table, 0xFF, sizeof(table));
+
+  while (ip < mf_limit)
+  {
+    v = read32(ip);
+    h = hash4(v);
+    ref = (table[h] >= 0) ? pSrc + table[h] : NULL;
+    table[h] = (int32_t)(ip - pSrc);
+
+    if (ref == NULL || (size_t)(ip - ref) > MAX_OFFSET || read32(ref) != v)
+    {
+      ip++;
+      continue;
+    }
+
+    while (ip > anchor && ref > pSrc && ip[-1] == ref[-1])
+    {
+      ip--;
+      ref--;
+    }
+    len = MIN_MATCH;
+    while (ip + len < match_limit && ip[len] == ref[len])
+    {
+      len++;
+    }
+
+    op = put_sequence(op, op_end, anchor, (size_t)(ip - anchor), (size_t)(ip - ref), len);
+    if (op == NULL)
+    {
+      return 0U;
+    }
+    ip += len;
+    anchor = ip;
+  }
+
+  op = put_sequence(op, op_end, anchor, (size_t)(end - anchor), 0U, 0U);
+  return (op == NULL) ? 0U : (size_t)(op - pDst);
+}
@@ -0,0 +1,9 @@
+#ifndef LZ4_COMPRESS_H
+#define LZ4_COMPRESS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+size_t LZ4_CompressBlock(const uint8_t *pSrc, size_t SrcSize, uint8_t *pDst, size_t DstCapacity);
+
+#endif /* LZ4_COMPRESS_H */
@@ -0,0 +1,88 @@
+/*
+ * Bus load of the DBC traffic, classic CAN against CAN FD.
+ *
+ *   can_busload
+ *
+ * Every periodic message of CAN_MSGS_Table (GenMsgCycleTime) is counted on
+ * its DashBus with the worst-case frame length of sw/can_load.c, for each
+ * bus setup below. In classic mode a message longer than 8 bytes has to be
+ * split: one multiplexor byte and 7 payload bytes per frame. Event driven
+ * messages (no cycle time) are left out. In the FD setups every message,
+ * short ones included, is sent as an FD frame.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "can_msgs.h"
+#include "sw/can_load.h"
+
+#define BUSLOAD_NOMINAL 1000000U
+#define BUSLOAD_SPLIT_PAYLOAD 7U
+
+typedef struct
+{
+  const char *Name;
+  uint32_t Fd;
+  uint32_t DataBitrate;
+} Setup_t;
+
+static const Setup_t Setups[] = {
+    {"classic 1M", 0U, BUSLOAD_NOMINAL}, {"FD 1M", 1U, BUSLOAD_NOMINAL},  {"FD+BRS 1M/2M", 1U, 2000000U},
+    {"FD+BRS 1M/4M", 1U, 4000000U},      {"FD+BRS 1M/5M", 1U, 5000000U}, {"FD+BRS 1M/8M", 1U, 8000000U},
+};
+
+/* Frames per cycle and duration of each, for one message in one setup */
+static uint32_t busload_frames(const CAN_MSGS_Desc_t *pDesc, const Setup_t *pSetup, uint32_t *pNs)
+{
+  uint32_t frames = 1U, len = pDesc->Dlc;
+
+  if ((pSetup->Fd == 0U) && (len > 8U))
+  {
+    frames = (len + BUSLOAD_SPLIT_PAYLOAD - 1U) / BUSLOAD_SPLIT_PAYLOAD;
+    len = 8U;
+  }
+  *pNs = CAN_LOAD_FrameNs(len, pDesc->Extended, pSetup->Fd, BUSLOAD_NOMINAL, pSetup->DataBitrate);
+  return frames;
+}
+
+int main(void)
+{
+  const CAN_MSGS_Desc_t *desc;
+  uint32_t bus, s, i, msgs, fd, frames, ns;
+  double per_s, load;
+
+  for (bus = 1U; bus <= 2U; bus++)
+  {
+    msgs = fd = 0U;
+    for (i = 0; i < CAN_MSGS_COUNT; i++)
+    {
+      desc = &CAN_MSGS_Table[i];
+      if ((desc->Bus == bus) && (desc->CycleMs != 0U))
+      {
+        msgs++;
+        fd += (desc->Dlc > 8U) ? 1U : 0U;
+      }
+    }
+    printf("bus %" PRIu32 ": %" PRIu32 " periodic messages, %" PRIu32 " longer than 8 bytes\n", bus, msgs, fd);
+    printf("  %-14s %10s %8s\n", "setup", "frames/s", "load %");
+
+    for (s = 0; s < sizeof(Setups) / sizeof(Setups[0]); s++)
+    {
+      per_s = load = 0.0;
+      for (i = 0; i < CAN_MSGS_COUNT; i++)
+      {
+        desc = &CAN_MSGS_Table[i];
+        if ((desc->Bus != bus) || (desc->CycleMs == 0U))
+        {
+          continue;
+        }
+        frames = busload_frames(desc, &Setups[s], &ns);
+        per_s += frames * 1000.0 / desc->CycleMs;
+        load += frames * (double)ns / (desc->CycleMs * 1e6);
+      }
+      printf("  %-14s %10.0f %8.1f\n", Setups[s].Name, per_s, load * 100.0);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,444 @@
+/*
+ * Host check and decode benchmark of the generated CAN codecs.
+ *
+ *   dbc_bench [frames] [rounds]
+ *
+ * 1. consistency: random payloads of every message are decoded by the
+ *    generated Unpack and by a generic decoder walking CAN_MSGS_Signals bit
+ *    by bit, every field must match; Pack must give back the payload bits
+ *    covered by signals
+ * 2. lookup: CAN_MSGS_Lookup() against a linear search of CAN_MSGS_Table
+ *    on every standard ID and on random and known extended IDs
+ * 3. throughput: a random stream of <frames> frames decoded <rounds> times
+ *    by both decoders
+ * 4. dispatch: ID lookup per ID class (standard/extended, known/unknown),
+ *    linear search, and lookup + decode + handler call per frame. Every
+ *    lookup class should cost the same whatever the size of the DBC.
+ *
+ * Exits with 1 if a check fails.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "can_msgs.h"
+
+#define BENCH_CHECKS 20000U
+#define BENCH_EXT_CHECKS (1U << 20)
+#define BENCH_DATA_MAX 64U
+
+typedef struct
+{
+  uint16_t Msg;
+  uint8_t Data[BENCH_DATA_MAX];
+} Frame_t;
+
+typedef struct
+{
+  uint32_t Id;
+  uint32_t Extended;
+} RxId_t;
+
+static uint64_t Rng = 0x9E3779B97F4A7C15ULL;
+static volatile uint32_t Sink;
+
+static uint64_t bench_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t bench_rand(void)
+{
+  Rng ^= Rng << 13;
+  Rng ^= Rng >> 7;
+  Rng ^= Rng << 17;
+  return Rng;
+}
+
+static void bench_payload(uint8_t *pData)
+{
+  uint32_t i;
+
+  for (i = 0; i < BENCH_DATA_MAX; i++)
+  {
+    pData[i] = (uint8_t)bench_rand();
+  }
+}
+
+/* Position of the k-th bit (LSB first) of a signal, DBC numbering */
+static uint32_t bench_bit(const CAN_MSGS_Signal_t *pSig, uint32_t k)
+{
+  uint32_t p = pSig->Start, i;
+
+  if (!pSig->Motorola)
+  {
+    return p + k;
+  }
+  /* Walk down from the MSB */
+  for (i = pSig->Length - 1U; i > k; i--)
+  {
+    p = ((p % 8U) == 0U) ? p + 15U : p - 1U;
+  }
+  return p;
+}
+
+/* What the dash would do without generated code */
+static int64_t bench_generic_signal(const CAN_MSGS_Signal_t *pSig, const uint8_t *pData)
+{
+  uint64_t raw = 0U;
+  int64_t value;
+  uint32_t k, p;
+
+  for (k = 0; k < pSig->Length; k++)
+  {
+    p = bench_bit(pSig, k);
+    raw |= (uint64_t)((pData[p / 8U] >> (p % 8U)) & 1U) << k;
+  }
+  if (pSig->Signed && pSig->Length < 64U && ((raw >> (pSig->Length - 1U)) & 1U) != 0U)
+  {
+    raw |= ~0ULL << pSig->Length;
+  }
+  value = (int64_t)raw;
+  return value * pSig->Mul + pSig->Off;
+}
+
+static void bench_store(void *pMsg, const CAN_MSGS_Signal_t *pSig, int64_t Value)
+{
+  uint8_t *field = (uint8_t *)pMsg + pSig->FieldOffset;
+  uint8_t u8 = (uint8_t)Value;
+  uint16_t u16 = (uint16_t)Value;
+  uint32_t u32 = (uint32_t)Value;
+  uint64_t u64 = (uint64_t)Value;
+
+  switch (pSig->FieldSize)
+  {
+  case 1:
+    memcpy(field, &u8, 1);
+    break;
+  case 2:
+    memcpy(field, &u16, 2);
+    break;
+  case 4:
+    memcpy(field, &u32, 4);
+    break;
+  default:
+    memcpy(field, &u64, 8);
+    break;
+  }
+}
+
+static int64_t bench_load(const void *pMsg, const CAN_MSGS_Signal_t *pSig)
+{
+  const uint8_t *field = (const uint8_t *)pMsg + pSig->FieldOffset;
+  uint8_t u8;
+  uint16_t u16;
+  uint32_t u32;
+  uint64_t u64;
+
+  switch (pSig->FieldSize)
+  {
+  case 1:
+    memcpy(&u8, field, 1);
+    return pSig->FieldSigned ? (int64_t)(int8_t)u8 : (int64_t)u8;
+  case 2:
+    memcpy(&u16, field, 2);
+    return pSig->FieldSigned ? (int64_t)(int16_t)u16 : (int64_t)u16;
+  case 4:
+    memcpy(&u32, field, 4);
+    return pSig->FieldSigned ? (int64_t)(int32_t)u32 : (int64_t)u32;
+  default:
+    memcpy(&u64, field, 8);
+    return (int64_t)u64;
+  }
+}
+
+static void bench_generic(uint32_t Msg, void *pMsg, const uint8_t *pData)
+{
+  const CAN_MSGS_Desc_t *desc = &CAN_MSGS_Table[Msg];
+  uint32_t i;
+
+  for (i = desc->FirstSignal; i < (uint32_t)desc->FirstSignal + desc->SignalCount; i++)
+  {
+    bench_store(pMsg, &CAN_MSGS_Signals[i], bench_generic_signal(&CAN_MSGS_Signals[i], pData));
+  }
+}
+
+static int bench_check(void)
+{
+  uint8_t data[BENCH_DATA_MAX], covered[BENCH_DATA_MAX], packed[BENCH_DATA_MAX];
+  uint64_t msg[BENCH_DATA_MAX];
+  const CAN_MSGS_Desc_t *desc;
+  const CAN_MSGS_Signal_t *sig;
+  uint32_t m, n, i, k, p;
+  int64_t want, got;
+  int fails = 0;
+
+  for (m = 0; m < CAN_MSGS_COUNT; m++)
+  {
+    desc = &CAN_MSGS_Table[m];
+    memset(covered, 0, sizeof(covered));
+    for (i = desc->FirstSignal; i < (uint32_t)desc->FirstSignal + desc->SignalCount; i++)
+    {
+      for (k = 0; k < CAN_MSGS_Signals[i].Length; k++)
+      {
+        p = bench_bit(&CAN_MSGS_Signals[i], k);
+        covered[p / 8U] |= (uint8_t)(1U << (p % 8U));
+      }
+    }
+
+    for (n = 0; n < BENCH_CHECKS && fails < 10; n++)
+    {
+      bench_payload(data);
+      memset(msg, 0, sizeof(msg));
+      desc->Unpack(msg, data);
+      for (i = desc->FirstSignal; i < (uint32_t)desc->FirstSignal + desc->SignalCount; i++)
+      {
+        sig = &CAN_MSGS_Signals[i];
+        want = bench_generic_signal(sig, data);
+        got = bench_load(msg, sig);
+        if (want != got)
+        {
+          printf("FAIL %s: unpack %" PRId64 ", expected %" PRId64 "\n", sig->Name, got, want);
+          fails++;
+        }
+      }
+
+      memset(packed, 0xA5, sizeof(packed));
+      desc->Pack(packed, msg);
+      for (i = 0; i < desc->Dlc; i++)
+      {
+        if (packed[i] != (data[i] & covered[i]))
+        {
+          printf("FAIL %s: pack byte %u 0x%02X, expected 0x%02X\n", desc->Name, i, packed[i], data[i] & covered[i]);
+          fails++;
+          break;
+        }
+      }
+      if (desc->Dlc < BENCH_DATA_MAX && packed[desc->Dlc] != 0xA5U)
+      {
+        printf("FAIL %s: pack wrote past the DLC\n", desc->Name);
+        fails++;
+      }
+    }
+  }
+  printf("consistency: %u messages, %u signals, %s\n", CAN_MSGS_COUNT, CAN_MSGS_SIGNALS, fails ? "FAIL" : "ok");
+  return fails;
+}
+
+static void bench_throughput(uint32_t Frames, uint32_t Rounds)
+{
+  Frame_t *frames = malloc(Frames * sizeof(Frame_t));
+  uint64_t msg[BENCH_DATA_MAX], t0, generic, generated;
+  uint32_t i, r, sum = 0U;
+
+  if (frames == NULL)
+  {
+    return;
+  }
+  for (i = 0; i < Frames; i++)
+  {
+    frames[i].Msg = (uint16_t)(bench_rand() % CAN_MSGS_COUNT);
+    bench_payload(frames[i].Data);
+  }
+
+  t0 = bench_ns();
+  for (r = 0; r < Rounds; r++)
+  {
+    for (i = 0; i < Frames; i++)
+    {
+      bench_generic(frames[i].Msg, msg, frames[i].Data);
+      sum += (uint32_t)msg[0];
+    }
+  }
+  generic = bench_ns() - t0;
+
+  t0 = bench_ns();
+  for (r = 0; r < Rounds; r++)
+  {
+    for (i = 0; i < Frames; i++)
+    {
+      CAN_MSGS_Table[frames[i].Msg].Unpack(msg, frames[i].Data);
+      sum += (uint32_t)msg[0];
+    }
+  }
+  generated = bench_ns() - t0;
+  Sink = sum;
+
+  printf("decode %u frames x %u:\n", Frames, Rounds);
+  printf("  generic table walk %8.1f ns/frame %8.2f Mframes/s\n", (double)generic / ((double)Frames * Rounds),
+         (double)Frames * Rounds * 1e3 / (double)generic);
+  printf("  generated          %8.1f ns/frame %8.2f Mframes/s (x%.1f)\n", (double)generated / ((double)Frames * Rounds),
+         (double)Frames * Rounds * 1e3 / (double)generated, (double)generic / (double)generated);
+  free(frames);
+}
+
+/* What a switch or a sorted list boils down to without generated maps */
+static int32_t bench_linear(uint32_t Id, uint32_t Extended)
+{
+  uint32_t i;
+
+  for (i = 0; i < CAN_MSGS_COUNT; i++)
+  {
+    if (CAN_MSGS_Table[i].Id == Id && CAN_MSGS_Table[i].Extended == Extended)
+    {
+      return (int32_t)i;
+    }
+  }
+  return -1;
+}
+
+static int bench_check_lookup(void)
+{
+  uint32_t i, id, fails = 0;
+
+  for (id = 0; id < 0x800U; id++)
+  {
+    fails += (CAN_MSGS_Lookup(id, 0U) != bench_linear(id, 0U));
+  }
+  for (i = 0; i < CAN_MSGS_COUNT; i++)
+  {
+    fails += (CAN_MSGS_Lookup(CAN_MSGS_Table[i].Id, CAN_MSGS_Table[i].Extended) != (int32_t)i);
+  }
+  for (i = 0; i < BENCH_EXT_CHECKS; i++)
+  {
+    id = (uint32_t)bench_rand() & 0x1FFFFFFFU;
+    fails += (CAN_MSGS_Lookup(id, 1U) != bench_linear(id, 1U));
+  }
+  printf("lookup: %u standard, %u extended IDs, %u extended slots, %s\n", 0x800U, BENCH_EXT_CHECKS + CAN_MSGS_COUNT,
+         CAN_MSGS_EXT_HASH_SIZE, fails ? "FAIL" : "ok");
+  return (int)fails;
+}
+
+/* IDs of one class: 0 known standard, 1 unknown standard, 2 known
+ * extended, 3 unknown extended, 4 mixed stream */
+static uint32_t bench_ids(RxId_t *pIds, uint32_t Count, uint32_t Class)
+{
+  uint32_t i, n = 0, tries, c;
+
+  for (i = 0; i < Count; i++)
+  {
+    c = (Class == 4U) ? (uint32_t)(bench_rand() % 4U) : Class;
+    for (tries = 0; tries < 1000U; tries++)
+    {
+      if (c == 0U || c == 2U)
+      {
+        const CAN_MSGS_Desc_t *desc = &CAN_MSGS_Table[bench_rand() % CAN_MSGS_COUNT];
+
+        pIds[n].Id = desc->Id;
+        pIds[n].Extended = desc->Extended;
+        if (desc->Extended == (c == 2U))
+        {
+          break;
+        }
+      }
+      else
+      {
+        pIds[n].Extended = (c == 3U);
+        pIds[n].Id = (uint32_t)bench_rand() & (pIds[n].Extended ? 0x1FFFFFFFU : 0x7FFU);
+        if (bench_linear(pIds[n].Id, pIds[n].Extended) < 0)
+        {
+          break;
+        }
+      }
+    }
+    n += (tries < 1000U);
+  }
+  return n;
+}
+
+static double bench_lookup_ns(const RxId_t *pIds, uint32_t Count, uint32_t Rounds, uint32_t Linear)
+{
+  uint64_t t0;
+  uint32_t i, r;
+  int32_t sum = 0;
+
+  t0 = bench_ns();
+  for (r = 0; r < Rounds; r++)
+  {
+    for (i = 0; i < Count; i++)
+    {
+      sum += Linear ? bench_linear(pIds[i].Id, pIds[i].Extended) : CAN_MSGS_Lookup(pIds[i].Id, pIds[i].Extended);
+    }
+  }
+  Sink = (uint32_t)sum;
+  return (double)(bench_ns() - t0) / ((double)Count * Rounds);
+}
+
+static void bench_handler(uint32_t Msg, const void *pMsg)
+{
+  Sink += Msg + *(const uint8_t *)pMsg;
+}
+
+static void bench_dispatch(uint32_t Frames, uint32_t Rounds)
+{
+  static const char *const classes[] = {"standard, known", "standard, unknown", "extended, known",
+                                        "extended, unknown", "mixed"};
+  RxId_t *ids = malloc(Frames * sizeof(RxId_t));
+  uint8_t (*data)[BENCH_DATA_MAX] = malloc(Frames * BENCH_DATA_MAX);
+  uint64_t msg[BENCH_DATA_MAX], t0;
+  uint32_t c, n, i, r;
+  int32_t idx;
+
+  if (ids == NULL || data == NULL)
+  {
+    free(ids);
+    free(data);
+    return;
+  }
+
+  printf("lookup, %u messages:\n", CAN_MSGS_COUNT);
+  for (c = 0; c < 5U; c++)
+  {
+    n = bench_ids(ids, Frames, c);
+    if (n == 0U)
+    {
+      continue;
+    }
+    printf("  %-18s generated %6.2f ns, linear %7.2f ns\n", classes[c], bench_lookup_ns(ids, n, Rounds, 0U),
+           bench_lookup_ns(ids, n, Rounds, 1U));
+  }
+
+  /* Mixed stream through the whole path */
+  n = bench_ids(ids, Frames, 4U);
+  for (i = 0; i < n; i++)
+  {
+    bench_payload(data[i]);
+  }
+  t0 = bench_ns();
+  for (r = 0; r < Rounds; r++)
+  {
+    for (i = 0; i < n; i++)
+    {
+      idx = CAN_MSGS_Lookup(ids[i].Id, ids[i].Extended);
+      if (idx >= 0)
+      {
+        CAN_MSGS_Table[idx].Unpack(msg, data[i]);
+        bench_handler((uint32_t)idx, msg);
+      }
+    }
+  }
+  printf("dispatch (lookup, decode, handler): %.1f ns/frame\n",
+         (double)(bench_ns() - t0) / ((double)(n != 0U ? n : 1U) * Rounds));
+  free(ids);
+  free(data);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t frames = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 65536U;
+  uint32_t rounds = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 32U;
+
+  if (bench_check() != 0 || bench_check_lookup() != 0)
+  {
+    return 1;
+  }
+  bench_throughput(frames, rounds);
+  bench_dispatch(frames, rounds);
+  return 0;
+}
@@ -0,0 +1,1073 @@
+/*
+ * Generates the CAN message codecs of the firmware from a DBC file.
+ *
+ *   dbcgen IN.dbc OUTDIR [BASENAME]
+ *
+ * writes OUTDIR/BASENAME.h and OUTDIR/BASENAME.c (BASENAME defaults to
+ * can_msgs). Every message gets a struct with one field per signal and a
+ * pair of functions
+ *
+ *   void CAN_MSG_<NAME>_Unpack(CAN_MSG_<NAME>_t *pMsg, const uint8_t *pData);
+ *   void CAN_MSG_<NAME>_Pack(uint8_t *pData, const CAN_MSG_<NAME>_t *pMsg);
+ *
+ * with every shift and mask a constant. Signals are extracted from 64-bit
+ * words loaded once per 8-byte window of the payload (byte swapped for
+ * Motorola signals): a single load for classic frames, a few for CAN FD
+ * payloads. Messages of up to 8 bytes are packed into one word, longer
+ * ones byte by byte. Scaled signals are stored in fixed point: the field holds
+ * the physical value times 10^d, d being the smallest number of decimals
+ * that makes the DBC factor and offset integers, so decoding is one integer
+ * multiply-add (CAN_MSG_<NAME>_<SIGNAL>_SCALE is 10^d). Unscaled signals
+ * keep their raw value in the smallest integer type.
+ *
+ * Received IDs map to message indexes in constant time with
+ * CAN_MSGS_Lookup(): a 2048-entry table for standard IDs, and a perfect
+ * hash searched here for extended IDs (two table reads, one compare).
+ *
+ * Multiplexed signals are not supported, they are skipped with a warning.
+ */
+
+#include <ctype.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NAME_MAX_LEN 64U
+#define UNIT_MAX_LEN 16U
+#define DATA_MAX 64U /* CAN FD */
+#define DECIMALS_MAX 6U
+#define HASH_BITS_MAX 12U
+#define HASH_TRIES 256U
+
+typedef struct
+{
+  char Name[NAME_MAX_LEN];
+  char Unit[UNIT_MAX_LEN];
+  uint32_t Start;
+  uint32_t Length;
+  int Motorola;
+  int Signed;
+  double Factor;
+  double Offset;
+  /* Fixed point: field = raw * Mul + Off, in units of 1 / Scale */
+  int64_t Mul;
+  int64_t Off;
+  int64_t Scale;
+  int Raw;          /* Factor 1, offset 0: the field is the raw value */
+  int Wide;         /* 64-bit arithmetic */
+  const char *Type; /* Field type */
+  uint16_t Bits[64]; /* Position (byte * 8 + bit) of each bit, LSB first */
+} Signal_t;
+
+typedef struct
+{
+  char Name[NAME_MAX_LEN];
+  char Sender[NAME_MAX_LEN];
+  uint32_t Id;
+  int Extended;
+  uint32_t Dlc;
+  uint32_t CycleMs; /* GenMsgCycleTime, 0 for event messages */
+  uint32_t Bus;     /* DashBus, 1 or 2 */
+  Signal_t *Signals;
+  uint32_t Count;
+} Message_t;
+
+static Message_t *Messages;
+static uint32_t MessageCount;
+static uint32_t Warnings;
+
+/* Extended ID perfect hash, see perfect_hash() */
+static uint32_t HashMul;
+static uint32_t HashBits;
+static uint32_t HashBucketMul;
+static uint32_t HashBucketBits;
+static uint32_t *HashDisp;
+static int32_t *HashSlots; /* Message index, -1 when empty */
+
+static void upper(char *pDst, const char *pSrc)
+{
+  while (*pSrc != '\0')
+  {
+    *pDst++ = (char)toupper((unsigned char)*pSrc++);
+  }
+  *pDst = '\0';
+}
+
+static int is_ident(const char *pName)
+{
+  if (!isalpha((unsigned char)*pName) && *pName != '_')
+  {
+    return 0;
+  }
+  while (*pName != '\0')
+  {
+    if (!isalnum((unsigned char)*pName) && *pName != '_')
+    {
+      return 0;
+    }
+    pName++;
+  }
+  return 1;
+}
+
+/* Smallest power of ten making the factor and the offset integers */
+static int fixed_point(Signal_t *pSig)
+{
+  int64_t scale = 1;
+  double f, o;
+  uint32_t d;
+
+  for (d = 0; d <= DECIMALS_MAX; d++, scale *= 10)
+  {
+    f = pSig->Factor * (double)scale;
+    o = pSig->Offset * (double)scale;
+    if (fabs(f - round(f)) < 1e-6 && fabs(o - round(o)) < 1e-6 && llround(f) != 0)
+    {
+      break;
+    }
+  }
+  if (d > DECIMALS_MAX)
+  {
+    scale /= 10;
+    f = pSig->Factor * (double)scale;
+    o = pSig->Offset * (double)scale;
+    fprintf(stderr, "warning: %s: factor %g offset %g rounded to %d decimals\n", pSig->Name, pSig->Factor, pSig->Offset,
+            DECIMALS_MAX);
+    Warnings++;
+    if (llround(f) == 0)
+    {
+      return -1;
+    }
+  }
+  pSig->Mul = llround(f);
+  pSig->Off = llround(o);
+  pSig->Scale = scale;
+  pSig->Raw = (pSig->Mul == 1 && pSig->Off == 0 && scale == 1);
+  return 0;
+}
+
+/* Field type and arithmetic width from the raw range */
+static int field_type(Signal_t *pSig)
+{
+  long double lo, hi, a, b, m;
+
+  if (pSig->Raw)
+  {
+    static const char *const utypes[] = {"uint8_t", "uint16_t", "uint32_t", "uint64_t"};
+    static const char *const stypes[] = {"int8_t", "int16_t", "int32_t", "int64_t"};
+    int i = (pSig->Length <= 8U) ? 0 : (pSig->Length <= 16U) ? 1 : (pSig->Length <= 32U) ? 2 : 3;
+
+    pSig->Type = pSig->Signed ? stypes[i] : utypes[i];
+    pSig->Wide = (pSig->Length > 32U);
+    return 0;
+  }
+
+  lo = pSig->Signed ? -ldexpl(1.0L, (int)pSig->Length - 1) : 0.0L;
+  hi = pSig->Signed ? ldexpl(1.0L, (int)pSig->Length - 1) - 1.0L : ldexpl(1.0L, (int)pSig->Length) - 1.0L;
+  a = lo * (long double)pSig->Mul;
+  b = hi * (long double)pSig->Mul;
+  m = fmaxl(fabsl(a), fabsl(b)) + fabsl((long double)pSig->Off);
+  if (m <= (long double)INT32_MAX && hi <= (long double)INT32_MAX)
+  {
+    pSig->Type = "int32_t";
+    pSig->Wide = 0;
+  }
+  else if (m <= (long double)INT64_MAX && pSig->Length < 64U)
+  {
+    pSig->Type = "int64_t";
+    pSig->Wide = 1;
+  }
+  else
+  {
+    return -1;
+  }
+  return 0;
+}
+
+/* Bit positions of a signal, LSB first. Motorola start bits are the MSB in
+ * the DBC sawtooth numbering. */
+static int layout(Signal_t *pSig, uint32_t Dlc)
+{
+  uint32_t i, p = pSig->Start;
+
+  for (i = 0; i < pSig->Length; i++)
+  {
+    if (pSig->Motorola)
+    {
+      pSig->Bits[pSig->Length - 1U - i] = (uint16_t)p;
+      p = ((p % 8U) == 0U) ? p + 15U : p - 1U;
+    }
+    else
+    {
+      pSig->Bits[i] = (uint16_t)(pSig->Start + i);
+    }
+  }
+  for (i = 0; i < pSig->Length; i++)
+  {
+    if (pSig->Bits[i] / 8U >= Dlc)
+    {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static int parse_signal(const char *pLine, Message_t *pMsg, uint32_t LineNo)
+{
+  Signal_t sig;
+  char name[NAME_MAX_LEN], mux[NAME_MAX_LEN], order, sign;
+  double min, max;
+  int n = 0;
+
+  memset(&sig, 0, sizeof(sig));
+  if (sscanf(pLine, " SG_ %63s %63s %n", name, mux, &n) != 2)
+  {
+    return -1;
+  }
+  if (strcmp(mux, ":") != 0)
+  {
+    fprintf(stderr, "warning: line %u: multiplexed signal %s skipped\n", LineNo, name);
+    Warnings++;
+    return 0;
+  }
+  strcpy(sig.Name, name);
+  if (sscanf(pLine + n, "%u|%u@%c%c (%lf,%lf) [%lf|%lf] \"%15[^\"]\"", &sig.Start, &sig.Length, &order, &sign,
+             &sig.Factor, &sig.Offset, &min, &max, sig.Unit) < 8)
+  {
+    return -1;
+  }
+  sig.Motorola = (order == '0');
+  sig.Signed = (sign == '-');
+  if (!is_ident(sig.Name) || sig.Length == 0U || sig.Length > 64U || (order != '0' && order != '1') ||
+      (sign != '+' && sign != '-'))
+  {
+    return -1;
+  }
+  if (layout(&sig, pMsg->Dlc) != 0)
+  {
+    fprintf(stderr, "line %u: %s outside the %u data bytes\n", LineNo, sig.Name, pMsg->Dlc);
+    return -1;
+  }
+  if (fixed_point(&sig) != 0 || field_type(&sig) != 0)
+  {
+    fprintf(stderr, "line %u: %s has no fixed point representation\n", LineNo, sig.Name);
+    return -1;
+  }
+
+  pMsg->Signals = realloc(pMsg->Signals, (pMsg->Count + 1U) * sizeof(Signal_t));
+  if (pMsg->Signals == NULL)
+  {
+    return -1;
+  }
+  pMsg->Signals[pMsg->Count++] = sig;
+  return 0;
+}
+
+/* Message attributes: BA_ "GenMsgCycleTime" BO_ <id> <ms>; and
+ * BA_ "DashBus" BO_ <id> <bus>; others are ignored */
+static int parse_attribute(const char *pLine)
+{
+  char name[NAME_MAX_LEN];
+  unsigned long id, value;
+  uint32_t i;
+
+  if (sscanf(pLine, "BA_ \"%63[^\"]\" BO_ %lu %lu", name, &id, &value) != 3)
+  {
+    return 0;
+  }
+  for (i = 0; i < MessageCount; i++)
+  {
+    if (Messages[i].Id == (uint32_t)(id & 0x1FFFFFFFUL) && Messages[i].Extended == ((id & 0x80000000UL) != 0UL))
+    {
+      if (strcmp(name, "GenMsgCycleTime") == 0)
+      {
+        Messages[i].CycleMs = (uint32_t)value;
+      }
+      else if (strcmp(name, "DashBus") == 0)
+      {
+        if (value < 1UL || value > 2UL)
+        {
+          return -1;
+        }
+        Messages[i].Bus = (uint32_t)value;
+      }
+      return 0;
+    }
+  }
+  return -1;
+}
+
+static int parse(const char *pPath)
+{
+  FILE *f = fopen(pPath, "r");
+  char line[512], name[NAME_MAX_LEN], sender[NAME_MAX_LEN];
+  unsigned long id;
+  unsigned dlc;
+  uint32_t no = 0;
+  Message_t *msg = NULL;
+
+  if (f == NULL)
+  {
+    perror(pPath);
+    return -1;
+  }
+  while (fgets(line, sizeof(line), f) != NULL)
+  {
+    no++;
+    if (strncmp(line, "BO_ ", 4) == 0)
+    {
+      if (sscanf(line, "BO_ %lu %63[^:]: %u %63s", &id, name, &dlc, sender) != 4 || !is_ident(name) ||
+          dlc == 0U || dlc > DATA_MAX)
+      {
+        fprintf(stderr, "%s:%u: bad message\n", pPath, no);
+        fclose(f);
+        return -1;
+      }
+      Messages = realloc(Messages, (MessageCount + 1U) * sizeof(Message_t));
+      if (Messages == NULL)
+      {
+        fclose(f);
+        return -1;
+      }
+      msg = &Messages[MessageCount++];
+      memset(msg, 0, sizeof(*msg));
+      upper(msg->Name, name);
+      strcpy(msg->Sender, sender);
+      msg->Extended = (id & 0x80000000UL) != 0UL;
+      msg->Id = (uint32_t)(id & 0x1FFFFFFFUL);
+      msg->Dlc = dlc;
+      msg->Bus = 1U;
+    }
+    else if (strncmp(line, "BA_ ", 4) == 0)
+    {
+      if (parse_attribute(line) != 0)
+      {
+        fprintf(stderr, "%s:%u: bad attribute\n", pPath, no);
+        fclose(f);
+        return -1;
+      }
+      msg = NULL;
+    }
+    else if (strncmp(line, " SG_ ", 5) == 0)
+    {
+      if (msg == NULL || parse_signal(line, msg, no) != 0)
+      {
+        fprintf(stderr, "%s:%u: bad signal\n", pPath, no);
+        fclose(f);
+        return -1;
+      }
+    }
+    else if (line[0] != ' ')
+    {
+      /* Any other section ends the signal list of the message */
+      msg = NULL;
+    }
+  }
+  fclose(f);
+  return 0;
+}
+
+static void mask(char *pOut, uint32_t Length)
+{
+  if (Length >= 64U)
+  {
+    strcpy(pOut, "0xFFFFFFFFFFFFFFFFU");
+  }
+  else
+  {
+    sprintf(pOut, "0x%" PRIX64 "U", (((uint64_t)1) << Length) - 1U);
+  }
+  if (Length > 32U)
+  {
+    strcat(pOut, "LL");
+  }
+}
+
+/* Right-aligned raw value of Word >> Shift, sign extended, and scaled */
+static void emit_decode(FILE *f, const Signal_t *pSig, const char *pWord, uint32_t Shift)
+{
+  char w[64], m[32];
+  uint32_t len = pSig->Length;
+
+  if (Shift != 0U)
+  {
+    sprintf(w, "(%s >> %u)", pWord, Shift);
+  }
+  else
+  {
+    strcpy(w, pWord);
+  }
+  mask(m, len);
+
+  fprintf(f, "  pMsg->%s = (%s)", pSig->Name, pSig->Type);
+  if (!pSig->Raw)
+  {
+    /* Signed arithmetic in the field type */
+    fprintf(f, "((%s)", pSig->Type);
+  }
+  if (pSig->Signed && len <= 32U)
+  {
+    fprintf(f, len == 32U ? "(int32_t)(uint32_t)%s" : "((int32_t)((uint32_t)%s << %u) >> %u)", w, 32U - len, 32U - len);
+  }
+  else if (pSig->Signed)
+  {
+    fprintf(f, len == 64U ? "(int64_t)%s" : "((int64_t)(%s << %u) >> %u)", w, 64U - len, 64U - len);
+  }
+  else if (len <= 32U)
+  {
+    fprintf(f, len == 32U ? "(uint32_t)%s" : "((uint32_t)%s & %s)", w, m);
+  }
+  else
+  {
+    fprintf(f, (Shift + len == 64U) ? "%s" : "(%s & %s)", w, m);
+  }
+  if (!pSig->Raw)
+  {
+    if (pSig->Mul != 1)
+    {
+      fprintf(f, " * %" PRId64 "%s", pSig->Mul, pSig->Wide ? "LL" : "");
+    }
+    if (pSig->Off != 0)
+    {
+      fprintf(f, " %c %" PRId64 "%s", (pSig->Off < 0) ? '-' : '+', (int64_t)llabs(pSig->Off), pSig->Wide ? "LL" : "");
+    }
+    fprintf(f, ")");
+  }
+  fprintf(f, ";\n");
+}
+
+/* Masked raw value of a field, as a uint64_t expression */
+static void emit_raw(FILE *f, const Signal_t *pSig)
+{
+  char m[32];
+
+  mask(m, pSig->Length);
+  if (pSig->Raw)
+  {
+    fprintf(f, "((uint64_t)pMsg->%s & %s)", pSig->Name, m);
+  }
+  else
+  {
+    fprintf(f, "((uint64_t)((pMsg->%s", pSig->Name);
+    if (pSig->Off != 0)
+    {
+      fprintf(f, " %c %" PRId64 "%s", (pSig->Off < 0) ? '+' : '-', (int64_t)llabs(pSig->Off), pSig->Wide ? "LL" : "");
+    }
+    fprintf(f, ")");
+    if (pSig->Mul != 1)
+    {
+      fprintf(f, " / %" PRId64 "%s", pSig->Mul, pSig->Wide ? "LL" : "");
+    }
+    fprintf(f, ") & %s)", m);
+  }
+}
+
+/* First byte of the 8-byte window holding a signal, -1 if it spans more.
+ * Payloads of up to 8 bytes always use the window at 0, longer ones never
+ * read past their DLC. */
+static int32_t window_base(const Signal_t *pSig, uint32_t Dlc)
+{
+  uint32_t first = 0xFFU, last = 0U, i;
+
+  for (i = 0; i < pSig->Length; i++)
+  {
+    first = (pSig->Bits[i] / 8U < first) ? pSig->Bits[i] / 8U : first;
+    last = (pSig->Bits[i] / 8U > last) ? pSig->Bits[i] / 8U : last;
+  }
+  if (last - first >= 8U)
+  {
+    return -1;
+  }
+  if (Dlc <= 8U)
+  {
+    return 0;
+  }
+  /* Prefer aligned windows, shared by the neighbouring signals */
+  for (i = 8U; i >= 1U; i /= 2U)
+  {
+    if ((first & ~(i - 1U)) + 8U <= Dlc && last < (first & ~(i - 1U)) + 8U)
+    {
+      return (int32_t)(first & ~(i - 1U));
+    }
+  }
+  return (int32_t)(Dlc - 8U);
+}
+
+/* Position of the signal LSB in the little endian (Intel) or big endian
+ * (Motorola) 64-bit word loaded from byte Base */
+static uint32_t word_shift(const Signal_t *pSig, uint32_t Base)
+{
+  uint32_t p = pSig->Bits[0] - Base * 8U;
+
+  return pSig->Motorola ? (7U - p / 8U) * 8U + p % 8U : p;
+}
+
+static void word_name(char *pOut, const Signal_t *pSig, uint32_t Base)
+{
+  if (Base == 0U)
+  {
+    strcpy(pOut, pSig->Motorola ? "be" : "le");
+  }
+  else
+  {
+    sprintf(pOut, "%s%u", pSig->Motorola ? "be" : "le", Base);
+  }
+}
+
+static void emit_message_c(FILE *f, const Message_t *pMsg)
+{
+  uint32_t i, k, j, be = 0, loads = 0, raw = 0;
+  uint8_t loaded[2][DATA_MAX] = {{0}};
+  const Signal_t *sig;
+  int32_t base;
+  char word[16];
+
+  for (i = 0; i < pMsg->Count; i++)
+  {
+    be |= (uint32_t)pMsg->Signals[i].Motorola;
+    raw |= (window_base(&pMsg->Signals[i], pMsg->Dlc) < 0);
+  }
+
+  fprintf(f, "void CAN_MSG_%s_Unpack(CAN_MSG_%s_t *pMsg, const uint8_t *pData)\n{\n", pMsg->Name, pMsg->Name);
+  /* One load per 8-byte window in use */
+  for (i = 0; i < pMsg->Count; i++)
+  {
+    sig = &pMsg->Signals[i];
+    base = window_base(sig, pMsg->Dlc);
+    if (base >= 0 && !loaded[sig->Motorola][base])
+    {
+      loaded[sig->Motorola][base] = 1U;
+      word_name(word, sig, (uint32_t)base);
+      fprintf(f, "  const uint64_t %s = CAN_MSGS_Load%s(pData%s", word, sig->Motorola ? "BE" : "LE",
+              (base != 0) ? " + " : ");\n");
+      if (base != 0)
+      {
+        fprintf(f, "%dU);\n", base);
+      }
+      loads++;
+    }
+  }
+  if (raw)
+  {
+    fprintf(f, "  uint64_t raw;\n");
+  }
+  if (loads != 0U || raw)
+  {
+    fprintf(f, "\n");
+  }
+  for (i = 0; i < pMsg->Count; i++)
+  {
+    sig = &pMsg->Signals[i];
+    base = window_base(sig, pMsg->Dlc);
+    if (base >= 0)
+    {
+      word_name(word, sig, (uint32_t)base);
+      emit_decode(f, sig, word, word_shift(sig, (uint32_t)base));
+      continue;
+    }
+    /* Wider than a window: one term per run of bits in the same byte */
+    fprintf(f, "  raw = ");
+    for (k = 0; k < sig->Length; k = j)
+    {
+      for (j = k + 1U; j < sig->Length && sig->Bits[j] == sig->Bits[j - 1U] + 1U && sig->Bits[j] % 8U != 0U; j++)
+      {
+      }
+      fprintf(f, "%s((uint64_t)((pData[%u] >> %u) & 0x%XU) << %u)", (k == 0U) ? "" : " | ", sig->Bits[k] / 8U,
+              sig->Bits[k] % 8U, (1U << (j - k)) - 1U, k);
+    }
+    fprintf(f, ";\n");
+    emit_decode(f, sig, "raw", 0U);
+  }
+  if (pMsg->Count == 0U)
+  {
+    fprintf(f, "  (void)pMsg;\n  (void)pData;\n");
+  }
+  fprintf(f, "}\n\n");
+
+  fprintf(f, "void CAN_MSG_%s_Pack(uint8_t *pData, const CAN_MSG_%s_t *pMsg)\n{\n", pMsg->Name, pMsg->Name);
+  if (pMsg->Dlc <= 8U)
+  {
+    fprintf(f, "  uint64_t le = 0U%s;\n\n", be ? ", be = 0U" : "");
+    for (i = 0; i < pMsg->Count; i++)
+    {
+      sig = &pMsg->Signals[i];
+      fprintf(f, "  %s |= ", sig->Motorola ? "be" : "le");
+      emit_raw(f, sig);
+      if (word_shift(sig, 0U) != 0U)
+      {
+        fprintf(f, " << %u", word_shift(sig, 0U));
+      }
+      fprintf(f, ";\n");
+    }
+    fprintf(f, "  CAN_MSGS_Store(pData, %s, %uU);\n", be ? "le | CAN_MSGS_Swap(be)" : "le", pMsg->Dlc);
+    if (pMsg->Count == 0U)
+    {
+      fprintf(f, "  (void)pMsg;\n");
+    }
+  }
+  else
+  {
+    fprintf(f, "  uint64_t raw;\n\n  memset(pData, 0, %uU);\n", pMsg->Dlc);
+    for (i = 0; i < pMsg->Count; i++)
+    {
+      sig = &pMsg->Signals[i];
+      fprintf(f, "  raw = ");
+      emit_raw(f, sig);
+      fprintf(f, ";\n");
+      for (k = 0; k < sig->Length; k = j)
+      {
+        for (j = k + 1U; j < sig->Length && sig->Bits[j] == sig->Bits[j - 1U] + 1U && sig->Bits[j] % 8U != 0U; j++)
+        {
+        }
+        fprintf(f, "  pData[%u] |= (uint8_t)(((raw >> %u) & 0x%XU) << %u);\n", sig->Bits[k] / 8U, k,
+                (1U << (j - k)) - 1U, sig->Bits[k] % 8U);
+      }
+    }
+  }
+  fprintf(f, "}\n\n");
+}
+
+static int emit_header(const char *pPath, const char *pGuard, const char *pDbc)
+{
+  FILE *f = fopen(pPath, "w");
+  uint32_t i, k, signals = 0, dlc = 0;
+  const Message_t *msg;
+  const Signal_t *sig;
+  char sname[NAME_MAX_LEN];
+
+  if (f == NULL)
+  {
+    perror(pPath);
+    return -1;
+  }
+  for (i = 0; i < MessageCount; i++)
+  {
+    signals += Messages[i].Count;
+  }
+
+  fprintf(f, "/* Generated by tools/dbcgen from %s, do not edit */\n\n", pDbc);
+  fprintf(f, "#ifndef %s\n#define %s\n\n#include <stddef.h>\n#include <stdint.h>\n\n", pGuard, pGuard);
+  fprintf(f, "/* Unpack reads 8 bytes from messages of up to 8 bytes: the payload\n"
+             " * buffer must hold at least CAN_MSGS_DATA_MIN bytes. Pack writes the\n"
+             " * DLC bytes only. Fixed point fields hold the physical value times\n"
+             " * their _SCALE, values between two steps are truncated by Pack. */\n");
+  for (i = 0; i < MessageCount; i++)
+  {
+    dlc = (Messages[i].Dlc > dlc) ? Messages[i].Dlc : dlc;
+  }
+  fprintf(f, "#define CAN_MSGS_DATA_MIN 8U\n#define CAN_MSGS_DLC_MAX %uU\n", dlc);
+  fprintf(f, "#define CAN_MSGS_COUNT %uU\n#define CAN_MSGS_SIGNALS %uU\n\n", MessageCount, signals);
+
+  for (i = 0; i < MessageCount; i++)
+  {
+    msg = &Messages[i];
+    fprintf(f, "/* %s, sent by %s */\n", msg->Name, msg->Sender);
+    fprintf(f, "#define CAN_MSG_%s_ID 0x%0*XU\n", msg->Name, msg->Extended ? 8 : 3, msg->Id);
+    fprintf(f, "#define CAN_MSG_%s_EXTENDED %uU\n", msg->Name, msg->Extended ? 1U : 0U);
+    fprintf(f, "#define CAN_MSG_%s_DLC %uU\n", msg->Name, msg->Dlc);
+    fprintf(f, "#define CAN_MSG_%s_INDEX %uU\n", msg->Name, i);
+    fprintf(f, "#define CAN_MSG_%s_CYCLE_MS %uU\n", msg->Name, msg->CycleMs);
+    fprintf(f, "#define CAN_MSG_%s_BUS %uU\n", msg->Name, msg->Bus);
+    for (k = 0; k < msg->Count; k++)
+    {
+      sig = &msg->Signals[k];
+      if (!sig->Raw)
+      {
+        upper(sname, sig->Name);
+        fprintf(f, "#define CAN_MSG_%s_%s_SCALE %" PRId64 "\n", msg->Name, sname, sig->Scale);
+      }
+    }
+    fprintf(f, "\ntypedef struct\n{\n");
+    for (k = 0; k < msg->Count; k++)
+    {
+      sig = &msg->Signals[k];
+      fprintf(f, "  %s %s;", sig->Type, sig->Name);
+      if (!sig->Raw || sig->Unit[0] != '\0')
+      {
+        fprintf(f, " /*");
+        if (sig->Unit[0] != '\0')
+        {
+          fprintf(f, " %s", sig->Unit);
+        }
+        if (!sig->Raw)
+        {
+          fprintf(f, " x%" PRId64, sig->Scale);
+        }
+        fprintf(f, " */");
+      }
+      fprintf(f, "\n");
+    }
+    if (msg->Count == 0U)
+    {
+      fprintf(f, "  uint8_t Unused;\n");
+    }
+    fprintf(f, "} CAN_MSG_%s_t;\n\n", msg->Name);
+    fprintf(f, "void CAN_MSG_%s_Unpack(CAN_MSG_%s_t *pMsg, const uint8_t *pData);\n", msg->Name, msg->Name);
+    fprintf(f, "void CAN_MSG_%s_Pack(uint8_t *pData, const CAN_MSG_%s_t *pMsg);\n\n", msg->Name, msg->Name);
+  }
+
+  fprintf(f, "/* Room for the signals of any message */\ntypedef union\n{\n");
+  for (i = 0; i < MessageCount; i++)
+  {
+    fprintf(f, "  CAN_MSG_%s_t %s;\n", Messages[i].Name, Messages[i].Name);
+  }
+  fprintf(f, "} CAN_MSGS_Any_t;\n\n");
+
+  fprintf(f, "/* Every message, in DBC order (CAN_MSG_<NAME>_INDEX) */\n");
+  fprintf(f, "typedef struct\n{\n"
+             "  const char *Name;\n"
+             "  uint32_t Id;\n"
+             "  uint8_t Extended;\n"
+             "  uint8_t Dlc;\n"
+             "  uint16_t Size; /* Of the struct */\n"
+             "  uint16_t CycleMs; /* 0 for event messages */\n"
+             "  uint8_t Bus;      /* 1 or 2 */\n"
+             "  void (*Unpack)(void *pMsg, const uint8_t *pData);\n"
+             "  void (*Pack)(uint8_t *pData, const void *pMsg);\n"
+             "  uint16_t FirstSignal; /* In CAN_MSGS_Signals */\n"
+             "  uint16_t SignalCount;\n"
+             "} CAN_MSGS_Desc_t;\n\n"
+             "extern const CAN_MSGS_Desc_t CAN_MSGS_Table[CAN_MSGS_COUNT];\n\n");
+
+  fprintf(f, "/* ID to message index: direct table for the 11-bit IDs, perfect hash\n"
+             " * for the 29-bit ones (collision free, a single probe) */\n");
+  fprintf(f, "#define CAN_MSGS_EXT_HASH_MUL 0x%08XU\n#define CAN_MSGS_EXT_HASH_SHIFT %uU\n"
+             "#define CAN_MSGS_EXT_HASH_SIZE %uU\n"
+             "#define CAN_MSGS_EXT_BUCKET_MUL 0x%08XU\n#define CAN_MSGS_EXT_BUCKET_SHIFT %uU\n"
+             "#define CAN_MSGS_EXT_BUCKETS %uU\n\n",
+          HashMul, 32U - HashBits, 1U << HashBits, HashBucketMul, 32U - HashBucketBits, 1U << HashBucketBits);
+  fprintf(f, "typedef %s CAN_MSGS_Slot_t; /* Message index + 1, 0 when unknown */\n\n",
+          (MessageCount < 255U) ? "uint8_t" : "uint16_t");
+  fprintf(f, "typedef struct\n{\n"
+             "  uint32_t Id; /* 0xFFFFFFFF when empty */\n"
+             "  CAN_MSGS_Slot_t Msg;\n"
+             "} CAN_MSGS_ExtSlot_t;\n\n"
+             "extern const CAN_MSGS_Slot_t CAN_MSGS_StdMap[2048];\n"
+             "extern const CAN_MSGS_ExtSlot_t CAN_MSGS_ExtMap[CAN_MSGS_EXT_HASH_SIZE];\n"
+             "extern const %s CAN_MSGS_ExtDisp[CAN_MSGS_EXT_BUCKETS];\n\n",
+          (HashBits <= 8U) ? "uint8_t" : "uint16_t");
+  fprintf(f, "/* Index in CAN_MSGS_Table of a received ID, -1 if not in the DBC */\n"
+             "static inline int32_t CAN_MSGS_Lookup(uint32_t Id, uint32_t Extended)\n{\n"
+             "  const CAN_MSGS_ExtSlot_t *slot;\n\n"
+             "  if (Extended == 0U)\n  {\n"
+             "    return (int32_t)CAN_MSGS_StdMap[Id & 0x7FFU] - 1;\n  }\n"
+             "  slot = &CAN_MSGS_ExtMap[((uint32_t)(Id * CAN_MSGS_EXT_HASH_MUL) >> CAN_MSGS_EXT_HASH_SHIFT) ^\n"
+             "                          CAN_MSGS_ExtDisp[(uint32_t)(Id * CAN_MSGS_EXT_BUCKET_MUL) >> CAN_MSGS_EXT_BUCKET_SHIFT]];\n"
+             "  return (slot->Id == Id) ? (int32_t)slot->Msg - 1 : -1;\n}\n\n");
+  fprintf(f, "/* Layout of every signal for generic tools (define CAN_MSGS_SIGNAL_TABLE) */\n"
+             "#ifdef CAN_MSGS_SIGNAL_TABLE\n"
+             "typedef struct\n{\n"
+             "  const char *Name;\n"
+             "  uint16_t Start;  /* DBC start bit */\n"
+             "  uint8_t Length;\n"
+             "  uint8_t Motorola;\n"
+             "  uint8_t Signed;\n"
+             "  uint8_t FieldSigned;\n"
+             "  uint8_t FieldSize;\n"
+             "  uint16_t FieldOffset;\n"
+             "  int64_t Mul; /* Field = raw * Mul + Off */\n"
+             "  int64_t Off;\n"
+             "  int64_t Scale;\n"
+             "} CAN_MSGS_Signal_t;\n\n"
+             "extern const CAN_MSGS_Signal_t CAN_MSGS_Signals[CAN_MSGS_SIGNALS];\n"
+             "#endif\n\n");
+  fprintf(f, "#endif /* %s */\n", pGuard);
+  fclose(f);
+  return 0;
+}
+
+static int emit_source(const char *pPath, const char *pHeader, const char *pDbc)
+{
+  FILE *f = fopen(pPath, "w");
+  uint32_t i, k, first = 0;
+  const Message_t *msg;
+  const Signal_t *sig;
+
+  if (f == NULL)
+  {
+    perror(pPath);
+    return -1;
+  }
+
+  fprintf(f, "/* Generated by tools/dbcgen from %s, do not edit */\n\n", pDbc);
+  fprintf(f, "#include \"%s\"\n\n#include <string.h>\n\n", pHeader);
+  fprintf(f, "/* Little endian targets (Cortex-M7, x86) */\n"
+             "static inline uint64_t CAN_MSGS_LoadLE(const uint8_t *pData)\n{\n"
+             "  uint64_t w;\n\n  memcpy(&w, pData, sizeof(w));\n  return w;\n}\n\n"
+             "static inline uint64_t CAN_MSGS_Swap(uint64_t Word)\n{\n"
+             "  return __builtin_bswap64(Word);\n}\n\n"
+             "static inline uint64_t CAN_MSGS_LoadBE(const uint8_t *pData)\n{\n"
+             "  return CAN_MSGS_Swap(CAN_MSGS_LoadLE(pData));\n}\n\n"
+             "static inline void CAN_MSGS_Store(uint8_t *pData, uint64_t Word, uint32_t Size)\n{\n"
+             "  memcpy(pData, &Word, Size);\n}\n\n");
+  fprintf(f, "/* Messages without big endian signals leave these unused */\n"
+             "static inline uint64_t CAN_MSGS_LoadBE(const uint8_t *pData) __attribute__((unused));\n"
+             "static inline uint64_t CAN_MSGS_Swap(uint64_t Word) __attribute__((unused));\n"
+             "static inline uint64_t CAN_MSGS_LoadLE(const uint8_t *pData) __attribute__((unused));\n"
+             "static inline void CAN_MSGS_Store(uint8_t *pData, uint64_t Word, uint32_t Size) "
+             "__attribute__((unused));\n\n");
+
+  for (i = 0; i < MessageCount; i++)
+  {
+    emit_message_c(f, &Messages[i]);
+  }
+
+  for (i = 0; i < MessageCount; i++)
+  {
+    msg = &Messages[i];
+    fprintf(f,
+            "static void CAN_MSGS_Unpack_%s(void *pMsg, const uint8_t *pData)\n{\n"
+            "  CAN_MSG_%s_Unpack((CAN_MSG_%s_t *)pMsg, pData);\n}\n\n"
+            "static void CAN_MSGS_Pack_%s(uint8_t *pData, const void *pMsg)\n{\n"
+            "  CAN_MSG_%s_Pack(pData, (const CAN_MSG_%s_t *)pMsg);\n}\n\n",
+            msg->Name, msg->Name, msg->Name, msg->Name, msg->Name, msg->Name);
+  }
+
+  fprintf(f, "const CAN_MSGS_Desc_t CAN_MSGS_Table[CAN_MSGS_COUNT] = {\n");
+  for (i = 0; i < MessageCount; i++)
+  {
+    msg = &Messages[i];
+    fprintf(f,
+            "    {\"%s\", CAN_MSG_%s_ID, %uU, %uU, sizeof(CAN_MSG_%s_t), %uU, %uU, CAN_MSGS_Unpack_%s, "
+            "CAN_MSGS_Pack_%s, %uU, %uU},\n",
+            msg->Name, msg->Name, msg->Extended ? 1U : 0U, msg->Dlc, msg->Name, msg->CycleMs, msg->Bus, msg->Name,
+            msg->Name, first, msg->Count);
+    first += msg->Count;
+  }
+  fprintf(f, "};\n\n");
+
+  fprintf(f, "const CAN_MSGS_Slot_t CAN_MSGS_StdMap[2048] = {\n");
+  for (i = 0; i < MessageCount; i++)
+  {
+    if (!Messages[i].Extended)
+    {
+      fprintf(f, "    [CAN_MSG_%s_ID] = %uU,\n", Messages[i].Name, i + 1U);
+    }
+  }
+  fprintf(f, "};\n\nconst CAN_MSGS_ExtSlot_t CAN_MSGS_ExtMap[CAN_MSGS_EXT_HASH_SIZE] = {\n");
+  for (i = 0; i < (1U << HashBits); i++)
+  {
+    if (HashSlots[i] < 0)
+    {
+      fprintf(f, "    {0xFFFFFFFFU, 0U},\n");
+    }
+    else
+    {
+      fprintf(f, "    {CAN_MSG_%s_ID, %uU},\n", Messages[HashSlots[i]].Name, (uint32_t)HashSlots[i] + 1U);
+    }
+  }
+  fprintf(f, "};\n\nconst %s CAN_MSGS_ExtDisp[CAN_MSGS_EXT_BUCKETS] = {", (HashBits <= 8U) ? "uint8_t" : "uint16_t");
+  for (i = 0; i < (1U << HashBucketBits); i++)
+  {
+    fprintf(f, "%s%uU", (i % 16U == 0U) ? "\n    " : " ", HashDisp[i]);
+    if (i + 1U < (1U << HashBucketBits))
+    {
+      fprintf(f, ",");
+    }
+  }
+  fprintf(f, "\n};\n\n");
+
+  fprintf(f, "#ifdef CAN_MSGS_SIGNAL_TABLE\nconst CAN_MSGS_Signal_t CAN_MSGS_Signals[CAN_MSGS_SIGNALS] = {\n");
+  for (i = 0; i < MessageCount; i++)
+  {
+    msg = &Messages[i];
+    for (k = 0; k < msg->Count; k++)
+    {
+      sig = &msg->Signals[k];
+      fprintf(f,
+              "    {\"%s.%s\", %u, %u, %u, %u, %u, sizeof(((CAN_MSG_%s_t *)0)->%s), offsetof(CAN_MSG_%s_t, %s), "
+              "%" PRId64 ", %" PRId64 ", %" PRId64 "},\n",
+              msg->Name, sig->Name, sig->Start, sig->Length, sig->Motorola, sig->Signed,
+              (sig->Signed || !sig->Raw) ? 1U : 0U, msg->Name, sig->Name, msg->Name, sig->Name, sig->Mul, sig->Off,
+              sig->Scale);
+    }
+  }
+  fprintf(f, "};\n#endif\n");
+  fclose(f);
+  return 0;
+}
+
+static uint32_t hash_rand(uint64_t *pState)
+{
+  *pState ^= *pState << 13;
+  *pState ^= *pState >> 7;
+  *pState ^= *pState << 17;
+  return (uint32_t)*pState | 1U;
+}
+
+/*
+ * Perfect hash of the extended IDs, hash and displace: an ID falls in a
+ * bucket, slot = h(ID) ^ displacement of its bucket. Buckets are placed
+ * largest first, each with the first displacement that lands all its IDs in
+ * free slots. The table is the smallest power of two that works with one of
+ * a few hundred multiplier pairs, about 4 IDs per bucket.
+ */
+static int perfect_hash(void)
+{
+  uint64_t rng = 0x2545F4914F6CDD1DULL;
+  uint32_t count = 0, bits = 1, bbits, size, buckets, i, k, tries, d, b, n, slot;
+  uint32_t *order = NULL, *fill = NULL;
+  int ok;
+
+  for (i = 0; i < MessageCount; i++)
+  {
+    count += (uint32_t)Messages[i].Extended;
+  }
+  while ((1U << bits) * 4U < count * 5U)
+  {
+    bits++;
+  }
+
+  for (; bits <= HASH_BITS_MAX; bits++)
+  {
+    size = 1U << bits;
+    bbits = (bits > 2U) ? bits - 2U : 1U;
+    buckets = 1U << bbits;
+    HashSlots = realloc(HashSlots, size * sizeof(int32_t));
+    HashDisp = realloc(HashDisp, buckets * sizeof(uint32_t));
+    order = realloc(order, buckets * sizeof(uint32_t));
+    fill = realloc(fill, buckets * sizeof(uint32_t));
+    if (HashSlots == NULL || HashDisp == NULL || order == NULL || fill == NULL)
+    {
+      return -1;
+    }
+
+    for (tries = 0; tries < HASH_TRIES; tries++)
+    {
+      HashMul = hash_rand(&rng);
+      HashBucketMul = hash_rand(&rng);
+      HashBits = bits;
+      HashBucketBits = bbits;
+      for (i = 0; i < size; i++)
+      {
+        HashSlots[i] = -1;
+      }
+      memset(fill, 0, buckets * sizeof(uint32_t));
+      for (i = 0; i < MessageCount; i++)
+      {
+        if (Messages[i].Extended)
+        {
+          fill[(uint32_t)(Messages[i].Id * HashBucketMul) >> (32U - bbits)]++;
+        }
+      }
+      /* Largest buckets first */
+      for (i = 0; i < buckets; i++)
+      {
+        for (k = i; k > 0U && fill[order[k - 1U]] < fill[i]; k--)
+        {
+          order[k] = order[k - 1U];
+        }
+        order[k] = i;
+      }
+
+      ok = 1;
+      for (b = 0; b < buckets && ok && fill[order[b]] != 0U; b++)
+      {
+        for (d = 0; d < size; d++)
+        {
+          n = 0;
+          for (i = 0; i < MessageCount; i++)
+          {
+            if (Messages[i].Extended && ((uint32_t)(Messages[i].Id * HashBucketMul) >> (32U - bbits)) == order[b])
+            {
+              slot = ((uint32_t)(Messages[i].Id * HashMul) >> (32U - bits)) ^ d;
+              if (HashSlots[slot] >= 0)
+              {
+                break;
+              }
+              HashSlots[slot] = (int32_t)i;
+              n++;
+            }
+          }
+          if (i == MessageCount)
+          {
+            break;
+          }
+          /* Undo the partial placement */
+          for (i = 0; i < size; i++)
+          {
+            if (HashSlots[i] >= 0 &&
+                ((uint32_t)(Messages[HashSlots[i]].Id * HashBucketMul) >> (32U - bbits)) == order[b])
+            {
+              HashSlots[i] = -1;
+            }
+          }
+        }
+        HashDisp[order[b]] = d;
+        ok = (d < size);
+      }
+      for (; b < buckets; b++)
+      {
+        HashDisp[order[b]] = 0U;
+      }
+      if (ok)
+      {
+        free(order);
+        free(fill);
+        return 0;
+      }
+    }
+  }
+  free(order);
+  free(fill);
+  fprintf(stderr, "no perfect hash for %u extended IDs\n", count);
+  return -1;
+}
+
+int main(int argc, char **argv)
+{
+  const char *base = (argc > 3) ? argv[3] : "can_msgs";
+  const char *dbc;
+  char path[1024], header[256], guard[256];
+  uint32_t i, k, signals = 0;
+
+  if (argc < 3)
+  {
+    fprintf(stderr, "usage: %s IN.dbc OUTDIR [BASENAME]\n", argv[0]);
+    return 2;
+  }
+  if (parse(argv[1]) != 0)
+  {
+    return 1;
+  }
+
+  /* IDs are unique per ID type */
+  for (i = 0; i < MessageCount; i++)
+  {
+    signals += Messages[i].Count;
+    for (k = 0; k < i; k++)
+    {
+      if (Messages[i].Id == Messages[k].Id && Messages[i].Extended == Messages[k].Extended)
+      {
+        fprintf(stderr, "%s and %s share ID 0x%X\n", Messages[k].Name, Messages[i].Name, Messages[i].Id);
+        return 1;
+      }
+    }
+  }
+
+  if (perfect_hash() != 0)
+  {
+    return 1;
+  }
+
+  dbc = strrchr(argv[1], '/') != NULL ? strrchr(argv[1], '/') + 1 : argv[1];
+  snprintf(header, sizeof(header), "%s.h", base);
+  upper(guard, base);
+  strcat(guard, "_H");
+
+  snprintf(path, sizeof(path), "%s/%s.h", argv[2], base);
+  if (emit_header(path, guard, dbc) != 0)
+  {
+    return 1;
+  }
+  snprintf(path, sizeof(path), "%s/%s.c", argv[2], base);
+  if (emit_source(path, header, dbc) != 0)
+  {
+    return 1;
+  }
+
+  printf("%s: %u messages, %u signals, %u warnings\n", dbc, MessageCount, signals, Warnings);
+  return 0;
+}
@@ -0,0 +1,201 @@
+#include "flash_file.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*
+ * NOR flash model backed by a file: programming can only clear bits, erase
+ * sets a whole sector to 0xFF, and program/erase keep the part busy for a
+ * time measured on a virtual clock driven by the caller, like the QSPI
+ * scheduler does on the target. A read during a program/erase suspends it,
+ * pushing its completion back by the time the read took. A power cut can be
+ * armed to stop programming after a given number of bytes, leaving a torn
+ * page or a half-erased sector behind.
+ */
+
+static struct
+{
+  int Fd;
+  uint8_t *Map;
+  uint32_t Size;
+  uint64_t Now;
+  uint64_t BusyUntil;
+  int Erasing;
+  int64_t CutBytes; /* Bytes left before the power cut, -1 when disarmed */
+  FLASH_FILE_Stats_t Stats;
+} FLASH_FILE_Ctx = {.Fd = -1, .CutBytes = -1};
+
+static int32_t FLASH_FILE_Read(uint8_t *pData, uint32_t Addr, uint32_t Size);
+static int32_t FLASH_FILE_Write(uint8_t *pData, uint32_t Addr, uint32_t Size);
+static int32_t FLASH_FILE_EraseSector(uint32_t Addr);
+static int32_t FLASH_FILE_IsBusy(void);
+
+const TLOG_Flash_t FLASH_FILE_Flash = {
+    .Read = FLASH_FILE_Read,
+    .Write = FLASH_FILE_Write,
+    .EraseSector = FLASH_FILE_EraseSector,
+    .IsBusy = FLASH_FILE_IsBusy,
+};
+
+/**
+ * Map Path as the flash array, creating it erased if it does not exist.
+ * @param Path backing file
+ * @param Size array size
+ * @return BSP status
+ */
+int32_t FLASH_FILE_Open(const char *Path, uint32_t Size)
+{
+  off_t old;
+
+  FLASH_FILE_Close();
+
+  FLASH_FILE_Ctx.Fd = open(Path, O_RDWR | O_CREAT, 0644);
+  if (FLASH_FILE_Ctx.Fd < 0)
+    return BSP_ERROR_PERIPH_FAILURE;
+
+  old = lseek(FLASH_FILE_Ctx.Fd, 0, SEEK_END);
+  if (ftruncate(FLASH_FILE_Ctx.Fd, Size) != 0)
+    return BSP_ERROR_PERIPH_FAILURE;
+
+  FLASH_FILE_Ctx.Map = mmap(NULL, Size, PROT_READ | PROT_WRITE, MAP_SHARED, FLASH_FILE_Ctx.Fd, 0);
+  if (FLASH_FILE_Ctx.Map == MAP_FAILED)
+  {
+    FLASH_FILE_Ctx.Map = NULL;
+    return BSP_ERROR_PERIPH_FAILURE;
+  }
+
+  if ((uint32_t)old < Size)
+    memset(FLASH_FILE_Ctx.Map + old, 0xFF, Size - (uint32_t)old);
+
+  FLASH_FILE_Ctx.Size = Size;
+  FLASH_FILE_Ctx.BusyUntil = FLASH_FILE_Ctx.Now;
+  FLASH_FILE_Ctx.CutBytes = -1;
+  memset(&FLASH_FILE_Ctx.Stats, 0, sizeof(FLASH_FILE_Ctx.Stats));
+
+  return BSP_ERROR_NONE;
+}
+
+void FLASH_FILE_Close(void)
+{
+  if (FLASH_FILE_Ctx.Map != NULL)
+    munmap(FLASH_FILE_Ctx.Map, FLASH_FILE_Ctx.Size);
+  if (FLASH_FILE_Ctx.Fd >= 0)
+    close(FLASH_FILE_Ctx.Fd);
+  FLASH_FILE_Ctx.Map = NULL;
+  FLASH_FILE_Ctx.Fd = -1;
+}
+
+void FLASH_FILE_Advance(uint64_t Us)
+{
+  FLASH_FILE_Ctx.Now += Us;
+}
+
+uint64_t FLASH_FILE_Now(void)
+{
+  return FLASH_FILE_Ctx.Now;
+}
+
+/**
+ * Arm a power cut: the array stops changing after Bytes more programmed or
+ * erased bytes, and every later program/erase fails. Negative disarms.
+ */
+void FLASH_FILE_CutAfter(int64_t Bytes)
+{
+  FLASH_FILE_Ctx.CutBytes = Bytes;
+}
+
+void FLASH_FILE_GetStats(FLASH_FILE_Stats_t *Stats)
+{
+  *Stats = FLASH_FILE_Ctx.Stats;
+}
+
+/**
+ * Erase in progress, for the statistics of the caller.
+ */
+int FLASH_FILE_Erasing(void)
+{
+  return FLASH_FILE_Ctx.Erasing && FLASH_FILE_Ctx.Now < FLASH_FILE_Ctx.BusyUntil;
+}
+
+static int32_t FLASH_FILE_Read(uint8_t *pData, uint32_t Addr, uint32_t Size)
+{
+  uint64_t cost = FLASH_FILE_READ_SETUP_US + Size / FLASH_FILE_READ_BYTES_PER_US;
+
+  if (Addr + Size > FLASH_FILE_Ctx.Size)
+    return BSP_ERROR_COMPONENT_FAILURE;
+
+  /* Suspend, read, resume: the operation in flight is paused meanwhile */
+  if (FLASH_FILE_Ctx.Now < FLASH_FILE_Ctx.BusyUntil)
+  {
+    cost += FLASH_FILE_SUSPEND_US;
+    FLASH_FILE_Ctx.BusyUntil += cost;
+    FLASH_FILE_Ctx.Stats.Suspends++;
+  }
+  FLASH_FILE_Ctx.Now += cost;
+
+  memcpy(pData, FLASH_FILE_Ctx.Map + Addr, Size);
+  FLASH_FILE_Ctx.Stats.Reads++;
+  FLASH_FILE_Ctx.Stats.ReadBytes += Size;
+
+  return BSP_ERROR_NONE;
+}
+
+static int32_t FLASH_FILE_Write(uint8_t *pData, uint32_t Addr, uint32_t Size)
+{
+  uint32_t i;
+
+  if (Addr + Size > FLASH_FILE_Ctx.Size || FLASH_FILE_IsBusy() == BSP_ERROR_BUSY)
+    return BSP_ERROR_COMPONENT_FAILURE;
+
+  for (i = 0; i < Size; i++)
+  {
+    if (FLASH_FILE_Ctx.CutBytes == 0)
+      return BSP_ERROR_COMPONENT_FAILURE;
+    if (FLASH_FILE_Ctx.CutBytes > 0)
+      FLASH_FILE_Ctx.CutBytes--;
+    FLASH_FILE_Ctx.Map[Addr + i] &= pData[i];
+  }
+
+  FLASH_FILE_Ctx.BusyUntil =
+      FLASH_FILE_Ctx.Now + ((Size + TLOG_PAGE_SIZE - 1U) / TLOG_PAGE_SIZE) * FLASH_FILE_PAGE_PROGRAM_US;
+  FLASH_FILE_Ctx.Erasing = 0;
+  FLASH_FILE_Ctx.Stats.Writes++;
+
+  return BSP_ERROR_NONE;
+}
+
+static int32_t FLASH_FILE_EraseSector(uint32_t Addr)
+{
+  uint32_t size = TLOG_SECTOR_SIZE;
+
+  if ((Addr % TLOG_SECTOR_SIZE) != 0U || Addr >= FLASH_FILE_Ctx.Size || FLASH_FILE_IsBusy() == BSP_ERROR_BUSY)
+    return BSP_ERROR_COMPONENT_FAILURE;
+
+  if (FLASH_FILE_Ctx.CutBytes == 0)
+    return BSP_ERROR_COMPONENT_FAILURE;
+  if (FLASH_FILE_Ctx.CutBytes > 0)
+  {
+    if (FLASH_FILE_Ctx.CutBytes < (int64_t)size)
+      size = (uint32_t)FLASH_FILE_Ctx.CutBytes;
+    FLASH_FILE_Ctx.CutBytes -= size;
+  }
+
+  memset(FLASH_FILE_Ctx.Map + Addr, 0xFF, size);
+  FLASH_FILE_Ctx.BusyUntil = FLASH_FILE_Ctx.Now + FLASH_FILE_SECTOR_ERASE_US;
+  FLASH_FILE_Ctx.Erasing = 1;
+  FLASH_FILE_Ctx.Stats.Erases++;
+
+  return BSP_ERROR_NONE;
+}
+
+/**
+ * A status register read takes about a microsecond on the bus, which also
+ * lets a caller spinning on the status see the erase complete.
+ */
+static int32_t FLASH_FILE_IsBusy(void)
+{
+  FLASH_FILE_Ctx.Now += FLASH_FILE_STATUS_POLL_US;
+  return (FLASH_FILE_Ctx.Now < FLASH_FILE_Ctx.BusyUntil) ? BSP_ERROR_BUSY : BSP_ERROR_NONE;
+}
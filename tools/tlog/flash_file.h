@@ -0,0 +1,35 @@
+#ifndef FLASH_FILE_H
+#define FLASH_FILE_H
+
+#include <stdint.h>
+
+#include "sw/tlog.h"
+
+/* MT25TL01G figures for the dual-die part, in microseconds */
+#define FLASH_FILE_PAGE_PROGRAM_US 120U
+#define FLASH_FILE_SECTOR_ERASE_US 150000U
+#define FLASH_FILE_STATUS_POLL_US 1U
+#define FLASH_FILE_SUSPEND_US 40U
+#define FLASH_FILE_READ_SETUP_US 1U
+#define FLASH_FILE_READ_BYTES_PER_US 40U
+
+typedef struct
+{
+  uint32_t Reads;
+  uint32_t ReadBytes;
+  uint32_t Writes;
+  uint32_t Erases;
+  uint32_t Suspends;
+} FLASH_FILE_Stats_t;
+
+int32_t FLASH_FILE_Open(const char *Path, uint32_t Size);
+void FLASH_FILE_Close(void);
+void FLASH_FILE_Advance(uint64_t Us);
+uint64_t FLASH_FILE_Now(void);
+void FLASH_FILE_CutAfter(int64_t Bytes);
+int FLASH_FILE_Erasing(void);
+void FLASH_FILE_GetStats(FLASH_FILE_Stats_t *Stats);
+
+extern const TLOG_Flash_t FLASH_FILE_Flash;
+
+#endif /* FLASH_FILE_H */
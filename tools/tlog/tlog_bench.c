@@ -0,0 +1,374 @@
+/*
+ * Host benchmark and consistency check of the telemetry log (sw/tlog.c)
+ * against the file-backed NOR model.
+ *
+ *   tlog_bench <flash-file> [channels] [seconds]
+ *
+ * 1. throughput: <channels> channels sampled at 1 kHz for <seconds> of
+ *    virtual time, main loop calling TLOG_Process() every 20 us
+ * 2. seek: random timestamp lookups on the log left by 1.
+ * 3. seek latency while logging, one lookup every 10 ms, first waiting for
+ *    the flash to be idle and then suspending the program/erase in flight
+ * 4. power loss: repeated cuts at a random byte of a program or erase,
+ *    remount, full read-back check, then logging resumes on the same log
+ *
+ * Exits with 1 if a check fails.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "flash_file.h"
+#include "sw/tlog.h"
+
+#define BENCH_LOOP_US 20U
+#define BENCH_PAYLOAD 8U
+#define BENCH_SEEKS 1000U
+#define BENCH_CUTS 50U
+#define BENCH_CUT_FLASH_SIZE (32U * TLOG_SECTOR_SIZE)
+#define BENCH_LATENCY_SECONDS 20U
+#define BENCH_LATENCY_PERIOD_MS 10U
+
+static TLOG_Flash_t Flash;
+static uint32_t Channels = 8U;
+static uint8_t *Present; /* Timestamps found by the last bench_verify() */
+static uint32_t PresentSize;
+static uint64_t AppendNs, ProcessNs;
+static void (*Hook)(uint32_t Ms); /* Called by bench_run() every millisecond */
+
+static uint64_t bench_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void bench_payload(uint16_t Channel, uint32_t Timestamp, uint8_t *pData)
+{
+  uint32_t a = Timestamp ^ (Channel * 0x9E3779B9U);
+  uint32_t b = ~Timestamp + Channel;
+
+  memcpy(pData, &a, sizeof(a));
+  memcpy(pData + sizeof(a), &b, sizeof(b));
+}
+
+/**
+ * Log every channel once per virtual millisecond from Start to End.
+ * @return the millisecond reached, earlier than End when the flash failed
+ */
+static uint32_t bench_run(uint32_t Start, uint32_t End)
+{
+  uint8_t payload[BENCH_PAYLOAD];
+  uint64_t t0, next, base = FLASH_FILE_Now();
+  uint32_t ms, ch;
+  int32_t ret = BSP_ERROR_NONE;
+
+  for (ms = Start; ms < End; ms++)
+  {
+    t0 = bench_ns();
+    for (ch = 0; ch < Channels; ch++)
+    {
+      bench_payload((uint16_t)ch, ms, payload);
+      TLOG_Append((uint16_t)ch, ms, payload, sizeof(payload));
+    }
+    AppendNs += bench_ns() - t0;
+
+    if (Hook != NULL)
+      Hook(ms);
+
+    next = base + (uint64_t)(ms - Start + 1U) * 1000U;
+    while (FLASH_FILE_Now() < next && ret >= BSP_ERROR_NONE)
+    {
+      t0 = bench_ns();
+      ret = TLOG_Process();
+      ProcessNs += bench_ns() - t0;
+      if (ret == BSP_ERROR_BUSY)
+        ret = BSP_ERROR_NONE;
+      FLASH_FILE_Advance(BENCH_LOOP_US);
+    }
+    if (ret < BSP_ERROR_NONE)
+      break;
+  }
+
+  return ms;
+}
+
+/**
+ * Drain the staging buffers to flash.
+ */
+static void bench_drain(void)
+{
+  uint64_t end = FLASH_FILE_Now() + 2000000U;
+  int32_t ret;
+
+  TLOG_Flush();
+  while (FLASH_FILE_Now() < end)
+  {
+    ret = TLOG_Process();
+    if (ret < BSP_ERROR_NONE && ret != BSP_ERROR_BUSY)
+      break;
+    FLASH_FILE_Advance(BENCH_LOOP_US);
+  }
+}
+
+/**
+ * Read the whole log back and check every record.
+ * @param Count set to the number of records read
+ * @param First set to the first timestamp found
+ * @param Last set to the last timestamp found
+ * @return number of bad records
+ */
+static uint32_t bench_verify(uint32_t *Count, uint32_t *First, uint32_t *Last)
+{
+  static TLOG_Cursor_t cursor;
+  static TLOG_Record_t record;
+  uint8_t expect[BENCH_PAYLOAD];
+  uint32_t bad = 0, prev = 0;
+
+  *Count = 0;
+  *First = 0;
+  *Last = 0;
+  if (TLOG_Seek(0, &cursor) != BSP_ERROR_NONE)
+    return 0;
+
+  while (TLOG_ReadNext(&cursor, &record) == BSP_ERROR_NONE)
+  {
+    bench_payload(record.Channel, record.Timestamp, expect);
+    if (record.Size != BENCH_PAYLOAD || memcmp(record.Data, expect, BENCH_PAYLOAD) != 0 ||
+        record.Channel >= Channels || record.Timestamp < prev)
+      bad++;
+    if (Present != NULL && record.Timestamp < PresentSize)
+      Present[record.Timestamp] = 1;
+    if (*Count == 0)
+      *First = record.Timestamp;
+    prev = record.Timestamp;
+    *Last = record.Timestamp;
+    (*Count)++;
+  }
+
+  return bad;
+}
+
+static int bench_throughput(const char *Path, uint32_t Seconds)
+{
+  TLOG_Stats_t stats;
+  FLASH_FILE_Stats_t fstats;
+  uint32_t count, first, last, bad;
+  uint64_t start = FLASH_FILE_Now();
+
+  unlink(Path);
+  if (FLASH_FILE_Open(Path, Flash.Size) != BSP_ERROR_NONE || TLOG_Init(&Flash) != BSP_ERROR_NONE)
+  {
+    printf("cannot open %s\n", Path);
+    return 1;
+  }
+
+  bench_run(0, Seconds * 1000U);
+  TLOG_GetStats(&stats);
+  FLASH_FILE_GetStats(&fstats);
+
+  printf("throughput: %" PRIu32 " channels x 1 kHz, %" PRIu32 " B payload, %" PRIu32 " s\n", Channels,
+         (uint32_t)BENCH_PAYLOAD, Seconds);
+  printf("  records %" PRIu32 " dropped %" PRIu32 " pages %" PRIu32 " erases %" PRIu32 "\n", stats.Records,
+         stats.Dropped, stats.Pages, stats.Erases);
+  printf("  staging high-water %" PRIu32 "/%u pages, erase stalls %" PRIu32 "\n", stats.StageHigh,
+         TLOG_STAGE_PAGES, stats.EraseStalls);
+  printf("  flash write %.1f KB/s, host cost %.0f ns/append %.0f ns/ms of process\n",
+         stats.Pages * (double)TLOG_PAGE_SIZE / 1024.0 / ((FLASH_FILE_Now() - start) / 1e6),
+         (double)AppendNs / stats.Records, (double)ProcessNs / (Seconds * 1000.0));
+
+  bench_drain();
+  bad = bench_verify(&count, &first, &last);
+  printf("  read back %" PRIu32 " records [%" PRIu32 " .. %" PRIu32 "] ms, %" PRIu32 " bad\n", count, first, last,
+         bad);
+
+  /* Until the ring wraps every accepted record must come back */
+  if (fstats.Erases < Flash.Size / TLOG_SECTOR_SIZE && count != stats.Records)
+    bad++;
+
+  return bad != 0;
+}
+
+static int bench_seek(void)
+{
+  static TLOG_Cursor_t cursor;
+  static TLOG_Record_t record;
+  FLASH_FILE_Stats_t before, after;
+  uint32_t count, first, last, i, target, expect, wrong = 0;
+  uint64_t t0, ns = 0;
+
+  bench_verify(&count, &first, &last);
+  if (count == 0)
+    return 1;
+
+  FLASH_FILE_GetStats(&before);
+  for (i = 0; i < BENCH_SEEKS; i++)
+  {
+    target = first + (uint32_t)rand() % (last - first + 1U);
+    t0 = bench_ns();
+    if (TLOG_Seek(target, &cursor) != BSP_ERROR_NONE || TLOG_ReadNext(&cursor, &record) != BSP_ERROR_NONE)
+    {
+      wrong++;
+      continue;
+    }
+    ns += bench_ns() - t0;
+    /* First logged millisecond at or after the target, dropped ones skipped */
+    for (expect = target; expect < last && Present[expect] == 0; expect++)
+    {
+    }
+    if (record.Timestamp != expect)
+      wrong++;
+  }
+  FLASH_FILE_GetStats(&after);
+
+  printf("seek: %u lookups, %.1f flash reads and %.0f bytes per lookup, %.1f us host, %" PRIu32 " wrong\n",
+         BENCH_SEEKS, (double)(after.Reads - before.Reads) / BENCH_SEEKS,
+         (double)(after.ReadBytes - before.ReadBytes) / BENCH_SEEKS, ns / 1000.0 / BENCH_SEEKS, wrong);
+
+  return wrong != 0;
+}
+
+static uint32_t Latency[2][BENCH_LATENCY_SECONDS * 1000U / BENCH_LATENCY_PERIOD_MS];
+static uint32_t LatencyCount[2];
+
+static void bench_latency_hook(uint32_t Ms)
+{
+  static TLOG_Cursor_t cursor;
+  static TLOG_Record_t record;
+  uint64_t t0 = FLASH_FILE_Now();
+  int erasing = FLASH_FILE_Erasing();
+
+  if (Ms == 0 || (Ms % BENCH_LATENCY_PERIOD_MS) != 0)
+    return;
+
+  if (TLOG_Seek((uint32_t)rand() % Ms, &cursor) == BSP_ERROR_NONE)
+    TLOG_ReadNext(&cursor, &record);
+  Latency[erasing][LatencyCount[erasing]++] = (uint32_t)(FLASH_FILE_Now() - t0);
+}
+
+static int bench_cmp(const void *A, const void *B)
+{
+  uint32_t a = *(const uint32_t *)A, b = *(const uint32_t *)B;
+
+  return (a > b) - (a < b);
+}
+
+static void bench_percentiles(const char *Name, uint32_t *Values, uint32_t Count)
+{
+  if (Count == 0)
+    return;
+
+  qsort(Values, Count, sizeof(*Values), bench_cmp);
+  printf("  %-12s %5" PRIu32 " seeks  p50 %6" PRIu32 "  p90 %6" PRIu32 "  p99 %6" PRIu32 "  max %6" PRIu32 " us\n",
+         Name, Count, Values[Count / 2], Values[Count * 9 / 10], Values[Count * 99 / 100], Values[Count - 1]);
+}
+
+static int bench_seek_latency(const char *Path, uint32_t ReadWhileBusy)
+{
+  TLOG_Stats_t stats;
+  FLASH_FILE_Stats_t fstats;
+
+  unlink(Path);
+  Flash.ReadWhileBusy = ReadWhileBusy;
+  if (FLASH_FILE_Open(Path, Flash.Size) != BSP_ERROR_NONE || TLOG_Init(&Flash) != BSP_ERROR_NONE)
+    return 1;
+
+  LatencyCount[0] = LatencyCount[1] = 0;
+  Hook = bench_latency_hook;
+  bench_run(0, BENCH_LATENCY_SECONDS * 1000U);
+  Hook = NULL;
+  TLOG_GetStats(&stats);
+  FLASH_FILE_GetStats(&fstats);
+
+  printf("seek latency while logging, %s:\n", ReadWhileBusy ? "suspending program/erase" : "waiting for idle flash");
+  bench_percentiles("no erase", Latency[0], LatencyCount[0]);
+  bench_percentiles("during erase", Latency[1], LatencyCount[1]);
+  printf("  %" PRIu32 " suspends, %" PRIu32 " records dropped\n", fstats.Suspends, stats.Dropped);
+
+  Flash.ReadWhileBusy = 0;
+  return 0;
+}
+
+static int bench_power_loss(const char *Path)
+{
+  TLOG_Stats_t stats;
+  uint32_t i, count, first, last, bad, lost, worst = 0, torn = 0, failures = 0;
+  uint32_t ms = 0, cut_ms, stop_ms;
+
+  unlink(Path);
+  Flash.Size = BENCH_CUT_FLASH_SIZE;
+  if (FLASH_FILE_Open(Path, Flash.Size) != BSP_ERROR_NONE)
+    return 1;
+
+  for (i = 0; i < BENCH_CUTS; i++)
+  {
+    TLOG_Init(&Flash);
+
+    /* Log until the cut, at a random byte somewhere in the next seconds */
+    cut_ms = ms + 200U + (uint32_t)rand() % 3000U;
+    bench_run(ms, cut_ms);
+    FLASH_FILE_CutAfter((int64_t)(rand() % TLOG_SECTOR_SIZE));
+    stop_ms = bench_run(cut_ms, cut_ms + 5000U);
+    ms = cut_ms + 5000U;
+    FLASH_FILE_CutAfter(-1);
+
+    /* Reboot: staging RAM is gone, the log must mount and read back clean */
+    TLOG_Init(&Flash);
+    bad = bench_verify(&count, &first, &last);
+    TLOG_GetStats(&stats);
+    torn += stats.TornPages;
+    lost = stop_ms - last;
+    if (lost > worst)
+      worst = lost;
+    if (bad != 0 || count == 0)
+    {
+      printf("  cut %" PRIu32 ": %" PRIu32 " bad records out of %" PRIu32 "\n", i, bad, count);
+      failures++;
+    }
+  }
+
+  printf("power loss: %u cuts, %" PRIu32 " failed, %" PRIu32 " torn pages skipped by the read-backs\n", BENCH_CUTS, failures, torn);
+  printf("  worst data loss %" PRIu32 " ms between the cut and the last record read back\n", worst);
+
+  return failures != 0;
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t seconds = 60U;
+  int ret = 0;
+
+  if (argc < 2)
+  {
+    printf("usage: %s <flash-file> [channels] [seconds]\n", argv[0]);
+    return 2;
+  }
+  if (argc > 2)
+    Channels = (uint32_t)strtoul(argv[2], NULL, 0);
+  if (argc > 3)
+    seconds = (uint32_t)strtoul(argv[3], NULL, 0);
+
+  srand(1);
+  Flash = FLASH_FILE_Flash;
+  Flash.Size = TLOG_MAX_SECTORS * TLOG_SECTOR_SIZE / 8U;
+
+  PresentSize = seconds * 1000U;
+  Present = calloc(PresentSize, 1);
+  if (Present == NULL)
+    return 2;
+
+  ret |= bench_throughput(argv[1], seconds);
+  ret |= bench_seek();
+  ret |= bench_seek_latency(argv[1], 0);
+  ret |= bench_seek_latency(argv[1], 1);
+  ret |= bench_power_loss(argv[1]);
+
+  FLASH_FILE_Close();
+  free(Present);
+  return ret;
+}
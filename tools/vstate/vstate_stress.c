@@ -0,0 +1,189 @@
+/*
+ * Host stress check of the vehicle state snapshot (Common/Src/vstate.c).
+ *
+ *   vstate_stress [readers] [seconds]
+ *
+ * One writer thread publishes back to back, as the CM4 main loop would at
+ * full speed, a state whose every word derives from the publication number.
+ * [readers] threads call VSTATE_Read() in a loop, as the CM7 would, and
+ * check each copy they are handed:
+ * - every word belongs to the same publication (no torn copy)
+ * - Seq is that publication
+ * - Seq never goes back for a reader
+ * Reads that needed a retry, and the ones that gave up, are counted: they
+ * are the cost of a reader racing a writer that never waits.
+ *
+ * Exits with 1 if a check fails.
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "vstate.h"
+
+#define STRESS_READERS_MAX 16U
+#define STRESS_WORDS (sizeof(VSTATE_t) / sizeof(uint32_t))
+#define STRESS_SEQ_WORD (offsetof(VSTATE_t, Seq) / sizeof(uint32_t))
+#define STRESS_TIME_WORD (offsetof(VSTATE_t, TimeUs) / sizeof(uint32_t))
+
+typedef struct
+{
+  pthread_t Thread;
+  uint64_t Reads;
+  uint64_t Retries; /* Attempts beyond the first */
+  uint64_t Failed;  /* VSTATE_Read() gave up after the first publication */
+  uint64_t Torn;
+  uint64_t Backwards;
+} STRESS_Reader_t;
+
+static volatile int Running = 1;
+static volatile uint32_t Published; /* Last publication number, writer */
+static STRESS_Reader_t Readers[STRESS_READERS_MAX];
+
+static uint32_t stress_word(uint32_t N, uint32_t K)
+{
+  return (N * 2654435761U) + K;
+}
+
+static uint64_t stress_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void *stress_writer(void *Arg)
+{
+  static VSTATE_t state;
+  uint32_t words[STRESS_WORDS];
+  uint32_t n = 0U, k;
+
+  (void)Arg;
+  while (Running != 0)
+  {
+    n++;
+    for (k = 0; k < STRESS_WORDS; k++)
+    {
+      words[k] = stress_word(n, k);
+    }
+    memcpy(&state, words, sizeof(words));
+    state.TimeUs = n;
+    VSTATE_Publish(&state);
+    __atomic_store_n(&Published, n, __ATOMIC_RELEASE);
+  }
+  return NULL;
+}
+
+static void *stress_reader(void *Arg)
+{
+  STRESS_Reader_t *reader = Arg;
+  static __thread VSTATE_t state;
+  uint32_t words[STRESS_WORDS];
+  uint32_t attempts, last = 0U, n, k;
+
+  while (Running != 0)
+  {
+    attempts = VSTATE_Read(&state);
+    reader->Reads++;
+    if (attempts == 0U)
+    {
+      reader->Failed += (__atomic_load_n(&Published, __ATOMIC_ACQUIRE) != 0U) ? 1U : 0U;
+      continue;
+    }
+    reader->Retries += attempts - 1U;
+
+    memcpy(words, &state, sizeof(words));
+    n = (uint32_t)state.TimeUs;
+    for (k = 0; k < STRESS_WORDS; k++)
+    {
+      if ((k != STRESS_SEQ_WORD) && (k != STRESS_TIME_WORD) && (k != (STRESS_TIME_WORD + 1U)) &&
+          (words[k] != stress_word(n, k)))
+      {
+        reader->Torn++;
+        break;
+      }
+    }
+    if ((state.Seq != n) || (state.TimeUs != n))
+    {
+      reader->Torn++;
+    }
+    if (state.Seq < last)
+    {
+      reader->Backwards++;
+    }
+    last = state.Seq;
+  }
+  return NULL;
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t readers = 3U, seconds = 5U, i;
+  uint64_t start, ns, reads = 0U, retries = 0U, failed = 0U, torn = 0U, backwards = 0U;
+  pthread_t writer;
+  struct timespec period = {0};
+
+  if (argc > 1)
+  {
+    readers = (uint32_t)strtoul(argv[1], NULL, 0);
+  }
+  if (argc > 2)
+  {
+    seconds = (uint32_t)strtoul(argv[2], NULL, 0);
+  }
+  if ((readers == 0U) || (readers > STRESS_READERS_MAX) || (seconds == 0U))
+  {
+    printf("usage: %s [readers 1..%u] [seconds]\n", argv[0], STRESS_READERS_MAX);
+    return 1;
+  }
+
+  VSTATE_Init();
+  printf("vstate %zu B, line %u, %u retries, %" PRIu32 " readers, %" PRIu32 " s\n", sizeof(VSTATE_t),
+         VSTATE_LINE, VSTATE_RETRIES, readers, seconds);
+
+  start = stress_ns();
+  pthread_create(&writer, NULL, stress_writer, NULL);
+  for (i = 0; i < readers; i++)
+  {
+    pthread_create(&Readers[i].Thread, NULL, stress_reader, &Readers[i]);
+  }
+  period.tv_sec = seconds;
+  nanosleep(&period, NULL);
+  Running = 0;
+  pthread_join(writer, NULL);
+  for (i = 0; i < readers; i++)
+  {
+    pthread_join(Readers[i].Thread, NULL);
+  }
+  ns = stress_ns() - start;
+
+  for (i = 0; i < readers; i++)
+  {
+    printf("reader %" PRIu32 ": %10" PRIu64 " reads %10" PRIu64 " retries %8" PRIu64 " failed %" PRIu64 " torn %" PRIu64
+           " backwards\n",
+           i, Readers[i].Reads, Readers[i].Retries, Readers[i].Failed, Readers[i].Torn, Readers[i].Backwards);
+    reads += Readers[i].Reads;
+    retries += Readers[i].Retries;
+    failed += Readers[i].Failed;
+    torn += Readers[i].Torn;
+    backwards += Readers[i].Backwards;
+  }
+  printf("writer:   %10" PRIu32 " publications, %.0f /s\n", Published, (double)Published * 1e9 / (double)ns);
+  printf("readers:  %10" PRIu64 " reads, %.0f /s, %.3f%% retried, %.3f%% failed\n", reads,
+         (double)reads * 1e9 / (double)ns, (reads == 0U) ? 0.0 : (double)retries * 100.0 / (double)reads,
+         (reads == 0U) ? 0.0 : (double)failed * 100.0 / (double)reads);
+
+  if ((torn != 0U) || (backwards != 0U))
+  {
+    printf("FAIL: %" PRIu64 " torn copies, %" PRIu64 " going back\n", torn, backwards);
+    return 1;
+  }
+  printf("OK: no torn copy\n");
+  return 0;
+}